@@ -23,6 +23,7 @@
 #include "Workspaces.hh"
 #include "Util.hh"
 #include "RegexString.hh"
+#include "Trace.hh"
 #include "WorkspaceIndicator.hh"
 #include "Harbour.hh"
 #include "MenuHandler.hh"
@@ -75,6 +76,7 @@ ActionHandler::handleAction(const ActionPerformed *ap)
 void
 ActionHandler::handleAction(const ActionPerformed* ap, ActionEvent::it it)
 {
+	Trace::Scope trace(Trace::KIND_ACTION, it->getAction());
 	PWinObj *wo = ap->wo;
 	Client *client = nullptr;
 	Frame *frame = nullptr;
@@ -430,7 +432,7 @@ ActionHandler::handleAnyAction(const ActionPerformed* ap, ActionEvent::it it,
 				      frame, ap->wo);
 		break;
 	case ACTION_DEBUG:
-		Debug::doAction(it->getParamS());
+		actionDebug(it->getParamS());
 		break;
 	case ACTION_WARP_POINTER:
 		actionWarpPointer(it->getParamI(0),
@@ -1062,10 +1064,64 @@ ActionHandler::actionWarpPointer(int x, int y)
 	return true;
 }
 
+/**
+ * Run Debug command, dump <name> root writes the dump to the
+ * _PEKWM_DEBUG_DUMP property on the root window where pekwm_ctrl
+ * reads it.
+ */
+void
+ActionHandler::actionDebug(const std::string &cmd)
+{
+	std::vector<std::string> args;
+	if (Util::splitString(cmd, args, " \t") == 3) {
+		Util::to_lower(args[0]);
+	}
+	if (args.size() == 3 && args[0] == "dump" && args[2] == "root") {
+		std::ostringstream os;
+		if (! Debug::dump(args[1], os)) {
+			os << "no dump named " << args[1] << std::endl;
+		}
+		X11::setUtf8String(X11::getRoot(), PEKWM_DEBUG_DUMP, os.str());
+	} else {
+		Debug::doAction(cmd);
+	}
+}
+
 //! @brief Searches the client list for a client with a title matching title
 Client*
 ActionHandler::findClientFromTitle(const std::string &or_title)
 {
+	// Plain text, optionally as /text/ or /text/i, is matched
+	// without compiling a regular expression.
+	std::string literal(or_title);
+	bool icase = false;
+	if (! literal.empty() && literal[0] == '/') {
+		std::string::size_type pos = literal.find_last_of('/');
+		std::string flags = literal.substr(pos + 1);
+		literal = pos ? literal.substr(1, pos - 1) : "";
+		icase = flags == "i";
+		if (! icase && ! flags.empty()) {
+			literal = "";
+		}
+	}
+	if (! literal.empty() && literal.find('/') == std::string::npos
+	    && TitleIndex::isLiteral(literal)) {
+		if (icase) {
+			literal = TitleIndex::fold(literal);
+		}
+		Client::client_cit it = Client::client_begin();
+		for (; it != Client::client_end(); ++it) {
+			std::string title = (*it)->getTitle()->getVisible();
+			if (icase) {
+				title = TitleIndex::fold(title);
+			}
+			if (title.find(literal) != std::string::npos) {
+				return (*it);
+			}
+		}
+		return 0;
+	}
+
 	RegexString o_rs;
 
 	if (o_rs.parse_match(or_title, true)) {
@@ -59,6 +59,7 @@ private:
 	void actionExec(Client *client, const std::string &command,
 			bool use_shell);
 	void actionSetenv(const std::string &name, const std::string &value);
+	void actionDebug(const std::string &cmd);
 	void actionFindClient(const std::string &title);
 	void actionGotoClientID(uint id);
 	void actionGotoWorkspace(const Action &action, int type);
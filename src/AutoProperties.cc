@@ -19,7 +19,7 @@
 
 #include "tk/ImageHandler.hh"
 
-static Util::StringTo<ApplyOn> apply_on_map[] =
+static Util::StringTo<ApplyOn> apply_on_map_entries[] =
 	{{"START", APPLY_ON_START},
 	 {"NEW", APPLY_ON_NEW},
 	 {"RELOAD", APPLY_ON_RELOAD},
@@ -27,8 +27,9 @@ static Util::StringTo<ApplyOn> apply_on_map[] =
 	 {"TRANSIENT", APPLY_ON_TRANSIENT},
 	 {"TRANSIENTONLY", APPLY_ON_TRANSIENT_ONLY},
 	 {nullptr, APPLY_ON_ALWAYS}};
+static Util::StringToIndex<ApplyOn> apply_on_map(apply_on_map_entries);
 
-static Util::StringTo<PropertyType> property_map[] =
+static Util::StringTo<PropertyType> property_map_entries[] =
 	{{"WORKSPACE", AP_WORKSPACE},
 	 {"PROPERTY", AP_PROPERTY},
 	 {"STICKY", AP_STICKY},
@@ -53,16 +54,19 @@ static Util::StringTo<PropertyType> property_map[] =
 	 {"DECOR", AP_DECOR},
 	 {"ICON", AP_ICON},
 	 {nullptr, AP_NO_PROPERTY}};
+static Util::StringToIndex<PropertyType> property_map(property_map_entries);
 
-static Util::StringTo<PropertyType> group_property_map[] =
+static Util::StringTo<PropertyType> group_property_map_entries[] =
 	{{"SIZE", AP_GROUP_SIZE},
 	 {"BEHIND", AP_GROUP_BEHIND},
 	 {"FOCUSEDFIRST", AP_GROUP_FOCUSED_FIRST},
 	 {"GLOBAL", AP_GROUP_GLOBAL},
 	 {"RAISE", AP_GROUP_RAISE},
 	 {nullptr, AP_NO_PROPERTY}};
+static Util::StringToIndex<PropertyType>
+	group_property_map(group_property_map_entries);
 
-static Util::StringTo<AtomName> window_type_map[] =
+static Util::StringTo<AtomName> window_type_map_entries[] =
 	{{"DESKTOP", WINDOW_TYPE_DESKTOP},
 	 {"DOCK", WINDOW_TYPE_DOCK},
 	 {"TOOLBAR", WINDOW_TYPE_TOOLBAR},
@@ -78,6 +82,7 @@ static Util::StringTo<AtomName> window_type_map[] =
 	 {"DND", WINDOW_TYPE_DND},
 	 {"NORMAL", WINDOW_TYPE_NORMAL},
 	 {nullptr, WINDOW_TYPE}};
+static Util::StringToIndex<AtomName> window_type_map(window_type_map_entries);
 
 std::ostream&
 operator<<(std::ostream& os, const ClassHint &ch)
@@ -46,7 +46,10 @@ extern "C" {
 const long Client::_clientEventMask = \
 	PropertyChangeMask|StructureNotifyMask|FocusChangeMask|KeyPressMask;
 std::vector<Client*> Client::_clients;
+uint Client::_shared_icon_size = 0;
 std::vector<uint> Client::_clientids;
+TitleIndex Client::_title_index;
+LayerObservation Client::layer_changed;
 
 Client::Client(Window new_client, ClientInitConfig &initConfig, bool is_new)
 	: PWinObj(true),
@@ -55,6 +58,8 @@ Client::Client(Window new_client, ClientInitConfig &initConfig, bool is_new)
 	  _transient_for(nullptr),
 	  _strut(nullptr),
 	  _icon(nullptr),
+	  _read_icon(true),
+	  _shared_icon(None),
 	  _pid(0), _is_remote(false), _class_hint(0),
 	  _window_type(WINDOW_TYPE_NORMAL),
 	  _alive(false), _marked(false),
@@ -135,6 +140,9 @@ Client::Client(Window new_client, ClientInitConfig &initConfig, bool is_new)
 	woListAdd(this);
 	_wo_map[_window] = this;
 	_clients.push_back(this);
+	_title_index.add(this, _title.getReal());
+
+	shareIcon();
 
 	P_TRACE(this << " client constructed for window " << FMT_HEX(_window));
 }
@@ -151,6 +159,7 @@ Client::~Client(void)
 	woListRemove(this);
 	_clients.erase(std::remove(_clients.begin(), _clients.end(), this),
 		       _clients.end());
+	_title_index.remove(this);
 	returnClientID(_id);
 
 	X11::grabServer();
@@ -178,7 +187,11 @@ Client::~Client(void)
 		pekwm::keyGrabber()->ungrabKeys(_window);
 		XRemoveFromSaveSet(X11::getDpy(), _window);
 		PWinObj::mapWindow();
+		if (_shared_icon != None) {
+			X11::unsetProperty(_window, PEKWM_ICON);
+		}
 	}
+	X11::freePixmap(_shared_icon);
 
 	// free names and size hint
 	if (_size) {
@@ -630,10 +643,10 @@ Client::handleShapeEvent(XShapeEvent *ev)
 void
 Client::notify(Observable *observable, Observation *observation)
 {
-	LayerObservation* layer_observation =
-		dynamic_cast<LayerObservation*>(observation);
-	if (layer_observation && layer_observation->layer > getLayer()) {
-		setLayer(layer_observation->layer);
+	Client *client = observation == &layer_changed
+		? dynamic_cast<Client*>(observable) : nullptr;
+	if (client && client->getLayer() > getLayer()) {
+		setLayer(client->getLayer());
 		updateParentLayerAndRaiseIfActive();
 	}
 }
@@ -822,7 +835,6 @@ Client::readHints(void)
 	readMwmHints();
 	readEwmhHints();
 	readPekwmHints();
-	readIcon();
 	readClientPid();
 	readClientRemote();
 	getWMProtocols();
@@ -980,25 +992,104 @@ Client::readPekwmHints(void)
 }
 
 /**
- * Read _NET_WM_ICON from client window.
+ * Read _NET_WM_ICON from client window, called from getIcon on first
+ * use of the icon by the frame list menus, SearchDialog and
+ * FocusToggleEventHandler, clients never listed do not read it. The
+ * icon size closest to the menu icon size is used and clients with the
+ * same icon share it.
  */
 void
 Client::readIcon(void)
 {
-	PImage *image = PImageIcon::newFromWindow(_window);
+	_read_icon = false;
+
+	Config *cfg = pekwm::config();
+	size_t width = cfg->getMenuIconLimit(0, WIDTH_MAX, "DEFAULT");
+	size_t height = cfg->getMenuIconLimit(0, HEIGHT_MAX, "DEFAULT");
+	PImage *image = PImageIcon::getFromWindow(_window, width, height);
+	if (image && _icon && _icon->getImage() == image) {
+		// icon unchanged, drop the reference from getFromWindow
+		pekwm::imageHandler()->returnImage(image);
+		return;
+	}
+
+	// a new texture is created when the icon changes as menus detect
+	// changed icons by comparing textures.
+	if (_icon) {
+		pekwm::textureHandler()->returnTexture(_icon);
+		_icon = nullptr;
+	}
 	if (image) {
-		if (_icon) {
-			_icon->setImage(image);
-		} else {
-			_icon = new PTextureImage(image);
-			pekwm::textureHandler()->referenceTexture(_icon);
-		}
-	} else {
-		delete image;
-		if (_icon) {
-			pekwm::textureHandler()->returnTexture(_icon);
-			_icon = nullptr;
+		_icon = new PTextureImage(image, true);
+		pekwm::textureHandler()->referenceTexture(_icon);
+	}
+}
+
+/**
+ * Publish icon in the size requested in _PEKWM_ICON_SIZE, by
+ * pekwm_panel, as a 32 bit pixmap with premultiplied alpha. The pixmap,
+ * width and height is set in _PEKWM_ICON letting panels reuse the
+ * converted and scaled icon instead of reading _NET_WM_ICON.
+ *
+ * _PEKWM_ICON_SIZE is a single root window property, sharing assumes a
+ * single panel. With more panels the size of the last started is used.
+ */
+void
+Client::shareIcon(void)
+{
+	// the old pixmap is freed after the property is updated, a panel
+	// that read the old id before the update gets an error reading
+	// the pixmap and falls back to _NET_WM_ICON.
+	Pixmap old_icon = _shared_icon;
+	_shared_icon = None;
+
+	size_t size = _shared_icon_size;
+	PImage *image = size
+		? PImageIcon::getFromWindow(_window, size, size) : nullptr;
+	size_t width = 0, height = 0;
+	if (image) {
+		// scale down keeping the aspect ratio, never up
+		width = image->getWidth();
+		height = image->getHeight();
+		if (width > size && width >= height) {
+			height = std::max<size_t>(1, height * size / width);
+			width = size;
+		} else if (height > size) {
+			width = std::max<size_t>(1, width * size / height);
+			height = size;
 		}
+		_shared_icon = image->createArgbPixmap(width, height);
+		pekwm::imageHandler()->returnImage(image);
+	}
+
+	if (_shared_icon != None) {
+		Cardinal icon[3];
+		icon[0] = _shared_icon;
+		icon[1] = width;
+		icon[2] = height;
+		X11::setCardinals(_window, PEKWM_ICON, icon, 3);
+	} else if (old_icon != None) {
+		X11::unsetProperty(_window, PEKWM_ICON);
+	}
+	X11::freePixmap(old_icon);
+}
+
+/**
+ * Set size icons are shared in, 0 stops sharing. Icons of all clients
+ * are updated.
+ */
+void
+Client::setSharedIconSize(uint size)
+{
+	if (size == _shared_icon_size) {
+		return;
+	}
+
+	P_TRACE("share icons in size " << size);
+	_shared_icon_size = size;
+	client_it it = _clients.begin();
+	for (; it != _clients.end(); ++it) {
+		(*it)->shareIcon();
 	}
 }
 
@@ -1192,6 +1283,8 @@ Client::readName(void)
 	_title.setCustom("");
 	_title.setCount(titleFindID(title));
 	_title.setReal(title);
+	_title_index.update(this, title);
+	Workspaces::frameListChanged();
 
 	// Apply title rules and find unique name, doesn't apply on
 	// user-set titles
@@ -1592,6 +1685,9 @@ Client::updateEwmhStates(void)
 	}
 	X11::setAtoms(_window, STATE, atoms, states.size());
 	delete [] atoms;
+
+	// iconified, sticky and layer are listed in frame list menus
+	Workspaces::frameListChanged();
 }
 
 void
@@ -20,6 +20,7 @@
 #include "tk/PWinObj.hh"
 #include "tk/PTexturePlain.hh"
 #include "PDecor.hh"
+#include "TitleIndex.hh"
 
 class PScreen;
 class Strut;
@@ -33,12 +34,15 @@ extern "C" {
 #include <X11/Xutil.h>
 }
 
+/**
+ * Observation sent when the layer of a client changes. The layer is
+ * read from the client when notified, making it possible to coalesce
+ * layer changes made while handling a batch of events.
+ */
 class LayerObservation : public Observation {
 public:
-	LayerObservation(enum Layer _layer) : layer(_layer) { };
 	virtual ~LayerObservation(void) { };
-public:
-	const enum Layer layer; /**< Layer client changed to. */
+	virtual bool canCoalesce(void) const { return true; }
 };
 
 class ClientInitConfig {
@@ -102,6 +106,8 @@ public: // Public Member Functions
 			    Observation *observation);
 	// END - Observer interface.
 
+	static LayerObservation layer_changed;
+
 	static Client *findClient(Window win);
 	static Client *findClientFromWindow(Window win);
 	static Client *findClientFromID(uint id);
@@ -114,6 +120,7 @@ public: // Public Member Functions
 	static uint client_size(void) { return _clients.size(); }
 	static client_cit client_begin(void) { return _clients.begin(); }
 	static client_cit client_end(void) { return _clients.end(); }
+	static const TitleIndex &getTitleIndex(void) { return _title_index; }
 	static client_vec::reverse_iterator client_rbegin(void) {
 		return _clients.rbegin();
 	}
@@ -130,6 +137,10 @@ public: // Public Member Functions
 	}
 	// END - Iterators
 
+	/** Return size icons are shared in, 0 if not shared. */
+	static uint getSharedIconSize(void) { return _shared_icon_size; }
+	static void setSharedIconSize(uint size);
+
 	bool validate(void);
 
 	inline uint getClientID(void) { return _id; }
@@ -164,7 +175,13 @@ public: // Public Member Functions
 	Strut *getStrut(void) const { return _strut; }
 	bool demandsAttention(void) const { return _demands_attention; }
 
-	PTexture *getIcon(void) const { return _icon; }
+	/** Return icon, _NET_WM_ICON is read on first use. */
+	PTexture *getIcon(void) {
+		if (_read_icon) {
+			readIcon();
+		}
+		return _icon;
+	}
 
 	/** Return PID of client. */
 	long getPid(void) const { return _pid; }
@@ -319,6 +336,8 @@ private:
 	inline void setMaximizedHorz(bool m) { _state.maximized_horz = m; }
 	inline void setShade(bool s) { _state.shaded = s; }
 	inline void setFullscreen(bool f) { _state.fullscreen = f; }
+	/** _NET_WM_ICON changed, read again on next getIcon. */
+	inline void setIconChanged(void) { _read_icon = true; }
 
 	void readHints(void);
 	void readClassRoleHints(void);
@@ -326,6 +345,7 @@ private:
 	void readMwmHints(void);
 	void readPekwmHints(void);
 	void readIcon(void);
+	void shareIcon(void);
 	void applyAutoprops(AutoProperty *ap);
 	void applyActionAccessMask(uint mask, bool value);
 	void readClientPid(void);
@@ -353,6 +373,10 @@ private: // Private Member Variables
 
 	PDecor::TitleItem _title; /**< Name of the client. */
 	PTextureImage *_icon;
+	/** If true, _icon is read from _NET_WM_ICON on next getIcon. */
+	bool _read_icon;
+	/** Icon published in _PEKWM_ICON, None if not shared. */
+	Pixmap _shared_icon;
 
 	/** _NET_WM_PID of the client, only valid if is_remote is false. */
 	Cardinal _pid;
@@ -417,7 +441,10 @@ private: // Private Member Variables
 	static const long _clientEventMask;
 
 	static client_vec _clients; //!< Vector of all Clients.
+	/** Size icons are shared in, 0 if not shared. */
+	static uint _shared_icon_size;
 	static std::vector<uint> _clientids; //!< Vector of free Client IDs.
+	static TitleIndex _title_index; //!< Index of real Client titles.
 };
 
 #endif // _PEKWM_CLIENT_HH_
@@ -30,7 +30,7 @@ extern "C" {
 #include <sys/stat.h>
 }
 
-static Util::StringTo<ActionAccessMask> action_access_mask_map[] =
+static Util::StringTo<ActionAccessMask> action_access_mask_map_entries[] =
 	{{"MOVE", ACTION_ACCESS_MOVE},
 	 {"RESIZE", ACTION_ACCESS_RESIZE},
 	 {"ICONIFY", ACTION_ACCESS_ICONIFY},
@@ -42,8 +42,10 @@ static Util::StringTo<ActionAccessMask> action_access_mask_map[] =
 	 {"SETWORKSPACE", ACTION_ACCESS_CHANGE_DESKTOP},
 	 {"CLOSE", ACTION_ACCESS_CLOSE},
 	 {nullptr, ACTION_ACCESS_NO}};
+static Util::StringToIndex<ActionAccessMask>
+	action_access_mask_map(action_access_mask_map_entries);
 
-static Util::StringTo<MoveResizeActionType> moveresize_map[] =
+static Util::StringTo<MoveResizeActionType> moveresize_map_entries[] =
 	{{"MOVEHORIZONTAL", MOVE_HORIZONTAL},
 	 {"MOVEVERTICAL", MOVE_VERTICAL},
 	 {"RESIZEHORIZONTAL", RESIZE_HORIZONTAL},
@@ -52,8 +54,10 @@ static Util::StringTo<MoveResizeActionType> moveresize_map[] =
 	 {"CANCEL", MOVE_CANCEL},
 	 {"END", MOVE_END},
 	 {nullptr, NO_MOVERESIZE_ACTION}};
+static Util::StringToIndex<MoveResizeActionType>
+	moveresize_map(moveresize_map_entries);
 
-static Util::StringTo<InputDialogAction> inputdialog_map[] =
+static Util::StringTo<InputDialogAction> inputdialog_map_entries[] =
 	{{"INSERT", INPUT_INSERT},
 	 {"ERASE", INPUT_REMOVE},
 	 {"CLEAR", INPUT_CLEAR},
@@ -69,8 +73,10 @@ static Util::StringTo<InputDialogAction> inputdialog_map[] =
 	 {"HISTNEXT", INPUT_HIST_NEXT},
 	 {"HISTPREV", INPUT_HIST_PREV},
 	 {nullptr, INPUT_NO_ACTION}};
+static Util::StringToIndex<InputDialogAction>
+	inputdialog_map(inputdialog_map_entries);
 
-static Util::StringTo<MouseEventType> mouse_event_map[] =
+static Util::StringTo<MouseEventType> mouse_event_map_entries[] =
 	{{"BUTTONPRESS", MOUSE_EVENT_PRESS},
 	 {"BUTTONRELEASE", MOUSE_EVENT_RELEASE},
 	 {"DOUBLECLICK", MOUSE_EVENT_DOUBLE},
@@ -80,8 +86,10 @@ static Util::StringTo<MouseEventType> mouse_event_map[] =
 	 {"ENTERMOVING", MOUSE_EVENT_ENTER_MOVING},
 	 {"MOTIONPRESSED", MOUSE_EVENT_MOTION_PRESSED},
 	 {nullptr, MOUSE_EVENT_NO}};
+static Util::StringToIndex<MouseEventType>
+	mouse_event_map(mouse_event_map_entries);
 
-static Util::StringTo<ActionType> menu_action_map[] =
+static Util::StringTo<ActionType> menu_action_map_entries[] =
 	{{"NEXTITEM", ACTION_MENU_NEXT},
 	 {"PREVITEM", ACTION_MENU_PREV},
 	 {"GOTOITEM", ACTION_MENU_GOTO},
@@ -90,25 +98,32 @@ static Util::StringTo<ActionType> menu_action_map[] =
 	 {"LEAVESUBMENU", ACTION_MENU_LEAVE_SUBMENU},
 	 {"CLOSE", ACTION_CLOSE},
 	 {nullptr, ACTION_NO}};
+static Util::StringToIndex<ActionType> menu_action_map(menu_action_map_entries);
 
-static Util::StringTo<HarbourPlacement> harbour_placement_map[] =
+static Util::StringTo<HarbourPlacement> harbour_placement_map_entries[] =
 	{{"TOP", TOP},
 	 {"LEFT", LEFT},
 	 {"RIGHT", RIGHT},
 	 {"BOTTOM", BOTTOM},
 	 {nullptr, NO_HARBOUR_PLACEMENT}};
+static Util::StringToIndex<HarbourPlacement>
+	harbour_placement_map(harbour_placement_map_entries);
 
-static Util::StringTo<Orientation> harbour_orientation_map[] =
+static Util::StringTo<Orientation> harbour_orientation_map_entries[] =
 	{{"TOPTOBOTTOM", TOP_TO_BOTTOM},
 	 {"LEFTTORIGHT", TOP_TO_BOTTOM},
 	 {"BOTTOMTOTOP", BOTTOM_TO_TOP},
 	 {"RIGHTTOLEFT", BOTTOM_TO_TOP},
 	 {nullptr, NO_ORIENTATION}};
+static Util::StringToIndex<Orientation>
+	harbour_orientation_map(harbour_orientation_map_entries);
 
-static Util::StringTo<CurrHeadSelector> curr_head_selector_map[] =
+static Util::StringTo<CurrHeadSelector> curr_head_selector_map_entries[] =
 	{{"CURSOR", CURR_HEAD_SELECTOR_CURSOR},
 	 {"FOCUSEDWINDOW", CURR_HEAD_SELECTOR_FOCUSED_WINDOW},
 	 {nullptr, CURR_HEAD_SELECTOR_NO}};
+static Util::StringToIndex<CurrHeadSelector>
+	curr_head_selector_map(curr_head_selector_map_entries);
 
 /**
  * Parse width and height limits.
@@ -152,6 +167,7 @@ getDefaultScriptsPath()
 
 //! @brief Constructor for Config class
 Config::Config(void) :
+	_files_image_cache_size(64),
 	_moveresize_edgeattract(0), _moveresize_edgeresist(0),
 	_moveresize_woattract(0), _moveresize_woresist(0),
 	_moveresize_opaquemove(0), _moveresize_opaqueresize(0),
@@ -358,6 +374,11 @@ Config::loadFiles(CfgParser::Entry *section)
 	keys.add_path("THEME", _files_theme, DATADIR "/pekwm/themes/default");
 	keys.add_string("THEMEVARIANT", _files_theme_variant);
 	keys.add_path("ICONS", _files_icon_path, DATADIR "/pekwm/icons");
+	// image cache is disabled unless configured
+	_files_image_cache.clear();
+	keys.add_path("IMAGECACHE", _files_image_cache);
+	keys.add_numeric<uint>("IMAGECACHESIZE", _files_image_cache_size,
+			       64, 1);
 
 	std::string config_script_path;
 	keys.add_path("SCRIPTS", config_script_path, getDefaultScriptsPath());
@@ -114,6 +114,14 @@ public:
 	const char *getSystemIconPath(void) const {
 		return DATADIR "/pekwm/icons/";
 	}
+	const std::string &getImageCache(void) const {
+		return _files_image_cache;
+	}
+	/** Maximum size of the image cache in bytes. */
+	size_t getImageCacheSize(void) const {
+		return static_cast<size_t>(_files_image_cache_size)
+			* 1024 * 1024;
+	}
 
 	// Moveresize
 	inline int getEdgeAttract(void) const {
@@ -321,6 +329,10 @@ private:
 	std::string _files_theme_variant;
 	std::string _files_mouse;
 	std::string _files_icon_path; /**< Path to user icon directory. */
+	/** Directory with decoded images, empty if disabled. */
+	std::string _files_image_cache;
+	/** Maximum size of the image cache in MB. */
+	uint _files_image_cache_size;
 
 	// moveresize
 	int _moveresize_edgeattract, _moveresize_edgeresist;
@@ -192,6 +192,7 @@ Frame::~Frame(void)
 	woListRemove(this);
 	_frames.erase(std::remove(_frames.begin(), _frames.end(), this),
 		      _frames.end());
+	Workspaces::frameListChanged();
 	Workspaces::removeFromMRU(this);
 	if (_tag_frame == this) {
 		_tag_frame = 0;
@@ -242,6 +243,7 @@ Frame::iconify(void)
 		return;
 	}
 	_iconified = true;
+	Workspaces::frameListChanged();
 
 	unmapWindow();
 }
@@ -258,6 +260,7 @@ Frame::stick(void)
 	// make sure it's visible/hidden
 	PDecor::setWorkspace(Workspaces::getActive());
 	updateDecor();
+	Workspaces::frameListChanged();
 }
 
 //! @brief Sets workspace on frame, wrapper to allow autoproperty loading
@@ -281,6 +284,7 @@ Frame::setWorkspace(unsigned int workspace)
 
 	PDecor::setWorkspace(workspace);
 	updateDecor();
+	Workspaces::frameListChanged();
 }
 
 void
@@ -291,9 +295,9 @@ Frame::setLayer(Layer layer)
 	if (_client->getLayer() != layer) {
 		_client->setLayer(layer);
 
-		LayerObservation observation(layer);
-		pekwm::observerMapping()->notifyObservers(_client,
-							  &observation);
+		pekwm::observerMapping()->notifyObservers(
+			_client, &Client::layer_changed);
+		Workspaces::frameListChanged();
 	}
 }
 
@@ -556,6 +560,7 @@ Frame::updatedChildOrder(void)
 	}
 
 	updatedActiveChild();
+	Workspaces::frameListChanged();
 }
 
 /**
@@ -608,6 +613,7 @@ Frame::setShaded(StateAction sa)
 	if (shaded != PDecor::setShaded(sa)) {
 		_client->setShade(isShaded());
 		_client->updateEwmhStates();
+		Workspaces::frameListChanged();
 	}
 	return isShaded();
 }
@@ -745,6 +751,7 @@ Frame::setSkip(uint skip)
 {
 	PDecor::setSkip(skip);
 	_client->setSkip(skip);
+	Workspaces::frameListChanged();
 }
 
 //! @brief Find Frame with id.
@@ -1461,6 +1468,7 @@ Frame::setStateTitle(StateAction sa, Client *client, const std::string &title)
 	// Set PEKWM_TITLE atom to preserve title on client between sessions.
 	X11::setUtf8String(client->getWindow(), PEKWM_TITLE,
 			   client->getTitle()->getUser());
+	Workspaces::frameListChanged();
 
 	renderTitle();
 }
@@ -2148,6 +2156,10 @@ Frame::handlePropertyChange(XPropertyEvent *ev, Client *client)
 		}
 	} else if (ev->atom == X11::getAtom(WM_PROTOCOLS)) {
 		client->getWMProtocols();
+	} else if (ev->atom == X11::getAtom(NET_WM_ICON)) {
+		client->setIconChanged();
+		client->shareIcon();
+		Workspaces::frameListChanged();
 	}
 }
 
@@ -12,7 +12,12 @@
 #include <cstdio>
 #include <iostream>
 
+extern "C" {
+#include <time.h>
+}
+
 #include "Compat.hh"
+#include "Debug.hh"
 #include "PDecor.hh"
 #include "PMenu.hh"
 #include "WORefMenu.hh"
@@ -34,43 +39,85 @@
 FrameListMenu::FrameListMenu(MenuType type,
 			     const std::string &title, const std::string &name,
 			     const std::string &decor_name)
-	: WORefMenu(title, name, decor_name)
+	: WORefMenu(title, name, decor_name),
+	  _dirty(true)
 {
 	_menu_type = type;
+	pekwm::observerMapping()->addObserver(Workspaces::getFrameList(),
+					      this);
 }
 
 //! @brief FrameListMenu destructor
 FrameListMenu::~FrameListMenu(void)
 {
+	pekwm::observerMapping()->removeObserver(Workspaces::getFrameList(),
+						 this);
 }
 
 // START - PWinObj interface.
 
 /**
- * Rebuilds the menu and if it has any items after it shows it.
+ * Updates the menu, if the frame list changed since it was last
+ * updated, and if it has any items after it shows it.
  */
 void
 FrameListMenu::mapWindow(void)
 {
-	updateFrameListMenu();
+	if (_dirty) {
+		updateFrameListMenu();
+		_dirty = false;
+	} else {
+		P_DBG("frame list menu " << _name << " unchanged");
+	}
 	if (size() > 0) {
 		WORefMenu::mapWindow();
 	}
 }
 
 /**
- * Remove all items when unmapping the menu, no point in holding on to
- * the resources.
+ * Items are kept when unmapping the menu, next time it is mapped only
+ * the rows that changed are updated. Items of clients removed while
+ * the menu was mapped are dropped.
  */
 void
 FrameListMenu::unmapWindow(void)
 {
-	removeAll();
 	WORefMenu::unmapWindow();
+	removeStaleItems();
 }
 
 // END - PWinObj interface.
 
+/**
+ * Mark items as out of date when the frame list changes, items of
+ * removed clients are dropped right away releasing their icons unless
+ * the menu is mapped.
+ */
+void
+FrameListMenu::notify(Observable *observable, Observation *observation)
+{
+	if (observation == &Workspaces::frame_list_changed) {
+		_dirty = true;
+		if (! isMapped()) {
+			removeStaleItems();
+		}
+	} else {
+		WORefMenu::notify(observable, observation);
+	}
+}
+
+/**
+ * Set reference, attach menus do not list the referenced client.
+ */
+void
+FrameListMenu::setWORef(PWinObj *wo_ref)
+{
+	if (wo_ref != getWORef()) {
+		_dirty = true;
+	}
+	WORefMenu::setWORef(wo_ref);
+}
+
 /**
  * Execute item execution.
  */
@@ -108,14 +155,65 @@ FrameListMenu::handleItemExec(PMenu::Item *item)
 	}
 }
 
-//! @brief Rebuilds the menu.
+static bool
+frameWorkspaceLess(const Frame *lhs, const Frame *rhs)
+{
+	return lhs->getWorkspace() < rhs->getWorkspace();
+}
+
+/**
+ * Update the menu from the current frames. The rows are computed in a
+ * single pass over the frames and compared with the items already in
+ * the menu, the menu is only rebuilt if rows are added, removed or
+ * re-ordered, otherwise only rows with an updated name are re-rendered.
+ */
 void
 FrameListMenu::updateFrameListMenu(void)
 {
-	removeAll();
+	struct timespec start;
+	clock_gettime(CLOCK_MONOTONIC, &start);
+
+	std::vector<Row> rows;
+	buildRows(rows);
+	bool updated = updateItems(rows);
+	if (! updated) {
+		rebuild(rows);
+	}
 
-	char buf[16];
-	std::string name;
+	struct timespec end;
+	clock_gettime(CLOCK_MONOTONIC, &end);
+	P_DBG("updated frame list menu " << _name << " with " << rows.size()
+	      << " rows in " << ((end.tv_sec - start.tv_sec) * 1000000
+				 + (end.tv_nsec - start.tv_nsec) / 1000)
+	      << " us" << (updated ? "" : ", rebuilt"));
+}
+
+/**
+ * Remove all items if any of them refers to a removed client, the
+ * rows no longer match the items and the menu is rebuilt next time
+ * it is mapped anyway.
+ */
+void
+FrameListMenu::removeStaleItems(void)
+{
+	PMenu::item_cit it = m_begin();
+	for (; it != m_end(); ++it) {
+		if ((*it)->getType() == PMenu::Item::MENU_ITEM_NORMAL
+		    && (*it)->getWORef() == nullptr) {
+			removeAll();
+			_dirty = true;
+			return;
+		}
+	}
+}
+
+/**
+ * Replace all items in the menu with rows.
+ */
+void
+FrameListMenu::rebuild(const std::vector<Row> &rows)
+{
+	removeAll();
 
 	// need to add an action, otherwise it looks as if we don't have
 	// anything to exec and thus it doesn't get handled.
@@ -123,6 +221,28 @@ FrameListMenu::updateFrameListMenu(void)
 	ActionEvent ae;
 	ae.action_list.push_back(action);
 
+	std::vector<Row>::const_iterator it = rows.begin();
+	for (; it != rows.end(); ++it) {
+		if (it->client) {
+			insert(it->name, ae, it->client,
+			       it->client->getIcon());
+		} else {
+			PMenu::Item *item = new PMenu::Item("");
+			item->setType(PMenu::Item::MENU_ITEM_SEPARATOR);
+			insert(item);
+		}
+	}
+
+	buildMenu();
+}
+
+/**
+ * Build menu rows for all frames matching the menu type, ordered by
+ * workspace.
+ */
+void
+FrameListMenu::buildRows(std::vector<Row> &rows)
+{
 	// Decide wheter to show clients and iconified.
 	bool show_clients = false, show_iconified_only = false;
 	if (_menu_type == ATTACH_CLIENT_TYPE
@@ -132,49 +252,88 @@ FrameListMenu::updateFrameListMenu(void)
 		show_iconified_only = true;
 	}
 
+	std::vector<Frame*> frames;
+	std::vector<Frame*>::const_iterator it = Frame::frame_begin();
+	for (; it != Frame::frame_end(); ++it) {
+		if ((*it)->getWorkspace() < Workspaces::size() &&
+		    // don't include ourselves if we're not doing a
+		    // gotoclient menu
+		    ((_menu_type != GOTOCLIENTMENU_TYPE)
+		     ? ((*it)->getActiveChild() != getWORef())
+		     : true) &&
+		    (show_iconified_only
+		     ? (*it)->isIconified()
+		     : !(*it)->isSkip(SKIP_MENUS))) {
+			frames.push_back(*it);
+		}
+	}
+	// sort by workspace, keeping the frame order within a workspace
+	std::stable_sort(frames.begin(), frames.end(), frameWorkspaceLess);
+
 	// if we have 1 workspace, we won't put an workspace indicator
+	char buf[16];
 	buf[0] = '\0';
 
-	std::vector<Frame*>::const_iterator it;
-	for (uint i = 0; i < Workspaces::size(); ++i) {
+	std::string name;
+	for (it = frames.begin(); it != frames.end(); ++it) {
 		if (Workspaces::size() > 1) {
-			snprintf(buf, sizeof(buf), "<%u> ", i + 1);
+			snprintf(buf, sizeof(buf), "<%u> ",
+				 (*it)->getWorkspace() + 1);
 		}
+		name = buf;
 
-		for (it = Frame::frame_begin();
-		     it != Frame::frame_end();
-		     ++it) {
-			if (((*it)->getWorkspace() == i) && // sort by workspace
-			    // don't include ourselves if we're not doing a
-			    // gotoclient menu
-			    ((_menu_type != GOTOCLIENTMENU_TYPE)
-			     ? ((*it)->getActiveChild() != getWORef())
-			     : true) &&
-			    (show_iconified_only
-			     ? (*it)->isIconified()
-			     : !(*it)->isSkip(SKIP_MENUS))) {
-				name = buf;
-
-				if (show_clients) {
-					bool is_last =
-						(it + 1) == Frame::frame_end();
-					buildFrameNames(*it, name, !is_last);
-
-				} else {
-					buildName(*it, name);
-					Client *client = static_cast<Client*>(
-						(*it)->getActiveChild());
-					name.append("] ");
-					name.append(client->getTitle()
-							->getVisible());
-					insert(name, ae,
-					       client, client->getIcon());
-				}
+		if (show_clients) {
+			if (it != frames.begin()) {
+				rows.push_back(Row(nullptr, ""));
 			}
+			buildFrameNames(*it, name, rows);
+		} else {
+			buildName(*it, name);
+			Client *client =
+				static_cast<Client*>((*it)->getActiveChild());
+			name.append("] ");
+			name.append(client->getTitle()->getVisible());
+			rows.push_back(Row(client, name));
 		}
 	}
+}
 
-	buildMenu();
+/**
+ * Update items in place from rows, only possible if the rows refer to
+ * the same clients, with the same icons, as the current items.
+ *
+ * @return true if items were updated, false if the menu needs to be
+ *         rebuilt.
+ */
+bool
+FrameListMenu::updateItems(const std::vector<Row> &rows)
+{
+	if (rows.size() != size()) {
+		return false;
+	}
+
+	std::vector<Row>::const_iterator row = rows.begin();
+	PMenu::item_cit it = m_begin();
+	for (; it != m_end(); ++it, ++row) {
+		if (row->client == nullptr
+		    ? (*it)->getType() != PMenu::Item::MENU_ITEM_SEPARATOR
+		    : ((*it)->getWORef() != row->client
+		       || (*it)->getIcon() != row->client->getIcon())) {
+			return false;
+		}
+	}
+
+	PMenu::item_vec changed;
+	for (it = m_begin(), row = rows.begin(); it != m_end(); ++it, ++row) {
+		if (row->client && (*it)->getName() != row->name) {
+			(*it)->setName(row->name);
+			changed.push_back(*it);
+		}
+	}
+	if (! changed.empty()) {
+		renderItems(changed);
+	}
+	return true;
 }
 
 //! @brief Builds the name for the frame.
@@ -201,16 +360,9 @@ FrameListMenu::buildName(Frame* frame, std::string &name)
 //! @brief Builds names for all the clients in a frame.
 void
 FrameListMenu::buildFrameNames(Frame *frame, const std::string &pre_name,
-			       bool insert_separator)
+			       std::vector<Row> &rows)
 {
 	std::string status_name;
-
-	// need to add an action, otherwise it looks as if we don't have
-	// anything to exec and thus it doesn't get handled.
-	Action action;
-	ActionEvent ae;
-	ae.action_list.push_back(action);
-
 	buildName(frame, status_name); // add states to the name
 
 	std::vector<PWinObj*>::const_iterator it = frame->begin();
@@ -224,14 +376,7 @@ FrameListMenu::buildFrameNames(Frame *frame, const std::string &pre_name,
 		Client* client = static_cast<Client*>(*it);
 		name.append(client->getTitle()->getVisible());
 
-		insert(name, ae, *it, static_cast<Client*>(*it)->getIcon());
-	}
-
-	// add separator
-	if (insert_separator) {
-		PMenu::Item *item = new PMenu::Item("");
-		item->setType(PMenu::Item::MENU_ITEM_SEPARATOR);
-		insert(item);
+		rows.push_back(Row(client, name));
 	}
 }
 
@@ -17,6 +17,7 @@
 
 #include <string>
 #include <list>
+#include <vector>
 
 class Frame;
 class Client;
@@ -34,19 +35,44 @@ public:
 	virtual void unmapWindow(void);
 	// END - PWinObj interface.
 
+	virtual void notify(Observable *observable, Observation *observation);
+	virtual void setWORef(PWinObj *wo_ref);
+
 	virtual void handleItemExec(PMenu::Item *item);
 
 private:
+	/**
+	 * Menu row, separator if client is not set.
+	 */
+	class Row {
+	public:
+		Row(Client *client_, const std::string &name_)
+			: client(client_),
+			  name(name_)
+		{
+		}
+
+		Client *client;
+		std::string name;
+	};
+
 	void updateFrameListMenu(void);
+	void removeStaleItems(void);
+	void buildRows(std::vector<Row> &rows);
+	bool updateItems(const std::vector<Row> &rows);
+	void rebuild(const std::vector<Row> &rows);
 
 private:
 	void buildName(Frame *frame, std::string &name);
 	void buildFrameNames(Frame *frame, const std::string &pre_name,
-			     bool insert_separator);
+			     std::vector<Row> &rows);
 
 	void handleGotomenu(Client *client);
 	void handleIconmenu(Client *client);
 	void handleAttach(Client *client_to, Client *client_from, bool frame);
+
+	/** Set when the frame list changed since the items were updated. */
+	bool _dirty;
 };
 
 #endif // _PEKWM_FRAMELISTMENU_HH_
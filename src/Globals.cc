@@ -15,6 +15,7 @@
 #include "ManagerWindows.hh"
 #include "KeyGrabber.hh"
 #include "StatusWindow.hh"
+#include "ThreadPool.hh"
 
 #include "tk/FontHandler.hh"
 #include "tk/ImageHandler.hh"
@@ -38,6 +39,7 @@ static RootWO* _root_wo = nullptr;
 static StatusWindow* _status_window = nullptr;
 static TextureHandler* _texture_handler = nullptr;
 static Theme* _theme = nullptr;
+static ThreadPool* _thread_pool = nullptr;
 
 namespace pekwm
 {
@@ -88,7 +90,11 @@ namespace pekwm
 		_font_handler =
 			new FontHandler(_config->isDefaultFontX11(),
 					_config->getFontCharsetOverride());
+		_thread_pool = new ThreadPool();
+		PImage::setThreadPool(_thread_pool);
 		_image_handler = new ImageHandler();
+		_image_handler->setCache(_config->getImageCache(),
+					 _config->getImageCacheSize());
 		_texture_handler = new TextureHandler();
 		_theme = new Theme(_font_handler, _image_handler,
 				   _texture_handler,
@@ -114,6 +120,8 @@ namespace pekwm
 		delete _theme;
 		delete _texture_handler;
 		delete _image_handler;
+		PImage::setThreadPool(nullptr);
+		delete _thread_pool;
 		delete _font_handler;
 		delete _key_grabber;
 		delete _auto_properties;
@@ -11,6 +11,7 @@
 #include "Config.hh"
 #include "Debug.hh"
 #include "ActionHandler.hh"
+#include "Client.hh"
 #include "ManagerWindows.hh"
 #include "Workspaces.hh"
 #include "Util.hh"
@@ -230,6 +231,8 @@ RootWO::RootWO(Window root, HintWO *hint_wo, Config *cfg)
 	desktop_geometry[1] = static_cast<Cardinal>(_gm.height);
 	X11::setCardinals(_window, NET_DESKTOP_GEOMETRY, desktop_geometry, 2);
 
+	readIconSize();
+
 	woListAdd(this);
 	_wo_map[_window] = this;
 
@@ -510,7 +513,23 @@ RootWO::handlePropertyChange(XPropertyEvent *ev)
 	if (ev->atom == X11::getAtom(NET_DESKTOP_NAMES)) {
 		readEwmhDesktopNames();
 		Workspaces::setNames();
+	} else if (ev->atom == X11::getAtom(PEKWM_ICON_SIZE)) {
+		readIconSize();
+	}
+}
+
+/**
+ * Read _PEKWM_ICON_SIZE, set by pekwm_panel, and share client icons
+ * in that size.
+ */
+void
+RootWO::readIconSize(void)
+{
+	Cardinal size;
+	if (! X11::getCardinal(_window, PEKWM_ICON_SIZE, size) || size < 0) {
+		size = 0;
 	}
+	Client::setSharedIconSize(size);
 }
 
 /**
@@ -93,6 +93,7 @@ public:
 private:
 	void initStrutHead();
 	void updateMaxStrut(Strut *max_strut, const Strut *strut);
+	void readIconSize(void);
 
 private:
 	HintWO *_hint_wo;
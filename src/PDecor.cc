@@ -25,6 +25,7 @@ extern "C" {
 #include "ActionHandler.hh"
 #include "ManagerWindows.hh"
 #include "StatusWindow.hh"
+#include "Trace.hh"
 #include "KeyGrabber.hh"
 #include "Workspaces.hh"
 #include "X11.hh"
@@ -34,6 +35,7 @@ extern "C" {
 #include "tk/PTexture.hh"
 #include "tk/PTexturePlain.hh"
 #include "tk/PWinObj.hh"
+#include "tk/TextureHandler.hh"
 #include "tk/Theme.hh"
 #include "tk/X11Util.hh"
 
@@ -218,6 +220,9 @@ PDecor::PDecor(const std::string &decor_name, const Window child_window,
 	  _titles_left(0),
 	  _titles_right(1)
 {
+	for (uint i = 0; i < BORDER_NO_POS; ++i) {
+		_border_pix[i] = None;
+	}
 	if (init) {
 		this->init(child_window);
 	}
@@ -352,6 +357,9 @@ PDecor::~PDecor(void)
 	for (uint i = 0; i < BORDER_NO_POS; ++i) {
 		removeChildWindow(_border_win[i]);
 		X11::destroyWindow(_border_win[i]);
+		if (_border_pix[i] != None) {
+			pekwm::textureHandler()->returnPixmap(_border_pix[i]);
+		}
 	}
 	X11::destroyWindow(_window);
 }
@@ -1363,6 +1371,7 @@ void PDecor::deiconify(void) {
 void
 PDecor::renderTitle(void)
 {
+	Trace::Scope trace(Trace::KIND_RENDER, Trace::RENDER_TITLE);
 	if (! titleHeight(this)) {
 		return;
 	}
@@ -1429,6 +1438,7 @@ PDecor::renderTitle(void)
 void
 PDecor::renderButtons(void)
 {
+	Trace::Scope trace(Trace::KIND_RENDER, Trace::RENDER_BUTTONS);
 	std::vector<PDecor::Button*>::iterator it = _buttons.begin();
 	for (; it != _buttons.end(); ++it) {
 		(*it)->setState(_focused
@@ -1440,10 +1450,17 @@ PDecor::renderButtons(void)
 void
 PDecor::renderBorder(void)
 {
+	Trace::Scope trace(Trace::KIND_RENDER, Trace::RENDER_BORDER);
+	TextureHandler *th = pekwm::textureHandler();
 	if (! _border) {
+		for (int i = 0; i < BORDER_NO_POS; ++i) {
+			th->returnPixmap(_border_pix[i]);
+		}
 		return;
 	}
 
+	// borders with the same texture and size, on this and other
+	// decors, share the same pixmap.
 	uint width, height;
 	FocusedState state = getFocusedState(false);
 	for (int i=0; i < BORDER_NO_POS; ++i) {
@@ -1451,7 +1468,8 @@ PDecor::renderBorder(void)
 		PTexture *tex =
 			_data->getBorderTexture(state, bp);
 		getBorderSize(static_cast<BorderPosition>(i), width, height);
-		tex->setBackground(_border_win[i], 0, 0, width, height);
+		th->setBackground(tex, _border_win[i], width, height,
+				  _border_pix[i]);
 		X11::clearWindow(_border_win[i]);
 	}
 }
@@ -403,6 +403,8 @@ protected:
 	uint _skip;
 
 	Window _border_win[BORDER_NO_POS]; /** Array of border windows. */
+	/** Shared pixmaps set as border background, from TextureHandler. */
+	Pixmap _border_pix[BORDER_NO_POS];
 
 private:
 	Theme::PDecorData *_data;
@@ -28,9 +28,15 @@
 #include <algorithm>
 #include <cstdlib>
 
+extern "C" {
+#include <time.h>
+}
+
 PMenu::Item::Item(const std::string &name, PWinObj *wo_ref, PTexture *icon)
 	: PWinObjReference(wo_ref),
 	  _name(name),
+	  _text_width(0),
+	  _text_width_font(nullptr),
 	  _type(MENU_ITEM_NORMAL),
 	  _icon(icon),
 	  _creator(0)
@@ -47,6 +53,20 @@ PMenu::Item::~Item(void)
 	}
 }
 
+/**
+ * Get width of item name in font, the width is measured once and
+ * re-used until the name or font changes.
+ */
+uint
+PMenu::Item::getTextWidth(PFont *font)
+{
+	if (_text_width_font != font) {
+		_text_width = font->getWidth(_name);
+		_text_width_font = font;
+	}
+	return _text_width;
+}
+
 std::map<Window,PMenu*> PMenu::_menu_map = std::map<Window,PMenu*>();
 
 //! @brief Constructor for PMenu class
@@ -68,6 +88,8 @@ PMenu::PMenu(const std::string &title,
 	  _rows(0),
 	  _cols(0),
 	  _scroll(false),
+	  _scroll_y(0),
+	  _scroll_height(0),
 	  _has_submenu(0)
 {
 	// PWinObj attributes
@@ -135,6 +157,7 @@ PMenu::unmapWindow(void)
 {
 	_item_curr = _items.size();
 	_sticky = false;
+	_scroll_y = 0;
 
 	PDecor::unmapWindow();
 }
@@ -174,6 +197,15 @@ ActionEvent*
 PMenu::handleButtonPress(XButtonEvent *ev)
 {
 	if (*_menu_wo == ev->window) {
+		if (isScrollButton(_scroll, ev->button)) {
+			int rows = ev->button == Button4 ? -3 : 3;
+			if (scrollTo(_scroll_y + rows * _item_height)) {
+				buildMenuRender();
+				renderSelectedItem();
+			}
+			return nullptr;
+		}
+
 		handleItemEvent(MOUSE_EVENT_PRESS, ev->x, ev->y);
 
 		// update pointer position
@@ -190,6 +222,16 @@ PMenu::handleButtonPress(XButtonEvent *ev)
 	}
 }
 
+/**
+ * Returns true if button scrolls the menu, only the wheel buttons in
+ * a scrolled menu do.
+ */
+bool
+PMenu::isScrollButton(bool scroll, uint button)
+{
+	return scroll && (button == Button4 || button == Button5);
+}
+
 /**
  * Handle button release.
  */
@@ -203,6 +245,12 @@ PMenu::handleButtonRelease(XButtonEvent *ev)
 	}
 
 	if (*_menu_wo == ev->window) {
+		// the wheel scrolled the menu on press, the release must
+		// not select or execute the item under the pointer.
+		if (isScrollButton(_scroll, ev->button)) {
+			return nullptr;
+		}
+
 		MouseEventType mb = MOUSE_EVENT_RELEASE;
 
 		Config *cfg = pekwm::config();
@@ -319,6 +367,11 @@ PMenu::handleLeaveEvent(XCrossingEvent *ev)
 void
 PMenu::loadTheme(void)
 {
+	// fonts may have been re-loaded, measure items again.
+	item_it it = _items.begin();
+	for (; it != _items.end(); ++it) {
+		(*it)->clearTextWidth();
+	}
 	buildMenu();
 }
 
@@ -373,6 +426,9 @@ PMenu::handleItemEvent(MouseEventType type, int x, int y)
 void
 PMenu::buildMenu(void)
 {
+	struct timespec start;
+	clock_gettime(CLOCK_MONOTONIC, &start);
+
 	// calculate geometry, if to enable scrolling etc
 	buildMenuCalculate();
 
@@ -384,6 +440,13 @@ PMenu::buildMenu(void)
 		// render items on the menu
 		buildMenuRender();
 	}
+
+	struct timespec end;
+	clock_gettime(CLOCK_MONOTONIC, &end);
+	P_DBG("built menu " << _name << " with " << _items.size()
+	      << " items in " << ((end.tv_sec - start.tv_sec) * 1000
+				  + (end.tv_nsec - start.tv_nsec) / 1000000)
+	      << " ms" << (_scroll ? ", scrolled" : ""));
 }
 
 /**
@@ -404,31 +467,10 @@ PMenu::buildMenuCalculate(void)
 		}
 	}
 
-	buildMenuCalculateMaxWidth(_item_width_max,
-				   _icon_width, _icon_height);
-	uint title_width = titleWidth(this, _title.getReal())
-		- titleLeftOffset(this) - titleRightOffset(this);
-	if (title_width > _item_width_max) {
-		_item_width_max = title_width;
-	}
-
-	// Continue add padding etc.
-	Theme::PMenuData *md = pekwm::theme()->getMenuData();
-	_item_pad_horz = md->getPad(PAD_LEFT) + md->getPad(PAD_RIGHT);
-	if (pekwm::config()->isDisplayMenuIcons()) {
-		_item_pad_horz += _icon_width;
-	}
-
-	// If we have any submenus, increase the maximum width with arrow width
-	// + right pad as we are going to pad the arrow from the text too.
-	if (_has_submenu) {
-		_item_pad_horz += md->getPad(PAD_RIGHT)
-			+ md->getTextureArrow(OBJECT_STATE_FOCUSED)->getWidth();
-	}
-
-	_item_width_max += _item_pad_horz;
+	buildMenuCalculateIconSize(_icon_width, _icon_height);
 
 	// Calculate item height
+	Theme::PMenuData *md = pekwm::theme()->getMenuData();
 	_item_height =
 		std::max(md->getFont(OBJECT_STATE_FOCUSED)->getHeight(),
 			 _icon_height)
@@ -442,55 +484,96 @@ PMenu::buildMenuCalculate(void)
 		_size += sep;
 	}
 
+	// Columns only depend on the height, known before measuring any
+	// text which allows measuring to stop once the menu is known to
+	// be scrolled.
+	uint cols = 1;
+	uint avail_height = X11::getHeight() - titleHeight(this);
+	if (! _menu_width && height > avail_height && avail_height > 0) {
+		cols = (height + avail_height - 1) / avail_height;
+	}
+	uint text_width = buildMenuCalculateMaxWidth(cols);
+	_item_width_max = buildMenuCalculateItemWidth(text_width, _icon_width);
+
 	uint width;
+	_scroll_height = height;
 	buildMenuCalculateColumns(width, height);
 
-	// Check if we need to enable scrolling
+	// Check if we need to enable scrolling, the columns do not fit
+	// on screen. Fallback to a single column and only render the
+	// rows visible in a viewport the height of the screen.
 	_scroll = (width > X11::getWidth());
+	if (_scroll) {
+		_cols = 1;
+		_rows = _size;
+		width = _menu_width ? _menu_width : _item_width_max;
+		height = std::min(_scroll_height,
+				  X11::getHeight() - titleHeight(this));
+		resizeChild(std::max(static_cast<uint>(1), width),
+			    std::max(static_cast<uint>(1), height));
+		scrollTo(_scroll_y);
+	} else {
+		_scroll_y = 0;
+		resizeChild(std::max(static_cast<uint>(1), width),
+			    std::max(static_cast<uint>(1), height));
+	}
+}
+
+/**
+ * Get item width, including padding, from the maximum text width
+ * making sure the title fits. Updates the horizontal item padding.
+ */
+uint
+PMenu::buildMenuCalculateItemWidth(uint text_width, uint icon_width)
+{
+	uint title_width = titleWidth(this, _title.getReal())
+		- titleLeftOffset(this) - titleRightOffset(this);
+	if (title_width > text_width) {
+		text_width = title_width;
+	}
 
-	resizeChild(std::max(static_cast<uint>(1), width),
-		    std::max(static_cast<uint>(1), height));
+	// Continue add padding etc.
+	Theme::PMenuData *md = pekwm::theme()->getMenuData();
+	_item_pad_horz = md->getPad(PAD_LEFT) + md->getPad(PAD_RIGHT);
+	if (pekwm::config()->isDisplayMenuIcons()) {
+		_item_pad_horz += icon_width;
+	}
+
+	// If we have any submenus, increase the maximum width with arrow width
+	// + right pad as we are going to pad the arrow from the text too.
+	if (_has_submenu) {
+		_item_pad_horz += md->getPad(PAD_RIGHT)
+			+ md->getTextureArrow(OBJECT_STATE_FOCUSED)->getWidth();
+	}
+
+	return text_width + _item_pad_horz;
 }
 
 /**
- * Get maximum item width and icon size.
+ * Get icon size, limited to the configured menu icon size.
  */
 void
-PMenu::buildMenuCalculateMaxWidth(uint &max_width,
-				  uint &icon_width, uint &icon_height)
+PMenu::buildMenuCalculateIconSize(uint &icon_width, uint &icon_height)
 {
-	// Calculate max item width, to be used if/when splitting a menu
-	// up in rows because of limited vertical space.
-	max_width = 1;
 	icon_width = 0;
 	icon_height = 0;
 
-	Theme::PMenuData *md = pekwm::theme()->getMenuData();
-	PFont *font = md->getFont(OBJECT_STATE_FOCUSED);
 	item_it it = _items.begin();
 	for (; it != _items.end(); ++it) {
 		// Only include standard items
-		if ((*it)->getType() != PMenu::Item::MENU_ITEM_NORMAL) {
+		if ((*it)->getType() != PMenu::Item::MENU_ITEM_NORMAL
+		    || ! (*it)->getIcon()) {
 			continue;
 		}
 
-		// Get icon height if any
-		if ((*it)->getIcon()) {
-			if ((*it)->getIcon()->getWidth() > icon_width) {
-				icon_width = (*it)->getIcon()->getWidth();
-			}
-			if ((*it)->getIcon()->getHeight() > icon_height) {
-				icon_height = (*it)->getIcon()->getHeight();
-			}
+		if ((*it)->getIcon()->getWidth() > icon_width) {
+			icon_width = (*it)->getIcon()->getWidth();
 		}
-
-		uint width = font->getWidth((*it)->getName().c_str());
-		if (width > max_width) {
-			max_width = width;
+		if ((*it)->getIcon()->getHeight() > icon_height) {
+			icon_height = (*it)->getIcon()->getHeight();
 		}
 	}
 
-
 	// Make sure icon width and height are not larger than configured.
 	if (icon_width) {
 		Config *cfg = pekwm::config();
@@ -506,6 +589,80 @@ PMenu::buildMenuCalculateMaxWidth(uint &max_width,
 	}
 }
 
+/**
+ * Get maximum text width of the standard items. Items already
+ * measured are always included, the rest are only measured until
+ * cols columns no longer fit on screen. The menu is then scrolled
+ * and remaining items are measured when they become visible.
+ */
+uint
+PMenu::buildMenuCalculateMaxWidth(uint cols)
+{
+	Theme::PMenuData *md = pekwm::theme()->getMenuData();
+	PFont *font = md->getFont(OBJECT_STATE_FOCUSED);
+
+	// item width for text that is narrower than the title
+	uint min_width = buildMenuCalculateItemWidth(0, _icon_width);
+	bool measure = true;
+	uint max_width = 1;
+	item_it it = _items.begin();
+	for (; it != _items.end(); ++it) {
+		if ((*it)->getType() != PMenu::Item::MENU_ITEM_NORMAL
+		    || ! (measure || (*it)->hasTextWidth(font))) {
+			continue;
+		}
+
+		uint width = (*it)->getTextWidth(font);
+		if (width > max_width) {
+			max_width = width;
+		}
+		if (measure && cols > 1
+		    && (cols * std::max(max_width + _item_pad_horz, min_width)
+			> X11::getWidth())) {
+			measure = false;
+		}
+	}
+	return max_width;
+}
+
+/**
+ * Measure the rows inside the viewport of a scrolled menu, the menu
+ * is widened, up to the screen width, if a row does not fit.
+ */
+void
+PMenu::buildMenuCalculateViewport(void)
+{
+	Theme::PMenuData *md = pekwm::theme()->getMenuData();
+	PFont *font = md->getFont(OBJECT_STATE_FOCUSED);
+
+	uint text_width = 0;
+	int view_end = _scroll_y + getChildHeight();
+	item_it it = _items.begin();
+	for (; it != _items.end(); ++it) {
+		if ((*it)->getType() != PMenu::Item::MENU_ITEM_NORMAL
+		    || ((*it)->getY() + (*it)->getHeight())
+		       <= static_cast<int>(_scroll_y)) {
+			continue;
+		} else if ((*it)->getY() >= view_end) {
+			break;
+		}
+		text_width = std::max(text_width, (*it)->getTextWidth(font));
+	}
+
+	uint width = std::min(buildMenuCalculateItemWidth(text_width,
+							  _icon_width),
+			      X11::getWidth());
+	if (_menu_width || width <= _item_width_max) {
+		return;
+	}
+
+	_item_width_max = width;
+	for (it = _items.begin(); it != _items.end(); ++it) {
+		(*it)->setWidth(width);
+	}
+	resizeChild(width, getChildHeight());
+}
+
 /**
  * Calculate number of columns, this does not apply to static width
  * menus.
@@ -603,6 +760,12 @@ PMenu::buildMenuPlace(void)
 void
 PMenu::buildMenuRender(void)
 {
+	// in scroll mode the child, and pixmaps, only cover the viewport
+	// and only the visible rows are measured and rendered.
+	if (_scroll) {
+		buildMenuCalculateViewport();
+	}
+
 	_menu_bg_fo.resize(getChildWidth(), getChildHeight());
 	buildMenuRenderState(&_menu_bg_fo, OBJECT_STATE_FOCUSED);
 	_menu_bg_un.resize(getChildWidth(), getChildHeight());
@@ -616,6 +779,81 @@ PMenu::buildMenuRender(void)
 	X11::clearWindow(_menu_wo->getWindow());
 }
 
+/**
+ * Re-render items after their name has changed without rebuilding
+ * the menu, the menu is rebuilt if the item width or icon size no
+ * longer matches the current layout.
+ */
+void
+PMenu::renderItems(const item_vec &items)
+{
+	uint icon_width, icon_height;
+	buildMenuCalculateIconSize(icon_width, icon_height);
+	if (_size == 0
+	    || icon_width != _icon_width || icon_height != _icon_height) {
+		buildMenu();
+		return;
+	}
+
+	if (_scroll) {
+		// scrolled menus only grow, and only measure the
+		// changed items.
+		Theme::PMenuData *md = pekwm::theme()->getMenuData();
+		PFont *font = md->getFont(OBJECT_STATE_FOCUSED);
+		item_cit it = items.begin();
+		for (; it != items.end(); ++it) {
+			uint width = buildMenuCalculateItemWidth(
+				(*it)->getTextWidth(font), icon_width);
+			if (width > _item_width_max
+			    && _item_width_max < X11::getWidth()) {
+				buildMenu();
+				return;
+			}
+		}
+	} else {
+		uint cols = _menu_width ? 1 : _cols;
+		uint text_width = buildMenuCalculateMaxWidth(cols);
+		if (buildMenuCalculateItemWidth(text_width, icon_width)
+		    != _item_width_max) {
+			buildMenu();
+			return;
+		}
+	}
+
+	renderItemsState(&_menu_bg_fo, OBJECT_STATE_FOCUSED, items);
+	renderItemsState(&_menu_bg_un, OBJECT_STATE_UNFOCUSED, items);
+	renderItemsState(&_menu_bg_se, OBJECT_STATE_SELECTED, items);
+
+	Drawable src = _focused ? _menu_bg_fo.getDrawable()
+				: _menu_bg_un.getDrawable();
+	item_cit it = items.begin();
+	for (; it != items.end(); ++it) {
+		if ((*it)->getType() != PMenu::Item::MENU_ITEM_HIDDEN) {
+			copyItemArea(*it, src);
+		}
+	}
+	renderSelectedItem();
+
+	P_DBG("re-rendered " << items.size() << " items in menu " << _name);
+}
+
+/**
+ * Render items on surf with state state, items do not need to be
+ * visible.
+ */
+void
+PMenu::renderItemsState(PSurface *surf, ObjectState state,
+			const item_vec &items)
+{
+	Theme::PMenuData *md = pekwm::theme()->getMenuData();
+	md->getFont(state)->setColor(md->getColor(state));
+
+	item_cit it = items.begin();
+	for (; it != items.end(); ++it) {
+		buildMenuRenderItem(surf, state, *it);
+	}
+}
+
 //! @brief Renders menu content on pix, with state state
 void
 PMenu::buildMenuRenderState(PSurface *surf, ObjectState state)
@@ -626,11 +864,23 @@ PMenu::buildMenuRenderState(PSurface *surf, ObjectState state)
 	PFont *font = md->getFont(state);
 	font->setColor(md->getColor(state));
 
+	int view_end = _scroll_y + getChildHeight();
 	item_it it = _items.begin();
 	for (; it != _items.end(); ++it) {
-		if ((*it)->getType() != PMenu::Item::MENU_ITEM_HIDDEN) {
-			buildMenuRenderItem(surf, state, *it);
+		if ((*it)->getType() == PMenu::Item::MENU_ITEM_HIDDEN) {
+			continue;
 		}
+		if (_scroll) {
+			// items are placed in a single column, skip rows
+			// before the viewport and stop after it.
+			if (((*it)->getY() + (*it)->getHeight())
+			    <= static_cast<int>(_scroll_y)) {
+				continue;
+			} else if ((*it)->getY() >= view_end) {
+				break;
+			}
+		}
+		buildMenuRenderItem(surf, state, *it);
 	}
 }
 
@@ -653,9 +903,10 @@ PMenu::buildMenuRenderItemNormal(PSurface *surf, ObjectState state,
 	Theme::PMenuData *md = pekwm::theme()->getMenuData();
 	Config *cfg = pekwm::config();
 
+	int item_y = item->getY() - _scroll_y;
 	PTexture *tex = md->getTextureItem(state);
 	tex->render(surf,
-		    item->getX(), item->getY(),
+		    item->getX(), item_y,
 		    item->getWidth(), item->getHeight());
 
 	uint start_x, start_y;
@@ -676,8 +927,7 @@ PMenu::buildMenuRenderItemNormal(PSurface *surf, ObjectState state,
 
 		start_x = item->getX() + md->getPad(PAD_LEFT)
 			+ (_icon_width - icon_width) / 2;
-		start_y = item->getY()
-			+ (_item_height - icon_height) / 2;
+		start_y = item_y + (_item_height - icon_height) / 2;
 		item->getIcon()->render(surf, start_x, start_y,
 					icon_width, icon_height);
 	}
@@ -694,7 +944,7 @@ PMenu::buildMenuRenderItemNormal(PSurface *surf, ObjectState state,
 
 		start_x = item->getX() + item->getWidth()
 			- arrow_width - md->getPad(PAD_RIGHT);
-		start_y = item->getY() + arrow_y;
+		start_y = item_y + arrow_y;
 		tex->render(surf, start_x, start_y,
 			    arrow_width, arrow_height);
 	}
@@ -707,7 +957,7 @@ PMenu::buildMenuRenderItemNormal(PSurface *surf, ObjectState state,
 		start_x += _icon_width;
 	}
 
-	start_y = item->getY() + md->getPad(PAD_UP)
+	start_y = item_y + md->getPad(PAD_UP)
 		+ (_item_height - font->getHeight()
 		   - md->getPad(PAD_UP) - md->getPad(PAD_DOWN)) / 2;
 
@@ -723,15 +973,66 @@ PMenu::buildMenuRenderItemSeparator(PSurface *surf, ObjectState state,
 	Theme::PMenuData *md = pekwm::theme()->getMenuData();
 	PTexture *tex = md->getTextureSeparator(state);
 	tex->render(surf,
-		    item->getX(), item->getY(),
+		    item->getX(), item->getY() - _scroll_y,
 		    item->getWidth(), item->getHeight());
 }
 
-#define COPY_ITEM_AREA(ITEM, PIX)		  \
-	X11::copyArea(PIX, _menu_wo->getWindow(), \
-		      (ITEM)->getX(), (ITEM)->getY(), \
-		      (ITEM)->getWidth(), (ITEM)->getHeight(), \
-		      (ITEM)->getX(), (ITEM)->getY());
+/**
+ * Move viewport to y, limited to the menu rows. Returns true if the
+ * viewport moved and the menu needs to be rendered again.
+ */
+bool
+PMenu::scrollTo(int y)
+{
+	int max_y = static_cast<int>(_scroll_height)
+		- static_cast<int>(getChildHeight());
+	y = std::max(0, std::min(y, max_y));
+	if (static_cast<uint>(y) == _scroll_y) {
+		return false;
+	}
+	_scroll_y = y;
+	return true;
+}
+
+/**
+ * Move viewport to make item fully visible.
+ */
+bool
+PMenu::scrollToItem(PMenu::Item *item)
+{
+	int y = item->getY();
+	if (y < static_cast<int>(_scroll_y)) {
+		return scrollTo(y);
+	}
+	int view_end = _scroll_y + getChildHeight();
+	if ((y + item->getHeight()) > view_end) {
+		return scrollTo(y + item->getHeight() - getChildHeight());
+	}
+	return false;
+}
+
+/**
+ * Copy area of item from src to the menu window, only the part of the
+ * item inside the viewport is copied.
+ */
+void
+PMenu::copyItemArea(PMenu::Item *item, Drawable src)
+{
+	int y = item->getY() - _scroll_y;
+	int height = item->getHeight();
+	if (y < 0) {
+		height += y;
+		y = 0;
+	}
+	if ((y + height) > static_cast<int>(getChildHeight())) {
+		height = getChildHeight() - y;
+	}
+	if (height > 0) {
+		X11::copyArea(src, _menu_wo->getWindow(),
+			      item->getX(), y, item->getWidth(), height,
+			      item->getX(), y);
+	}
+}
 
 //! @brief Renders item as selected
 //! @param item Item to select
@@ -747,6 +1048,9 @@ PMenu::selectItem(std::vector<PMenu::Item*>::const_iterator item,
 	deselectItem(unmap_submenu);
 	_item_curr = item-_items.begin();
 
+	if (_scroll && scrollToItem(*item)) {
+		buildMenuRender();
+	}
 	renderSelectedItem();
 }
 
@@ -759,7 +1063,7 @@ PMenu::renderSelectedItem(void)
 	}
 	PMenu::Item *item = _items[_item_curr];
 	if (item->getType() != PMenu::Item::MENU_ITEM_HIDDEN) {
-		COPY_ITEM_AREA(item, _menu_bg_se.getDrawable());
+		copyItemArea(item, _menu_bg_se.getDrawable());
 	}
 }
 
@@ -779,9 +1083,9 @@ PMenu::deselectItem(bool unmap_submenu)
 	}
 
 	if (_mapped) {
-		COPY_ITEM_AREA(_items[_item_curr],
-			       (_focused ? _menu_bg_fo.getDrawable()
-					 : _menu_bg_un.getDrawable()));
+		copyItemArea(_items[_item_curr],
+			     _focused ? _menu_bg_fo.getDrawable()
+				      : _menu_bg_un.getDrawable());
 	}
 
 	PWinObj* wo_ref = item->getWORef();
@@ -794,8 +1098,6 @@ PMenu::deselectItem(bool unmap_submenu)
 	}
 }
 
-#undef COPY_ITEM_AREA
-
 //! @brief Selects next item ( wraps ). First item if none is selected.
 void
 PMenu::selectNextItem(void)
@@ -992,7 +1294,7 @@ PMenu::mapSubmenu(PMenu *menu, bool focus)
 
 	x = getRX();
 	if (_item_curr < _items.size()) {
-		y = _gm.y + _items[_item_curr]->getY();
+		y = _gm.y + _items[_item_curr]->getY() - _scroll_y;
 	} else {
 		y = _gm.y;
 	}
@@ -1133,6 +1435,7 @@ PMenu::checkItemWORef(PMenu::Item *item)
 PMenu::Item*
 PMenu::findItem(int x, int y)
 {
+	y += _scroll_y;
 	item_it it = _items.begin();
 	for (; it != _items.end(); ++it) {
 		if (((*it)->getType() == PMenu::Item::MENU_ITEM_NORMAL) &&
@@ -22,6 +22,7 @@
 
 #include "tk/PPixmapSurface.hh"
 
+class PFont;
 class PTexture;
 class ActionEvent;
 class Theme;
@@ -52,16 +53,28 @@ public:
 		inline void setY(int y) { _gm.y = y; }
 		inline void setWidth(int width) { _gm.width = width; }
 		inline void setHeight(int height) { _gm.height = height; }
-		inline void setName(const std::string &name) { _name = name; }
+		inline void setName(const std::string &name) {
+			_name = name;
+			_text_width_font = nullptr;
+		}
 		inline void setAE(const ActionEvent &ae) { _ae = ae; }
 		inline void setType(PMenu::Item::Type type) { _type = type; }
 
 		inline void setCreator(PMenu::Item *c) { _creator = c; }
 		inline PMenu::Item *getCreator(void) const { return _creator; }
 
+		uint getTextWidth(PFont *font);
+		bool hasTextWidth(PFont *font) const {
+			return _text_width_font == font;
+		}
+		void clearTextWidth(void) { _text_width_font = nullptr; }
+
 	private:
 		Geometry _gm;
 		std::string _name;
+		/** Width of _name in _text_width_font, measured once. */
+		uint _text_width;
+		PFont *_text_width_font;
 
 		ActionEvent _ae; // used for specifying action of the entry
 
@@ -103,6 +116,7 @@ public:
 		std::map<Window, PMenu*>::iterator it = _menu_map.find(win);
 		return (it != _menu_map.end()) ? it->second : 0;
 	}
+	static bool isScrollButton(bool scroll, uint button);
 
 	const std::string &getName(void) { return _name; }
 	PMenu::Item *getItemCurr(void) {
@@ -128,6 +142,7 @@ public:
 
 	virtual void reload(CfgParser::Entry*) { }
 	void buildMenu(void);
+	void renderItems(const item_vec &items);
 
 	inline uint size(void) const { return _items.size(); }
 	item_it m_begin_non_const(void) { return _items.begin(); }
@@ -161,16 +176,24 @@ private:
 	PMenu& operator=(const PMenu&);
 
 	void renderSelectedItem(void);
+	void copyItemArea(PMenu::Item *item, Drawable src);
+
+	bool scrollTo(int y);
+	bool scrollToItem(PMenu::Item *item);
 
 	void handleItemEvent(MouseEventType type, int x, int y);
 
 	void buildMenuCalculate(void);
-	void buildMenuCalculateMaxWidth(uint &width,
-					uint &icon_width, uint &icon_height);
+	uint buildMenuCalculateItemWidth(uint text_width, uint icon_width);
+	void buildMenuCalculateIconSize(uint &icon_width, uint &icon_height);
+	uint buildMenuCalculateMaxWidth(uint cols);
+	void buildMenuCalculateViewport(void);
 	void buildMenuCalculateColumns(uint &width, uint &height);
 	void buildMenuPlace(void);
 	void buildMenuRender(void);
 	void buildMenuRenderState(PSurface *surf, ObjectState state);
+	void renderItemsState(PSurface *surf, ObjectState state,
+			      const item_vec &items);
 	void buildMenuRenderItem(PSurface *surf, ObjectState state,
 				 PMenu::Item* item);
 	void buildMenuRenderItemNormal(PSurface *surf, ObjectState state,
@@ -214,7 +237,13 @@ private:
 
 	uint _size; // size, hidden items excluded
 	uint _rows, _cols;
+	/** If true, the menu does not fit the screen and only the rows
+	    inside a scrolled viewport are rendered. */
 	bool _scroll;
+	/** Offset of the viewport into the menu rows. */
+	uint _scroll_y;
+	/** Height of all menu rows, viewport height is the child height. */
+	uint _scroll_height;
 	uint _has_submenu;
 
 	static std::map<Window, PMenu*> _menu_map;
@@ -16,6 +16,42 @@
 #include <iostream>
 #include <list>
 
+SearchResult::SearchResult(void)
+	: _generation(0)
+{
+}
+
+SearchResult::~SearchResult(void)
+{
+}
+
+/**
+ * Update result, title index generations start at 1 so a cleared
+ * result never matches.
+ *
+ * @return true if clients or generation changed.
+ */
+bool
+SearchResult::update(const std::vector<Client*> &clients, uint generation)
+{
+	if (generation == _generation && clients == _clients) {
+		return false;
+	}
+	_clients = clients;
+	_generation = generation;
+	return true;
+}
+
+/**
+ * Clear result, next update always reports a change.
+ */
+void
+SearchResult::clear(void)
+{
+	_clients.clear();
+	_generation = 0;
+}
+
 /**
  * SearchDialog constructor.
  */
@@ -109,7 +145,9 @@ SearchDialog::updateSize(const Geometry &head)
 }
 
 /**
- * Search list of clients for matching titles.
+ * Search list of clients for matching titles. Searches without regular
+ * expression meta characters use the client title index, refining the
+ * result of the previous keystroke and ranking the results.
  *
  * @param search Regexp to search, case insensitive
  * @return Number of matches
@@ -123,27 +161,36 @@ SearchDialog::findClients(const std::string &search)
 	}
 	_previous_search = search;
 
-	_result_menu->removeAll();
-	if (search.size() > 0) {
-		RegexString search_re("/" + search + "/i");
-		if (! search_re.is_match_ok()) {
-			return 0;
-		}
-
-		std::vector<Client*> matches;
-		Client::client_cit it(Client::client_begin());
-		for (; it != Client::client_end(); ++it) {
+	std::vector<Client*> matches;
+	if (search.empty()) {
+		_search.reset();
+	} else if (TitleIndex::isLiteral(search)) {
+		std::vector<Client*> found;
+		Client::getTitleIndex().search(_search, search, found);
+		std::vector<Client*>::iterator it(found.begin());
+		for (; it != found.end(); ++it) {
 			if ((*it)->isFocusable()
-			    && ! (*it)->isSkip(SKIP_FOCUS_TOGGLE)
-			    && search_re == (*it)->getTitle()->getReal()) {
+			    && ! (*it)->isSkip(SKIP_FOCUS_TOGGLE)) {
 				matches.push_back(*it);
 			}
 		}
+	} else {
+		_search.reset();
+		findClientsRegex(search, matches);
+	}
 
-		for (it = matches.begin(); it != matches.end(); ++it) {
-			_result_menu->insert((*it)->getTitle()->getVisible(),
-					     *it, (*it)->getIcon());
-		}
+	// Result unchanged, skip rebuilding the menu. Clients are only
+	// compared when none has been added, removed or re-titled.
+	uint generation = Client::getTitleIndex().getGeneration();
+	if (! _result.update(matches, generation)) {
+		return _result_menu->size();
+	}
+
+	_result_menu->removeAll();
+	std::vector<Client*>::iterator it(matches.begin());
+	for (; it != matches.end(); ++it) {
+		_result_menu->insert((*it)->getTitle()->getVisible(),
+				     *it, (*it)->getIcon());
 	}
 
 	// Rebuild menu and make room for it
@@ -167,7 +214,30 @@ SearchDialog::findClients(const std::string &search)
 		X11::lowerWindow(_result_menu->getWindow());
 	}
 
-	return 0;
+	return _result_menu->size();
+}
+
+/**
+ * Search all clients for titles matching the regular expression
+ * search, case insensitive.
+ */
+void
+SearchDialog::findClientsRegex(const std::string &search,
+			       std::vector<Client*> &matches)
+{
+	RegexString search_re("/" + search + "/i");
+	if (! search_re.is_match_ok()) {
+		return;
+	}
+
+	Client::client_cit it(Client::client_begin());
+	for (; it != Client::client_end(); ++it) {
+		if ((*it)->isFocusable()
+		    && ! (*it)->isSkip(SKIP_FOCUS_TOGGLE)
+		    && search_re == (*it)->getTitle()->getReal()) {
+			matches.push_back(*it);
+		}
+	}
 }
 
 /**
@@ -184,6 +254,10 @@ SearchDialog::unmapWindow(void)
 		// Clear the menu and hide it.
 		X11::clearWindow(_result_menu->getWindow());
 		_previous_search = "";
+		_search.reset();
+		// The menu is lowered, the next search must rebuild and
+		// raise it even if the result is the same.
+		_result.clear();
 		X11::lowerWindow(_result_menu->getWindow());
 	}
 }
@@ -15,8 +15,31 @@
 
 #include "InputDialog.hh"
 #include "PMenu.hh"
+#include "TitleIndex.hh"
 
 #include <string>
+#include <vector>
+
+/**
+ * Clients shown in the search result menu together with the title
+ * index generation they were computed at, used to skip rebuilding
+ * the menu when a search gives the same result.
+ */
+class SearchResult {
+public:
+	SearchResult(void);
+	~SearchResult(void);
+
+	const std::vector<Client*>& clients(void) const { return _clients; }
+
+	bool update(const std::vector<Client*> &clients, uint generation);
+	void clear(void);
+
+private:
+	std::vector<Client*> _clients;
+	/** Title index generation, 0 when not computed. */
+	uint _generation;
+};
 
 /**
  * Search dialog providing a dialog for searching clients together
@@ -44,10 +67,16 @@ private:
 	SearchDialog& operator=(const SearchDialog&);
 
 	uint findClients(const std::string &search);
+	void findClientsRegex(const std::string &search,
+			      std::vector<Client*> &matches);
 
 	PMenu *_result_menu; /**< Menu for displaying results. */
 	/** Buffer with previous search string. */
 	std::string _previous_search;
+	/** Incremental search state for literal searches. */
+	TitleIndex::Search _search;
+	/** Clients currently shown in the result menu. */
+	SearchResult _result;
 };
 
 #endif // _PEKWM_SEARCHDIALOG_HH_
@@ -0,0 +1,200 @@
+//
+// TitleIndex.cc for pekwm
+// Copyright (C) 2023 Claes Nästén <pekdon@gmail.com>
+//
+// This program is licensed under the GNU GPL.
+// See the LICENSE file for more information.
+//
+
+#include "TitleIndex.hh"
+#include "Charset.hh"
+
+#include <algorithm>
+#include <cctype>
+#include <utility>
+
+/** Characters making a query a regular expression and not a literal. */
+static const char *REGEX_META_CHARS = ".[]()*+?{}|^$\\";
+
+TitleIndex::Search::Search(void)
+	: _generation(0)
+{
+}
+
+/**
+ * Forget previous matches, next search scans the full index.
+ */
+void
+TitleIndex::Search::reset(void)
+{
+	_query.clear();
+	_generation = 0;
+	_matches.clear();
+}
+
+TitleIndex::TitleIndex(void)
+	: _generation(1)
+{
+}
+
+TitleIndex::~TitleIndex(void)
+{
+}
+
+void
+TitleIndex::add(Client *client, const std::string &title)
+{
+	_entries.push_back(Entry(client, fold(title)));
+	_generation++;
+}
+
+/**
+ * Update title of client, clients not in the index are ignored.
+ */
+void
+TitleIndex::update(Client *client, const std::string &title)
+{
+	std::vector<Entry>::iterator it = find(client);
+	if (it == _entries.end()) {
+		return;
+	}
+
+	std::string folded = fold(title);
+	if (it->title != folded) {
+		it->title = folded;
+		_generation++;
+	}
+}
+
+void
+TitleIndex::remove(Client *client)
+{
+	std::vector<Entry>::iterator it = find(client);
+	if (it != _entries.end()) {
+		_entries.erase(it);
+		_generation++;
+	}
+}
+
+/**
+ * Search for titles matching query, case insensitive. Results are
+ * ranked prefix matches first followed by matches at the start of a
+ * word, substring matches and fuzzy matches, keeping index order within
+ * each rank.
+ *
+ * If query extends the query of the previous search and the index has
+ * not changed since, only the previous matches are considered as any
+ * title matching the longer query also matches the shorter.
+ */
+void
+TitleIndex::search(Search &search, const std::string &query,
+		   std::vector<Client*> &result) const
+{
+	result.clear();
+
+	std::string folded = fold(query);
+	bool refine = search._generation == _generation
+		&& ! search._query.empty()
+		&& folded.size() >= search._query.size()
+		&& folded.compare(0, search._query.size(), search._query) == 0;
+
+	std::vector<std::pair<MatchType, size_t> > ranked;
+	if (! folded.empty()) {
+		if (refine) {
+			std::vector<size_t>::const_iterator it =
+				search._matches.begin();
+			for (; it != search._matches.end(); ++it) {
+				MatchType type = match(_entries[*it].title,
+						       folded);
+				if (type != MATCH_NONE) {
+					ranked.push_back(std::make_pair(type,
+									*it));
+				}
+			}
+		} else {
+			for (size_t i = 0; i < _entries.size(); i++) {
+				MatchType type = match(_entries[i].title,
+						       folded);
+				if (type != MATCH_NONE) {
+					ranked.push_back(std::make_pair(type,
+									i));
+				}
+			}
+		}
+		// pairs compare on match type first and then index order
+		std::sort(ranked.begin(), ranked.end());
+	}
+
+	search._query = folded;
+	search._generation = _generation;
+	search._matches.clear();
+	std::vector<std::pair<MatchType, size_t> >::iterator it =
+		ranked.begin();
+	for (; it != ranked.end(); ++it) {
+		search._matches.push_back(it->second);
+		result.push_back(_entries[it->second].client);
+	}
+}
+
+/**
+ * Return true if query contains no regular expression meta characters
+ * and can be searched for using the index.
+ */
+bool
+TitleIndex::isLiteral(const std::string &query)
+{
+	return query.find_first_of(REGEX_META_CHARS) == std::string::npos;
+}
+
+/**
+ * Fold case of str, non-ASCII characters are folded using the current
+ * locale and are only folded in a locale with case mappings for them.
+ */
+std::string
+TitleIndex::fold(const std::string &str)
+{
+	return Charset::toLower(str);
+}
+
+/**
+ * Match case folded title against case folded query.
+ */
+TitleIndex::MatchType
+TitleIndex::match(const std::string &title, const std::string &query)
+{
+	size_t pos = title.find(query);
+	if (pos == 0) {
+		return MATCH_PREFIX;
+	} else if (pos != std::string::npos) {
+		for (; pos != std::string::npos;
+		     pos = title.find(query, pos + 1)) {
+			unsigned char prev = title[pos - 1];
+			if (prev < 0x80 && ! std::isalnum(prev)) {
+				return MATCH_WORD;
+			}
+		}
+		return MATCH_SUBSTRING;
+	}
+
+	// fuzzy, all characters of the query in order
+	std::string::const_iterator t_it = title.begin();
+	std::string::const_iterator q_it = query.begin();
+	for (; t_it != title.end() && q_it != query.end(); ++t_it) {
+		if (*t_it == *q_it) {
+			++q_it;
+		}
+	}
+	return q_it == query.end() ? MATCH_FUZZY : MATCH_NONE;
+}
+
+std::vector<TitleIndex::Entry>::iterator
+TitleIndex::find(Client *client)
+{
+	std::vector<Entry>::iterator it = _entries.begin();
+	for (; it != _entries.end(); ++it) {
+		if (it->client == client) {
+			return it;
+		}
+	}
+	return _entries.end();
+}
@@ -0,0 +1,99 @@
+//
+// TitleIndex.hh for pekwm
+// Copyright (C) 2023 Claes Nästén <pekdon@gmail.com>
+//
+// This program is licensed under the GNU GPL.
+// See the LICENSE file for more information.
+//
+
+#ifndef _PEKWM_TITLE_INDEX_HH_
+#define _PEKWM_TITLE_INDEX_HH_
+
+#include "config.h"
+
+#include "Types.hh"
+
+#include <string>
+#include <vector>
+
+class Client;
+
+/**
+ * Index of case folded client titles, kept up to date as clients are
+ * added, removed and re-titled so that searches do not need to walk
+ * the clients and compile a regular expression per keystroke.
+ *
+ * Clients are only used as keys, the index never dereferences them.
+ */
+class TitleIndex {
+public:
+	/** Match types in ranking order, best match first. */
+	enum MatchType {
+		MATCH_PREFIX,
+		MATCH_WORD,
+		MATCH_SUBSTRING,
+		MATCH_FUZZY,
+		MATCH_NONE
+	};
+
+	/**
+	 * State of an ongoing search, used to refine the result of the
+	 * previous keystroke when the query is extended.
+	 */
+	class Search {
+	public:
+		Search(void);
+
+		void reset(void);
+
+	private:
+		friend class TitleIndex;
+
+		/** Case folded query the matches were computed for. */
+		std::string _query;
+		/** Index generation the matches are valid for. */
+		uint _generation;
+		/** Positions in the index of entries matching _query. */
+		std::vector<size_t> _matches;
+	};
+
+	TitleIndex(void);
+	~TitleIndex(void);
+
+	size_t size(void) const { return _entries.size(); }
+	uint getGeneration(void) const { return _generation; }
+
+	void add(Client *client, const std::string &title);
+	void update(Client *client, const std::string &title);
+	void remove(Client *client);
+
+	void search(Search &search, const std::string &query,
+		    std::vector<Client*> &result) const;
+
+	static bool isLiteral(const std::string &query);
+	static std::string fold(const std::string &str);
+	static MatchType match(const std::string &title,
+			       const std::string &query);
+
+private:
+	class Entry {
+	public:
+		Entry(Client *client_, const std::string &title_)
+			: client(client_),
+			  title(title_)
+		{
+		}
+
+		Client *client;
+		/** Case folded title. */
+		std::string title;
+	};
+
+	std::vector<Entry>::iterator find(Client *client);
+
+	std::vector<Entry> _entries;
+	/** Incremented on every change invalidating search state. */
+	uint _generation;
+};
+
+#endif // _PEKWM_TITLE_INDEX_HH_
@@ -27,6 +27,8 @@
 #include "X11.hh"
 
 #include "RegexString.hh"
+#include "Trace.hh"
+#include "X11Stats.hh"
 
 #include "KeyGrabber.hh"
 #include "MenuHandler.hh"
@@ -49,6 +51,7 @@
 #include <cstring>
 #include <iostream>
 #include <memory>
+#include <sstream>
 #include <cassert>
 
 extern "C" {
@@ -67,6 +70,12 @@ extern "C" {
 // include after all includes to get ifndefs right
 #include "Compat.hh"
 
+/** Maximum size of a _PEKWM_CMD command and of a batch of commands. */
+static const size_t PEKWM_CMD_MAX_SIZE = 1024;
+static const size_t PEKWM_CMD_BATCH_MAX_SIZE = 65536;
+/** Number of parsed _PEKWM_CMD commands cached. */
+static const size_t PEKWM_CMD_CACHE_SIZE = 64;
+
 extern "C" {
 
 	static bool is_signal = false;
@@ -151,7 +160,9 @@ WindowManager::start(const std::string &config_file,
 }
 
 WindowManager::WindowManager(void)
-	: _shutdown(false),
+	: _pekwm_cmd_batch(false),
+	  _pekwm_cmd_cache(PEKWM_CMD_CACHE_SIZE, CMD_OK),
+	  _shutdown(false),
 	  _reload(false),
 	  _restart(false),
 	  _bg_pid(-1),
@@ -175,11 +186,16 @@ WindowManager::WindowManager(void)
 	sigaction(SIGHUP, &act, 0);
 	sigaction(SIGCHLD, &act, 0);
 	sigaction(SIGALRM, &act, 0);
+
+	Debug::addDump("trace", Trace::dump, nullptr);
+	Debug::addDump("x11", X11Stats::dump, nullptr);
 }
 
 //! @brief WindowManager destructor
 WindowManager::~WindowManager(void)
 {
+	Debug::removeDump("x11");
+	Debug::removeDump("trace");
 	cleanup();
 
 	MenuHandler::deleteMenus();
@@ -484,6 +500,9 @@ WindowManager::doReloadConfig(void)
 		return;
 	}
 
+	pekwm::imageHandler()->setCache(cfg->getImageCache(),
+					cfg->getImageCacheSize());
+
 	// Update what might have changed in the cfg touching the hints
 	Workspaces::setSize(cfg->getWorkspaces());
 	Workspaces::setPerRow(cfg->getWorkspacesPerRow());
@@ -546,6 +565,16 @@ WindowManager::startBackground(const std::string& theme_dir,
 		args.push_back(BINDIR "/pekwm_bg");
 		args.push_back("--load-dir");
 		args.push_back(theme_dir + "/backgrounds");
+		const std::string &image_cache =
+			pekwm::config()->getImageCache();
+		if (! image_cache.empty()) {
+			args.push_back("--image-cache");
+			args.push_back(image_cache);
+			std::ostringstream size;
+			size << pekwm::config()->getImageCacheSize();
+			args.push_back("--image-cache-size");
+			args.push_back(size.str());
+		}
 		args.push_back(texture);
 		_bg_pid = Util::forkExec(args);
 	}
@@ -729,6 +758,8 @@ void
 WindowManager::doEventLoop(void)
 {
 	XEvent ev;
+	ObserverMapping *om = pekwm::observerMapping();
+	om->setDeferred(true);
 
 	while (! _shutdown && ! is_signal_int_term) {
 		if (is_signal) {
@@ -739,13 +770,40 @@ WindowManager::doEventLoop(void)
 			doReload();
 		}
 
+		// deliver notifications deferred while processing the
+		// current batch of events before waiting for more events.
+		if (om->queueSize() > 0 && ! X11::pending()) {
+			om->flush();
+		}
+
 		// Get next event, drop event handling if none was given
 		if (X11::getNextEvent(ev)) {
+			bool trace = Trace::isEnabled();
+
+			uint requests = X11Stats::getCount(X11Stats::REQUEST);
+			uint round_trips =
+				X11Stats::getCount(X11Stats::ROUND_TRIP);
+			X11Stats::setEvent(ev.type);
+
 			if (! _event_handler || ! handleEventHandlerEvent(ev)) {
 				handleEvent(ev);
 			}
+
+			X11Stats::setEvent(-1);
+			if (trace) {
+				Trace::record(Trace::KIND_EVENT, ev.type,
+					      X11::getEventReadTime());
+			}
+			P_TRACE("event " << Trace::getEventName(ev.type)
+				<< " made "
+				<< (X11Stats::getCount(X11Stats::REQUEST)
+				    - requests) << " requests and "
+				<< (X11Stats::getCount(X11Stats::ROUND_TRIP)
+				    - round_trips) << " round trips");
 		}
 	}
+
+	om->setDeferred(false);
 }
 
 bool
@@ -788,6 +846,7 @@ void
 WindowManager::handleEvent(XEvent &ev)
 {
 	static ScreenChangeNotification scn;
+	Trace::Scope trace(Trace::KIND_DISPATCH, ev.type);
 
 	switch (ev.type) {
 	case MapRequest:
@@ -1577,24 +1636,50 @@ WindowManager::handlePekwmCmd(XClientMessageEvent *ev)
 		return;
 	}
 
-	Action action;
-	P_TRACE("received _PEKWM_CMD: " << _pekwm_cmd_buf);
-	if (ActionConfig::parseAction(_pekwm_cmd_buf, action, CMD_OK)) {
-		ActionEvent ae;
-		ae.action_list.push_back(action);
-
-		PWinObj *wo = nullptr;
-		if (ev->window != X11::getRoot()) {
-			wo = Client::findClient(ev->window);
+	if (_pekwm_cmd_batch) {
+		P_TRACE("received _PEKWM_CMD batch: " << _pekwm_cmd_buf);
+		size_t start = 0;
+		while (start < _pekwm_cmd_buf.size()) {
+			size_t end = _pekwm_cmd_buf.find('\n', start);
+			if (end == std::string::npos) {
+				end = _pekwm_cmd_buf.size();
+			}
+			if (end > start) {
+				runPekwmCmd(_pekwm_cmd_buf.substr(start,
+								  end - start),
+					    ev->window);
+			}
+			start = end + 1;
 		}
-
-		ActionPerformed ap(wo, ae);
-		pekwm::actionHandler()->handleAction(&ap);
+	} else {
+		P_TRACE("received _PEKWM_CMD: " << _pekwm_cmd_buf);
+		runPekwmCmd(_pekwm_cmd_buf, ev->window);
 	}
 
 	_pekwm_cmd_buf = "";
 }
 
+/**
+ * Run single _PEKWM_CMD command on win, the client is looked up for
+ * every command as a previous command in a batch may have closed it.
+ */
+void
+WindowManager::runPekwmCmd(const std::string &cmd, Window win)
+{
+	ActionEvent ae;
+	if (! _pekwm_cmd_cache.parse(cmd, ae)) {
+		return;
+	}
+
+	PWinObj *wo = nullptr;
+	if (win != X11::getRoot()) {
+		wo = Client::findClient(win);
+	}
+
+	ActionPerformed ap(wo, ae);
+	pekwm::actionHandler()->handleAction(&ap);
+}
+
 /**
  * Receive data from XClientMessage building up the _pekwm_cmd_buf,
  * command can be split up in multiple messages due to size
@@ -1606,14 +1691,19 @@ bool
 WindowManager::recvPekwmCmd(XClientMessageEvent *ev)
 {
 	size_t last = sizeof(ev->data.b) - 1;
-	enum PekwmCmdBuf op = static_cast<enum PekwmCmdBuf>(ev->data.b[last]);
+	int flags = ev->data.b[last];
+	enum PekwmCmdBuf op =
+		static_cast<enum PekwmCmdBuf>(flags & ~PEKWM_CMD_BATCH);
 	switch (op) {
 	case PEKWM_CMD_SINGLE:
+		ev->data.b[last] = 0;
 		_pekwm_cmd_buf = ev->data.b;
+		_pekwm_cmd_batch = flags & PEKWM_CMD_BATCH;
 		return true;
 	case PEKWM_CMD_MULTI_FIRST:
 		ev->data.b[last] = 0;
 		_pekwm_cmd_buf = ev->data.b;
+		_pekwm_cmd_batch = flags & PEKWM_CMD_BATCH;
 		return false;
 	case PEKWM_CMD_MULTI_CONT:
 	case PEKWM_CMD_MULTI_END:
@@ -1627,7 +1717,9 @@ WindowManager::recvPekwmCmd(XClientMessageEvent *ev)
 		// multi-message command, continuation.
 		_pekwm_cmd_buf.append(ev->data.b,
 				      std::min(std::strlen(ev->data.b), last));
-		if (_pekwm_cmd_buf.size() > 1024) {
+		if (_pekwm_cmd_buf.size() > (_pekwm_cmd_batch
+					     ? PEKWM_CMD_BATCH_MAX_SIZE
+					     : PEKWM_CMD_MAX_SIZE)) {
 			P_DBG("maximum _PEKWM_CMD message size reached, drop");
 			_pekwm_cmd_buf = "";
 			return false;
@@ -1635,8 +1727,8 @@ WindowManager::recvPekwmCmd(XClientMessageEvent *ev)
 		return op == PEKWM_CMD_MULTI_END;
 	default:
 		// invalid data
-		P_DBG("invalid _PEKMW_CMD, last byte " << op
-		      << " not in range 0-3");
+		P_DBG("invalid _PEKMW_CMD, last byte " << flags
+		      << " not in range 0-7");
 		_pekwm_cmd_buf = "";
 		return false;
 	}
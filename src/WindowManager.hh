@@ -23,6 +23,7 @@
 #include "ManagerWindows.hh"
 
 #include "tk/Action.hh"
+#include "tk/ActionCache.hh"
 #include "tk/PWinObj.hh"
 
 #include <algorithm>
@@ -66,6 +67,7 @@ protected:
 	WindowManager(void);
 
 	void handlePekwmCmd(XClientMessageEvent *ev);
+	void runPekwmCmd(const std::string &cmd, Window win);
 	bool recvPekwmCmd(XClientMessageEvent *ev);
 
 private:
@@ -134,6 +136,10 @@ private:
 protected:
 	/** pekwm_cmd buffer for commands that do not fit in 20 bytes. */
 	std::string _pekwm_cmd_buf;
+	/** Set if _pekwm_cmd_buf holds newline separated commands. */
+	bool _pekwm_cmd_batch;
+	/** Parsed _PEKWM_CMD commands. */
+	ActionCache _pekwm_cmd_cache;
 
 private:
 	bool _shutdown; //!< Set to wheter we want to shutdown.
@@ -94,6 +94,8 @@ uint Workspaces::_previous;
 uint Workspaces::_per_row;
 std::vector<WinLayouter*> Workspaces::_layout_models;
 std::vector<PWinObj*> Workspaces::_wobjs;
+Observable *Workspaces::_frame_list = nullptr;
+FrameListObservation Workspaces::frame_list_changed;
 std::vector<Workspace> Workspaces::_workspaces;
 std::vector<Frame*> Workspaces::_mru;
 WorkspaceIndicator* Workspaces::_workspace_indicator = nullptr;
@@ -102,6 +104,7 @@ void
 Workspaces::init(void)
 {
 	_workspace_indicator = new WorkspaceIndicator();
+	_frame_list = new Observable();
 }
 
 void
@@ -109,6 +112,21 @@ Workspaces::cleanup()
 {
 	clearLayoutModels();
 	delete _workspace_indicator;
+	delete _frame_list;
+	_frame_list = nullptr;
+}
+
+/**
+ * Notify observers of the frame list that frames were added, removed
+ * or changed how they are listed.
+ */
+void
+Workspaces::frameListChanged(void)
+{
+	if (_frame_list) {
+		pekwm::observerMapping()->notifyObservers(_frame_list,
+							  &frame_list_changed);
+	}
 }
 
 //! @brief Sets total amount of workspaces to number
@@ -138,6 +156,9 @@ Workspaces::setSize(uint number)
 		_workspaces[i].setName(getWorkspaceName(i));
 	}
 
+	// workspace numbers are only listed with multiple workspaces
+	frameListChanged();
+
 	// Tell the rest of the world how many workspaces we have.
 	X11::setCardinal(X11::getRoot(), NET_NUMBER_OF_DESKTOPS,
 			 static_cast<Cardinal>(number));
@@ -14,12 +14,24 @@
 #include <string>
 
 #include "pekwm.hh"
+#include "Observable.hh"
 #include "WinLayouter.hh"
 #include "WorkspaceIndicator.hh"
 
 class PWinObj;
 class Frame;
 
+/**
+ * Observation sent when frames are added, removed or change how they
+ * are listed in menus. Carries no state, the frames are read when
+ * notified.
+ */
+class FrameListObservation : public Observation {
+public:
+	virtual ~FrameListObservation(void) { };
+	virtual bool canCoalesce(void) const { return true; }
+};
+
 class Workspace {
 public:
 	Workspace(void);
@@ -49,6 +61,11 @@ public:
 	static void init(void);
 	static void cleanup(void);
 
+	/** Observable notified with frame_list_changed. */
+	static Observable *getFrameList(void) { return _frame_list; }
+	static void frameListChanged(void);
+	static FrameListObservation frame_list_changed;
+
 	static inline iterator begin(void) { return _wobjs.begin(); }
 	static inline iterator end(void) { return _wobjs.end(); }
 	static inline reverse_iterator rbegin(void) { return _wobjs.rbegin(); }
@@ -171,6 +188,7 @@ private:
 	static WorkspaceIndicator *_workspace_indicator;
 
 	static std::vector<PWinObj*> _wobjs;
+	static Observable *_frame_list;
 	/** The most recently used frame is kept at the front. */
 	static std::vector<Frame*> _mru;
 	static std::vector<Workspace> _workspaces;
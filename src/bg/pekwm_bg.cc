@@ -7,22 +7,32 @@
 //
 
 #include "Compat.hh"
+#include "ThreadPool.hh"
 #include "Util.hh"
 #include "X11.hh"
 
 #include "../tk/ImageHandler.hh"
+#include "../tk/PTexturePlain.hh"
 #include "../tk/TextureHandler.hh"
 
+#include <algorithm>
+#include <vector>
+
 extern "C" {
 #include <errno.h>
 #include <getopt.h>
+#include <stdlib.h>
 #include <signal.h>
+#include <time.h>
 #include <unistd.h>
 }
 
 static bool _stop = false;
+static bool _benchmark = false;
 static ImageHandler* _image_handler = nullptr;
 static TextureHandler* _texture_handler = nullptr;
+/** Created on first use, threads do not survive daemon(). */
+static ThreadPool* _thread_pool = nullptr;
 
 namespace pekwm
 {
@@ -52,6 +62,8 @@ static void init(Display* dpy)
 
 static void cleanup()
 {
+	PImage::setThreadPool(nullptr);
+	delete _thread_pool;
 	delete _texture_handler;
 	delete _image_handler;
 }
@@ -59,11 +71,19 @@ static void cleanup()
 static void usage(const char* name, int ret)
 {
 	std::cout << "usage: " << name << " [-hl] texture" << std::endl;
+	std::cout << "  -b --benchmark      Print time spent setting background"
+		  << std::endl;
 	std::cout << "  -d --display dpy    Display" << std::endl;
 	std::cout << "  -D --daemon         Run in the background"
 		  << std::endl;
 	std::cout << "  -h --help           Display this information"
 		  << std::endl;
+	std::cout << "  -c --image-cache path" << std::endl
+		  << "                      Directory with decoded images"
+		  << std::endl;
+	std::cout << "  -C --image-cache-size bytes" << std::endl
+		  << "                      Maximum size of image cache"
+		  << std::endl;
 	std::cout << "  -l --load-dir path  Search path for images"
 		  << std::endl;
 	std::cout << "  -s --stop           Stop running pekwm_bg"
@@ -71,15 +91,157 @@ static void usage(const char* name, int ret)
 	exit(ret);
 }
 
+static double elapsedMs(const struct timespec &start)
+{
+	struct timespec now;
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return (now.tv_sec - start.tv_sec) * 1000.0
+		+ (now.tv_nsec - start.tv_nsec) / 1000000.0;
+}
+
+/**
+ * Image scaled to one of the head sizes, heads of the same size share
+ * the image.
+ */
+struct HeadImage {
+	HeadImage(uint width_, uint height_)
+		: width(width_),
+		  height(height_),
+		  ximage(nullptr)
+	{
+	}
+
+	uint width;
+	uint height;
+	XImage *ximage;
+};
+
+struct HeadImages {
+	PImage *image;
+	std::vector<HeadImage> images;
+};
+
+static void renderHeadImage(size_t i, void *opaque)
+{
+	HeadImages *head_images = static_cast<HeadImages*>(opaque);
+	HeadImage &head = head_images->images[i];
+	head_images->image->fillXImage(head.ximage, head.width, head.height);
+}
+
+/**
+ * Destroy the XImages allocated for the heads, skipping failed
+ * allocations.
+ */
+static void destroyHeadImages(HeadImages &head_images)
+{
+	std::vector<HeadImage>::iterator it = head_images.images.begin();
+	for (; it != head_images.images.end(); ++it) {
+		if (it->ximage != nullptr) {
+			PImage::destroyXImage(it->ximage);
+		}
+	}
+}
+
+/**
+ * Render scaled image texture on all heads, scaling and converting the
+ * image for each head size on the thread pool. X11 calls are only made
+ * from this thread, allocating the images before and uploading them
+ * once per head after the workers are done.
+ *
+ * @return false if texture is not a scaled image without alpha or
+ *         allocating the images failed.
+ */
+static bool renderScaledImage(PTexture *tex, Pixmap pix)
+{
+	if (tex->getType() != PTexture::TYPE_IMAGE) {
+		return false;
+	}
+	PImage *image = static_cast<PTextureImage*>(tex)->getImage();
+	if (image->getType() != IMAGE_TYPE_SCALED || image->useAlpha()) {
+		return false;
+	}
+
+	struct timespec start;
+	clock_gettime(CLOCK_MONOTONIC, &start);
+
+	HeadImages head_images;
+	head_images.image = image;
+	std::vector<size_t> head_image(X11::getNumHeads());
+	for (int i = 0; i < X11::getNumHeads(); i++) {
+		Geometry head = X11::getHeadGeometry(i);
+		size_t j = 0;
+		for (; j < head_images.images.size(); j++) {
+			if (head_images.images[j].width == head.width
+			    && head_images.images[j].height == head.height) {
+				break;
+			}
+		}
+		if (j == head_images.images.size()) {
+			head_images.images.push_back(HeadImage(head.width,
+							       head.height));
+			head_images.images[j].ximage =
+				PImage::allocXImage(head.width, head.height);
+		}
+		head_image[i] = j;
+	}
+
+	std::vector<HeadImage>::iterator it = head_images.images.begin();
+	for (; it != head_images.images.end(); ++it) {
+		if (it->ximage == nullptr) {
+			destroyHeadImages(head_images);
+			return false;
+		}
+	}
+
+	_thread_pool->run(head_images.images.size(), renderHeadImage,
+			  &head_images);
+	if (_benchmark) {
+		std::cout << "benchmark: scaled " << head_images.images.size()
+			  << " images using " << _thread_pool->size()
+			  << " threads in " << elapsedMs(start) << "ms"
+			  << std::endl;
+		clock_gettime(CLOCK_MONOTONIC, &start);
+	}
+
+	for (int i = 0; i < X11::getNumHeads(); i++) {
+		Geometry head = X11::getHeadGeometry(i);
+		X11::putImage(pix, X11::getGC(),
+			      head_images.images[head_image[i]].ximage,
+			      0, 0, head.x, head.y, head.width, head.height);
+	}
+	destroyHeadImages(head_images);
+	if (_benchmark) {
+		std::cout << "benchmark: uploaded " << X11::getNumHeads()
+			  << " heads in " << elapsedMs(start) << "ms"
+			  << std::endl;
+	}
+	return true;
+}
+
 static Pixmap setBackground(PTexture *tex)
 {
+	if (_thread_pool == nullptr) {
+		_thread_pool = new ThreadPool();
+		PImage::setThreadPool(_thread_pool);
+	}
+
 	Pixmap pix = X11::createPixmap(X11::getWidth(), X11::getHeight());
 
 	// render background per-head, might not suite all but leave it at
 	// that for now.
-	for (int i = 0; i < X11::getNumHeads(); i++) {
-		Geometry head = X11::getHeadGeometry(i);
-		tex->render(pix, head.x, head.y, head.width, head.height);
+	if (! renderScaledImage(tex, pix)) {
+		struct timespec start;
+		clock_gettime(CLOCK_MONOTONIC, &start);
+		for (int i = 0; i < X11::getNumHeads(); i++) {
+			Geometry head = X11::getHeadGeometry(i);
+			tex->render(pix, head.x, head.y,
+				    head.width, head.height);
+		}
+		if (_benchmark) {
+			std::cout << "benchmark: rendered "
+				  << X11::getNumHeads() << " heads in "
+				  << elapsedMs(start) << "ms" << std::endl;
+		}
 	}
 
 	X11::setCardinal(X11::getRoot(), XROOTPMAP_ID, pix, XA_PIXMAP);
@@ -92,14 +254,37 @@ static Pixmap setBackground(PTexture *tex)
 
 static Pixmap loadAndSetBackground(const std::string& tex_str)
 {
-	PTexture *tex = pekwm::textureHandler()->getTexture(tex_str);
+	// the texture is rendered once per head, scaled images do not
+	// need to be decoded larger than the largest head.
+	uint hint_width = 0, hint_height = 0;
+	for (int i = 0; i < X11::getNumHeads(); i++) {
+		Geometry head = X11::getHeadGeometry(i);
+		hint_width = std::max(hint_width, head.width);
+		hint_height = std::max(hint_height, head.height);
+	}
+
+	struct timespec start;
+	clock_gettime(CLOCK_MONOTONIC, &start);
+	PTexture *tex = pekwm::textureHandler()->getTexture(tex_str,
+							    hint_width,
+							    hint_height);
 	if (! tex) {
 		std::cerr << "Failed to load texture " << tex_str << std::endl;
 		return None;
 	}
+	if (_benchmark) {
+		std::cout << "benchmark: loaded texture in "
+			  << elapsedMs(start) << "ms" << std::endl;
+	}
 
 	std::cout << "Setting background " << tex_str << std::endl;
+	clock_gettime(CLOCK_MONOTONIC, &start);
 	Pixmap pix = setBackground(tex);
+	if (_benchmark) {
+		X11::sync(False);
+		std::cout << "benchmark: set background in "
+			  << elapsedMs(start) << "ms" << std::endl;
+	}
 	pekwm::textureHandler()->returnTexture(tex);
 	return pix;
 }
@@ -151,12 +336,19 @@ int main(int argc, char* argv[])
 	bool do_daemon = false;
 	bool stop = false;
 	std::string load_dir("./");
+	std::string image_cache;
+	size_t image_cache_size = 64 * 1024 * 1024;
 
 	static struct option opts[] = {
+		{const_cast<char*>("benchmark"), no_argument, nullptr, 'b'},
 		{const_cast<char*>("display"), required_argument, nullptr,
 		 'd'},
 		{const_cast<char*>("daemon"), no_argument, nullptr, 'D'},
 		{const_cast<char*>("help"), no_argument, nullptr, 'h'},
+		{const_cast<char*>("image-cache"), required_argument, nullptr,
+		 'c'},
+		{const_cast<char*>("image-cache-size"), required_argument,
+		 nullptr, 'C'},
 		{const_cast<char*>("load-dir"), required_argument, nullptr,
 		 'l'},
 		{const_cast<char*>("stop"), no_argument, nullptr, 's'},
@@ -164,8 +356,19 @@ int main(int argc, char* argv[])
 	};
 
 	int ch;
-	while ((ch = getopt_long(argc, argv, "d:Dhl:s", opts, nullptr)) != -1) {
+	while ((ch = getopt_long(argc, argv, "bc:C:d:Dhl:s", opts, nullptr))
+	       != -1) {
 		switch (ch) {
+		case 'b':
+			_benchmark = true;
+			break;
+		case 'c':
+			image_cache = optarg;
+			Util::expandFileName(image_cache);
+			break;
+		case 'C':
+			image_cache_size = strtoul(optarg, nullptr, 10);
+			break;
 		case 'd':
 			display = optarg;
 			break;
@@ -222,6 +425,7 @@ int main(int argc, char* argv[])
 	init(dpy);
 
 	_image_handler->path_push_back(load_dir);
+	_image_handler->setCache(image_cache, image_cache_size);
 
 	modeStop();
 	if (! stop) {
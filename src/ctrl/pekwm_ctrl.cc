@@ -29,6 +29,8 @@ typedef bool(*send_message_fun)(Window, AtomName, int, const void*, size_t,
 
 enum CtrlAction {
 	PEKWM_CTRL_ACTION_RUN,
+	PEKWM_CTRL_ACTION_BATCH,
+	PEKWM_CTRL_ACTION_DUMP,
 	PEKWM_CTRL_ACTION_FOCUS,
 	PEKWM_CTRL_ACTION_LIST,
 	PEKWM_CTRL_ACTION_UTIL,
@@ -55,8 +57,8 @@ namespace pekwm
 static void usage(const char* name, int ret)
 {
 	std::cout << "usage: " << name << " [-acdhs] [command]" << std::endl;
-	std::cout << "  -a --action [run|focus|list|util] Control action"
-		  << std::endl;
+	std::cout << "  -a --action [run|batch|dump|focus|list|util] Control "
+		  << "action" << std::endl;
 	std::cout << "  -c --client pattern Client pattern" << std::endl;
 	std::cout << "  -d --display dpy    Display" << std::endl;
 	std::cout << "  -h --help           Display this information"
@@ -69,7 +71,11 @@ static void usage(const char* name, int ret)
 
 static CtrlAction getAction(const std::string& name)
 {
-	if (name == "focus") {
+	if (name == "batch") {
+		return PEKWM_CTRL_ACTION_BATCH;
+	} else if (name == "dump") {
+		return PEKWM_CTRL_ACTION_DUMP;
+	} else if (name == "focus") {
 		return PEKWM_CTRL_ACTION_FOCUS;
 	} else if (name == "list") {
 		return PEKWM_CTRL_ACTION_LIST;
@@ -155,8 +161,13 @@ static bool focusClient(Window win)
 
 #endif // ! UNITTEST
 
+/**
+ * Send cmd as _PEKWM_CMD, split up in multiple messages if it does not
+ * fit in one. If batch is true, cmd is newline separated commands.
+ */
 static bool sendCommand(const std::string& cmd, Window win,
-			send_message_fun send_message, void *opaque)
+			send_message_fun send_message, void *opaque,
+			bool batch = false)
 {
 	XClientMessageEvent ev;
 	char buf[sizeof(ev.data.b)] = {0};
@@ -165,6 +176,10 @@ static bool sendCommand(const std::string& cmd, Window win,
 	const char *src = cmd.c_str();
 	int left = cmd.size();
 	buf[chunk_size] = static_cast<int>(cmd.size()) <= chunk_size ? 0 : 1;
+	if (batch) {
+		// PEKWM_CMD_BATCH
+		buf[chunk_size] |= 4;
+	}
 	memcpy(buf, src, std::min(left, chunk_size));
 	bool res = send_message(win, PEKWM_CMD, 8, buf, sizeof(buf), opaque);
 	src += chunk_size;
@@ -244,6 +259,82 @@ static bool actionRun(const char *argv0, int argc, char** argv, Window client)
 	return res;
 }
 
+/**
+ * Read commands from stdin, one per line, and send them as a single
+ * batch.
+ */
+static bool actionBatch(Window client)
+{
+	if (client == None) {
+		client = X11::getRoot();
+	}
+
+	std::string cmds;
+	uint num = 0;
+	std::string line;
+	while (std::getline(std::cin, line)) {
+		Util::trimLeadingBlanks(line);
+		if (line.empty()) {
+			continue;
+		}
+		if (! cmds.empty()) {
+			cmds += "\n";
+		}
+		cmds += line;
+		num++;
+	}
+
+	if (num == 0) {
+		std::cerr << "no commands given on stdin" << std::endl;
+		return false;
+	}
+	std::cout << "_PEKWM_CMD " << client << " batch of " << num
+		  << " commands";
+	bool res = sendCommand(cmds, client, sendClientMessage, nullptr,
+			       true);
+	printRes(res);
+	return res;
+}
+
+/**
+ * Request internal state dump from pekwm, the dump is written to the
+ * _PEKWM_DEBUG_DUMP property on the root window.
+ */
+static bool actionDump(const char *argv0, int argc, char** argv)
+{
+	if (argc != 1) {
+		std::cerr << "no dump name given" << std::endl;
+		usage(argv0, 1);
+	}
+
+	Window root = X11::getRoot();
+	Atom atom = X11::getAtom(PEKWM_DEBUG_DUMP);
+	X11::selectInput(root, PropertyChangeMask);
+	X11::unsetProperty(root, PEKWM_DEBUG_DUMP);
+
+	std::string cmd = std::string("Debug dump ") + argv[0] + " root";
+	if (! sendCommand(cmd, root, sendClientMessage, nullptr)) {
+		return false;
+	}
+
+	XEvent ev;
+	struct timeval timeout = {2, 0};
+	while (X11::getNextEvent(ev, &timeout)) {
+		if (ev.type == PropertyNotify
+		    && ev.xproperty.atom == atom
+		    && ev.xproperty.state == PropertyNewValue) {
+			std::string dump;
+			X11::getUtf8String(root, PEKWM_DEBUG_DUMP, dump);
+			X11::unsetProperty(root, PEKWM_DEBUG_DUMP);
+			std::cout << Charset::toSystem(dump);
+			return true;
+		}
+	}
+
+	std::cerr << "no dump received" << std::endl;
+	return false;
+}
+
 static int actionUtil(int argc, char* argv[])
 {
 	if (argc == 0) {
@@ -394,6 +485,12 @@ int main(int argc, char* argv[])
 	case PEKWM_CTRL_ACTION_RUN:
 		res = actionRun(argv[0], argc - optind, argv + optind, client);
 		break;
+	case PEKWM_CTRL_ACTION_BATCH:
+		res = actionBatch(client);
+		break;
+	case PEKWM_CTRL_ACTION_DUMP:
+		res = actionDump(argv[0], argc - optind, argv + optind);
+		break;
 	case PEKWM_CTRL_ACTION_FOCUS:
 		std::cout << "_NET_ACTIVE_WINDOW " << client;
 		res = focusClient(client);
@@ -10,8 +10,10 @@
 #include "Types.hh"
 #include "Debug.hh"
 
+#include <cctype>
 #include <cstdlib>
 #include <cstring>
+#include <cwctype>
 #include <iomanip>
 #include <stdexcept>
 
@@ -78,17 +80,17 @@ utf8_to_wchar(const char *utf8, wchar_t &wc)
 	if (len == 1) {
 		wc = utf8[0];
 	} else if (len == 2) {
-		wc = ((utf8[0] & 0x3f) << 6)
+		wc = ((utf8[0] & 0x1f) << 6)
 			| (utf8[1] & 0x3f);
 	} else if (len == 3) {
-		wc = ((utf8[0] & 0x3f) << 12)
+		wc = ((utf8[0] & 0x0f) << 12)
 			| ((utf8[1] & 0x3f) << 6)
 			| (utf8[2] & 0x3f);
 	} else if (len == 4) {
-		wc = ((utf8[0] & 0x3f) << 18)
+		wc = ((utf8[0] & 0x07) << 18)
 			| ((utf8[1] & 0x3f) << 12)
-			| ((utf8[1] & 0x3f) << 6)
-			| (utf8[2] & 0x3f);
+			| ((utf8[2] & 0x3f) << 6)
+			| (utf8[3] & 0x3f);
 	} else {
 		// 5 and 6 character sequences are invalid.
 		len = 0;
@@ -331,4 +333,45 @@ namespace Charset
 
 		return str_utf8;
 	}
+
+	/**
+	 * Lower case UTF-8 str using towlower of the current locale,
+	 * invalid and truncated sequences are left untouched.
+	 */
+	std::string toLower(const std::string &str)
+	{
+		char utf8[UTF8_MAX_BYTES];
+		std::string lower;
+		lower.reserve(str.size());
+
+		for (size_t pos = 0; pos < str.size(); ) {
+			uint8_t chr = str[pos];
+			if (chr < 0x80) {
+				lower += std::tolower(chr);
+				pos++;
+				continue;
+			}
+
+			wchar_t wc;
+			uint8_t len = UTF8_BYTES[chr];
+			if (len < 2 || len > UTF8_MAX_BYTES
+			    || (pos + len) > str.size()
+			    || utf8_to_wchar(str.c_str() + pos, wc) != len) {
+				lower += str[pos];
+				pos++;
+				continue;
+			}
+
+			uint8_t lower_len = wchar_to_utf8(std::towlower(wc),
+							  utf8);
+			if (lower_len) {
+				lower.append(utf8, lower_len);
+			} else {
+				lower.append(str, pos, len);
+			}
+			pos += len;
+		}
+
+		return lower;
+	}
 }
@@ -64,6 +64,8 @@ namespace Charset
 
 	std::string toSystem(const std::string &str);
 	std::string fromSystem(const std::string &str);
+
+	std::string toLower(const std::string &str);
 }
 
 #endif // _PEKWM_CHARSET_HH_
@@ -9,9 +9,12 @@
 
 #include "Debug.hh"
 #include "Util.hh"
+#include "Trace.hh"
+#include "X11Stats.hh"
 
 #include <cstdlib>
 #include <ctime>
+#include <map>
 
 static Util::StringTo<Debug::Level> debug_level_map[] = {
 	{"ERROR", Debug::LEVEL_ERR},
@@ -22,7 +25,10 @@ static Util::StringTo<Debug::Level> debug_level_map[] = {
 	{nullptr, Debug::LEVEL_WARN}
 };
 
+typedef std::map<std::string, std::pair<Debug::DumpFun, void*> > dump_map;
+
 static Debug::Level _level = Debug::LEVEL_WARN;
+static dump_map _dumps;
 static bool _use_cerr = true;
 std::ofstream _log("/dev/null");
 
@@ -123,6 +129,10 @@ namespace Debug
 	 *
 	 * logfile <filename> - set log file, use - for stderr.
 	 * level [err|warn|info|debug|trace] - sets log level.
+	 * dump <name> - write internal state of name to the log.
+	 * trace [on|off|reset] - control event tracing.
+	 * tracefile <filename> - save binary trace records to file.
+	 * x11 [on|off|reset] - control counting of X11 requests.
 	 */
 	void
 	doAction(const std::string &cmd)
@@ -142,6 +152,59 @@ namespace Debug
 			}
 		} else if (args[0] == "level") {
 			_level = getLevel(args[1]);
+		} else if (args[0] == "trace") {
+			if (args[1] == "reset") {
+				Trace::reset();
+			} else {
+				Trace::setEnabled(Util::isTrue(args[1])
+						  || args[1] == "on");
+			}
+		} else if (args[0] == "tracefile") {
+			if (! Trace::save(args[1])) {
+				P_WARN("failed to save trace to " << args[1]);
+			}
+		} else if (args[0] == "x11") {
+			if (args[1] == "reset") {
+				X11Stats::reset();
+			} else {
+				X11Stats::setEnabled(Util::isTrue(args[1])
+						     || args[1] == "on");
+			}
+		} else if (args[0] == "dump") {
+			std::ostream &os = getStream("");
+			if (! dump(args[1], os)) {
+				os << "no dump named " << args[1] << std::endl;
+			}
+		}
+	}
+
+	/**
+	 * Register dump function, available as the dump debug command.
+	 */
+	void
+	addDump(const std::string& name, DumpFun fun, void *opaque)
+	{
+		_dumps[name] = std::pair<DumpFun, void*>(fun, opaque);
+	}
+
+	void
+	removeDump(const std::string& name)
+	{
+		_dumps.erase(name);
+	}
+
+	/**
+	 * Write dump name to os, returns false if no such dump is
+	 * registered.
+	 */
+	bool
+	dump(const std::string& name, std::ostream& os)
+	{
+		dump_map::iterator it = _dumps.find(name);
+		if (it == _dumps.end()) {
+			return false;
 		}
+		it->second.first(os, it->second.second);
+		return true;
 	}
 }
@@ -36,6 +36,12 @@ namespace Debug
 
 	void doAction(const std::string& action);
 
+	/** Function writing internal state of opaque to os. */
+	typedef void (*DumpFun)(std::ostream& os, void *opaque);
+	void addDump(const std::string& name, DumpFun fun, void *opaque);
+	void removeDump(const std::string& name);
+	bool dump(const std::string& name, std::ostream& os);
+
 	std::ostream& getStream(const char* prefix);
 	std::ostream& getStream(const char* file, int line, const char* prefix);
 	bool setLogFile(const std::string& path);
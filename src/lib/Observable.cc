@@ -25,42 +25,156 @@ Observer::~Observer(void)
 }
 
 ObserverMapping::ObserverMapping(void)
+	: _slots(new Slot[INITIAL_CAPACITY]),
+	  _capacity(INITIAL_CAPACITY),
+	  _size(0),
+	  _deferred(false)
 {
+	for (size_t i = 0; i < _capacity; i++) {
+		_slots[i].observable = nullptr;
+	}
 }
 
 ObserverMapping::~ObserverMapping(void)
 {
+	for (size_t i = 0; i < _capacity; i++) {
+		if (_slots[i].observable != nullptr) {
+			delete _slots[i].more;
+		}
+	}
+	delete [] _slots;
+}
+
+/**
+ * Enable/disable deferred notifications. When enabled, notifications
+ * without an observation or with an observation that can be coalesced
+ * are queued until flush is called, merging notifications of the same
+ * observation type for each observable. Disabling deferred mode flushes
+ * the queue.
+ */
+void
+ObserverMapping::setDeferred(bool deferred)
+{
+	_deferred = deferred;
+	if (! _deferred) {
+		flush();
+	}
+}
+
+/**
+ * Deliver all queued notifications in the order they were first
+ * queued. Notifications queued by observers while flushing are
+ * delivered before returning.
+ */
+void
+ObserverMapping::flush(void)
+{
+	while (! _queue.empty()) {
+		std::vector<Notification> queue;
+		queue.swap(_queue);
+
+		std::vector<Notification>::iterator it = queue.begin();
+		for (; it != queue.end(); ++it) {
+			notifyObserversNow(it->observable, it->observation);
+		}
+	}
 }
 
 /**
- * Notify all observers.
+ * Notify all observers, in deferred mode notifications that can be
+ * coalesced are queued until flush.
  */
 void
 ObserverMapping::notifyObservers(Observable *observable,
 				 Observation *observation)
 {
-	observable_map_it oit = _observable_map.find(observable);
-	if (oit != _observable_map.end()) {
-		std::vector<Observer*>::iterator it = oit->second.begin();
-		for (; it != oit->second.end(); ++it) {
-			(*it)->notify(observable, observation);
+	if (_deferred
+	    && (observation == nullptr || observation->canCoalesce())) {
+		queueNotification(observable, observation);
+	} else {
+		notifyObserversNow(observable, observation);
+	}
+}
+
+void
+ObserverMapping::notifyObserversNow(Observable *observable,
+				    Observation *observation)
+{
+	Slot *slot = find(observable);
+	if (slot == nullptr) {
+		return;
+	}
+
+	// observers are copied before being notified as observers can be
+	// added and removed while notifying, moving the slot. Observers
+	// removed while notifying are skipped.
+	Observer *stack_observers[8];
+	std::vector<Observer*> heap_observers;
+	Observer **observers = stack_observers;
+	size_t num = slot->num;
+	if (num > sizeof(stack_observers) / sizeof(stack_observers[0])) {
+		heap_observers.resize(num);
+		observers = &heap_observers[0];
+	}
+	for (size_t i = 0; i < num; i++) {
+		observers[i] = slot->get(i);
+	}
+
+	for (size_t i = 0; i < num; i++) {
+		if (i > 0) {
+			slot = find(observable);
+			if (slot == nullptr) {
+				break;
+			}
+			if (! slot->contains(observers[i])) {
+				continue;
+			}
 		}
+		observers[i]->notify(observable, observation);
 	}
 }
 
+/**
+ * Queue notification unless a notification with the same observable and
+ * observation type is already queued.
+ */
+void
+ObserverMapping::queueNotification(Observable *observable,
+				   Observation *observation)
+{
+	if (find(observable) == nullptr) {
+		return;
+	}
+
+	std::vector<Notification>::iterator it = _queue.begin();
+	for (; it != _queue.end(); ++it) {
+		if (it->observable != observable) {
+			continue;
+		}
+		if (it->observation == nullptr || observation == nullptr) {
+			if (it->observation == observation) {
+				return;
+			}
+		} else if (typeid(*it->observation) == typeid(*observation)) {
+			return;
+		}
+	}
+
+	Notification notification = { observable, observation };
+	_queue.push_back(notification);
+}
+
 /**
  * Add observer.
  */
 void
 ObserverMapping::addObserver(Observable *observable, Observer *observer)
 {
-	observable_map_it it = _observable_map.find(observable);
-	if (it == _observable_map.end()) {
-		_observable_map[observable] = std::vector<Observer*>();
-		_observable_map[observable].push_back(observer);
-	} else {
-		it->second.push_back(observer);
+	Slot *slot = find(observable);
+	if (slot == nullptr) {
+		slot = insert(observable);
 	}
+	slot->push(observer);
 }
 
 /**
@@ -69,17 +183,15 @@ ObserverMapping::addObserver(Observable *observable, Observer *observer)
 void
 ObserverMapping::removeObserver(Observable *observable, Observer *observer)
 {
-	observable_map_it it = _observable_map.find(observable);
-	if (it == _observable_map.end()) {
+	Slot *slot = find(observable);
+	if (slot == nullptr) {
 		P_ERR("stale observable " << observable);
 		return;
 	}
 
-	it->second.erase(std::remove(it->second.begin(),
-				     it->second.end(), observer),
-			 it->second.end());
-	if (it->second.empty()) {
-		_observable_map.erase(it);
+	slot->remove(observer);
+	if (slot->num == 0) {
+		erase(slot);
 	}
 }
 
@@ -89,8 +201,173 @@ ObserverMapping::removeObserver(Observable *observable, Observer *observer)
 void
 ObserverMapping::removeObservable(Observable *observable)
 {
-	observable_map_it it = _observable_map.find(observable);
-	if (it != _observable_map.end()) {
-		_observable_map.erase(it);
+	Slot *slot = find(observable);
+	if (slot != nullptr) {
+		erase(slot);
+	}
+
+	std::vector<Notification>::iterator qit = _queue.begin();
+	while (qit != _queue.end()) {
+		if (qit->observable == observable) {
+			qit = _queue.erase(qit);
+		} else {
+			++qit;
+		}
+	}
+}
+
+size_t
+ObserverMapping::hash(Observable *observable) const
+{
+	// mix the bits of the address, the lower bits are mostly zero
+	// due to alignment.
+	ulong val = reinterpret_cast<ulong>(observable);
+	val ^= val >> 17;
+	val *= 0x9e3779b9UL;
+	val ^= val >> 15;
+	return static_cast<size_t>(val) & (_capacity - 1);
+}
+
+ObserverMapping::Slot*
+ObserverMapping::find(Observable *observable) const
+{
+	size_t i = hash(observable);
+	while (_slots[i].observable != nullptr) {
+		if (_slots[i].observable == observable) {
+			return _slots + i;
+		}
+		i = (i + 1) & (_capacity - 1);
+	}
+	return nullptr;
+}
+
+/**
+ * Insert observable, without observers, in the table. The observable
+ * must not already be in the table.
+ */
+ObserverMapping::Slot*
+ObserverMapping::insert(Observable *observable)
+{
+	if ((_size + 1) * 4 > _capacity * 3) {
+		grow();
+	}
+
+	size_t i = hash(observable);
+	while (_slots[i].observable != nullptr) {
+		i = (i + 1) & (_capacity - 1);
+	}
+
+	_slots[i].observable = observable;
+	_slots[i].num = 0;
+	_slots[i].more = nullptr;
+	_size++;
+	return _slots + i;
+}
+
+/**
+ * Remove slot from the table, shifting back following entries in the
+ * probe sequence instead of leaving a tombstone.
+ */
+void
+ObserverMapping::erase(Slot *slot)
+{
+	delete slot->more;
+
+	size_t mask = _capacity - 1;
+	size_t i = slot - _slots;
+	size_t j = i;
+	for (;;) {
+		j = (j + 1) & mask;
+		if (_slots[j].observable == nullptr) {
+			break;
+		}
+
+		// entry at j can fill the hole at i unless its home
+		// position is cyclically in (i, j]
+		size_t k = hash(_slots[j].observable);
+		bool in_range = i <= j ? (i < k && k <= j) : (i < k || k <= j);
+		if (! in_range) {
+			_slots[i] = _slots[j];
+			i = j;
+		}
+	}
+
+	_slots[i].observable = nullptr;
+	_size--;
+}
+
+void
+ObserverMapping::grow(void)
+{
+	Slot *old_slots = _slots;
+	size_t old_capacity = _capacity;
+
+	_capacity *= 2;
+	_slots = new Slot[_capacity];
+	for (size_t i = 0; i < _capacity; i++) {
+		_slots[i].observable = nullptr;
+	}
+
+	for (size_t i = 0; i < old_capacity; i++) {
+		if (old_slots[i].observable == nullptr) {
+			continue;
+		}
+		size_t j = hash(old_slots[i].observable);
+		while (_slots[j].observable != nullptr) {
+			j = (j + 1) & (_capacity - 1);
+		}
+		_slots[j] = old_slots[i];
+	}
+	delete [] old_slots;
+}
+
+bool
+ObserverMapping::Slot::contains(Observer *observer) const
+{
+	for (size_t i = 0; i < num; i++) {
+		if (get(i) == observer) {
+			return true;
+		}
+	}
+	return false;
+}
+
+void
+ObserverMapping::Slot::push(Observer *observer)
+{
+	if (num < INLINE_OBSERVERS) {
+		observers[num] = observer;
+	} else {
+		if (more == nullptr) {
+			more = new std::vector<Observer*>();
+		}
+		more->push_back(observer);
+	}
+	num++;
+}
+
+/**
+ * Remove all occurrences of observer, keeping the order of the
+ * remaining observers.
+ */
+void
+ObserverMapping::Slot::remove(Observer *observer)
+{
+	size_t w = 0;
+	for (size_t i = 0; i < num; i++) {
+		Observer *o = get(i);
+		if (o != observer) {
+			set(w++, o);
+		}
+	}
+	num = w;
+
+	if (more != nullptr) {
+		if (num <= INLINE_OBSERVERS) {
+			delete more;
+			more = nullptr;
+		} else {
+			more->resize(num - INLINE_OBSERVERS);
+		}
 	}
 }
@@ -10,7 +10,7 @@
 #define _PEKWM_OBSERVABLE_HH_
 
 #include <cstdlib>
-#include <map>
+#include <typeinfo>
 #include <vector>
 
 /**
@@ -19,6 +19,14 @@
 class Observation {
 public:
 	virtual ~Observation(void);
+
+	/**
+	 * Return true if the observation carries no state of its own,
+	 * making it possible to merge it with other observations of the
+	 * same type when notifications are deferred. Observations
+	 * returning true must outlive the notification queue.
+	 */
+	virtual bool canCoalesce(void) const { return false; }
 };
 
 /**
@@ -38,15 +46,24 @@ public:
 	virtual void notify(Observable*, Observation*) = 0;
 };
 
+/**
+ * Mapping from Observable to the Observers observing it.
+ *
+ * Observables are stored in an open addressing hash table, using linear
+ * probing, with the first observers stored inline in the table avoiding
+ * allocations for the common case of few observers per observable.
+ */
 class ObserverMapping {
 public:
-	typedef std::map<Observable*, std::vector<Observer*> > observable_map;
-	typedef observable_map::iterator observable_map_it;
-
 	ObserverMapping(void);
 	~ObserverMapping(void);
 
-	size_t size(void) const { return _observable_map.size(); }
+	size_t size(void) const { return _size; }
+
+	bool isDeferred(void) const { return _deferred; }
+	void setDeferred(bool deferred);
+	size_t queueSize(void) const { return _queue.size(); }
+	void flush(void);
 
 	void notifyObservers(Observable *observable, Observation *observation);
 	void addObserver(Observable *observable, Observer *observer);
@@ -55,8 +72,70 @@ public:
 	void removeObservable(Observable *observable);
 
 private:
-	/** Map from Observable to list of observers. */
-	observable_map _observable_map;
+	ObserverMapping(const ObserverMapping&);
+	ObserverMapping& operator=(const ObserverMapping&);
+
+	/** Number of observers stored in the table slot. */
+	static const size_t INLINE_OBSERVERS = 3;
+	/** Initial number of slots in the table, must be a power of 2. */
+	static const size_t INITIAL_CAPACITY = 64;
+
+	/**
+	 * Table slot, observers beyond INLINE_OBSERVERS are stored in
+	 * more.
+	 */
+	struct Slot {
+		Observable *observable;
+		size_t num;
+		Observer *observers[INLINE_OBSERVERS];
+		std::vector<Observer*> *more;
+
+		Observer *get(size_t i) const {
+			return i < INLINE_OBSERVERS
+				? observers[i] : (*more)[i - INLINE_OBSERVERS];
+		}
+		void set(size_t i, Observer *observer) {
+			if (i < INLINE_OBSERVERS) {
+				observers[i] = observer;
+			} else {
+				(*more)[i - INLINE_OBSERVERS] = observer;
+			}
+		}
+		bool contains(Observer *observer) const;
+		void push(Observer *observer);
+		void remove(Observer *observer);
+	};
+
+	/**
+	 * Queued notification, waiting for flush.
+	 */
+	struct Notification {
+		Observable *observable;
+		Observation *observation;
+	};
+
+	size_t hash(Observable *observable) const;
+	Slot *find(Observable *observable) const;
+	Slot *insert(Observable *observable);
+	void erase(Slot *slot);
+	void grow(void);
+
+	void notifyObserversNow(Observable *observable,
+				Observation *observation);
+	void queueNotification(Observable *observable,
+			       Observation *observation);
+
+	/** Hash table slots, _capacity entries. */
+	Slot *_slots;
+	/** Number of slots, always a power of 2. */
+	size_t _capacity;
+	/** Number of observables in the table. */
+	size_t _size;
+
+	/** If true, coalescable notifications are queued until flush. */
+	bool _deferred;
+	/** Notifications queued in deferred mode, in notification order. */
+	std::vector<Notification> _queue;
 };
 
 namespace pekwm
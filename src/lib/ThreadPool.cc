@@ -0,0 +1,183 @@
+//
+// ThreadPool.cc for pekwm
+// Copyright (C) 2023 Claes Nästén <pekdon@gmail.com>
+//
+// This program is licensed under the GNU GPL.
+// See the LICENSE file for more information.
+//
+
+#include "Compat.hh"
+#include "Debug.hh"
+#include "ThreadPool.hh"
+
+extern "C" {
+#include <signal.h>
+#include <unistd.h>
+}
+
+/**
+ * Create thread pool with threads number of threads, including the
+ * thread calling run. 0 uses one thread per online CPU.
+ */
+ThreadPool::ThreadPool(uint threads)
+	: _size(threads ? threads : getNumCPUs())
+#ifdef PEKWM_HAVE_THREADS
+	  , _fn(nullptr),
+	  _opaque(nullptr),
+	  _num(0),
+	  _next(0),
+	  _done(0),
+	  _stop(false)
+#endif // PEKWM_HAVE_THREADS
+{
+#ifdef PEKWM_HAVE_THREADS
+	pthread_mutex_init(&_mutex, nullptr);
+	pthread_cond_init(&_cond_work, nullptr);
+	pthread_cond_init(&_cond_done, nullptr);
+
+	// workers inherit the signal mask, keep signals on the calling
+	// thread so that handlers interrupt its event loop.
+	sigset_t all, orig;
+	sigfillset(&all);
+	pthread_sigmask(SIG_SETMASK, &all, &orig);
+
+	// the calling thread runs jobs as well
+	for (uint i = 1; i < _size; i++) {
+		pthread_t thread;
+		if (pthread_create(&thread, nullptr, worker, this)) {
+			P_WARN("failed to create worker thread " << i);
+			break;
+		}
+		_threads.push_back(thread);
+	}
+	pthread_sigmask(SIG_SETMASK, &orig, nullptr);
+	_size = _threads.size() + 1;
+#else // ! PEKWM_HAVE_THREADS
+	_size = 1;
+#endif // PEKWM_HAVE_THREADS
+}
+
+ThreadPool::~ThreadPool(void)
+{
+#ifdef PEKWM_HAVE_THREADS
+	pthread_mutex_lock(&_mutex);
+	_stop = true;
+	pthread_cond_broadcast(&_cond_work);
+	pthread_mutex_unlock(&_mutex);
+
+	std::vector<pthread_t>::iterator it = _threads.begin();
+	for (; it != _threads.end(); ++it) {
+		pthread_join(*it, nullptr);
+	}
+
+	pthread_cond_destroy(&_cond_done);
+	pthread_cond_destroy(&_cond_work);
+	pthread_mutex_destroy(&_mutex);
+#endif // PEKWM_HAVE_THREADS
+}
+
+/**
+ * Run fn for every index in 0 to num - 1 and wait for all jobs to
+ * complete. Jobs are started in index order but may complete in any
+ * order.
+ *
+ * Calling run from a job, or while another thread is running jobs,
+ * runs the jobs in the calling thread.
+ */
+void
+ThreadPool::run(size_t num, Fn fn, void *opaque)
+{
+#ifdef PEKWM_HAVE_THREADS
+	if (_threads.empty() || num < 2) {
+		runInline(num, fn, opaque);
+		return;
+	}
+
+	pthread_mutex_lock(&_mutex);
+	if (_num) {
+		pthread_mutex_unlock(&_mutex);
+		runInline(num, fn, opaque);
+		return;
+	}
+
+	_fn = fn;
+	_opaque = opaque;
+	_num = num;
+	_next = 0;
+	_done = 0;
+	pthread_cond_broadcast(&_cond_work);
+
+	runJobs();
+	while (_done < _num) {
+		pthread_cond_wait(&_cond_done, &_mutex);
+	}
+	_num = 0;
+	pthread_mutex_unlock(&_mutex);
+#else // ! PEKWM_HAVE_THREADS
+	runInline(num, fn, opaque);
+#endif // PEKWM_HAVE_THREADS
+}
+
+void
+ThreadPool::runInline(size_t num, Fn fn, void *opaque)
+{
+	for (size_t i = 0; i < num; i++) {
+		fn(i, opaque);
+	}
+}
+
+/**
+ * Get number of online CPUs, 1 if unknown.
+ */
+uint
+ThreadPool::getNumCPUs(void)
+{
+#ifdef _SC_NPROCESSORS_ONLN
+	long num = sysconf(_SC_NPROCESSORS_ONLN);
+	if (num > 0) {
+		return num;
+	}
+#endif // _SC_NPROCESSORS_ONLN
+	return 1;
+}
+
+#ifdef PEKWM_HAVE_THREADS
+
+void*
+ThreadPool::worker(void *opaque)
+{
+	ThreadPool *pool = static_cast<ThreadPool*>(opaque);
+	pthread_mutex_lock(&pool->_mutex);
+	while (! pool->_stop) {
+		if (pool->_next < pool->_num) {
+			pool->runJobs();
+		} else {
+			pthread_cond_wait(&pool->_cond_work, &pool->_mutex);
+		}
+	}
+	pthread_mutex_unlock(&pool->_mutex);
+	return nullptr;
+}
+
+/**
+ * Run jobs until no jobs are left to start, called with _mutex locked.
+ */
+void
+ThreadPool::runJobs(void)
+{
+	while (_next < _num) {
+		size_t index = _next++;
+		Fn fn = _fn;
+		void *opaque = _opaque;
+
+		pthread_mutex_unlock(&_mutex);
+		fn(index, opaque);
+		pthread_mutex_lock(&_mutex);
+
+		if (++_done == _num) {
+			pthread_cond_broadcast(&_cond_done);
+		}
+	}
+}
+
+#endif // PEKWM_HAVE_THREADS
@@ -0,0 +1,77 @@
+//
+// ThreadPool.hh for pekwm
+// Copyright (C) 2023 Claes Nästén <pekdon@gmail.com>
+//
+// This program is licensed under the GNU GPL.
+// See the LICENSE file for more information.
+//
+
+#ifndef _PEKWM_THREAD_POOL_HH_
+#define _PEKWM_THREAD_POOL_HH_
+
+#include "config.h"
+
+#include "Types.hh"
+
+#include <vector>
+
+#ifdef PEKWM_HAVE_THREADS
+extern "C" {
+#include <pthread.h>
+}
+#endif // PEKWM_HAVE_THREADS
+
+/**
+ * Fixed set of worker threads running independent jobs, used for CPU
+ * bound work such as scaling and converting images.
+ *
+ * Jobs must not do any X11 calls, Xlib is not initialized for use from
+ * multiple threads. Without thread support jobs are run in the calling
+ * thread.
+ */
+class ThreadPool {
+public:
+	/** Job function, called once for every index in 0 to num - 1. */
+	typedef void (*Fn)(size_t index, void *opaque);
+
+	ThreadPool(uint threads = 0);
+	~ThreadPool(void);
+
+	/** Number of threads running jobs, including the calling thread. */
+	uint size(void) const { return _size; }
+
+	void run(size_t num, Fn fn, void *opaque);
+
+	static uint getNumCPUs(void);
+
+private:
+	ThreadPool(const ThreadPool&);
+	ThreadPool& operator=(const ThreadPool&);
+
+	static void runInline(size_t num, Fn fn, void *opaque);
+
+	uint _size;
+
+#ifdef PEKWM_HAVE_THREADS
+	static void *worker(void *opaque);
+	void runJobs(void);
+
+	std::vector<pthread_t> _threads;
+	pthread_mutex_t _mutex;
+	/** Signaled when new jobs are available or on stop. */
+	pthread_cond_t _cond_work;
+	/** Signaled when the last job of a run has completed. */
+	pthread_cond_t _cond_done;
+
+	Fn _fn;
+	void *_opaque;
+	size_t _num;
+	/** Next job index to start. */
+	size_t _next;
+	/** Number of completed jobs. */
+	size_t _done;
+	bool _stop;
+#endif // PEKWM_HAVE_THREADS
+};
+
+#endif // _PEKWM_THREAD_POOL_HH_
@@ -0,0 +1,365 @@
+//
+// Trace.cc for pekwm
+// Copyright (C) 2023 Claes Nästén <pekdon@gmail.com>
+//
+// This program is licensed under the GNU GPL.
+// See the LICENSE file for more information.
+//
+
+#include "Compat.hh"
+#include "Trace.hh"
+
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+
+extern "C" {
+#include <X11/X.h>
+}
+
+namespace Trace
+{
+	static bool _enabled = true;
+	static Record _ring[RING_SIZE];
+	/** Total number of records, next record index modulo RING_SIZE. */
+	static ulong _ring_count = 0;
+	static uint _histogram[KIND_NO][TYPE_MAX][BUCKETS];
+	static uint64_t _max_ns[KIND_NO][TYPE_MAX];
+	static double _sum_ns[KIND_NO][TYPE_MAX];
+	/** Innermost Scope, KIND_NO outside of scopes. */
+	static Kind _scope_kind = KIND_NO;
+	static uint _scope_type = 0;
+
+	static const char *_kind_names[] = {
+		"event", "dispatch", "action", "render"
+	};
+	static const char *_render_names[] = {
+		"title", "buttons", "border"
+	};
+	static const char *_event_names[] = {
+		nullptr, nullptr, "KeyPress", "KeyRelease", "ButtonPress",
+		"ButtonRelease", "MotionNotify", "EnterNotify",
+		"LeaveNotify", "FocusIn", "FocusOut", "KeymapNotify",
+		"Expose", "GraphicsExpose", "NoExpose", "VisibilityNotify",
+		"CreateNotify", "DestroyNotify", "UnmapNotify", "MapNotify",
+		"MapRequest", "ReparentNotify", "ConfigureNotify",
+		"ConfigureRequest", "GravityNotify", "ResizeRequest",
+		"CirculateNotify", "CirculateRequest", "PropertyNotify",
+		"SelectionClear", "SelectionRequest", "SelectionNotify",
+		"ColormapNotify", "ClientMessage", "MappingNotify",
+		"GenericEvent"
+	};
+
+	static uint
+	getBucketNum(uint64_t duration_ns)
+	{
+		uint64_t us = duration_ns / 1000;
+		uint bucket = 0;
+		for (; us && bucket < (BUCKETS - 1); us >>= 1) {
+			bucket++;
+		}
+		return bucket;
+	}
+
+	static std::string
+	getTypeName(uint kind, uint type)
+	{
+		if (kind == KIND_RENDER && type <= RENDER_BORDER) {
+			return _render_names[type];
+		} else if ((kind == KIND_EVENT || kind == KIND_DISPATCH)
+			   && type < LASTEvent && _event_names[type]) {
+			return _event_names[type];
+		}
+
+		std::ostringstream name;
+		name << type;
+		return name.str();
+	}
+
+	std::string
+	getEventName(uint type)
+	{
+		return getTypeName(KIND_EVENT, type);
+	}
+
+	/**
+	 * Get name of scope, kind and type separated by a colon.
+	 */
+	std::string
+	getScopeName(Kind kind, uint type)
+	{
+		if (kind >= KIND_NO) {
+			return "none";
+		}
+		return std::string(_kind_names[kind]) + ":"
+			+ getTypeName(kind, type);
+	}
+
+	Kind
+	getScopeKind(void)
+	{
+		return _scope_kind;
+	}
+
+	uint
+	getScopeType(void)
+	{
+		return _scope_type;
+	}
+
+	void
+	setScope(Kind kind, uint type)
+	{
+		_scope_kind = kind;
+		_scope_type = type;
+	}
+
+	bool
+	isEnabled(void)
+	{
+		return _enabled;
+	}
+
+	void
+	setEnabled(bool enabled)
+	{
+		_enabled = enabled;
+	}
+
+	/**
+	 * Clear ring buffer and histograms.
+	 */
+	void
+	reset(void)
+	{
+		_ring_count = 0;
+		memset(_histogram, 0, sizeof(_histogram));
+		memset(_max_ns, 0, sizeof(_max_ns));
+		memset(_sum_ns, 0, sizeof(_sum_ns));
+	}
+
+	void
+	now(struct timespec &ts)
+	{
+		clock_gettime(CLOCK_MONOTONIC, &ts);
+	}
+
+	/**
+	 * Record trace of kind and type that started at start and ends
+	 * now.
+	 */
+	void
+	record(Kind kind, uint type, const struct timespec &start)
+	{
+		struct timespec end;
+		now(end);
+
+		int64_t duration = static_cast<int64_t>(end.tv_sec
+						       - start.tv_sec)
+			* 1000000000 + (end.tv_nsec - start.tv_nsec);
+		uint64_t duration_ns = duration > 0 ? duration : 0;
+		if (type >= TYPE_MAX) {
+			type = TYPE_MAX - 1;
+		}
+
+		Record &rec = _ring[_ring_count++ % RING_SIZE];
+		rec.sec = start.tv_sec;
+		rec.nsec = start.tv_nsec;
+		rec.duration_ns = duration_ns;
+		rec.kind = kind;
+		rec.type = type;
+
+		_histogram[kind][type][getBucketNum(duration_ns)]++;
+		_sum_ns[kind][type] += duration_ns;
+		if (duration_ns > _max_ns[kind][type]) {
+			_max_ns[kind][type] = duration_ns;
+		}
+	}
+
+	EventQueue::EventQueue(void)
+		: _queued(0)
+	{
+	}
+
+	void
+	EventQueue::reset(void)
+	{
+		_queued = 0;
+		_batches.clear();
+	}
+
+	/**
+	 * Update with the number of events currently in the queue,
+	 * events added since the last update were read at read. Events
+	 * taken from the queue without pop, such as when compressing
+	 * events, are dropped oldest first.
+	 */
+	void
+	EventQueue::update(uint queued, const struct timespec &read)
+	{
+		for (; _queued > queued; _queued--) {
+			if (--_batches.front().count == 0) {
+				_batches.pop_front();
+			}
+		}
+
+		if (queued > _queued) {
+			Batch batch;
+			batch.count = queued - _queued;
+			batch.read = read;
+			_batches.push_back(batch);
+			_queued = queued;
+		}
+	}
+
+	/**
+	 * Take the oldest event from the queue, setting read to the time
+	 * it was read. Events not seen by update are read now.
+	 */
+	void
+	EventQueue::pop(struct timespec &read)
+	{
+		if (_batches.empty()) {
+			now(read);
+			return;
+		}
+
+		read = _batches.front().read;
+		if (--_batches.front().count == 0) {
+			_batches.pop_front();
+		}
+		_queued--;
+	}
+
+	/**
+	 * Number of records available in the ring buffer.
+	 */
+	uint
+	size(void)
+	{
+		return _ring_count < RING_SIZE ? _ring_count : RING_SIZE;
+	}
+
+	/**
+	 * Get record num, 0 being the oldest record in the ring buffer.
+	 */
+	bool
+	getRecord(uint num, Record &record)
+	{
+		if (num >= size()) {
+			return false;
+		}
+		record = _ring[(_ring_count - size() + num) % RING_SIZE];
+		return true;
+	}
+
+	uint
+	getCount(Kind kind, uint type)
+	{
+		uint count = 0;
+		for (uint i = 0; i < BUCKETS; i++) {
+			count += _histogram[kind][type][i];
+		}
+		return count;
+	}
+
+	/**
+	 * Get number of records in bucket, bucket 0 holds durations
+	 * below 1us and bucket n durations from 2^(n-1) up to 2^n us.
+	 */
+	uint
+	getBucket(Kind kind, uint type, uint bucket)
+	{
+		return _histogram[kind][type][bucket];
+	}
+
+	/**
+	 * Get upper bound, in microseconds, of the bucket holding the
+	 * given percentile.
+	 */
+	uint
+	getPercentile(Kind kind, uint type, uint percentile)
+	{
+		uint count = getCount(kind, type);
+		if (count == 0) {
+			return 0;
+		}
+
+		uint limit = (count * percentile + 99) / 100;
+		uint sum = 0;
+		for (uint i = 0; i < BUCKETS; i++) {
+			sum += _histogram[kind][type][i];
+			if (sum >= limit) {
+				return 1 << i;
+			}
+		}
+		return 1 << (BUCKETS - 1);
+	}
+
+	/**
+	 * Save records in the ring buffer, oldest first, to path in
+	 * binary form prefixed with a header containing the record size.
+	 */
+	bool
+	save(const std::string &path)
+	{
+		std::ofstream ofs(path.c_str(), std::ios::binary);
+		if (! ofs.good()) {
+			return false;
+		}
+
+		uint record_size = sizeof(Record);
+		ofs.write("PEKWMTRC", 8);
+		ofs.write(reinterpret_cast<const char*>(&record_size),
+			  sizeof(record_size));
+		Record rec;
+		for (uint i = 0; getRecord(i, rec); i++) {
+			ofs.write(reinterpret_cast<const char*>(&rec),
+				  sizeof(rec));
+		}
+		return ofs.good();
+	}
+
+	/**
+	 * Write latency histograms, with count, average, maximum and
+	 * percentiles in microseconds, for all traced kinds and types.
+	 */
+	void
+	dump(std::ostream &os, void*)
+	{
+		os << "trace " << (_enabled ? "enabled" : "disabled")
+		   << ", " << _ring_count << " records, "
+		   << size() << " in ring buffer" << std::endl;
+		os << std::left << std::setw(9) << "kind"
+		   << std::setw(18) << "type" << std::right
+		   << std::setw(8) << "count" << std::setw(10) << "avg us"
+		   << std::setw(10) << "max us" << std::setw(10) << "p50 us"
+		   << std::setw(10) << "p99 us" << std::endl;
+
+		for (uint kind = 0; kind < KIND_NO; kind++) {
+			for (uint type = 0; type < TYPE_MAX; type++) {
+				Kind k = static_cast<Kind>(kind);
+				uint count = getCount(k, type);
+				if (count == 0) {
+					continue;
+				}
+				os << std::left << std::setw(9)
+				   << _kind_names[kind]
+				   << std::setw(18) << getTypeName(kind, type)
+				   << std::right << std::setw(8) << count
+				   << std::setw(10)
+				   << static_cast<uint>(_sum_ns[kind][type]
+							/ count / 1000)
+				   << std::setw(10)
+				   << static_cast<ulong>(_max_ns[kind][type]
+							 / 1000)
+				   << std::setw(10)
+				   << getPercentile(k, type, 50)
+				   << std::setw(10)
+				   << getPercentile(k, type, 99)
+				   << std::endl;
+			}
+		}
+	}
+}
@@ -0,0 +1,152 @@
+//
+// Trace.hh for pekwm
+// Copyright (C) 2023 Claes Nästén <pekdon@gmail.com>
+//
+// This program is licensed under the GNU GPL.
+// See the LICENSE file for more information.
+//
+
+#ifndef _PEKWM_TRACE_HH_
+#define _PEKWM_TRACE_HH_
+
+#include "Types.hh"
+
+#include <deque>
+#include <ostream>
+#include <string>
+
+extern "C" {
+#include <time.h>
+}
+
+/**
+ * Low overhead event tracing, records are stored in binary form in a
+ * fixed size ring buffer and accumulated in per kind and type latency
+ * histograms. No formatting is done until the trace is dumped.
+ */
+namespace Trace
+{
+	enum Kind {
+		/**
+		 * X event from being read from the connection until
+		 * handled, type is event type.
+		 */
+		KIND_EVENT,
+		/** WindowManager::handleEvent, type is event type. */
+		KIND_DISPATCH,
+		/** Action execution, type is ActionType. */
+		KIND_ACTION,
+		/** PDecor rendering, type is RenderType. */
+		KIND_RENDER,
+		KIND_NO
+	};
+
+	enum RenderType {
+		RENDER_TITLE,
+		RENDER_BUTTONS,
+		RENDER_BORDER
+	};
+
+	/** Number of records kept in the ring buffer. */
+	static const uint RING_SIZE = 4096;
+	/** Types above this value are accounted as TYPE_MAX - 1. */
+	static const uint TYPE_MAX = 256;
+	/** Number of power of two microsecond buckets in histograms. */
+	static const uint BUCKETS = 24;
+
+	/** Binary trace record, as stored in the ring buffer. */
+	struct Record {
+		ulong sec;
+		uint64_t duration_ns;
+		uint nsec;
+		ushort kind;
+		ushort type;
+	};
+
+	bool isEnabled(void);
+	void setEnabled(bool enabled);
+	void reset(void);
+
+	void now(struct timespec &ts);
+	void record(Kind kind, uint type, const struct timespec &start);
+
+	uint size(void);
+	bool getRecord(uint num, Record &record);
+	uint getCount(Kind kind, uint type);
+	uint getBucket(Kind kind, uint type, uint bucket);
+	uint getPercentile(Kind kind, uint type, uint percentile);
+
+	std::string getEventName(uint type);
+	std::string getScopeName(Kind kind, uint type);
+
+	Kind getScopeKind(void);
+	uint getScopeType(void);
+	void setScope(Kind kind, uint type);
+
+	bool save(const std::string &path);
+	void dump(std::ostream &os, void *opaque);
+
+	/**
+	 * Time events in a queue were read, events are read into the
+	 * queue in batches and taken from it one at the time in the order
+	 * they were read.
+	 */
+	class EventQueue {
+	public:
+		EventQueue(void);
+
+		uint size(void) const { return _queued; }
+
+		void reset(void);
+		void update(uint queued, const struct timespec &read);
+		void pop(struct timespec &read);
+
+	private:
+		struct Batch {
+			uint count;
+			struct timespec read;
+		};
+
+		/** Number of events in the queue, sum of batch counts. */
+		uint _queued;
+		std::deque<Batch> _batches;
+	};
+
+	/**
+	 * Record duration of scope, construct at the start of the code
+	 * to trace. The scope is the current scope until destructed,
+	 * used to attribute X11 requests even when tracing is disabled.
+	 */
+	class Scope {
+	public:
+		Scope(Kind kind, uint type)
+			: _kind(kind),
+			  _type(type),
+			  _prev_kind(getScopeKind()),
+			  _prev_type(getScopeType()),
+			  _enabled(isEnabled())
+		{
+			setScope(kind, type);
+			if (_enabled) {
+				now(_start);
+			}
+		}
+		~Scope(void)
+		{
+			if (_enabled) {
+				record(_kind, _type, _start);
+			}
+			setScope(_prev_kind, _prev_type);
+		}
+
+	private:
+		Kind _kind;
+		uint _type;
+		Kind _prev_kind;
+		uint _prev_type;
+		bool _enabled;
+		struct timespec _start;
+	};
+}
+
+#endif // _PEKWM_TRACE_HH_
@@ -525,6 +525,89 @@ namespace Util {
 			       static_cast<int(*)(int)>(std::tolower));
 	}
 
+	StringHash::StringHash(void)
+		: _seed(0),
+		  _mask(0)
+	{
+	}
+
+	/**
+	 * Build hash of names, searching for a seed giving each name a
+	 * slot of its own and growing the table if none is found. Names
+	 * equal ignoring case are only added once, first name wins.
+	 */
+	void
+	StringHash::build(const std::vector<const char*> &names)
+	{
+		_names = names;
+		uint size = 4;
+		while (size < names.size() * 2) {
+			size <<= 1;
+		}
+
+		for (;; size <<= 1) {
+			for (uint seed = 1; seed <= 64; seed++) {
+				if (place(seed, size)) {
+					return;
+				}
+			}
+		}
+	}
+
+	/**
+	 * Find key, returns index of the matching name or -1.
+	 */
+	int
+	StringHash::find(const std::string &key) const
+	{
+		if (_slots.empty()) {
+			return -1;
+		}
+		uint slot = hash(key.c_str(), key.size(), _seed) & _mask;
+		int i = _slots[slot];
+		if (i != -1 && pekwm::ascii_ncase_equal(_names[i], key)) {
+			return i;
+		}
+		return -1;
+	}
+
+	/**
+	 * FNV-1a hash of ASCII case folded str.
+	 */
+	uint
+	StringHash::hash(const char *str, size_t len, uint seed)
+	{
+		uint hash = 2166136261U ^ seed;
+		for (size_t i = 0; i < len; i++) {
+			uchar chr = str[i];
+			if (chr >= 'A' && chr <= 'Z') {
+				chr += 'a' - 'A';
+			}
+			hash = (hash ^ chr) * 16777619U;
+		}
+		return hash ^ (hash >> 16);
+	}
+
+	bool
+	StringHash::place(uint seed, uint size)
+	{
+		_slots.assign(size, -1);
+		for (size_t i = 0; i < _names.size(); i++) {
+			uint slot = hash(_names[i], strlen(_names[i]), seed)
+				& (size - 1);
+			int other = _slots[slot];
+			if (other == -1) {
+				_slots[slot] = i;
+			} else if (! pekwm::ascii_ncase_equal(_names[other],
+							      _names[i])) {
+				return false;
+			}
+		}
+		_seed = seed;
+		_mask = size - 1;
+		return true;
+	}
+
 } // end namespace Util.
 
 // OsENv
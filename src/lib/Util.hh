@@ -216,6 +216,76 @@ namespace Util {
 		return map[i].value;
 	}
 
+	/**
+	 * Case insensitive perfect hash of names, the hash seed and table
+	 * size are chosen so that no two names share a slot making a
+	 * lookup a single hash and string comparison.
+	 */
+	class StringHash {
+	public:
+		StringHash(void);
+
+		void build(const std::vector<const char*> &names);
+		int find(const std::string &key) const;
+
+		static uint hash(const char *str, size_t len, uint seed);
+
+	private:
+		bool place(uint seed, uint size);
+
+		std::vector<const char*> _names;
+		/** Index into _names per slot, -1 for empty slots. */
+		std::vector<int> _slots;
+		uint _seed;
+		uint _mask;
+	};
+
+	/**
+	 * Lookup index for a StringTo table, the table remains the source
+	 * of truth and is hashed on first lookup. Define next to the table
+	 * and lookup with StringToGet.
+	 */
+	template<typename T>
+	class StringToIndex {
+	public:
+		StringToIndex(const Util::StringTo<T> *map)
+			: _map(map),
+			  _size(-1)
+		{
+		}
+
+		T get(const std::string &key) const
+		{
+			if (_size == -1) {
+				build();
+			}
+			int i = _hash.find(key);
+			return _map[i == -1 ? _size : i].value;
+		}
+
+	private:
+		void build(void) const
+		{
+			std::vector<const char*> names;
+			for (_size = 0; _map[_size].name != nullptr; _size++) {
+				names.push_back(_map[_size].name);
+			}
+			_hash.build(names);
+		}
+
+		const Util::StringTo<T> *_map;
+		/** Number of entries, excluding the terminating entry. */
+		mutable int _size;
+		mutable StringHash _hash;
+	};
+
+	template<typename T>
+	T StringToGet(const Util::StringToIndex<T> &index,
+		      const std::string& key)
+	{
+		return index.get(key);
+	}
+
 }
 
 /**
@@ -20,6 +20,7 @@ extern "C" {
 #include <sys/types.h>
 #include <sys/time.h>
 #include <sys/select.h>
+#include <errno.h>
 #include <string.h>
 #include <unistd.h>
 
@@ -32,6 +33,11 @@ extern "C" {
 #ifdef PEKWM_HAVE_XRANDR
 #include <X11/extensions/Xrandr.h>
 #endif // PEKWM_HAVE_XRANDR
+#ifdef PEKWM_HAVE_SHM
+#include <sys/ipc.h>
+#include <sys/shm.h>
+#include <X11/extensions/XShm.h>
+#endif // PEKWM_HAVE_SHM
 #include <X11/keysym.h> // For XK_ entries
 #ifdef PEKWM_HAVE_X11_XKBLIB_H
 #include <X11/XKBlib.h>
@@ -41,6 +47,8 @@ extern "C" {
 }
 
 #include "X11.hh"
+#include "X11Stats.hh"
+#include "Trace.hh"
 #include "Debug.hh"
 #include "String.hh"
 #include "pekwm_types.hh"
@@ -89,6 +97,15 @@ extern "C" {
 	}
 }
 
+/** Read times of the events in the Xlib event queue, when tracing. */
+static Trace::EventQueue _event_queue;
+/** Time the event last returned by getNextEvent was read. */
+static struct timespec _event_read;
+/** Time the event last returned by getNextEvent started to be handled. */
+static struct timespec _event_handled;
+/** If true, the event queue was tracked by the last getNextEvent. */
+static bool _event_traced = false;
+
 static const char *atomnames[] = {
 	// EWMH atoms
 	"_NET_SUPPORTED",
@@ -157,6 +174,9 @@ static const char *atomnames[] = {
 	"_PEKWM_BG_PID",
 	"_PEKWM_CMD",
 	"_PEKWM_THEME",
+	"_PEKWM_DEBUG_DUMP",
+	"_PEKWM_ICON",
+	"_PEKWM_ICON_SIZE",
 
 	// ICCCM atoms
 	"WM_NAME",
@@ -433,6 +453,23 @@ X11::init(Display *dpy, bool synchronous, bool honour_randr)
 	}
 #endif // PEKWM_HAVE_XDBE
 
+#ifdef PEKWM_HAVE_SHM
+	_has_extension_shm = XShmQueryExtension(_dpy);
+	_shm_verified = false;
+#endif // PEKWM_HAVE_SHM
+
+#ifdef PEKWM_HAVE_XRENDER
+	{
+		int dummy_event, dummy_error;
+		_has_extension_xrender =
+			XRenderQueryExtension(_dpy, &dummy_event,
+					      &dummy_error)
+			&& XRenderFindStandardFormat(_dpy,
+						     PictStandardARGB32)
+			&& XRenderFindVisualFormat(_dpy, _visual);
+	}
+#endif // PEKWM_HAVE_XRENDER
+
 #ifdef PEKWM_HAVE_XRANDR
 	{
 		int dummy_error;
@@ -519,6 +556,7 @@ Window
 X11::getSelectionOwner(Atom atom)
 {
 	if (_dpy) {
+		X11_STAT("getSelectionOwner", ROUND_TRIP);
 		return XGetSelectionOwner(_dpy, atom);
 	}
 	return None;
@@ -537,6 +575,7 @@ X11::setSelectionOwner(Atom atom, Window owner, Time timestamp)
 		if (timestamp == static_cast<Time>(-1)) {
 			timestamp = _last_event_time;
 		}
+		X11_STAT("setSelectionOwner", REQUEST);
 		XSetSelectionOwner(_dpy, atom, owner, timestamp);
 	}
 }
@@ -561,6 +600,7 @@ X11::getColor(const std::string &color)
 
 	// X alloc
 	XColor dummy;
+	X11_STAT("getColor", ROUND_TRIP);
 	if (XAllocNamedColor(_dpy, X11::getColormap(),
 			     color.c_str(), entry->getColor(), &dummy) == 0) {
 		P_ERR("failed to alloc color: " << color);
@@ -622,6 +662,7 @@ void
 X11::warpPointer(int x, int y)
 {
 	if (_dpy) {
+		X11_STAT("warpPointer", REQUEST);
 		XWarpPointer(_dpy, None, _root, 0, 0, 0, 0, x, y);
 	}
 }
@@ -630,6 +671,7 @@ void
 X11::moveWindow(Window win, int x, int y)
 {
 	if (_dpy) {
+		X11_STAT("moveWindow", REQUEST);
 		XMoveWindow(_dpy, win, x, y);
 	}
 }
@@ -638,6 +680,7 @@ X11::resizeWindow(Window win,
 		  unsigned int width, unsigned int height)
 {
 	if (_dpy) {
+		X11_STAT("resizeWindow", REQUEST);
 		XResizeWindow(_dpy, win, width, height);
 	}
 }
@@ -647,6 +690,7 @@ X11::moveResizeWindow(Window win, int x, int y,
 		      unsigned int width, unsigned int height)
 {
 	if (_dpy) {
+		X11_STAT("moveResizeWindow", REQUEST);
 		XMoveResizeWindow(_dpy, win, x, y, width, height);
 	}
 }
@@ -709,35 +753,72 @@ X11::pending(void)
 bool
 X11::getNextEvent(XEvent &ev, struct timeval *timeout)
 {
+	bool trace = Trace::isEnabled();
+	if (! trace) {
+		_event_traced = false;
+	} else if (_event_traced) {
+		// events read while handling the previous event, in round
+		// trips, were read at the earliest when it started.
+		_event_queue.update(XEventsQueued(_dpy, QueuedAlready),
+				    _event_handled);
+	} else {
+		_event_queue.reset();
+	}
+
 	// A call to flush was previously used when no pending events was
 	// found, however accoarding to the XFlush man page XPending does
 	// flush by itself.
 	//
 	// This reportedly fixes lockups and the change was suggested
 	// by Christian Zander
-	if (pending()) {
-		XNextEvent(_dpy, &ev);
-		return true;
-	}
+	bool selected = false;
+	if (! pending()) {
+		int ret;
+		fd_set rfds;
 
-	int ret;
-	fd_set rfds;
+		FD_ZERO(&rfds);
+		FD_SET(_fd, &rfds);
 
-	FD_ZERO(&rfds);
-	FD_SET(_fd, &rfds);
+		ret = select(_fd + 1, &rfds, nullptr, nullptr, timeout);
+		if (ret <= 0) {
+			return false;
+		}
+		selected = true;
+	}
 
-	ret = select(_fd + 1, &rfds, nullptr, nullptr, timeout);
-	if (ret > 0) {
-		XNextEvent(_dpy, &ev);
+	if (trace) {
+		// read what is available after select, making the events
+		// read now part of the current batch.
+		Trace::now(_event_handled);
+		_event_queue.update(XEventsQueued(_dpy, selected
+						  ? QueuedAfterReading
+						  : QueuedAlready),
+				    _event_handled);
+		_event_traced = true;
 	}
 
-	return ret > 0;
+	XNextEvent(_dpy, &ev);
+	if (trace) {
+		_event_queue.pop(_event_read);
+	}
+	return true;
+}
+
+/**
+ * Get time the event last returned by getNextEvent was read from the
+ * connection, only set while tracing is enabled.
+ */
+const struct timespec&
+X11::getEventReadTime(void)
+{
+	return _event_read;
 }
 
 void
 X11::allowEvents(int event_mode, Time time)
 {
 	if (_dpy) {
+		X11_STAT("allowEvents", REQUEST);
 		XAllowEvents(_dpy, event_mode, time);
 	}
 }
@@ -748,6 +829,7 @@ X11::grabServer(void)
 {
 	if (_server_grabs == 0) {
 		P_TRACE("grabbing server");
+		X11_STAT("grabServer", REQUEST);
 		XGrabServer(_dpy);
 		++_server_grabs;
 	} else {
@@ -771,6 +853,7 @@ X11::ungrabServer(bool sync)
 		} else {
 			P_TRACE("0 server grabs left, ungrabbing server.");
 		}
+		X11_STAT("ungrabServer", REQUEST);
 		XUngrabServer(_dpy);
 	}
 	return _server_grabs == 0;
@@ -781,6 +864,7 @@ bool
 X11::grabKeyboard(Window win)
 {
 	P_TRACE("grabbing keyboard");
+	X11_STAT("grabKeyboard", ROUND_TRIP);
 	if (XGrabKeyboard(_dpy, win, false, GrabModeAsync, GrabModeAsync,
 			  CurrentTime) == GrabSuccess) {
 		return true;
@@ -794,6 +878,7 @@ bool
 X11::ungrabKeyboard(void)
 {
 	P_TRACE("ungrabbing keyboard");
+	X11_STAT("ungrabKeyboard", REQUEST);
 	XUngrabKeyboard(_dpy, CurrentTime);
 	return false;
 }
@@ -804,6 +889,7 @@ X11::grabPointer(Window win, uint event_mask, CursorType type)
 {
 	P_TRACE("grabbing pointer");
 	Cursor cursor = type < CURSOR_NONE ? _cursor_map[type] : None;
+	X11_STAT("grabPointer", ROUND_TRIP);
 	if (XGrabPointer(_dpy, win, false, event_mask,
 			 GrabModeAsync, GrabModeAsync,
 			 None, cursor, CurrentTime) == GrabSuccess) {
@@ -820,6 +906,7 @@ bool
 X11::ungrabPointer(void)
 {
 	P_TRACE("ungrabbing pointer");
+	X11_STAT("ungrabPointer", REQUEST);
 	XUngrabPointer(_dpy, CurrentTime);
 	return false;
 }
@@ -832,6 +919,7 @@ Window
 X11::translateRootCoordinates(int x, int y, int *ret_x, int *ret_y)
 {
 	Window win = None;
+	X11_STAT("translateRootCoordinates", ROUND_TRIP);
 	XTranslateCoordinates(_dpy, _root, _root, x, y, ret_x, ret_y,
 			      &win);
 	return win;
@@ -842,6 +930,7 @@ X11::xdbeAllocBackBuffer(Window win)
 {
 #ifdef PEKWM_HAVE_XDBE
 	if (_has_extension_xdbe) {
+		X11_STAT("xdbeAllocBackBuffer", REQUEST);
 		return XdbeAllocateBackBufferName(_dpy, win, XdbeCopied);
 	}
 #endif // PEKWM_HAVE_XDBE
@@ -853,6 +942,7 @@ X11::xdbeFreeBackBuffer(XdbeBackBuffer buf)
 {
 #ifdef PEKWM_HAVE_XDBE
 	if (buf != None) {
+		X11_STAT("xdbeFreeBackBuffer", REQUEST);
 		XdbeDeallocateBackBufferName(_dpy, buf);
 	}
 #endif // PEKWM_HAVE_XDBE
@@ -866,6 +956,7 @@ X11::xdbeSwapBackBuffer(Window win)
 		XdbeSwapInfo swap_info;
 		swap_info.swap_window = win;
 		swap_info.swap_action = XdbeCopied;
+		X11_STAT("xdbeSwapBackBuffer", REQUEST);
 		XdbeSwapBuffers(_dpy, &swap_info, 1);
 	}
 #endif // PEKWM_HAVE_XDBE
@@ -1170,6 +1261,7 @@ Atom
 X11::getAtomId(const std::string& str)
 {
 	if (_dpy) {
+		X11_STAT("getAtomId", ROUND_TRIP);
 		return XInternAtom(_dpy, str.c_str(), False);
 	}
 	return 0;
@@ -1182,6 +1274,7 @@ std::string
 X11::getAtomIdString(Atom id)
 {
 	std::string name;
+	X11_STAT("getAtomIdString", ROUND_TRIP);
 	char *c_name = XGetAtomName(_dpy, id);
 	if (c_name != nullptr) {
 		name = c_name;
@@ -1345,6 +1438,7 @@ X11::listProperties(Window win, std::vector<Atom>& atoms)
 	}
 
 	int num_props;
+	X11_STAT("listProperties", ROUND_TRIP);
 	Atom *c_atoms = XListProperties(_dpy, win, &num_props);
 	if (c_atoms) {
 		for (int i = 0; i < num_props; i++) {
@@ -1355,10 +1449,20 @@ X11::listProperties(Window win, std::vector<Atom>& atoms)
 	return c_atoms != nullptr;
 }
 
+/**
+ * Read property atom of type from win. The first request asks for
+ * expected 32-bit units, or the size of the previous read of the same
+ * atom if larger, and if more data is left it is read in a second
+ * request starting where the first ended.
+ *
+ * Data is NUL terminated, as with XGetWindowProperty, and is freed
+ * with X11::free.
+ */
 bool
 X11::getProperty(Window win, Atom atom, Atom type,
 		 ulong expected, uchar **data_ret, ulong *actual)
 {
+	*data_ret = nullptr;
 	if (! _dpy) {
 		return false;
 	}
@@ -1366,38 +1470,75 @@ X11::getProperty(Window win, Atom atom, Atom type,
 	if (expected == 0) {
 		expected = 1024;
 	}
+	std::map<Atom, ulong>::iterator hint = _property_size_hint.find(atom);
+	if (hint != _property_size_hint.end() && hint->second > expected) {
+		expected = hint->second;
+	}
 
+	Atom r_type;
+	int r_format;
+	ulong read, left;
 	uchar *data = nullptr;
-	ulong read = 0, left = 0;
-	do {
+	int status =
+		XGetWindowProperty(_dpy, win, atom, 0L, expected, False, type,
+				   &r_type, &r_format, &read, &left, &data);
+	X11_STAT_BYTES("getProperty", ROUND_TRIP,
+		       status == Success ? read * r_format / 8 : 0);
+	if (status != Success || type != r_type || read == 0) {
 		if (data != nullptr) {
 			X11::free(data);
-			data = nullptr;
 		}
-		expected += left;
-
-		Atom r_type;
-		int r_format, status;
-		status =
-			XGetWindowProperty(_dpy, win, atom,
-					   0L, expected, False, type,
-					   &r_type, &r_format, &read, &left,
-					   &data);
-		if (status != Success || type != r_type || read == 0) {
-			if (data != nullptr) {
-				X11::free(data);
-				data = nullptr;
+		return false;
+	}
+
+	if (left) {
+		// continue after the data already received, the server
+		// has sent exactly expected 32-bit units.
+		uchar *rest = nullptr;
+		ulong rest_read, rest_left;
+		status = XGetWindowProperty(_dpy, win, atom, expected,
+					    (left + 3) / 4, False, type,
+					    &r_type, &r_format, &rest_read,
+					    &rest_left, &rest);
+		X11_STAT_BYTES("getProperty rest", ROUND_TRIP,
+			       status == Success
+			       ? rest_read * r_format / 8 : 0);
+		if (status != Success || type != r_type) {
+			if (rest != nullptr) {
+				X11::free(rest);
 			}
-			left = 0;
+			X11::free(data);
+			return false;
 		}
-	} while (left);
 
+		// Xlib returns 32-bit data as longs. The combined data is
+		// allocated with malloc, as Xlib does, to be freed with
+		// X11::free.
+		size_t item_size = r_format == 32
+			? sizeof(long) : r_format / 8;
+		uchar *all = static_cast<uchar*>(
+			malloc((read + rest_read) * item_size + 1));
+		if (all == nullptr) {
+			X11::free(rest);
+			X11::free(data);
+			return false;
+		}
+		memcpy(all, data, read * item_size);
+		memcpy(all + read * item_size, rest, rest_read * item_size);
+		all[(read + rest_read) * item_size] = 0;
+		X11::free(rest);
+		X11::free(data);
+
+		data = all;
+		read += rest_read;
+	}
+
+	_property_size_hint[atom] = (read * r_format / 8 + 3) / 4;
 	if (actual) {
 		*actual = read;
 	}
 	*data_ret = data;
-
-	return data != nullptr;
+	return true;
 }
 
 bool
@@ -1405,6 +1546,7 @@ X11::getTextProperty(Window win, Atom atom, std::string &value)
 {
 	// Read text property, return if it fails.
 	XTextProperty text_property;
+	X11_STAT("getTextProperty", ROUND_TRIP);
 	if (! XGetTextProperty(_dpy, win, &text_property, atom)
 	    || ! text_property.value || ! text_property.nitems) {
 		return false;
@@ -1432,13 +1574,15 @@ void*
 X11::getEwmhPropData(Window win, AtomName prop, Atom type, int &num)
 {
 	Atom type_ret;
-	int format_ret;
-	ulong items_ret, after_ret;
+	int format_ret = 0;
+	ulong items_ret = 0, after_ret;
 	uchar *prop_data = 0;
 
 	XGetWindowProperty(_dpy, win, _atoms[prop], 0, 0x7fffffff,
 			   False, type, &type_ret, &format_ret, &items_ret,
 			   &after_ret, &prop_data);
+	X11_STAT_BYTES("getEwmhPropData", ROUND_TRIP,
+		       items_ret * format_ret / 8);
 	num = items_ret;
 	return prop_data;
 }
@@ -1447,6 +1591,7 @@ void
 X11::unsetProperty(Window win, AtomName aname)
 {
 	if (_dpy) {
+		X11_STAT("unsetProperty", REQUEST);
 		XDeleteProperty(_dpy, win, _atoms[aname]);
 	}
 }
@@ -1458,6 +1603,7 @@ X11::getMousePosition(int &x, int &y)
 	int win_x, win_y;
 	uint mask;
 
+	X11_STAT("getMousePosition", ROUND_TRIP);
 	XQueryPointer(_dpy, _root, &d_root, &d_win, &x, &y,
 		      &win_x, &win_y, &mask);
 }
@@ -1506,6 +1652,7 @@ int
 X11::sendEvent(Window dest, Bool propagate, long mask, XEvent *ev)
 {
 	if (_dpy) {
+		X11_STAT("sendEvent", REQUEST);
 		return XSendEvent(_dpy, dest, propagate, mask, ev);
 	}
 	return BadValue;
@@ -1523,6 +1670,7 @@ X11::changeProperty(Window win, Atom prop, Atom type, int format,
 		    int mode, const unsigned char *data, int num_e)
 {
 	if (_dpy) {
+		X11_STAT("changeProperty", REQUEST);
 		return XChangeProperty(_dpy, win, prop, type, format, mode,
 				       data, num_e);
 	}
@@ -1536,6 +1684,7 @@ X11::getGeometry(Window win, unsigned *w, unsigned *h, unsigned *bw)
 	int x, y;
 	unsigned int depth_return;
 	if (_dpy) {
+		X11_STAT("getGeometry", ROUND_TRIP);
 		return XGetGeometry(_dpy, win, &wn, &x, &y,
 				    w, h, bw, &depth_return);
 	}
@@ -1546,6 +1695,7 @@ Status
 X11::getWindowAttributes(Window win, XWindowAttributes &wa)
 {
 	if (_dpy) {
+		X11_STAT("getWindowAttributes", ROUND_TRIP);
 		return XGetWindowAttributes(_dpy, win, &wa);
 	}
 	return BadImplementation;
@@ -1555,6 +1705,7 @@ bool
 X11::getWMHints(Window win, XWMHints &hints)
 {
 	if (_dpy) {
+		X11_STAT("getWMHints", ROUND_TRIP);
 		XWMHints *hints_ptr = XGetWMHints(_dpy, win);
 		if (hints_ptr) {
 			hints = *hints_ptr;
@@ -1569,6 +1720,7 @@ GC
 X11::createGC(Drawable d, ulong mask, XGCValues *values)
 {
 	if (_dpy) {
+		X11_STAT("createGC", REQUEST);
 		return XCreateGC(_dpy, d, mask, values);
 	}
 	return None;
@@ -1578,6 +1730,7 @@ void
 X11::freeGC(GC gc)
 {
 	if (_dpy) {
+		X11_STAT("freeGC", REQUEST);
 		XFreeGC(_dpy, gc);
 	}
 }
@@ -1586,6 +1739,7 @@ Pixmap
 X11::createPixmapMask(unsigned w, unsigned h)
 {
 	if (_dpy) {
+		X11_STAT("createPixmapMask", REQUEST);
 		return XCreatePixmap(_dpy, _root, w, h, 1);
 	}
 	return None;
@@ -1595,6 +1749,7 @@ Pixmap
 X11::createPixmap(unsigned w, unsigned h)
 {
 	if (_dpy) {
+		X11_STAT("createPixmap", REQUEST);
 		return XCreatePixmap(_dpy, _root, w, h, _depth);
 	}
 	return None;
@@ -1604,6 +1759,7 @@ void
 X11::freePixmap(Pixmap& pixmap)
 {
 	if (_dpy && pixmap != None) {
+		X11_STAT("freePixmap", REQUEST);
 		XFreePixmap(_dpy, pixmap);
 	}
 	pixmap = None;
@@ -1623,11 +1779,25 @@ XImage*
 X11::getImage(Drawable src, int x, int y, uint width, uint height,
 	      unsigned long plane_mask, int format)
 {
-	if (_dpy) {
-		return XGetImage(_dpy, src, x, y, width, height,
-				 plane_mask, format);
+	if (! _dpy) {
+		return nullptr;
 	}
-	return nullptr;
+
+#ifdef PEKWM_HAVE_SHM
+	if (format == ZPixmap && plane_mask == AllPlanes) {
+		XImage *ximage = createShmImage(width, height);
+		if (ximage != nullptr) {
+			X11_STAT("getImage shm", ROUND_TRIP);
+			if (XShmGetImage(_dpy, src, ximage, x, y, AllPlanes)) {
+				return ximage;
+			}
+			destroyImage(ximage);
+		}
+	}
+#endif // PEKWM_HAVE_SHM
+
+	X11_STAT("getImage", ROUND_TRIP);
+	return XGetImage(_dpy, src, x, y, width, height, plane_mask, format);
 }
 
 void
@@ -1635,18 +1805,393 @@ X11::putImage(Drawable dest, GC gc, XImage *ximage,
 	      int src_x, int src_y, int dest_x, int dest_y,
 	      uint width, uint height)
 {
-	if (_dpy) {
-		XPutImage(_dpy, dest, gc, ximage,
-			  src_x, src_y, dest_x, dest_y, width, height);
+	if (! _dpy) {
+		return;
 	}
+
+#ifdef PEKWM_HAVE_SHM
+	if (isShmImage(ximage)) {
+		X11_STAT("putImage shm", REQUEST);
+		XShmPutImage(_dpy, dest, gc, ximage,
+			     src_x, src_y, dest_x, dest_y, width, height,
+			     False);
+		return;
+	}
+#endif // PEKWM_HAVE_SHM
+
+	X11_STAT("putImage", REQUEST);
+	XPutImage(_dpy, dest, gc, ximage,
+		  src_x, src_y, dest_x, dest_y, width, height);
 }
 
+/**
+ * Destroy image created with createImage, getImage or createShmImage,
+ * shared memory images are detached from the server. The segment is
+ * already marked for removal and is freed once the server detaches.
+ */
 void
 X11::destroyImage(XImage *ximage)
 {
-	if (ximage) {
+	if (! ximage) {
+		return;
+	}
+
+#ifdef PEKWM_HAVE_SHM
+	if (isShmImage(ximage)) {
+		XShmSegmentInfo *shminfo =
+			reinterpret_cast<XShmSegmentInfo*>(ximage->obdata);
+		// no sync required, the server handles the detach after
+		// any XShmPutImage still queued and keeps its own mapping
+		// of the segment until then.
+		X11_STAT("destroyImage shm", REQUEST);
+		XShmDetach(_dpy, shminfo);
+		shmdt(shminfo->shmaddr);
+		delete shminfo;
+
+		ximage->obdata = nullptr;
+		ximage->data = nullptr;
+	}
+#endif // PEKWM_HAVE_SHM
+
+	XDestroyImage(ximage);
+}
+
+/**
+ * Create a ZPixmap image backed by a MIT-SHM segment shared with the
+ * server, avoiding copying the pixel data over the protocol stream.
+ *
+ * Returns nullptr if the extension is unavailable, the image is too
+ * small to benefit or the segment could not be setup, callers are
+ * expected to fallback to createImage/getImage. The image must be
+ * destroyed with destroyImage.
+ */
+XImage*
+X11::createShmImage(uint width, uint height)
+{
+#ifdef PEKWM_HAVE_SHM
+	if (! _dpy || ! _has_extension_shm
+	    || static_cast<size_t>(width) * height * 4 < SHM_IMAGE_MIN_SIZE) {
+		return nullptr;
+	}
+
+	XShmSegmentInfo *shminfo = new XShmSegmentInfo;
+	XImage *ximage = XShmCreateImage(_dpy, _visual, _depth, ZPixmap,
+					 nullptr, shminfo, width, height);
+	if (ximage == nullptr) {
+		delete shminfo;
+		return nullptr;
+	}
+
+	shminfo->shmid = shmget(IPC_PRIVATE,
+				static_cast<size_t>(ximage->bytes_per_line)
+				* ximage->height,
+				IPC_CREAT | 0600);
+	if (shminfo->shmid == -1) {
+		P_DBG("shmget failed, disabling MIT-SHM: " << strerror(errno));
+		_has_extension_shm = false;
 		XDestroyImage(ximage);
+		delete shminfo;
+		return nullptr;
 	}
+
+	shminfo->shmaddr = static_cast<char*>(shmat(shminfo->shmid,
+						    nullptr, 0));
+	if (shminfo->shmaddr == reinterpret_cast<char*>(-1)) {
+		P_DBG("shmat failed, disabling MIT-SHM: " << strerror(errno));
+		_has_extension_shm = false;
+		shmctl(shminfo->shmid, IPC_RMID, nullptr);
+		XDestroyImage(ximage);
+		delete shminfo;
+		return nullptr;
+	}
+	shminfo->readOnly = False;
+	ximage->data = shminfo->shmaddr;
+
+	if (_shm_verified) {
+		XShmAttach(_dpy, shminfo);
+#ifndef __linux__
+		// the segment can not be attached once marked for removal,
+		// except on Linux, wait for the server to attach.
+		X11_STAT("createShmImage attach", ROUND_TRIP);
+		XSync(_dpy, False);
+#endif // ! __linux__
+	} else {
+		// the extension is reported on remote displays as well,
+		// where attaching fails. Verify the first attach.
+		X11_STAT("createShmImage verify", ROUND_TRIP);
+		bool ignore = xerrors_ignore;
+		setXErrorsIgnore(false);
+		XSync(_dpy, False);
+		uint errors_before = xerrors_count;
+		XShmAttach(_dpy, shminfo);
+		XSync(_dpy, False);
+		setXErrorsIgnore(ignore);
+
+		if (errors_before != xerrors_count) {
+			P_DBG("XShmAttach failed, disabling MIT-SHM");
+			_has_extension_shm = false;
+			shmdt(shminfo->shmaddr);
+			shmctl(shminfo->shmid, IPC_RMID, nullptr);
+			ximage->data = nullptr;
+			XDestroyImage(ximage);
+			delete shminfo;
+			return nullptr;
+		}
+		_shm_verified = true;
+	}
+
+	// mark the segment for removal right away, it is freed when
+	// both pekwm and the server have detached even if pekwm crashes.
+	shmctl(shminfo->shmid, IPC_RMID, nullptr);
+
+	ximage->obdata = reinterpret_cast<char*>(shminfo);
+	return ximage;
+#else // ! PEKWM_HAVE_SHM
+	return nullptr;
+#endif // PEKWM_HAVE_SHM
+}
+
+/**
+ * Return true if ximage was created with createShmImage.
+ */
+bool
+X11::isShmImage(const XImage *ximage)
+{
+#ifdef PEKWM_HAVE_SHM
+	// obdata is only set by XShmCreateImage, XCreateImage leaves it
+	// unset.
+	return ximage != nullptr && ximage->obdata != nullptr;
+#else // ! PEKWM_HAVE_SHM
+	return false;
+#endif // PEKWM_HAVE_SHM
+}
+
+/**
+ * Create XRender picture for drawable using the default visual.
+ *
+ * @return Picture, None if XRender is not available.
+ */
+Picture
+X11::renderCreatePicture(Drawable draw)
+{
+#ifdef PEKWM_HAVE_XRENDER
+	if (hasExtensionXRender()) {
+		XRenderPictFormat *format =
+			XRenderFindVisualFormat(_dpy, _visual);
+		X11_STAT("renderCreatePicture", REQUEST);
+		return XRenderCreatePicture(_dpy, draw, format, 0, nullptr);
+	}
+#endif // PEKWM_HAVE_XRENDER
+	return None;
+}
+
+/**
+ * Upload ARGB data, 4 bytes per pixel as used by PImage, to a 32 bit
+ * server side picture with premultiplied alpha. Free with
+ * renderFreePicture.
+ *
+ * @return Picture, None if XRender is not available.
+ */
+Picture
+X11::renderCreateArgbPicture(const uchar *data, uint width, uint height)
+{
+#ifdef PEKWM_HAVE_XRENDER
+	Pixmap pix = createArgbPixmap(data, width, height);
+	if (pix == None) {
+		return None;
+	}
+
+	XRenderPictFormat *format =
+		XRenderFindStandardFormat(_dpy, PictStandardARGB32);
+	X11_STAT("renderCreateArgbPicture", REQUEST);
+	Picture pic = XRenderCreatePicture(_dpy, pix, format, 0, nullptr);
+	// the picture keeps a reference to the pixmap
+	freePixmap(pix);
+	return pic;
+#else // ! PEKWM_HAVE_XRENDER
+	return None;
+#endif // PEKWM_HAVE_XRENDER
+}
+
+/**
+ * Upload ARGB data, 4 bytes per pixel as used by PImage, to a 32 bit
+ * pixmap with premultiplied alpha, the format of XRender ARGB32
+ * pictures.
+ *
+ * @return Pixmap, None if XRender is not available.
+ */
+Pixmap
+X11::createArgbPixmap(const uchar *data, uint width, uint height)
+{
+#ifdef PEKWM_HAVE_XRENDER
+	if (! hasExtensionXRender() || ! width || ! height) {
+		return None;
+	}
+
+	uint *pixels = static_cast<uint*>(malloc(width * height * 4));
+	if (pixels == nullptr) {
+		return None;
+	}
+	for (uint i = 0; i < width * height; i++, data += 4) {
+		uint a = data[0];
+		pixels[i] = (a << 24)
+			| ((data[1] * a / 255) << 16)
+			| ((data[2] * a / 255) << 8)
+			| (data[3] * a / 255);
+	}
+
+	// the pixels are in host byte order, Xlib converts them if the
+	// server byte order differs.
+	XImage *ximage = XCreateImage(_dpy, _visual, 32, ZPixmap, 0,
+				      reinterpret_cast<char*>(pixels),
+				      width, height, 32, 0);
+	if (ximage == nullptr) {
+		free(pixels);
+		return None;
+	}
+	const uint one = 1;
+	ximage->byte_order =
+		*reinterpret_cast<const uchar*>(&one) ? LSBFirst : MSBFirst;
+
+	X11_STAT("createArgbPixmap", REQUEST);
+	Pixmap pix = XCreatePixmap(_dpy, _root, width, height, 32);
+	GC gc = XCreateGC(_dpy, pix, 0, nullptr);
+	XPutImage(_dpy, pix, gc, ximage, 0, 0, 0, 0, width, height);
+	XFreeGC(_dpy, gc);
+	XDestroyImage(ximage);
+	return pix;
+#else // ! PEKWM_HAVE_XRENDER
+	return None;
+#endif // PEKWM_HAVE_XRENDER
+}
+
+/**
+ * Read pixmap created with createArgbPixmap into data, width * height
+ * * 4 bytes of ARGB.
+ *
+ * @return true on success, false if the pixmap has been freed.
+ */
+bool
+X11::readArgbPixmap(Pixmap pix, uint width, uint height, uchar *data)
+{
+	if (! _dpy || pix == None) {
+		return false;
+	}
+
+	// the pixmap is owned by another client and can be freed between
+	// reading its id and XGetImage, ignore the BadDrawable error.
+	X11_STAT("readArgbPixmap", ROUND_TRIP);
+	bool ignore = xerrors_ignore;
+	setXErrorsIgnore(true);
+	XImage *ximage = XGetImage(_dpy, pix, 0, 0, width, height,
+				   AllPlanes, ZPixmap);
+	setXErrorsIgnore(ignore);
+	if (ximage == nullptr) {
+		return false;
+	}
+	if (ximage->depth != 32) {
+		XDestroyImage(ximage);
+		return false;
+	}
+
+	for (uint y = 0; y < height; y++) {
+		for (uint x = 0; x < width; x++, data += 4) {
+			ulong pixel = XGetPixel(ximage, x, y);
+			uint a = pixel >> 24 & 0xff;
+			data[0] = a;
+			if (a == 0) {
+				data[1] = data[2] = data[3] = 0;
+			} else {
+				data[1] = (pixel >> 16 & 0xff) * 255 / a;
+				data[2] = (pixel >> 8 & 0xff) * 255 / a;
+				data[3] = (pixel & 0xff) * 255 / a;
+			}
+		}
+	}
+	XDestroyImage(ximage);
+	return true;
+}
+
+void
+X11::renderFreePicture(Picture pic)
+{
+#ifdef PEKWM_HAVE_XRENDER
+	if (_dpy && pic != None) {
+		X11_STAT("renderFreePicture", REQUEST);
+		XRenderFreePicture(_dpy, pic);
+	}
+#endif // PEKWM_HAVE_XRENDER
+}
+
+/**
+ * Set transform of pic scaling src_width x src_height to dst_width x
+ * dst_height when used as composite source, bilinear filtered.
+ */
+void
+X11::renderSetPictureScale(Picture pic, uint src_width, uint src_height,
+			   uint dst_width, uint dst_height)
+{
+#ifdef PEKWM_HAVE_XRENDER
+	if (! _dpy || ! dst_width || ! dst_height) {
+		return;
+	}
+
+	bool identity = src_width == dst_width && src_height == dst_height;
+	XTransform transform = {{
+		{XDoubleToFixed(static_cast<double>(src_width) / dst_width),
+		 XDoubleToFixed(0), XDoubleToFixed(0)},
+		{XDoubleToFixed(0),
+		 XDoubleToFixed(static_cast<double>(src_height) / dst_height),
+		 XDoubleToFixed(0)},
+		{XDoubleToFixed(0), XDoubleToFixed(0), XDoubleToFixed(1)}
+	}};
+	X11_STAT("renderSetPictureScale", REQUEST);
+	XRenderSetPictureTransform(_dpy, pic, &transform);
+	XRenderSetPictureFilter(_dpy, pic,
+				identity ? FilterNearest : FilterBilinear,
+				nullptr, 0);
+#endif // PEKWM_HAVE_XRENDER
+}
+
+void
+X11::renderSetPictureRepeat(Picture pic, RenderRepeat repeat)
+{
+#ifdef PEKWM_HAVE_XRENDER
+	if (_dpy) {
+		XRenderPictureAttributes attrs;
+		switch (repeat) {
+		case RENDER_REPEAT_NORMAL:
+			attrs.repeat = RepeatNormal;
+			break;
+		case RENDER_REPEAT_PAD:
+			attrs.repeat = RepeatPad;
+			break;
+		case RENDER_REPEAT_NONE:
+		default:
+			attrs.repeat = RepeatNone;
+			break;
+		}
+		X11_STAT("renderSetPictureRepeat", REQUEST);
+		XRenderChangePicture(_dpy, pic, CPRepeat, &attrs);
+	}
+#endif // PEKWM_HAVE_XRENDER
+}
+
+/**
+ * Composite src over dst.
+ */
+void
+X11::renderComposite(Picture src, Picture dst, int src_x, int src_y,
+		     int dst_x, int dst_y, uint width, uint height)
+{
+#ifdef PEKWM_HAVE_XRENDER
+	if (_dpy) {
+		X11_STAT("renderComposite", REQUEST);
+		XRenderComposite(_dpy, PictOpOver, src, None, dst,
+				 src_x, src_y, 0, 0, dst_x, dst_y,
+				 width, height);
+	}
+#endif // PEKWM_HAVE_XRENDER
 }
 
 void
@@ -1655,6 +2200,7 @@ X11::copyArea(Drawable src, Drawable dst, int src_x, int src_y,
 	      int dest_x, int dest_y)
 {
 	if (_dpy && width > 0 && height > 0) {
+		X11_STAT("copyArea", REQUEST);
 		XCopyArea(_dpy, src, dst, getGC(),
 			  src_x, src_y, width, height, dest_x, dest_y);
 	}
@@ -1664,6 +2210,7 @@ void
 X11::setWindowBackground(Window window, ulong pixel)
 {
 	if (_dpy) {
+		X11_STAT("setWindowBackground", REQUEST);
 		XSetWindowBackground(_dpy, window, pixel);
 	}
 }
@@ -1672,6 +2219,7 @@ void
 X11::setWindowBackgroundPixmap(Window window, Pixmap pixmap)
 {
 	if (_dpy) {
+		X11_STAT("setWindowBackgroundPixmap", REQUEST);
 		XSetWindowBackgroundPixmap(_dpy, window, pixmap);
 	}
 }
@@ -1680,6 +2228,7 @@ void
 X11::clearWindow(Window window)
 {
 	if (_dpy) {
+		X11_STAT("clearWindow", REQUEST);
 		XClearWindow(_dpy, window);
 	}
 }
@@ -1689,6 +2238,7 @@ void
 X11::shapeSelectInput(Window window, ulong mask)
 {
 	if (_dpy) {
+		X11_STAT("shapeSelectInput", REQUEST);
 		XShapeSelectInput(_dpy, window, mask);
 	}
 }
@@ -1697,6 +2247,7 @@ void
 X11::shapeQuery(Window dst, int *bshaped)
 {
 	int foo; unsigned bar;
+	X11_STAT("shapeQuery", ROUND_TRIP);
 	XShapeQueryExtents(_dpy, dst, bshaped, &foo, &foo, &bar, &bar,
 			   &foo, &foo, &foo, &bar, &bar);
 }
@@ -1705,12 +2256,14 @@ void
 X11::shapeCombine(Window dst, int kind, int x, int y,
 		  Window src, int op)
 {
+	X11_STAT("shapeCombine", REQUEST);
 	XShapeCombineShape(_dpy, dst, kind, x, y, src, kind, op);
 }
 
 void
 X11::shapeSetRect(Window dst, XRectangle *rect)
 {
+	X11_STAT("shapeSetRect", REQUEST);
 	XShapeCombineRectangles(_dpy, dst, ShapeBounding, 0, 0, rect, 1,
 				ShapeSet, YXBanded);
 }
@@ -1718,6 +2271,7 @@ X11::shapeSetRect(Window dst, XRectangle *rect)
 void
 X11::shapeIntersectRect(Window dst, XRectangle *rect)
 {
+	X11_STAT("shapeIntersectRect", REQUEST);
 	XShapeCombineRectangles(_dpy, dst, ShapeBounding, 0, 0, rect, 1,
 				ShapeIntersect, YXBanded);
 }
@@ -1725,6 +2279,7 @@ X11::shapeIntersectRect(Window dst, XRectangle *rect)
 void
 X11::shapeSetMask(Window dst, int kind, Pixmap pix)
 {
+	X11_STAT("shapeSetMask", REQUEST);
 	XShapeCombineMask(_dpy, dst, kind, 0, 0, pix, ShapeSet);
 }
 #else // ! PEKWM_HAVE_SHAPE
@@ -1824,18 +2379,22 @@ X11::initHeadsRandr(void)
 		return;
 	}
 
+	X11_STAT("initHeadsRandr resources", ROUND_TRIP);
 	XRRScreenResources *resources = XRRGetScreenResources(_dpy, _root);
 	if (! resources) {
 		return;
 	}
 
+	X11_STAT("initHeadsRandr primary", ROUND_TRIP);
 	RROutput primary_output = XRRGetOutputPrimary(_dpy, _root);
 
 	for (int i = 0; i < resources->noutput; ++i) {
+		X11_STAT("initHeadsRandr output", ROUND_TRIP);
 		XRROutputInfo* output =
 			XRRGetOutputInfo(_dpy, resources,
 					 resources->outputs[i]);
 		if (output->crtc) {
+			X11_STAT("initHeadsRandr crtc", ROUND_TRIP);
 			XRRCrtcInfo* crtc =
 				XRRGetCrtcInfo(_dpy, resources, output->crtc);
 			addHead(Head(crtc->x, crtc->y,
@@ -2070,6 +2629,7 @@ X11::createWindow(Window parent,
 		  XSetWindowAttributes* attrs)
 {
 	if (_dpy) {
+		X11_STAT("createWindow", REQUEST);
 		return XCreateWindow(_dpy, parent,
 				     x, y, width, height, border_width,
 				     depth, _class, visual, valuemask, attrs);
@@ -2097,6 +2657,7 @@ void
 X11::destroyWindow(Window win)
 {
 	if (_dpy) {
+		X11_STAT("destroyWindow", REQUEST);
 		XDestroyWindow(_dpy, win);
 	}
 }
@@ -2106,6 +2667,7 @@ X11::changeWindowAttributes(Window win, ulong mask,
 			    XSetWindowAttributes &attrs)
 {
 	if (_dpy) {
+		X11_STAT("changeWindowAttributes", REQUEST);
 		XChangeWindowAttributes(_dpy, win, mask, &attrs);
 	}
 }
@@ -2114,6 +2676,7 @@ void
 X11::grabButton(unsigned b, unsigned int mod, Window win,
 		unsigned mask, int mode)
 {
+	X11_STAT("grabButton", REQUEST);
 	XGrabButton(_dpy, b, mod, win, False, mask, mode,
 		    GrabModeAsync, None, None);
 }
@@ -2122,6 +2685,7 @@ void
 X11::mapWindow(Window w)
 {
 	if (_dpy) {
+		X11_STAT("mapWindow", REQUEST);
 		XMapWindow(_dpy, w);
 	}
 }
@@ -2130,6 +2694,7 @@ void
 X11::mapRaised(Window w)
 {
 	if (_dpy) {
+		X11_STAT("mapRaised", REQUEST);
 		XMapRaised(_dpy, w);
 	}
 }
@@ -2138,6 +2703,7 @@ void
 X11::unmapWindow(Window w)
 {
 	if (_dpy) {
+		X11_STAT("unmapWindow", REQUEST);
 		XUnmapWindow(_dpy, w);
 	}
 }
@@ -2146,6 +2712,7 @@ void
 X11::reparentWindow(Window w, Window parent, int x, int y)
 {
 	if (_dpy) {
+		X11_STAT("reparentWindow", REQUEST);
 		XReparentWindow(_dpy, w, parent, x, y);
 	}
 }
@@ -2154,6 +2721,7 @@ void
 X11::raiseWindow(Window w)
 {
 	if (_dpy) {
+		X11_STAT("raiseWindow", REQUEST);
 		XRaiseWindow(_dpy, w);
 	}
 }
@@ -2162,6 +2730,7 @@ void
 X11::lowerWindow(Window w)
 {
 	if (_dpy) {
+		X11_STAT("lowerWindow", REQUEST);
 		XLowerWindow(_dpy, w);
 	}
 }
@@ -2169,6 +2738,7 @@ X11::lowerWindow(Window w)
 void
 X11::ungrabButton(uint button, uint modifiers, Window win)
 {
+	X11_STAT("ungrabButton", REQUEST);
 	XUngrabButton(_dpy, button, modifiers, win);
 }
 
@@ -2179,6 +2749,7 @@ void
 X11::stackWindows(Window *wins, unsigned len)
 {
 	if (len > 1) {
+		X11_STAT("stackWindows", REQUEST);
 		XRestackWindows(_dpy, wins, len);
 	}
 }
@@ -2201,10 +2772,43 @@ X11::checkTypedWindowEvent(Window w, int type, XEvent *ev)
 	return XCheckTypedWindowEvent(_dpy, w, type, ev);
 }
 
+/** Window, message type and data matched by matchClientMessage. */
+struct ClientMessageMatch {
+	Window window;
+	Atom message_type;
+	long data1;
+};
+
+static Bool
+matchClientMessage(Display*, XEvent *ev, XPointer arg)
+{
+	ClientMessageMatch *match = reinterpret_cast<ClientMessageMatch*>(arg);
+	return ev->type == ClientMessage
+		&& ev->xclient.window == match->window
+		&& ev->xclient.message_type == match->message_type
+		&& ev->xclient.format == 32
+		&& ev->xclient.data.l[1] == match->data1;
+}
+
+/**
+ * Remove the first queued ClientMessage of message_type, with the
+ * second data long (the opcode of most messages) set to data1, sent to
+ * win leaving other events in the queue.
+ */
+bool
+X11::checkClientMessage(Window win, Atom message_type, long data1,
+			XEvent *ev)
+{
+	ClientMessageMatch match = { win, message_type, data1 };
+	return XCheckIfEvent(_dpy, ev, matchClientMessage,
+			     reinterpret_cast<XPointer>(&match));
+}
+
 void
 X11::sync(Bool discard)
 {
 	if (_dpy) {
+		X11_STAT("sync", ROUND_TRIP);
 		XSync(X11::getDpy(), discard);
 	}
 }
@@ -2213,6 +2817,7 @@ int
 X11::selectInput(Window w, long mask)
 {
 	if (_dpy) {
+		X11_STAT("selectInput", REQUEST);
 		return XSelectInput(_dpy, w, mask);
 	}
 	return 0;
@@ -2221,6 +2826,7 @@ X11::selectInput(Window w, long mask)
 void
 X11::setInputFocus(Window w)
 {
+	X11_STAT("setInputFocus", REQUEST);
 	XSetInputFocus(_dpy, w, RevertToPointerRoot, CurrentTime);
 }
 
@@ -2366,6 +2972,10 @@ XModifierKeymap *X11::_modifier_map;
 bool X11::_has_extension_shape = false;
 int X11::_event_shape = -1;
 bool X11::_has_extension_xdbe = false;
+bool X11::_has_extension_shm = false;
+bool X11::_shm_verified = false;
+bool X11::_has_extension_xrender = false;
+bool X11::_use_xrender = true;
 bool X11::_has_extension_xkb = false;
 bool X11::_has_extension_xinerama = false;
 bool X11::_has_extension_xrandr = false;
@@ -2381,5 +2991,6 @@ std::vector<X11::ColorEntry*> X11::_colors;
 XColor X11::_xc_default;
 Cursor X11::_cursor_map[CURSOR_NONE];
 XrmDatabase X11::_xrm_db = 0;
+std::map<Atom, ulong> X11::_property_size_hint;
 std::map<std::string, std::string> X11::_ref_resources =
 	std::map<std::string, std::string>();
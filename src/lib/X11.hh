@@ -27,6 +27,7 @@ extern "C" {
 #include <X11/keysym.h>
 #include <X11/keysymdef.h>
 #include <X11/Xresource.h>
+#include <time.h>
 #ifdef PEKWM_HAVE_XINERAMA
 #include <X11/extensions/Xinerama.h>
 #endif // PEKWM_HAVE_XINERAMA
@@ -46,6 +47,14 @@ extern "C" {
 #else // ! PEKWM_HAVE_XDBE
 typedef int XdbeBackBuffer;
 #endif // PEKWM_HAVE_XDBE
+#ifdef PEKWM_HAVE_SHM
+#include <X11/extensions/XShm.h>
+#endif // PEKWM_HAVE_SHM
+#ifdef PEKWM_HAVE_XRENDER
+#include <X11/extensions/Xrender.h>
+#else // ! PEKWM_HAVE_XRENDER
+typedef XID Picture;
+#endif // PEKWM_HAVE_XRENDER
 
 	extern bool xerrors_ignore; /**< If true, ignore X errors. */
 	extern unsigned int xerrors_count; /**< Number of X errors occured. */
@@ -129,6 +138,9 @@ enum AtomName {
 	PEKWM_BG_PID,
 	PEKWM_CMD,
 	PEKWM_THEME,
+	PEKWM_DEBUG_DUMP,
+	PEKWM_ICON,
+	PEKWM_ICON_SIZE,
 
 	// ICCCM Atom Names
 	WM_NAME,
@@ -218,6 +230,16 @@ enum XEmbedFlags {
 	XEMBED_FLAG_MAPPED = 1 << 0
 };
 
+/**
+ * Repeat of XRender pictures used as composite source outside of their
+ * size, pad repeats the edge pixels.
+ */
+enum RenderRepeat {
+	RENDER_REPEAT_NONE,
+	RENDER_REPEAT_NORMAL,
+	RENDER_REPEAT_PAD
+};
+
 /**
  * Bitmask values for parseGeometry result.
  */
@@ -328,6 +350,9 @@ class X11
 	    named in X11/X.h. */
 	static const unsigned KbdLayoutMask1 = 1<<13;
 	static const unsigned KbdLayoutMask2 = 1<<14;
+	/** Smallest image, in bytes, transferred using MIT-SHM. Below
+	    this the segment setup costs more than the copy. */
+	static const uint SHM_IMAGE_MIN_SIZE = 64 * 1024;
 
 public:
 	static void init(Display *dpy,
@@ -353,6 +378,13 @@ public:
 	static XdbeBackBuffer xdbeAllocBackBuffer(Window win);
 	static void xdbeFreeBackBuffer(XdbeBackBuffer buf);
 	static void xdbeSwapBackBuffer(Window win);
+	static bool hasExtensionShm(void) { return _has_extension_shm; }
+	/** true if XRender is available and not disabled. */
+	static bool hasExtensionXRender(void) {
+		return _has_extension_xrender && _use_xrender;
+	}
+	/** Enable or disable use of XRender, ignored if unavailable. */
+	static void setUseXRender(bool use) { _use_xrender = use; }
 
 	static bool updateGeometry(uint width, uint height);
 	static Cursor getCursor(CursorType type) { return _cursor_map[type]; }
@@ -413,6 +445,7 @@ public:
 	static int pending(void);
 
 	static bool getNextEvent(XEvent &ev, struct timeval *timeout = nullptr);
+	static const struct timespec &getEventReadTime(void);
 	static void allowEvents(int event_mode, Time time);
 	static bool grabServer(void);
 	static bool ungrabServer(bool sync);
@@ -525,6 +558,8 @@ public:
 	static bool maskEvent(long event_mask, XEvent *ev);
 	static bool checkTypedEvent(int type, XEvent *ev);
 	static bool checkTypedWindowEvent(Window win, int type, XEvent *ev);
+	static bool checkClientMessage(Window win, Atom message_type,
+				       long data1, XEvent *ev);
 
 	static void sync(Bool discard);
 
@@ -561,6 +596,24 @@ public:
 			     int src_x, int src_y, int dest_x, int dest_y,
 			     uint width, uint height);
 	static void destroyImage(XImage *ximage);
+	static XImage *createShmImage(uint width, uint height);
+	static bool isShmImage(const XImage *ximage);
+	static Picture renderCreatePicture(Drawable draw);
+	static Picture renderCreateArgbPicture(const uchar *data,
+					       uint width, uint height);
+	static void renderFreePicture(Picture pic);
+	static Pixmap createArgbPixmap(const uchar *data,
+				       uint width, uint height);
+	static bool readArgbPixmap(Pixmap pix, uint width, uint height,
+				   uchar *data);
+	static void renderSetPictureScale(Picture pic,
+					  uint src_width, uint src_height,
+					  uint dst_width, uint dst_height);
+	static void renderSetPictureRepeat(Picture pic, RenderRepeat repeat);
+	static void renderComposite(Picture src, Picture dst,
+				    int src_x, int src_y,
+				    int dst_x, int dst_y,
+				    uint width, uint height);
 	static void copyArea(Drawable src, Drawable dst, int src_x, int src_y,
 			     unsigned int width, unsigned int height,
 			     int dest_x, int dest_y);
@@ -626,6 +679,10 @@ private:
 	static bool _has_extension_shape;
 	static int _event_shape;
 	static bool _has_extension_xdbe;
+	static bool _has_extension_shm;
+	static bool _shm_verified;
+	static bool _has_extension_xrender;
+	static bool _use_xrender;
 	static bool _has_extension_xkb;
 	static bool _has_extension_xinerama;
 	static bool _has_extension_xrandr;
@@ -648,6 +705,8 @@ private:
 	static XColor _xc_default; // when allocating fails
 	static XrmDatabase _xrm_db;
 	static std::map<std::string, std::string> _ref_resources;
+	/** Size, in 32-bit units, of the last property read per atom. */
+	static std::map<Atom, ulong> _property_size_hint;
 
 	static Atom _atoms[MAX_NR_ATOMS];
 };
@@ -0,0 +1,223 @@
+//
+// X11Stats.cc for pekwm
+// Copyright (C) 2023 Claes Nästén <pekdon@gmail.com>
+//
+// This program is licensed under the GNU GPL.
+// See the LICENSE file for more information.
+//
+
+#include "Compat.hh"
+#include "Trace.hh"
+#include "X11Stats.hh"
+
+#include <algorithm>
+#include <cstring>
+#include <iomanip>
+
+namespace X11Stats
+{
+	static bool _enabled = true;
+	static uint _event = EVENT_NONE;
+	static Site *_sites = nullptr;
+	static Site *_sites_last = nullptr;
+	static uint _totals[TYPE_NO] = { 0, 0 };
+	static ulong _total_bytes = 0;
+
+	static const char *_type_names[] = {
+		"request", "round-trip"
+	};
+
+	Site::Site(const char *name, Type type)
+		: _name(name),
+		  _type(type),
+		  _count(0),
+		  _bytes(0),
+		  _next(nullptr)
+	{
+		memset(_events, 0, sizeof(_events));
+		if (_sites_last) {
+			_sites_last->_next = this;
+		} else {
+			_sites = this;
+		}
+		_sites_last = this;
+	}
+
+	/**
+	 * Get number of requests made from scope kind and type.
+	 */
+	uint
+	Site::getScopeCount(uint kind, uint type) const
+	{
+		std::map<uint, uint>::const_iterator it =
+			_scopes.find(kind * Trace::TYPE_MAX + type);
+		return it == _scopes.end() ? 0 : it->second;
+	}
+
+	void
+	Site::inc(ulong bytes)
+	{
+		if (_enabled) {
+			_count++;
+			_events[_event]++;
+			uint kind = Trace::getScopeKind();
+			if (kind < Trace::KIND_NO) {
+				uint type = std::min(Trace::getScopeType(),
+						     Trace::TYPE_MAX - 1);
+				_scopes[kind * Trace::TYPE_MAX + type]++;
+			}
+			_bytes += bytes;
+			_totals[_type]++;
+			if (_type == ROUND_TRIP) {
+				_total_bytes += bytes;
+			}
+		}
+	}
+
+	void
+	Site::reset(void)
+	{
+		_count = 0;
+		_bytes = 0;
+		memset(_events, 0, sizeof(_events));
+		_scopes.clear();
+	}
+
+	bool
+	isEnabled(void)
+	{
+		return _enabled;
+	}
+
+	void
+	setEnabled(bool enabled)
+	{
+		_enabled = enabled;
+	}
+
+	void
+	reset(void)
+	{
+		for (Site *site = _sites; site; site = site->getNext()) {
+			site->reset();
+		}
+		memset(_totals, 0, sizeof(_totals));
+		_total_bytes = 0;
+	}
+
+	/**
+	 * Set type of the event being handled, requests made until the
+	 * next call are accounted to it. Use -1 outside of events.
+	 */
+	void
+	setEvent(int type)
+	{
+		if (type < 0 || type >= static_cast<int>(EVENT_NONE)) {
+			_event = EVENT_NONE;
+		} else {
+			_event = type;
+		}
+	}
+
+	int
+	getEvent(void)
+	{
+		return _event == EVENT_NONE ? -1 : static_cast<int>(_event);
+	}
+
+	/**
+	 * Get total number of requests of type.
+	 */
+	uint
+	getCount(Type type)
+	{
+		return _totals[type];
+	}
+
+	/**
+	 * Get number of requests made from site name.
+	 */
+	uint
+	getCount(const char *name)
+	{
+		uint count = 0;
+		for (Site *site = _sites; site; site = site->getNext()) {
+			if (strcmp(site->getName(), name) == 0) {
+				count += site->getCount();
+			}
+		}
+		return count;
+	}
+
+	/**
+	 * Get total number of bytes received in replies, only counted for
+	 * sites reading properties.
+	 */
+	ulong
+	getBytes(void)
+	{
+		return _total_bytes;
+	}
+
+	static void
+	dumpScopes(std::ostream &os, const Site *site)
+	{
+		std::map<uint, uint>::const_iterator it =
+			site->getScopes().begin();
+		for (; it != site->getScopes().end(); ++it) {
+			Trace::Kind kind =
+				static_cast<Trace::Kind>(it->first
+							 / Trace::TYPE_MAX);
+			uint type = it->first % Trace::TYPE_MAX;
+			os << " " << Trace::getScopeName(kind, type)
+			   << "=" << it->second;
+		}
+	}
+
+	/**
+	 * Write totals followed by the count per site, round trips
+	 * first, with the events the requests were made while handling
+	 * and the scopes they were made from.
+	 */
+	void
+	dump(std::ostream &os, void*)
+	{
+		os << "x11 " << (_enabled ? "enabled" : "disabled")
+		   << ", " << getCount(REQUEST) << " requests, "
+		   << getCount(ROUND_TRIP) << " round trips, "
+		   << _total_bytes << " bytes received" << std::endl;
+		os << std::left << std::setw(11) << "type"
+		   << std::setw(28) << "site" << std::right
+		   << std::setw(8) << "count" << std::setw(10) << "bytes"
+		   << "  events, scopes" << std::endl;
+
+		for (int type = TYPE_NO - 1; type >= 0; type--) {
+			Site *site = _sites;
+			for (; site; site = site->getNext()) {
+				if (site->getType() != type
+				    || site->getCount() == 0) {
+					continue;
+				}
+
+				os << std::left << std::setw(11)
+				   << _type_names[type]
+				   << std::setw(28) << site->getName()
+				   << std::right << std::setw(8)
+				   << site->getCount() << std::setw(10)
+				   << site->getBytes() << " ";
+				for (uint ev = 0; ev < EVENT_TYPES; ev++) {
+					uint count = site->getCount(ev);
+					if (count == 0) {
+						continue;
+					}
+					os << " " << (ev == EVENT_NONE
+						      ? "none"
+						      : Trace::getEventName(ev))
+					   << "=" << count;
+				}
+				dumpScopes(os, site);
+				os << std::endl;
+			}
+		}
+	}
+}
@@ -0,0 +1,110 @@
+//
+// X11Stats.hh for pekwm
+// Copyright (C) 2023 Claes Nästén <pekdon@gmail.com>
+//
+// This program is licensed under the GNU GPL.
+// See the LICENSE file for more information.
+//
+
+#ifndef _PEKWM_X11_STATS_HH_
+#define _PEKWM_X11_STATS_HH_
+
+#include "config.h"
+
+#include "Types.hh"
+
+#include <map>
+#include <ostream>
+
+extern "C" {
+#include <X11/X.h>
+}
+
+/**
+ * Counters for requests sent to the X server through the X11 wrappers,
+ * classified as asynchronous requests or blocking round trips waiting
+ * for a reply. Each wrapper is a site, counting calls per type of the
+ * event being handled and per innermost Trace::Scope, the dispatch,
+ * action or rendering, the request was made from.
+ */
+namespace X11Stats
+{
+	enum Type {
+		REQUEST,
+		ROUND_TRIP,
+		TYPE_NO
+	};
+
+	/** Number of event types, the last slot is used outside events. */
+	static const uint EVENT_TYPES = LASTEvent + 1;
+	static const uint EVENT_NONE = EVENT_TYPES - 1;
+
+	class Site {
+	public:
+		Site(const char *name, Type type);
+
+		const char *getName(void) const { return _name; }
+		Type getType(void) const { return _type; }
+		uint getCount(void) const { return _count; }
+		uint getCount(uint event) const { return _events[event]; }
+		uint getScopeCount(uint kind, uint type) const;
+		const std::map<uint, uint> &getScopes(void) const {
+			return _scopes;
+		}
+		ulong getBytes(void) const { return _bytes; }
+		Site *getNext(void) const { return _next; }
+
+		void inc(ulong bytes = 0);
+		void reset(void);
+
+	private:
+		const char *_name;
+		Type _type;
+		uint _count;
+		uint _events[EVENT_TYPES];
+		/** Count per scope, kind * Trace::TYPE_MAX + type. */
+		std::map<uint, uint> _scopes;
+		/**
+		 * Bytes received in replies for round trips, bytes
+		 * transferred for requests, if counted for the site.
+		 */
+		ulong _bytes;
+		/** Next site, sites form a list in registration order. */
+		Site *_next;
+	};
+
+	bool isEnabled(void);
+	void setEnabled(bool enabled);
+	void reset(void);
+
+	void setEvent(int type);
+	int getEvent(void);
+
+	uint getCount(Type type);
+	uint getCount(const char *name);
+	ulong getBytes(void);
+
+	void dump(std::ostream &os, void *opaque);
+}
+
+#ifdef PEKWM_HAVE_X11_STATS
+/**
+ * Count call as a request of type, X11Stats::REQUEST or
+ * X11Stats::ROUND_TRIP, using a site named name.
+ */
+#define X11_STAT(name, type) X11_STAT_BYTES(name, type, 0)
+/**
+ * Count call as X11_STAT, adding bytes received in the reply or, for
+ * requests, the bytes transferred.
+ */
+#define X11_STAT_BYTES(name, type, bytes)				\
+	do {								\
+		static X11Stats::Site _x11_stats_site(name, X11Stats::type); \
+		_x11_stats_site.inc(bytes);				\
+	} while (0)
+#else // ! PEKWM_HAVE_X11_STATS
+#define X11_STAT(name, type)
+#define X11_STAT_BYTES(name, type, bytes)
+#endif // PEKWM_HAVE_X11_STATS
+
+#endif // _PEKWM_X11_STATS_HH_
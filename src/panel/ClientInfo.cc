@@ -18,7 +18,7 @@ ClientInfo::ClientInfo(Window window)
 	  _name(readName()),
 	  _gm(readGeometry()),
 	  _workspace(readWorkspace()),
-	  _icon(PImageIcon::newFromWindow(window))
+	  _icon(readIcon())
 
 {
 	X11::selectInput(_window, PropertyChangeMask);
@@ -42,6 +42,10 @@ ClientInfo::handlePropertyNotify(XPropertyEvent *ev)
 		_workspace = readWorkspace();
 	} else if (ev->atom == X11::getAtom(STATE)) {
 		X11Util::readEwmhStates(_window, *this);
+	} else if (ev->atom == X11::getAtom(PEKWM_ICON)
+		   || ev->atom == X11::getAtom(NET_WM_ICON)) {
+		delete _icon;
+		_icon = readIcon();
 	} else {
 		return false;
 	}
@@ -64,6 +68,20 @@ ClientInfo::readName(void)
 	return _empty_string;
 }
 
+/**
+ * Read icon shared by pekwm, falling back to reading _NET_WM_ICON if
+ * pekwm does not share icons.
+ */
+PImageIcon*
+ClientInfo::readIcon(void)
+{
+	PImageIcon *icon = PImageIcon::newFromShared(_window);
+	if (icon == nullptr) {
+		icon = PImageIcon::newFromWindow(_window);
+	}
+	return icon;
+}
+
 uint
 ClientInfo::readWorkspace(void)
 {
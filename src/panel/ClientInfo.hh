@@ -31,6 +31,7 @@ public:
 
 private:
 	std::string readName(void);
+	PImageIcon *readIcon(void);
 	Geometry readGeometry(void) { return Geometry(); }
 	uint readWorkspace(void);
 
@@ -22,11 +22,29 @@ ClientListWidget::ClientListWidget(const PWinObj* parent,
 						   draw_separator))
 {
 	pekwm::observerMapping()->addObserver(&_wm_state, this);
+
+	// let pekwm share client icons in the size they are drawn in. The
+	// size is global, with multiple panels the last started sets it and
+	// the others scale the shared icons when drawing.
+	if (_theme.getHeight() > 2) {
+		X11::setCardinal(X11::getRoot(), PEKWM_ICON_SIZE,
+				 _theme.getHeight() - 2);
+	}
 }
 
 ClientListWidget::~ClientListWidget(void)
 {
 	pekwm::observerMapping()->removeObserver(&_wm_state, this);
+
+	// stop pekwm from sharing icons nobody reads, unless another panel
+	// has set a different size since. The property is not reference
+	// counted, a panel with the same size loses sharing.
+	Cardinal size;
+	if (_theme.getHeight() > 2
+	    && X11::getCardinal(X11::getRoot(), PEKWM_ICON_SIZE, size)
+	    && size == static_cast<Cardinal>(_theme.getHeight() - 2)) {
+		X11::unsetProperty(X11::getRoot(), PEKWM_ICON_SIZE);
+	}
 }
 
 void
@@ -13,10 +13,12 @@
 /** empty string, used as default return value. */
 static std::string _empty_string;
 
-static Util::StringTo<PanelPlacement> panel_placement_map[] =
+static Util::StringTo<PanelPlacement> panel_placement_map_entries[] =
 	{{"TOP", PANEL_TOP},
 	 {"BOTTOM", PANEL_BOTTOM},
 	 {nullptr, PANEL_TOP}};
+static Util::StringToIndex<PanelPlacement>
+	panel_placement_map(panel_placement_map_entries);
 
 
 // WidgetConfig
@@ -151,26 +151,80 @@ SystrayWidget::handleXEvent(XEvent* ev)
 	}
 }
 
-SystrayWidget::Client*
-SystrayWidget::addTrayIcon(Window win)
+/**
+ * Collect dock requests already queued for the owner window, making a
+ * burst of requests (tray applications started before the panel) be
+ * added in one pass.
+ */
+void
+SystrayWidget::collectDockRequests()
+{
+	// only take dock requests from the queue, other opcodes such as
+	// SYSTEM_TRAY_CANCEL_MESSAGE must stay ordered after the
+	// messages queued before them and go through the regular
+	// dispatch.
+	XEvent ev;
+	Atom opcode = X11::getAtom(NET_SYSTEM_TRAY_OPCODE);
+	while (X11::checkClientMessage(_owner, opcode,
+				       SYSTEM_TRAY_REQUEST_DOCK, &ev)) {
+		handleSystemTrayOpcode(ev.xclient.data.l[1],
+				       ev.xclient.data.l[2]);
+	}
+}
+
+/**
+ * Add all pending tray icons. _XEMBED_INFO is read for all icons before
+ * any of them are reparented, and layout is only updated once when all
+ * icons have been added.
+ */
+void
+SystrayWidget::addTrayIcons()
 {
-	P_TRACE("systray: add tray icon " << win);
+	client_vector clients;
+	std::vector<Window>::iterator wit = _pending_docks.begin();
+	for (; wit != _pending_docks.end(); ++wit) {
+		if (findClient(*wit) != nullptr) {
+			P_DBG("systray: " << *wit << " already docked");
+			continue;
+		}
+
+		bool duplicate = false;
+		client_it cit = clients.begin();
+		for (; ! duplicate && cit != clients.end(); ++cit) {
+			duplicate = (*cit)->getWindow() == *wit;
+		}
+		if (duplicate) {
+			continue;
+		}
+
+		P_TRACE("systray: add tray icon " << *wit);
+		SystrayWidget::Client* client = new SystrayWidget::Client(*wit);
+		readXEmbedInfo(client);
+		clients.push_back(client);
+	}
+	_pending_docks.clear();
+
+	if (clients.empty()) {
+		return;
+	}
 
 	int x = getX() + (numClientsMapped() * _theme.getHeight());
-	int y = 0;
-	SystrayWidget::Client* client = new SystrayWidget::Client(win);
-	readXEmbedInfo(client);
+	client_it it = clients.begin();
+	for (; it != clients.end(); ++it) {
+		X11::reparentWindow((*it)->getWindow(), _parent->getWindow(),
+				    x, 0);
+		if ((*it)->isMapped()) {
+			P_TRACE("systray: mapping client "
+				<< (*it)->getWindow());
+			X11::mapRaised((*it)->getWindow());
+			x += _theme.getHeight();
+		}
 
-	X11::reparentWindow(client->getWindow(), _parent->getWindow(), x, y);
-	if (client->isMapped()) {
-		P_TRACE("systray: mapping client " << client->getWindow());
-		X11::mapRaised(client->getWindow());
+		_clients.push_back(*it);
+		notifyTrayIcon(*it);
 	}
 
-	_clients.push_back(client);
 	sendRequiredSizeChanged();
-
-	return client;
 }
 
 /**
@@ -313,7 +367,13 @@ SystrayWidget::handleClientMessage(XClientMessageEvent* ev)
 	if (ev->message_type != X11::getAtom(NET_SYSTEM_TRAY_OPCODE)) {
 		return false;
 	}
-	return handleSystemTrayOpcode(ev->data.l[1], ev->data.l[2]);
+
+	bool handled = handleSystemTrayOpcode(ev->data.l[1], ev->data.l[2]);
+	if (! _pending_docks.empty()) {
+		collectDockRequests();
+		addTrayIcons();
+	}
+	return handled;
 }
 
 /**
@@ -352,8 +412,7 @@ SystrayWidget::handleSystemTrayOpcode(long opcode, long win)
 	switch (opcode) {
 	case SYSTEM_TRAY_REQUEST_DOCK: {
 		P_TRACE("systray: SYSTEM_TRAY_REQUEST_DOCK " << win);
-		SystrayWidget::Client* client = addTrayIcon(win);
-		notifyTrayIcon(client);
+		_pending_docks.push_back(win);
 		return true;
 	}
 	case SYSTEM_TRAY_BEGIN_MESSAGE:
@@ -63,7 +63,8 @@ public:
 	virtual bool handleXEvent(XEvent* ev);
 
 private:
-	SystrayWidget::Client* addTrayIcon(Window win);
+	void collectDockRequests();
+	void addTrayIcons();
 	void notifyTrayIcon(SystrayWidget::Client* client);
 	void removeTrayIcon(SystrayWidget::Client* client,
 			    bool reparent);
@@ -92,6 +93,8 @@ private:
 
 	/** Clients in the systray */
 	client_vector _clients;
+	/** Windows requesting to be docked, not yet added. */
+	std::vector<Window> _pending_docks;
 };
 
 #endif // _PEKWM_PANEL_SYSTRAY_WIDGET_HH_
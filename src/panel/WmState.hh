@@ -21,9 +21,13 @@ class WmState : public Observable
 {
 public:
 	class XROOTPMAP_ID_Changed : public Observation {
+	public:
+		virtual bool canCoalesce(void) const { return true; }
 	};
 
 	class PEKWM_THEME_Changed : public Observation {
+	public:
+		virtual bool canCoalesce(void) const { return true; }
 	};
 
 	typedef std::vector<ClientInfo*> client_info_vector;
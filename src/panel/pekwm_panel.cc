@@ -182,7 +182,7 @@ private:
 	{
 		X11::setLastEventTime(ev->time);
 		if (_wm_state.handlePropertyNotify(ev)) {
-			render();
+			_render_pending = true;
 		}
 	}
 
@@ -253,6 +253,8 @@ private:
 	WmState _wm_state;
 	std::vector<PanelWidget*> _widgets;
 	uint _widgets_visible;
+	/** Set when dirty widgets should be rendered at the next refresh. */
+	bool _render_pending;
 
 	Pixmap _pixmap;
 };
@@ -270,6 +272,7 @@ PekwmPanel::PekwmPanel(const PanelConfig &cfg, PanelTheme &theme,
 	  _ext_data(cfg, _var_data),
 	  _wm_state(_var_data),
 	  _widgets_visible(0),
+	  _render_pending(false),
 	  _pixmap(X11::createPixmap(sh->width, sh->height))
 {
 	X11::selectInput(_window,
@@ -378,7 +381,9 @@ PekwmPanel::notify(Observable*, Observation *observation)
 		resizeWidgets();
 		renderPred(renderPredAlways, nullptr);
 	} else {
-		renderPred(renderPredDirty, nullptr);
+		// render once all observers have been notified, widgets
+		// observing the same object get notified after the panel.
+		_render_pending = true;
 	}
 }
 
@@ -388,7 +393,10 @@ PekwmPanel::refresh(bool timed_out)
 	_ext_data.refresh(ppAddFd, reinterpret_cast<void*>(this));
 	if (timed_out) {
 		renderPred(renderPredAlways, nullptr);
+	} else if (_render_pending) {
+		render();
 	}
+	_render_pending = false;
 }
 
 void
@@ -566,6 +574,7 @@ PekwmPanel::renderPred(renderPredFun pred, void *opaque)
 	PTexture *handle = _theme.getHandle();
 
 	int x = handle ? handle->getWidth() : 0;
+	bool damaged = false;
 	PanelWidget *last_widget = _widgets.back();
 	X11Render rend(getRenderDrawable(), getRenderBackground());
 	std::vector<PanelWidget*>::iterator it = _widgets.begin();
@@ -577,6 +586,8 @@ PekwmPanel::renderPred(renderPredFun pred, void *opaque)
 		bool do_render = pred(*it, opaque);
 		if (do_render) {
 			(*it)->render(rend);
+			addDamage(x, 0, (*it)->getWidth(), _gm.height);
+			damaged = true;
 		}
 		x += (*it)->getWidth();
 
@@ -584,12 +595,17 @@ PekwmPanel::renderPred(renderPredFun pred, void *opaque)
 			if (do_render) {
 				sep->render(rend, x, 0,
 					    sep->getWidth(), sep->getHeight());
+				addDamage(x, 0, sep->getWidth(), _gm.height);
 			}
 			x += sep->getWidth();
 		}
 	}
 
-	swapBuffer();
+	// only copy the rendered widgets to the window, nothing changed
+	// if no widget was rendered.
+	if (damaged) {
+		swapBuffer();
+	}
 }
 
 void
@@ -627,6 +643,9 @@ static bool loadConfig(PanelConfig& cfg, const std::string& file)
 static void init(Display* dpy)
 {
 	_observer_mapping = new ObserverMapping();
+	// coalesce WmState notifications during bursts of PropertyNotify
+	// events, flushed by the main loop once all events are processed.
+	_observer_mapping->setDeferred(true);
 	// options setup in loadTheme later on
 	_font_handler = new FontHandler(false, "");
 	_image_handler = new ImageHandler();
@@ -86,6 +86,8 @@ private:
  * Notification sent when the required size of a widget is changed.
  */
 class RequiredSizeChanged : public Observation {
+public:
+	virtual bool canCoalesce(void) const { return true; }
 };
 
 #endif // _PEKWM_PANEL_HH_
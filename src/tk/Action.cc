@@ -24,7 +24,7 @@ const int ANY_MASK =
 	BUTTONCLICK_OK|WINDOWMENU_OK|ROOTMENU_OK|SCREEN_EDGE_OK|
 	CMD_OK;
 
-static Util::StringTo<std::pair<ActionType, uint> > action_map[] =
+static Util::StringTo<std::pair<ActionType, uint> > action_map_entries[] =
 	{{"Focus", action_pair(ACTION_FOCUS, ANY_MASK)},
 	 {"UnFocus", action_pair(ACTION_UNFOCUS, ANY_MASK)},
 	 {"Set", action_pair(ACTION_SET, ANY_MASK)},
@@ -120,8 +120,10 @@ static Util::StringTo<std::pair<ActionType, uint> > action_map[] =
 	 {"SetOpacity", action_pair(ACTION_SET_OPACITY, FRAME_MASK|CMD_OK)},
 	 {"Debug", action_pair(ACTION_DEBUG, ANY_MASK)},
 	 {nullptr, action_pair(ACTION_NO, 0)}};
+static Util::StringToIndex<std::pair<ActionType, uint> >
+	action_map(action_map_entries);
 
-static Util::StringTo<ActionStateType> action_state_map[] =
+static Util::StringTo<ActionStateType> action_state_map_entries[] =
 	{{"Maximized", ACTION_STATE_MAXIMIZED},
 	 {"Fullscreen", ACTION_STATE_FULLSCREEN},
 	 {"Shaded", ACTION_STATE_SHADED},
@@ -141,8 +143,10 @@ static Util::StringTo<ActionStateType> action_state_map[] =
 	 {"HarbourHidden", ACTION_STATE_HARBOUR_HIDDEN},
 	 {"GlobalGrouping", ACTION_STATE_GLOBAL_GROUPING},
 	 {nullptr, ACTION_STATE_NO}};
+static Util::StringToIndex<ActionStateType>
+	action_state_map(action_state_map_entries);
 
-static Util::StringTo<BorderPosition> borderpos_map[] =
+static Util::StringTo<BorderPosition> borderpos_map_entries[] =
 	{{"TOPLEFT", BORDER_TOP_LEFT},
 	 {"TOP", BORDER_TOP},
 	 {"TOPRIGHT", BORDER_TOP_RIGHT},
@@ -152,8 +156,9 @@ static Util::StringTo<BorderPosition> borderpos_map[] =
 	 {"BOTTOM", BORDER_BOTTOM},
 	 {"BOTTOMRIGHT", BORDER_BOTTOM_RIGHT},
 	 {nullptr, BORDER_NO_POS}};
+static Util::StringToIndex<BorderPosition> borderpos_map(borderpos_map_entries);
 
-static Util::StringTo<CfgDeny> cfg_deny_map[] =
+static Util::StringTo<CfgDeny> cfg_deny_map_entries[] =
 	{{"POSITION", CFG_DENY_POSITION},
 	 {"SIZE", CFG_DENY_SIZE},
 	 {"STACKING", CFG_DENY_STACKING},
@@ -167,15 +172,17 @@ static Util::StringTo<CfgDeny> cfg_deny_map[] =
 	 {"STRUT", CFG_DENY_STRUT},
 	 {"RESIZEINC", CFG_DENY_RESIZE_INC},
 	 {nullptr, CFG_DENY_NO}};
+static Util::StringToIndex<CfgDeny> cfg_deny_map(cfg_deny_map_entries);
 
-static Util::StringTo<DirectionType> direction_map[] =
+static Util::StringTo<DirectionType> direction_map_entries[] =
 	{{"UP", DIRECTION_UP},
 	 {"DOWN", DIRECTION_DOWN},
 	 {"LEFT", DIRECTION_LEFT},
 	 {"RIGHT", DIRECTION_RIGHT},
 	 {nullptr, DIRECTION_NO}};
+static Util::StringToIndex<DirectionType> direction_map(direction_map_entries);
 
-static Util::StringTo<OrientationType> edge_map[] =
+static Util::StringTo<OrientationType> edge_map_entries[] =
 	{{"TOPLEFT", TOP_LEFT},
 	 {"TOPEDGE", TOP_EDGE},
 	 {"TOPCENTEREDGE", TOP_CENTER_EDGE},
@@ -190,8 +197,9 @@ static Util::StringTo<OrientationType> edge_map[] =
 	 {"RIGHTCENTEREDGE", RIGHT_CENTER_EDGE},
 	 {"CENTER", CENTER},
 	 {nullptr, NO_EDGE}};
+static Util::StringToIndex<OrientationType> edge_map(edge_map_entries);
 
-static Util::StringTo<Layer> layer_map[] =
+static Util::StringTo<Layer> layer_map_entries[] =
 	{{"DESKTOP", LAYER_DESKTOP},
 	 {"BELOW", LAYER_BELOW},
 	 {"NORMAL", LAYER_NORMAL},
@@ -200,8 +208,9 @@ static Util::StringTo<Layer> layer_map[] =
 	 {"ABOVEHARBOUR", LAYER_ABOVE_DOCK},
 	 {"MENU", LAYER_MENU},
 	 {nullptr, LAYER_NONE}};
+static Util::StringToIndex<Layer> layer_map(layer_map_entries);
 
-static Util::StringTo<uint> mod_map[] =
+static Util::StringTo<uint> mod_map_entries[] =
 	{{"NONE", 0},
 	 {"SHIFT", ShiftMask},
 	 {"CTRL", ControlMask},
@@ -212,23 +221,26 @@ static Util::StringTo<uint> mod_map[] =
 	 {"MOD5", Mod5Mask},
 	 {"ANY", MOD_ANY},
 	 {nullptr, 0}};
+static Util::StringToIndex<uint> mod_map(mod_map_entries);
 
-static Util::StringTo<Raise> raise_map[] =
+static Util::StringTo<Raise> raise_map_entries[] =
 	{{"ALWAYSRAISE", ALWAYS_RAISE},
 	 {"ENDRAISE", END_RAISE},
 	 {"NEVP_ERRAISE", NEVER_RAISE},
 	 {"TEMPRAISE", TEMP_RAISE},
 	 {nullptr, NO_RAISE}};
+static Util::StringToIndex<Raise> raise_map(raise_map_entries);
 
-static Util::StringTo<Skip> skip_map[] =
+static Util::StringTo<Skip> skip_map_entries[] =
 	{{"MENUS", SKIP_MENUS},
 	 {"FOCUSTOGGLE", SKIP_FOCUS_TOGGLE},
 	 {"SNAP", SKIP_SNAP},
 	 {"PAGER", SKIP_PAGER},
 	 {"TASKBAR", SKIP_TASKBAR},
 	 {nullptr, SKIP_NONE}};
+static Util::StringToIndex<Skip> skip_map(skip_map_entries);
 
-static Util::StringTo<WorkspaceChangeType> workspace_change_map[] =
+static Util::StringTo<WorkspaceChangeType> workspace_change_map_entries[] =
 	{{"LEFT", WORKSPACE_LEFT},
 	 {"LEFTN", WORKSPACE_LEFT_N},
 	 {"PREV", WORKSPACE_PREV},
@@ -243,13 +255,17 @@ static Util::StringTo<WorkspaceChangeType> workspace_change_map[] =
 	 {"DOWN", WORKSPACE_DOWN},
 	 {"LAST", WORKSPACE_LAST},
 	 {nullptr, WORKSPACE_NO}};
+static Util::StringToIndex<WorkspaceChangeType>
+	workspace_change_map(workspace_change_map_entries);
 
-static Util::StringTo<FocusSelector> focus_selector_map[] =
+static Util::StringTo<FocusSelector> focus_selector_map_entries[] =
 	{{"POINTER", FOCUS_SELECTOR_POINTER},
 	 {"WORKSPACELASTFOCUSED", FOCUS_SELECTOR_WORKSPACE_LAST_FOCUSED},
 	 {"TOP", FOCUS_SELECTOR_TOP},
 	 {"ROOT", FOCUS_SELECTOR_ROOT},
 	 {nullptr, FOCUS_SELECTOR_NO}};
+static Util::StringToIndex<FocusSelector>
+	focus_selector_map(focus_selector_map_entries);
 
 /**
  * Parse WarpToWorkspace, (part of) SendToWorkspace and GotoWorkspace argument.
@@ -878,9 +894,10 @@ namespace ActionConfig {
 	getActionNameList(void)
 	{
 		std::vector<std::string> action_names;
-		for (int i = 0; action_map[i].name != nullptr; i++) {
-			if (action_map[i].value.second&KEYGRABBER_OK) {
-				action_names.push_back(action_map[i].name);
+		for (int i = 0; action_map_entries[i].name != nullptr; i++) {
+			if (action_map_entries[i].value.second&KEYGRABBER_OK) {
+				action_names.push_back(
+					action_map_entries[i].name);
 			}
 		}
 		return action_names;
@@ -890,8 +907,9 @@ namespace ActionConfig {
 	/** Return vector with available state action names. */
 	std::vector<std::string> getStateNameList(void) {
 		std::vector<std::string> state_names;
-		for (int i = 0; action_state_map[i].name != nullptr; i++) {
-			state_names.push_back(action_state_map[i].name);
+		for (int i = 0; action_state_map_entries[i].name != nullptr;
+		     i++) {
+			state_names.push_back(action_state_map_entries[i].name);
 		}
 		return state_names;
 	}
@@ -159,13 +159,16 @@ enum ActionParamUnit {
 
 /**
  * Last byte of data buffer in _PEKWM_CMD messages, indicates if the
- * message is part of a larger message.
+ * message is part of a larger message. PEKWM_CMD_BATCH is set together
+ * with PEKWM_CMD_SINGLE or PEKWM_CMD_MULTI_FIRST on the first message
+ * of a batch of newline separated commands.
  */
 enum PekwmCmdBuf {
 	PEKWM_CMD_SINGLE = 0,
 	PEKWM_CMD_MULTI_FIRST = 1,
 	PEKWM_CMD_MULTI_CONT = 2,
-	PEKWM_CMD_MULTI_END = 3
+	PEKWM_CMD_MULTI_END = 3,
+	PEKWM_CMD_BATCH = 4
 };
 
 // Action Utils
@@ -0,0 +1,69 @@
+//
+// ActionCache.cc for pekwm
+// Copyright (C) 2023 Claes Nästén <pekdon@gmail.com>
+//
+// This program is licensed under the GNU GPL.
+// See the LICENSE file for more information.
+//
+
+#include "ActionCache.hh"
+
+ActionCache::ActionCache(size_t capacity, uint mask)
+	: _capacity(capacity),
+	  _mask(mask),
+	  _hits(0),
+	  _misses(0)
+{
+}
+
+ActionCache::~ActionCache(void)
+{
+}
+
+/**
+ * Parse single action in str into ae, re-using the result of a
+ * previous parse of the same string if available.
+ *
+ * @return true if str is a valid action, else false.
+ */
+bool
+ActionCache::parse(const std::string &str, ActionEvent &ae)
+{
+	entry_map::iterator it = _map.find(str);
+	if (it != _map.end()) {
+		_hits++;
+		if (it->second != _entries.begin()) {
+			_entries.splice(_entries.begin(), _entries,
+					it->second);
+		}
+		ae = it->second->ae;
+		return it->second->ok;
+	}
+
+	_misses++;
+	Action action;
+	bool ok = ActionConfig::parseAction(str, action, _mask);
+	ae.action_list.clear();
+	if (ok) {
+		ae.action_list.push_back(action);
+	}
+
+	if (_capacity == 0) {
+		return ok;
+	}
+	if (_map.size() >= _capacity) {
+		_map.erase(_entries.back().str);
+		_entries.pop_back();
+	}
+	_entries.push_front(Entry(str, ok));
+	_entries.front().ae = ae;
+	_map[str] = _entries.begin();
+	return ok;
+}
+
+void
+ActionCache::clear(void)
+{
+	_entries.clear();
+	_map.clear();
+}
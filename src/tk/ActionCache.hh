@@ -0,0 +1,67 @@
+//
+// ActionCache.hh for pekwm
+// Copyright (C) 2023 Claes Nästén <pekdon@gmail.com>
+//
+// This program is licensed under the GNU GPL.
+// See the LICENSE file for more information.
+//
+
+#ifndef _PEKWM_ACTION_CACHE_HH_
+#define _PEKWM_ACTION_CACHE_HH_
+
+#include "config.h"
+
+#include "Action.hh"
+#include "Types.hh"
+
+#include <list>
+#include <map>
+#include <string>
+
+/**
+ * Bounded, least recently used, cache of parsed action strings. Scripts
+ * driving pekwm through _PEKWM_CMD send the same commands over and over
+ * again, parsing them once saves tokenizing and table lookups per
+ * message. Strings failing to parse are cached as well.
+ */
+class ActionCache {
+public:
+	ActionCache(size_t capacity, uint mask);
+	~ActionCache(void);
+
+	bool parse(const std::string &str, ActionEvent &ae);
+	void clear(void);
+
+	size_t size(void) const { return _map.size(); }
+	size_t capacity(void) const { return _capacity; }
+	ulong getHits(void) const { return _hits; }
+	ulong getMisses(void) const { return _misses; }
+
+private:
+	class Entry {
+	public:
+		Entry(const std::string &str_, bool ok_)
+			: str(str_),
+			  ok(ok_)
+		{
+		}
+
+		std::string str;
+		bool ok;
+		ActionEvent ae;
+	};
+	typedef std::list<Entry> entry_list;
+	typedef std::map<std::string, entry_list::iterator> entry_map;
+
+	size_t _capacity;
+	/** Action mask strings are parsed with. */
+	uint _mask;
+	/** Entries, most recently used first. */
+	entry_list _entries;
+	entry_map _map;
+
+	ulong _hits;
+	ulong _misses;
+};
+
+#endif // _PEKWM_ACTION_CACHE_HH_
@@ -38,7 +38,7 @@
 	"-[*0-9]+-[*0-9]+-[*0-9]+-[*0-9]+" \
 	"-[^-]+-[*0-9]+-[^-]+-[^-]+"
 
-static Util::StringTo<PFont::Type> map_type[] =
+static Util::StringTo<PFont::Type> map_type_entries[] =
 	{{"", PFont::FONT_TYPE_AUTO},
 	 {"X11", PFont::FONT_TYPE_X11},
 	 {"XMB", PFont::FONT_TYPE_XMB},
@@ -48,23 +48,38 @@ static Util::StringTo<PFont::Type> map_type[] =
 	 {"PANGOXFT", PFont::FONT_TYPE_PANGO_XFT},
 	 {"EMPTY", PFont::FONT_TYPE_EMPTY},
 	 {nullptr, PFont::FONT_TYPE_NO}};
+static Util::StringToIndex<PFont::Type> map_type(map_type_entries);
 
-static Util::StringTo<FontJustify> map_justify[] =
+static Util::StringTo<FontJustify> map_justify_entries[] =
 	{{"LEFT", FONT_JUSTIFY_LEFT},
 	 {"CENTER", FONT_JUSTIFY_CENTER},
 	 {"RIGHT", FONT_JUSTIFY_RIGHT},
 	 {nullptr, FONT_JUSTIFY_NO}};
+static Util::StringToIndex<FontJustify> map_justify(map_justify_entries);
+
+/** Number of measured strings kept in the text extent cache. */
+static const size_t EXTENT_CACHE_SIZE = 2048;
+
+static void
+dumpFontHandler(std::ostream &os, void *opaque)
+{
+	reinterpret_cast<FontHandler*>(opaque)->dump(os);
+}
 
 FontHandler::FontHandler(bool default_font_x11,
 			 const std::string &charset_override)
 	: _x11_font_name(X11_FONT_NAME_PATTERN),
 	  _default_font_x11(default_font_x11),
-	  _charset_override(charset_override)
+	  _charset_override(charset_override),
+	  _extent_cache(EXTENT_CACHE_SIZE)
 {
+	Debug::addDump("fonts", dumpFontHandler, this);
 }
 
 FontHandler::~FontHandler(void)
 {
+	Debug::removeDump("fonts");
+
 	std::vector<HandlerEntry<PFont*> >::iterator fit = _fonts.begin();
 	for (; fit != _fonts.end(); ++fit) {
 		delete fit->getData();
@@ -111,6 +126,7 @@ FontHandler::getFont(const std::string &font)
 
 	// fields left for justify and offset
 	parseFontOptions(pfont, tok);
+	pfont->setExtentCache(&_extent_cache);
 
 	// create new entry
 	HandlerEntry<PFont*> entry(font);
@@ -296,6 +312,22 @@ FontHandler::returnFont(const PFont *font)
 	}
 }
 
+/**
+ * Write loaded fonts and text extent cache statistics to os, available
+ * with the Debug dump fonts command.
+ */
+void
+FontHandler::dump(std::ostream &os)
+{
+	os << "fonts: " << _fonts.size() << std::endl;
+	std::vector<HandlerEntry<PFont*> >::iterator it = _fonts.begin();
+	for (; it != _fonts.end(); ++it) {
+		os << "  " << it->getName() << " (" << it->getRef()
+		   << " references)" << std::endl;
+	}
+	_extent_cache.dump(os);
+}
+
 //! @brief Gets or allocs a color
 PFont::Color*
 FontHandler::getColor(const std::string &color)
@@ -14,6 +14,7 @@
 #include "Handler.hh"
 #include "PFont.hh"
 #include "RegexString.hh"
+#include "TextExtentCache.hh"
 
 #include <map>
 #include <string>
@@ -38,6 +39,11 @@ public:
 	PFont::Color *getColor(const std::string &color);
 	void returnColor(const PFont::Color *color);
 
+	const TextExtentCache &getExtentCache(void) const {
+		return _extent_cache;
+	}
+	void dump(std::ostream &os);
+
 protected:
 	bool parseFontOffset(PFont *pfont, const std::string &str);
 	bool parseFontJustify(PFont *pfont, const std::string &str);
@@ -63,6 +69,8 @@ private:
 	std::string _charset_override;
 	std::vector<HandlerEntry<PFont*> > _fonts;
 	std::vector<HandlerEntry<PFont::Color*> > _colors;
+	/** Widths of text measured with any of the fonts in _fonts. */
+	TextExtentCache _extent_cache;
 };
 
 namespace pekwm
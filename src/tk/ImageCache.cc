@@ -0,0 +1,381 @@
+//
+// ImageCache.cc for pekwm
+// Copyright (C) 2023 Claes Nästén <pekdon@gmail.com>
+//
+// This program is licensed under the GNU GPL.
+// See the LICENSE file for more information.
+//
+
+#include "Debug.hh"
+#include "ImageCache.hh"
+#include "PImage.hh"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+#include <iomanip>
+#include <sstream>
+#include <vector>
+
+extern "C" {
+#include <dirent.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/time.h>
+#include <unistd.h>
+}
+
+/** Extension of cache entries, other files in the directory are kept. */
+static const char *ENTRY_EXT = ".argb";
+static const size_t ENTRY_EXT_LEN = 5;
+/** Temporary files, left behind if pekwm exits while storing. */
+static const char *TMP_EXT = ".argb.tmp.";
+/** Temporary files older than this, in seconds, are removed. */
+static const time_t TMP_MAX_AGE = 3600;
+
+/**
+ * Header of cache entries, followed by the key and the ARGB data.
+ * Entries are not portable between architectures, header_size catches
+ * the most obvious layout differences.
+ */
+struct ImageCacheHeader {
+	char magic[8];
+	uint header_size;
+	uint key_len;
+	long mtime;
+	ulong size;
+	uint width;
+	uint height;
+	uint use_alpha;
+	uint pad;
+};
+
+static const char *MAGIC = "PEKWMIMG";
+
+/**
+ * Entry in the cache directory, used when evicting entries.
+ */
+class ImageCacheEntry {
+public:
+	ImageCacheEntry(const std::string &path_, time_t mtime_,
+			size_t size_)
+		: path(path_),
+		  mtime(mtime_),
+		  size(size_)
+	{
+	}
+
+	bool operator<(const ImageCacheEntry &rhs) const {
+		return mtime < rhs.mtime;
+	}
+
+	std::string path;
+	time_t mtime;
+	size_t size;
+};
+
+/**
+ * Create directory and any missing parent directories.
+ */
+static bool
+makeDirs(const std::string &dir)
+{
+	for (size_t pos = dir.find('/', 1); ; pos = dir.find('/', pos + 1)) {
+		std::string part = dir.substr(0, pos);
+		if (mkdir(part.c_str(), 0700) == -1 && errno != EEXIST) {
+			P_DBG("failed to create image cache directory "
+			      << part << ": " << strerror(errno));
+			return false;
+		}
+		if (pos == std::string::npos) {
+			return true;
+		}
+	}
+}
+
+/**
+ * Write all of data to fd, retrying short and interrupted writes.
+ */
+static bool
+writeData(int fd, const void *data, size_t size)
+{
+	const char *pos = static_cast<const char*>(data);
+	while (size > 0) {
+		ssize_t written = write(fd, pos, size);
+		if (written == -1) {
+			if (errno == EINTR) {
+				continue;
+			}
+			return false;
+		}
+		pos += written;
+		size -= written;
+	}
+	return true;
+}
+
+ImageCache::ImageCache(const std::string &dir, size_t max_size)
+	: _dir(dir),
+	  _max_size(max_size),
+	  _size(0),
+	  _scanned(false),
+	  _hits(0),
+	  _misses(0),
+	  _evictions(0)
+{
+	if (! _dir.empty() && _dir[_dir.size() - 1] == '/') {
+		_dir.erase(_dir.size() - 1);
+	}
+}
+
+ImageCache::~ImageCache(void)
+{
+}
+
+/**
+ * Load decoded image for the source image at path, the entry is only
+ * used if the modification time and size of the source image matches.
+ * Images decoded with a size hint are stored in separate entries.
+ *
+ * @return PImage or nullptr if no valid entry is available.
+ */
+PImage*
+ImageCache::load(const std::string &path,
+		 size_t hint_width, size_t hint_height)
+{
+	struct stat src_st;
+	if (stat(path.c_str(), &src_st) == -1) {
+		// not a miss, the search path is tried one entry at a time
+		return nullptr;
+	}
+
+	std::string key = getKey(path, hint_width, hint_height);
+	std::string entry = getEntryPath(path, hint_width, hint_height);
+	int fd = open(entry.c_str(), O_RDONLY);
+	if (fd == -1) {
+		_misses++;
+		return nullptr;
+	}
+
+	struct stat st;
+	void *map = MAP_FAILED;
+	if (fstat(fd, &st) == 0
+	    && static_cast<size_t>(st.st_size) >= sizeof(ImageCacheHeader)) {
+		map = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE,
+			   fd, 0);
+	}
+	close(fd);
+	if (map == MAP_FAILED) {
+		_misses++;
+		return nullptr;
+	}
+
+	const ImageCacheHeader *header =
+		static_cast<const ImageCacheHeader*>(map);
+	const char *entry_key = static_cast<const char*>(map)
+		+ sizeof(ImageCacheHeader);
+	size_t data_size = static_cast<size_t>(header->width)
+		* header->height * 4;
+
+	PImage *image = nullptr;
+	if (memcmp(header->magic, MAGIC, sizeof(header->magic)) == 0
+	    && header->header_size == sizeof(ImageCacheHeader)
+	    && header->mtime == static_cast<long>(src_st.st_mtime)
+	    && header->size == static_cast<ulong>(src_st.st_size)
+	    && header->key_len == key.size()
+	    && static_cast<size_t>(st.st_size)
+	       == sizeof(ImageCacheHeader) + key.size() + data_size
+	    && memcmp(entry_key, key.c_str(), key.size()) == 0) {
+		uchar *data = new uchar[data_size];
+		memcpy(data, entry_key + key.size(), data_size);
+		image = new PImage(data, header->width, header->height,
+				   header->use_alpha);
+	}
+	munmap(map, st.st_size);
+
+	if (image) {
+		// mark entry as recently used
+		utimes(entry.c_str(), nullptr);
+		_hits++;
+	} else {
+		P_DBG("stale image cache entry " << entry << " for "
+		      << key);
+		_misses++;
+	}
+	return image;
+}
+
+/**
+ * Store decoded image for the source image at path, evicting the least
+ * recently used entries if the cache grows above the maximum size.
+ */
+bool
+ImageCache::store(const std::string &path, PImage *image,
+		  size_t hint_width, size_t hint_height)
+{
+	struct stat src_st;
+	if (stat(path.c_str(), &src_st) == -1) {
+		return false;
+	}
+
+	std::string key = getKey(path, hint_width, hint_height);
+	size_t data_size = image->getWidth() * image->getHeight() * 4;
+	size_t entry_size = sizeof(ImageCacheHeader) + key.size() + data_size;
+	if (entry_size > _max_size || ! makeDirs(_dir)) {
+		return false;
+	}
+
+	ImageCacheHeader header;
+	memset(&header, 0, sizeof(header));
+	memcpy(header.magic, MAGIC, sizeof(header.magic));
+	header.header_size = sizeof(ImageCacheHeader);
+	header.key_len = key.size();
+	header.mtime = src_st.st_mtime;
+	header.size = src_st.st_size;
+	header.width = image->getWidth();
+	header.height = image->getHeight();
+	header.use_alpha = image->useAlpha();
+
+	// write to a temporary file and rename, other instances sharing
+	// the cache directory never see partially written entries.
+	// the name is unique in the cache directory, the pid is not when
+	// it is shared between hosts.
+	std::string entry = getEntryPath(path, hint_width, hint_height);
+	std::vector<char> tmp(entry.begin(), entry.end());
+	const char *tmp_suffix = ".tmp.XXXXXX";
+	tmp.insert(tmp.end(), tmp_suffix, tmp_suffix + strlen(tmp_suffix) + 1);
+	int fd = mkstemp(&tmp[0]);
+	if (fd == -1) {
+		P_DBG("failed to create temporary file for " << entry << ": "
+		      << strerror(errno));
+		return false;
+	}
+
+	bool ok = writeData(fd, &header, sizeof(header))
+		&& writeData(fd, key.c_str(), key.size())
+		&& writeData(fd, image->getData(), data_size);
+	if (close(fd) == -1) {
+		ok = false;
+	}
+	if (! ok || rename(&tmp[0], entry.c_str()) == -1) {
+		P_DBG("failed to write image cache entry " << entry);
+		unlink(&tmp[0]);
+		return false;
+	}
+
+	// replaced entries and entries stored by other instances make
+	// _size drift, it is corrected on the next scan.
+	if (! _scanned || _size + entry_size > _max_size) {
+		evict(_max_size);
+	} else {
+		_size += entry_size;
+	}
+	return true;
+}
+
+/**
+ * Remove least recently used entries until the entries in the cache
+ * directory use at most max_size bytes. Temporary files older than
+ * TMP_MAX_AGE are removed as well, they are not counted as evictions.
+ *
+ * @return Number of removed entries.
+ */
+size_t
+ImageCache::evict(size_t max_size)
+{
+	DIR *dh = opendir(_dir.c_str());
+	if (dh == nullptr) {
+		return 0;
+	}
+
+	time_t tmp_mtime_min = time(nullptr) - TMP_MAX_AGE;
+	size_t total = 0;
+	std::vector<ImageCacheEntry> entries;
+	struct dirent *de;
+	while ((de = readdir(dh)) != nullptr) {
+		size_t len = strlen(de->d_name);
+		bool is_tmp = strstr(de->d_name, TMP_EXT) != nullptr;
+		if (! is_tmp
+		    && (len <= ENTRY_EXT_LEN
+			|| strcmp(de->d_name + len - ENTRY_EXT_LEN,
+				  ENTRY_EXT))) {
+			continue;
+		}
+
+		std::string entry_path = _dir + "/" + de->d_name;
+		struct stat st;
+		if (stat(entry_path.c_str(), &st) == -1) {
+			continue;
+		}
+		if (is_tmp) {
+			// recent files are being written by another instance
+			if (st.st_mtime < tmp_mtime_min
+			    && unlink(entry_path.c_str()) == 0) {
+				P_DBG("removed stale image cache file "
+				      << entry_path);
+			}
+		} else {
+			entries.push_back(ImageCacheEntry(entry_path,
+							  st.st_mtime,
+							  st.st_size));
+			total += st.st_size;
+		}
+	}
+	closedir(dh);
+
+	size_t removed = 0;
+	std::sort(entries.begin(), entries.end());
+	std::vector<ImageCacheEntry>::iterator it = entries.begin();
+	for (; total > max_size && it != entries.end(); ++it) {
+		if (unlink(it->path.c_str()) == 0) {
+			total -= it->size;
+			removed++;
+		}
+	}
+	_size = total;
+	_scanned = true;
+	_evictions += removed;
+	return removed;
+}
+
+/**
+ * Get path of cache entry for source image path, named after the
+ * FNV-1a hash of the key. Collisions replace the previous entry.
+ */
+std::string
+ImageCache::getEntryPath(const std::string &path,
+			 size_t hint_width, size_t hint_height) const
+{
+	std::string key = getKey(path, hint_width, hint_height);
+	uint hash = 2166136261U;
+	std::string::const_iterator it = key.begin();
+	for (; it != key.end(); ++it) {
+		hash ^= static_cast<uchar>(*it);
+		hash *= 16777619U;
+	}
+
+	std::ostringstream entry;
+	entry << _dir << "/" << std::hex << std::setfill('0') << std::setw(8)
+	      << hash << ENTRY_EXT;
+	return entry.str();
+}
+
+/**
+ * Get key of cache entry, the source path followed by the size hint if
+ * set.
+ */
+std::string
+ImageCache::getKey(const std::string &path,
+		   size_t hint_width, size_t hint_height)
+{
+	if (hint_width == 0 && hint_height == 0) {
+		return path;
+	}
+
+	std::ostringstream key;
+	key << path << "@" << hint_width << "x" << hint_height;
+	return key.str();
+}
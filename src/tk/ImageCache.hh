@@ -0,0 +1,70 @@
+//
+// ImageCache.hh for pekwm
+// Copyright (C) 2023 Claes Nästén <pekdon@gmail.com>
+//
+// This program is licensed under the GNU GPL.
+// See the LICENSE file for more information.
+//
+
+#ifndef _PEKWM_IMAGE_CACHE_HH_
+#define _PEKWM_IMAGE_CACHE_HH_
+
+#include "config.h"
+
+#include "Types.hh"
+
+#include <string>
+
+class PImage;
+
+/**
+ * Directory of decoded ARGB images, each entry is validated against the
+ * path, modification time and size of the source image before use
+ * making it possible to skip decoding PNG, JPEG and XPM files on start,
+ * theme reload and in pekwm_bg.
+ *
+ * The modification time of an entry is updated on every hit and the
+ * least recently used entries are removed when the size of the
+ * directory goes above the configured maximum. The directory is only
+ * scanned on the first store and when the size, tracked as entries are
+ * stored, goes above the maximum. Images larger than the maximum, a
+ * decoded 7680x4320 image uses 132MB, are never stored.
+ */
+class ImageCache {
+public:
+	ImageCache(const std::string &dir, size_t max_size);
+	~ImageCache(void);
+
+	const std::string &getDir(void) const { return _dir; }
+	size_t getMaxSize(void) const { return _max_size; }
+	ulong getHits(void) const { return _hits; }
+	ulong getMisses(void) const { return _misses; }
+	ulong getEvictions(void) const { return _evictions; }
+
+	PImage *load(const std::string &path,
+		     size_t hint_width = 0, size_t hint_height = 0);
+	bool store(const std::string &path, PImage *image,
+		   size_t hint_width = 0, size_t hint_height = 0);
+	size_t evict(size_t max_size);
+
+	std::string getEntryPath(const std::string &path,
+				 size_t hint_width = 0,
+				 size_t hint_height = 0) const;
+
+private:
+	static std::string getKey(const std::string &path,
+				  size_t hint_width, size_t hint_height);
+
+	std::string _dir;
+	size_t _max_size;
+	/** Size of the directory as of the last scan plus stored entries. */
+	size_t _size;
+	/** Set after the first scan, _size is unknown before. */
+	bool _scanned;
+
+	ulong _hits;
+	ulong _misses;
+	ulong _evictions;
+};
+
+#endif // _PEKWM_IMAGE_CACHE_HH_
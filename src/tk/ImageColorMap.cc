@@ -0,0 +1,144 @@
+//
+// ImageColorMap.cc for pekwm
+// Copyright (C) 2023 Claes Nästén <pekdon@gmail.com>
+//
+// This program is licensed under the GNU GPL.
+// See the LICENSE file for more information.
+//
+
+#include "ImageColorMap.hh"
+#include "PImage.hh"
+#include "ThreadPool.hh"
+
+#include <algorithm>
+
+/** Minimum number of pixels for mapping on the thread pool. */
+static const size_t THREAD_MIN_PIXELS = 256 * 256;
+
+/**
+ * Pixels split into bands, mapped by separate jobs.
+ */
+struct ApplyJob {
+	const ImageColorMap *color_map;
+	int *pixels;
+	size_t num_pixels;
+	size_t band;
+};
+
+ImageColorMap::ImageColorMap(void)
+	: _size(0)
+{
+}
+
+ImageColorMap::ImageColorMap(const std::map<int, int> &color_map)
+	: _size(color_map.size())
+{
+	size_t capacity = 8;
+	while (capacity < _size * 2) {
+		capacity *= 2;
+	}
+	_entries.resize(capacity);
+
+	std::map<int, int>::const_iterator it = color_map.begin();
+	for (; it != color_map.end(); ++it) {
+		Entry &entry = _entries[getSlot(it->first)];
+		entry.from = it->first;
+		entry.to = it->second;
+		entry.used = true;
+	}
+}
+
+ImageColorMap::~ImageColorMap(void)
+{
+}
+
+/**
+ * Lookup replacement for the pixel value from.
+ *
+ * @return true if from is mapped, to is set to the replacement.
+ */
+bool
+ImageColorMap::lookup(int from, int &to) const
+{
+	if (_size == 0) {
+		return false;
+	}
+	const Entry &entry = _entries[getSlot(from)];
+	if (! entry.used) {
+		return false;
+	}
+	to = entry.to;
+	return true;
+}
+
+/**
+ * Get slot of from, or the first free slot where it would be inserted.
+ */
+size_t
+ImageColorMap::getSlot(int from) const
+{
+	uint hash = static_cast<uint>(from) * 0x9e3779b1u;
+	hash ^= hash >> 16;
+
+	size_t mask = _entries.size() - 1;
+	size_t slot = hash & mask;
+	while (_entries[slot].used && _entries[slot].from != from) {
+		slot = (slot + 1) & mask;
+	}
+	return slot;
+}
+
+/**
+ * Replace all mapped pixels in num_pixels of ARGB data.
+ */
+void
+ImageColorMap::apply(uchar *data, size_t num_pixels) const
+{
+	if (_size == 0) {
+		return;
+	}
+
+	int *pixels = reinterpret_cast<int*>(data);
+	ThreadPool *pool = PImage::getThreadPool();
+	if (pool == nullptr || pool->size() < 2
+	    || num_pixels < THREAD_MIN_PIXELS) {
+		applyPixels(pixels, num_pixels);
+		return;
+	}
+
+	ApplyJob job;
+	job.color_map = this;
+	job.pixels = pixels;
+	job.num_pixels = num_pixels;
+	job.band = (num_pixels + pool->size() - 1) / pool->size();
+	pool->run((num_pixels + job.band - 1) / job.band, applyJob, &job);
+}
+
+void
+ImageColorMap::applyJob(size_t index, void *opaque)
+{
+	ApplyJob *job = static_cast<ApplyJob*>(opaque);
+	size_t start = index * job->band;
+	size_t num = std::min(job->band, job->num_pixels - start);
+	job->color_map->applyPixels(job->pixels + start, num);
+}
+
+/**
+ * Map pixels, images usually have runs of the same color so the result
+ * of the previous lookup is re-used when the pixel value repeats.
+ */
+void
+ImageColorMap::applyPixels(int *p, size_t num_pixels) const
+{
+	int last_from = 0, last_to = 0;
+	bool last_mapped = lookup(last_from, last_to);
+	for (; num_pixels; num_pixels--, p++) {
+		if (*p != last_from) {
+			last_from = *p;
+			last_mapped = lookup(last_from, last_to);
+		}
+		if (last_mapped) {
+			*p = last_to;
+		}
+	}
+}
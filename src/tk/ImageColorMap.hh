@@ -0,0 +1,55 @@
+//
+// ImageColorMap.hh for pekwm
+// Copyright (C) 2023 Claes Nästén <pekdon@gmail.com>
+//
+// This program is licensed under the GNU GPL.
+// See the LICENSE file for more information.
+//
+
+#ifndef _PEKWM_IMAGE_COLOR_MAP_HH_
+#define _PEKWM_IMAGE_COLOR_MAP_HH_
+
+#include "config.h"
+
+#include "Types.hh"
+
+#include <map>
+#include <vector>
+
+/**
+ * Theme color map, replacing ARGB pixel values with other values.
+ *
+ * Entries are kept in a flat open addressing hash table for cache
+ * friendly lookup, large images are mapped in bands of rows on the
+ * PImage thread pool.
+ */
+class ImageColorMap {
+public:
+	ImageColorMap(void);
+	ImageColorMap(const std::map<int, int> &color_map);
+	~ImageColorMap(void);
+
+	size_t size(void) const { return _size; }
+
+	bool lookup(int from, int &to) const;
+	void apply(uchar *data, size_t num_pixels) const;
+
+private:
+	static void applyJob(size_t index, void *opaque);
+	void applyPixels(int *p, size_t num_pixels) const;
+	size_t getSlot(int from) const;
+
+	struct Entry {
+		Entry(void) : from(0), to(0), used(false) { }
+
+		int from;
+		int to;
+		bool used;
+	};
+
+	/** Table with a power of two size, at most half full. */
+	std::vector<Entry> _entries;
+	size_t _size;
+};
+
+#endif // _PEKWM_IMAGE_COLOR_MAP_HH_
@@ -14,15 +14,18 @@
 #include "PImage.hh"
 #include "Util.hh"
 
+#include <sstream>
+
 extern "C" {
 #include <assert.h>
 }
 
-static Util::StringTo<ImageType> image_type_map[] =
+static Util::StringTo<ImageType> image_type_map_entries[] =
 	{{"TILED", IMAGE_TYPE_TILED},
 	 {"SCALED", IMAGE_TYPE_SCALED},
 	 {"FIXED", IMAGE_TYPE_FIXED},
 	 {nullptr, IMAGE_TYPE_NO}};
+static Util::StringToIndex<ImageType> image_type_map(image_type_map_entries);
 
 ImageRefEntry::ImageRefEntry(const std::string& u_name, PImage* data)
 	: _u_name(u_name),
@@ -53,6 +56,7 @@ ImageRefEntry::decRef(void)
 }
 
 ImageHandler::ImageHandler(void)
+	: _cache(nullptr)
 {
 	clearColorMaps();
 }
@@ -73,21 +77,45 @@ ImageHandler::~ImageHandler(void)
 			_images.erase(it);
 		}
 	}
+	delete _cache;
+}
+
+/**
+ * Set directory and maximum size, in bytes, of the on-disk cache of
+ * decoded images. An empty directory disables the cache.
+ */
+void
+ImageHandler::setCache(const std::string &dir, size_t max_size)
+{
+	if (_cache && _cache->getDir() == dir
+	    && _cache->getMaxSize() == max_size) {
+		return;
+	}
+
+	delete _cache;
+	_cache = dir.empty() ? nullptr : new ImageCache(dir, max_size);
 }
 
 /**
  * Gets image from cache and increments the reference or creates a new image.
+ *
+ * @param file Image file, optionally followed by #type.
+ * @param hint_width Width scaled images will be drawn with, loaders
+ *                   supporting it decode a smaller image. 0 if unknown.
+ * @param hint_height Height scaled images will be drawn with.
  */
 PImage*
-ImageHandler::getImage(const std::string &file)
+ImageHandler::getImage(const std::string &file,
+		       size_t hint_width, size_t hint_height)
 {
 	uint ref;
-	return getImage(file, ref, _images);
+	return getImage(file, ref, _images, hint_width, hint_height);
 }
 
 PImage*
 ImageHandler::getImage(const std::string &file, uint &ref,
-		       std::vector<ImageRefEntry> &images)
+		       std::vector<ImageRefEntry> &images,
+		       size_t hint_width, size_t hint_height)
 {
 	if (! file.size()) {
 		ref = 0;
@@ -104,6 +132,11 @@ ImageHandler::getImage(const std::string &file, uint &ref,
 		image_type = Util::StringToGet(image_type_map,
 					       file.substr(pos + 1));
 	}
+	if (image_type != IMAGE_TYPE_SCALED) {
+		// tiled and fixed images are drawn in their full size
+		hint_width = 0;
+		hint_height = 0;
+	}
 
 	// Load the image, try load paths if not an absolute image path
 	// already.
@@ -111,7 +144,8 @@ ImageHandler::getImage(const std::string &file, uint &ref,
 	if (real_file[0] == '/') {
 		std::string u_real_file(real_file);
 		Util::to_upper(u_real_file);
-		image = getImageFromPath(real_file, u_real_file, ref, images);
+		image = getImageFromPath(real_file, u_real_file, ref, images,
+					 hint_width, hint_height);
 	} else {
 		std::vector<std::string>::reverse_iterator it =
 			_search_path.rbegin();
@@ -120,7 +154,8 @@ ImageHandler::getImage(const std::string &file, uint &ref,
 			std::string u_sp_real_file(sp_real_file);
 			Util::to_upper(u_sp_real_file);
 			image = getImageFromPath(sp_real_file, u_sp_real_file,
-						 ref, images);
+						 ref, images,
+						 hint_width, hint_height);
 			if (image) {
 				break;
 			}
@@ -145,28 +180,44 @@ PImage*
 ImageHandler::getImageFromPath(const std::string &file,
 			       const std::string &u_file,
 			       uint &ref,
-			       std::vector<ImageRefEntry> &images)
+			       std::vector<ImageRefEntry> &images,
+			       size_t hint_width, size_t hint_height)
 {
+	// Images decoded for a size are kept apart from full size images.
+	std::string u_name(u_file);
+	if (hint_width || hint_height) {
+		std::ostringstream hint;
+		hint << "@" << hint_width << "X" << hint_height;
+		u_name += hint.str();
+	}
+
 	// Check cache for entry.
 	std::vector<ImageRefEntry>::iterator it = images.begin();
 	for (; it != images.end(); ++it) {
-		if (it->getUName() == u_file) {
+		if (it->getUName() == u_name) {
 			ref = it->incRef();
 			return it->get();
 		}
 	}
 
 	// Try to load the image, setup cache only if it succeeds.
-	PImage *image;
-	try {
-		image = new PImage(file);
-		images.push_back(ImageRefEntry(u_file, image));
-		ref = 1;
-	} catch (LoadException&) {
-		image = nullptr;
-		ref = 0;
+	PImage *image = _cache
+		? _cache->load(file, hint_width, hint_height) : nullptr;
+	if (image == nullptr) {
+		try {
+			image = new PImage(file, hint_width, hint_height);
+			if (_cache) {
+				_cache->store(file, image,
+					      hint_width, hint_height);
+			}
+		} catch (LoadException&) {
+			ref = 0;
+			return nullptr;
+		}
 	}
 
+	images.push_back(ImageRefEntry(u_name, image));
+	ref = 1;
 	return image;
 }
 
@@ -185,9 +236,39 @@ ImageHandler::returnImage(PImage *image)
 void
 ImageHandler::takeOwnership(PImage *image)
 {
-	std::string key = Util::to_string(static_cast<void*>(image));
-	Util::to_upper(key);
-	_images.push_back(ImageRefEntry(key, image));
+	takeOwnership(image, Util::to_string(static_cast<void*>(image)));
+}
+
+/**
+ * Take ownership over image, making it available with findImage
+ * using key until the last reference is returned.
+ */
+void
+ImageHandler::takeOwnership(PImage *image, const std::string &key)
+{
+	std::string u_key(key);
+	Util::to_upper(u_key);
+	_images.push_back(ImageRefEntry(u_key, image));
+}
+
+/**
+ * Find image added with takeOwnership and increment the reference.
+ *
+ * @return Image, nullptr if no image is owned using key.
+ */
+PImage*
+ImageHandler::findImage(const std::string &key)
+{
+	std::string u_key(key);
+	Util::to_upper(u_key);
+	std::vector<ImageRefEntry>::iterator it = _images.begin();
+	for (; it != _images.end(); ++it) {
+		if (it->getUName() == u_key) {
+			it->incRef();
+			return it->get();
+		}
+	}
+	return nullptr;
 }
 
 PImage*
@@ -197,7 +278,7 @@ ImageHandler::getMappedImage(const std::string &file,
 	std::string u_colormap(colormap);
 	Util::to_upper(u_colormap);
 
-	std::map<std::string, std::map<int, int> >::iterator c_it =
+	std::map<std::string, ImageColorMap>::iterator c_it =
 		_color_maps.find(u_colormap);
 	if (c_it == _color_maps.end()) {
 		// no color map present with that name, return no image
@@ -211,31 +292,16 @@ ImageHandler::getMappedImage(const std::string &file,
 	}
 
 	uint ref;
-	PImage *image = getImage(file, ref, _images_mapped[u_colormap]);
+	PImage *image = getImage(file, ref, _images_mapped[u_colormap], 0, 0);
 	if (ref == 1) {
 		// new image, requires color mapping.
-		mapColors(image, _color_maps[u_colormap]);
+		c_it->second.apply(image->getData(),
+				   image->getWidth() * image->getHeight());
 	}
 
 	return image;
 }
 
-/**
- * Map colors in loaded image.
- */
-void
-ImageHandler::mapColors(PImage *image, const std::map<int,int> &color_map)
-{
-	int *p = reinterpret_cast<int*>(image->getData());
-	int num_pixels = image->getWidth() * image->getHeight();
-	for (; num_pixels; num_pixels--, p++) {
-		std::map<int, int>::const_iterator it = color_map.find(*p);
-		if (it != color_map.end()) {
-			*p = it->second;
-		}
-	}
-}
-
 /**
  * Return color-mapped image to handler, removes entry if it is the
  * last reference.
@@ -279,5 +345,5 @@ ImageHandler::addColorMap(const std::string& name,
 {
 	std::string u_name(name);
 	Util::to_upper(u_name);
-	_color_maps[u_name] = color_map;
+	_color_maps[u_name] = ImageColorMap(color_map);
 }
@@ -11,6 +11,8 @@
 
 #include "config.h"
 
+#include "ImageCache.hh"
+#include "ImageColorMap.hh"
 #include "PImage.hh"
 #include "Util.hh"
 
@@ -63,10 +65,17 @@ public:
 		_search_path.clear();
 	}
 
-	PImage *getImage(const std::string &file);
+	void setCache(const std::string &dir, size_t max_size);
+	/** Return on-disk cache of decoded images, nullptr if disabled. */
+	ImageCache *getCache(void) { return _cache; }
+
+	PImage *getImage(const std::string &file,
+			 size_t hint_width = 0, size_t hint_height = 0);
 	void returnImage(PImage *image);
 
+	PImage *findImage(const std::string &key);
 	void takeOwnership(PImage *image);
+	void takeOwnership(PImage *image, const std::string &key);
 
 	PImage *getMappedImage(const std::string &file,
 			       const std::string& colormap);
@@ -78,13 +87,13 @@ public:
 
 private:
 	PImage *getImage(const std::string &file, uint &ref,
-			 std::vector<ImageRefEntry> &images);
+			 std::vector<ImageRefEntry> &images,
+			 size_t hint_width, size_t hint_height);
 	PImage *getImageFromPath(const std::string &file,
 				 const std::string &u_file,
 				 uint &ref,
-				 std::vector<ImageRefEntry> &images);
-
-	void mapColors(PImage *image, const std::map<int,int> &color_map);
+				 std::vector<ImageRefEntry> &images,
+				 size_t hint_width, size_t hint_height);
 
 	static void returnImage(PImage *image,
 				std::vector<ImageRefEntry> &images);
@@ -97,7 +106,11 @@ private:
 	/** Loaded images with color mapped data. */
 	std::map<std::string, std::vector<ImageRefEntry> > _images_mapped;
 
-	std::map<std::string, std::map<int, int> > _color_maps;
+	/** Color maps, by upper case name. */
+	std::map<std::string, ImageColorMap> _color_maps;
+
+	/** On-disk cache of decoded images, consulted before decoding. */
+	ImageCache *_cache;
 };
 
 namespace pekwm
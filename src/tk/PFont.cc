@@ -14,6 +14,7 @@
 #include "Charset.hh"
 #include "Debug.hh"
 #include "PFont.hh"
+#include "TextExtentCache.hh"
 #include "Util.hh"
 #include "pekwm_types.hh"
 
@@ -218,12 +219,72 @@ PFont::PFont(void) :
 	_descent(0),
 	_offset_x(0),
 	_offset_y(0),
-	_justify(FONT_JUSTIFY_LEFT)
+	_justify(FONT_JUSTIFY_LEFT),
+	_width_cache_next(0),
+	_extent_cache(nullptr)
 {
 }
 
 PFont::~PFont(void)
 {
+	if (_extent_cache) {
+		_extent_cache->remove(this);
+	}
+}
+
+// PFont::WidthTable
+
+PFont::WidthTable::WidthTable(void)
+	: _width(-1)
+{
+}
+
+void
+PFont::WidthTable::reset(const std::string &text)
+{
+	_text = text;
+	_width = -1;
+	_pos.clear();
+
+	Charset::Utf8Iterator it(_text, 0);
+	for (++it; ! it.end(); ++it) {
+		_pos.push_back(it.pos());
+	}
+	_prefix.assign(_pos.size(), -1);
+	_suffix.assign(_pos.size(), -1);
+}
+
+uint
+PFont::WidthTable::getWidth(PFont *font)
+{
+	if (_width == -1) {
+		_width = font->getWidth(_text);
+	}
+	return _width;
+}
+
+/**
+ * Width of text up to, not including, character boundary i.
+ */
+uint
+PFont::WidthTable::getPrefixWidth(PFont *font, size_t i)
+{
+	if (_prefix[i] == -1) {
+		_prefix[i] = font->getWidth(_text, _pos[i]);
+	}
+	return _prefix[i];
+}
+
+/**
+ * Width of text starting at character boundary i.
+ */
+uint
+PFont::WidthTable::getSuffixWidth(PFont *font, size_t i)
+{
+	if (_suffix[i] == -1) {
+		_suffix[i] = font->getWidth(_text.substr(_pos[i]));
+	}
+	return _suffix[i];
 }
 
 /**
@@ -272,6 +333,34 @@ PFont::draw(PSurface *dest, int x, int y, const std::string &text,
 	return offset;
 }
 
+/**
+ * Get width of text, limited to the first max_chars bytes if non
+ * zero. Widths are looked up in the shared extent cache, if set,
+ * before measuring.
+ */
+uint
+PFont::getWidth(const std::string &text, uint max_chars)
+{
+	if (_extent_cache == nullptr) {
+		return textWidth(text, max_chars);
+	}
+
+	uint width;
+	if (max_chars == 0 || max_chars >= text.size()) {
+		if (! _extent_cache->get(this, text, width)) {
+			width = textWidth(text, max_chars);
+			_extent_cache->put(this, text, width);
+		}
+	} else {
+		std::string key(text, 0, max_chars);
+		if (! _extent_cache->get(this, key, width)) {
+			width = textWidth(text, max_chars);
+			_extent_cache->put(this, key, width);
+		}
+	}
+	return width;
+}
+
 /**
  * Trims the text making it max max_width wide
  */
@@ -282,7 +371,7 @@ PFont::trim(std::string &text, PFont::TrimType trim_type, uint max_width)
 		return;
 	}
 
-	if (getWidth(text) > max_width) {
+	if (getWidthTable(text).getWidth(this) > max_width) {
 		if (_trim_string.size() > 0
 		    && trim_type == FONT_TRIM_MIDDLE
 		    && trimMiddle(text, max_width)) {
@@ -299,16 +388,13 @@ PFont::trim(std::string &text, PFont::TrimType trim_type, uint max_width)
 void
 PFont::trimEnd(std::string &text, uint max_width)
 {
-	Charset::Utf8Iterator it(text, text.size());
-	--it;
-	--it;
-	for (; ! it.begin(); --it) {
-		if (getWidth(text, it.pos()) <= max_width) {
-			text.resize(it.pos());
-			return;
-		}
+	WidthTable &table = getWidthTable(text);
+	size_t num = findPrefixFit(table, max_width);
+	if (num == 0) {
+		text = "";
+	} else {
+		text.resize(table.pos(num - 1));
 	}
-	text = "";
 }
 
 /**
@@ -323,9 +409,6 @@ PFont::trimMiddle(std::string &text, uint max_width)
 	uint max_side = (max_width / 2);
 	uint sep_width = getWidth(_trim_string);
 
-	uint pos = 0;
-	std::string dest;
-
 	// If the trim string is too large, do nothing and let trimEnd handle
 	// this.
 	if (sep_width > max_width) {
@@ -334,44 +417,113 @@ PFont::trimMiddle(std::string &text, uint max_width)
 	// Add space for the trim string
 	max_side -= sep_width / 2;
 
+	WidthTable &table = getWidthTable(text);
+
 	// Get numbers of chars before trim string (..)
-	Charset::Utf8Iterator it(text, text.size());
-	for (--it; ! it.begin(); --it) {
-		if (getWidth(text, it.pos()) <= max_side) {
-			pos = it.pos();
-			dest.insert(0, text.substr(0, it.pos()));
-			break;
-		}
+	uint pos = 0;
+	std::string dest;
+	size_t num = findPrefixFit(table, max_side);
+	if (num > 0) {
+		pos = table.pos(num - 1);
+		dest = text.substr(0, pos);
 	}
 
 	// get numbers of chars after ...
-	if (pos < text.size()) {
-		for (++it; ! it.end(); ++it) {
-			std::string second_part(text.substr(it.pos(),
-						text.size() - it.pos()));
-			if (getWidth(second_part, 0) <= max_side) {
-				dest.insert(dest.size(), second_part);
-				break;
-			}
-		}
+	size_t after = findSuffixFit(table, num, max_side);
+	if (after < table.size()) {
+		dest.append(text, table.pos(after), std::string::npos);
+	}
 
-		// Got a char after and before, if not do nothing and trimEnd
-		// will handle trimming after this call.
-		if (dest.size() > 1) {
-			if ((getWidth(dest) + getWidth(_trim_string))
-			    <= max_width) {
-				dest.insert(pos, _trim_string);
-				trimmed = true;
-			}
-
-			// Update original string
-			text = dest;
+	// Got a char after and before, if not do nothing and trimEnd
+	// will handle trimming after this call.
+	if (dest.size() > 1) {
+		if ((getWidth(dest) + sep_width) <= max_width) {
+			dest.insert(pos, _trim_string);
+			trimmed = true;
 		}
+
+		// Update original string
+		text = dest;
 	}
 
 	return trimmed;
 }
 
+/**
+ * Return width table for text, re-using the table from a previous
+ * trim of the same text.
+ */
+PFont::WidthTable&
+PFont::getWidthTable(const std::string &text)
+{
+	std::vector<WidthTable>::iterator it = _width_cache.begin();
+	for (; it != _width_cache.end(); ++it) {
+		if (it->getText() == text) {
+			return *it;
+		}
+	}
+
+	if (_width_cache.size() < WIDTH_CACHE_SIZE) {
+		_width_cache.push_back(WidthTable());
+		_width_cache.back().reset(text);
+		return _width_cache.back();
+	}
+
+	WidthTable &table = _width_cache[_width_cache_next];
+	_width_cache_next = (_width_cache_next + 1) % WIDTH_CACHE_SIZE;
+	table.reset(text);
+	return table;
+}
+
+void
+PFont::clearWidthCache(void)
+{
+	_width_cache.clear();
+	_width_cache_next = 0;
+	if (_extent_cache) {
+		_extent_cache->remove(this);
+	}
+}
+
+/**
+ * Binary search for the number of character boundaries where the
+ * text cut at the boundary fits in max_width.
+ */
+size_t
+PFont::findPrefixFit(WidthTable &table, uint max_width)
+{
+	size_t lo = 0, hi = table.size();
+	while (lo < hi) {
+		size_t mid = lo + (hi - lo) / 2;
+		if (table.getPrefixWidth(this, mid) <= max_width) {
+			lo = mid + 1;
+		} else {
+			hi = mid;
+		}
+	}
+	return lo;
+}
+
+/**
+ * Binary search for the first character boundary, at or after start,
+ * where the text following the boundary fits in max_width. Returns
+ * table.size() if no such boundary exists.
+ */
+size_t
+PFont::findSuffixFit(WidthTable &table, size_t start, uint max_width)
+{
+	size_t lo = start, hi = table.size();
+	while (lo < hi) {
+		size_t mid = lo + (hi - lo) / 2;
+		if (table.getSuffixWidth(this, mid) <= max_width) {
+			hi = mid;
+		} else {
+			lo = mid + 1;
+		}
+	}
+	return lo;
+}
+
 void
 PFont::setTrimString(const std::string &text) {
 	_trim_string = text;
@@ -12,9 +12,12 @@
 #include "config.h"
 
 #include <string>
+#include <vector>
 
 #include "PSurface.hh"
 
+class TextExtentCache;
+
 class PFont
 {
 public:
@@ -136,7 +139,11 @@ public:
 	inline uint getJustify(void) const { return _justify; }
 
 	inline void setJustify(uint j) { _justify = j; }
-	inline void setOffset(uint x, uint y) { _offset_x = x; _offset_y = y; }
+	inline void setOffset(uint x, uint y) {
+		_offset_x = x;
+		_offset_y = y;
+		clearWidthCache();
+	}
 
 	int draw(PSurface *dest, int x, int y, const std::string &text,
 		 uint max_chars = 0, uint max_width = 0,
@@ -155,7 +162,7 @@ public:
 	virtual bool load(const PFont::Descr &descr) = 0;
 	virtual void unload(void) = 0;
 
-	virtual uint getWidth(const std::string& text, uint max_chars = 0) = 0;
+	uint getWidth(const std::string& text, uint max_chars = 0);
 	virtual bool useAscentDescent(void) const {
 		return _ascent > 0 && _descent > 0;
 	}
@@ -165,19 +172,66 @@ public:
 
 	virtual void setColor(PFont::Color* color) = 0;
 
+	void setExtentCache(TextExtentCache *extent_cache) {
+		_extent_cache = extent_cache;
+	}
+
 protected:
 	virtual std::string toNativeDescr(const PFont::Descr &descr) const = 0;
+	void clearWidthCache(void);
 
 private:
+	virtual uint textWidth(const std::string& text, uint max_chars) = 0;
 	virtual void drawText(PSurface *dest, int x, int y,
 			      const std::string &text, uint chars,
 			      bool fg) = 0;
 
+	/**
+	 * Width of text cut at each character boundary, measured on
+	 * demand while searching for a cut point and kept for the next
+	 * trim of the same text.
+	 */
+	class WidthTable {
+	public:
+		WidthTable(void);
+
+		void reset(const std::string &text);
+
+		const std::string &getText(void) const { return _text; }
+		/** Number of character boundaries, excluding 0 and end. */
+		size_t size(void) const { return _pos.size(); }
+		size_t pos(size_t i) const { return _pos[i]; }
+
+		uint getWidth(PFont *font);
+		uint getPrefixWidth(PFont *font, size_t i);
+		uint getSuffixWidth(PFont *font, size_t i);
+
+	private:
+		std::string _text;
+		int _width;
+		std::vector<size_t> _pos;
+		std::vector<int> _prefix;
+		std::vector<int> _suffix;
+	};
+
+	WidthTable &getWidthTable(const std::string &text);
+	size_t findPrefixFit(WidthTable &table, uint max_width);
+	size_t findSuffixFit(WidthTable &table, size_t start, uint max_width);
+
 protected:
 	uint _height, _ascent, _descent;
 	uint _offset_x, _offset_y, _justify;
 
 	static std::string _trim_string;
+
+private:
+	/** Number of strings to keep width tables for. */
+	static const size_t WIDTH_CACHE_SIZE = 16;
+
+	std::vector<WidthTable> _width_cache;
+	size_t _width_cache_next;
+	/** Cache of measured text, shared between fonts. */
+	TextExtentCache *_extent_cache;
 };
 
 /**
@@ -192,10 +246,6 @@ public:
 	virtual bool load(const PFont::Descr&) { return true; }
 	virtual void unload(void) { }
 
-	virtual uint getWidth(const std::string&, uint max_chars = 0) {
-		return 0;
-	}
-
 	virtual void setColor(PFont::Color *color) { }
 
 protected:
@@ -204,6 +254,7 @@ protected:
 	}
 
 private:
+	virtual uint textWidth(const std::string&, uint) { return 0; }
 	virtual void drawText(PSurface*, int, int, const std::string&, uint,
 			      bool) { }
 };
@@ -13,7 +13,7 @@
 static const char* FALLBACK_FONT_FAMILY = "Sans";
 static const int FALLBACK_FONT_SIZE = 12 * PANGO_SCALE;
 
-static Util::StringTo<const char*> weight_map[] =
+static Util::StringTo<const char*> weight_map_entries[] =
 	{{"THIN", "Thin"},
 	 {"EXTRALIGHT", "Extra-Light"},
 	 {"ULTRALIGHT", "Ultra-Light"},
@@ -31,8 +31,9 @@ static Util::StringTo<const char*> weight_map[] =
 	 {"BLACK", "Black"},
 	 {"HEAVY", "Heavy"},
 	 {nullptr, ""}};
+static Util::StringToIndex<const char*> weight_map(weight_map_entries);
 
-static Util::StringTo<const char*> width_map[] =
+static Util::StringTo<const char*> width_map_entries[] =
 	{{"ULTRACONDENSED", "Ultra-Condensed"},
 	 {"EXTRACONDENSED", "Extra-Condensed"},
 	 {"CONDENSED", "Condensed"},
@@ -43,6 +44,7 @@ static Util::StringTo<const char*> width_map[] =
 	 {"EXTRAEXPANDED", "Extra-Expanded"},
 	 {"ULTRAEXPANDED", "Ultra-Expanded"},
 	 {nullptr, ""}};
+static Util::StringToIndex<const char*> width_map(width_map_entries);
 
 static void
 ossAppend(std::ostringstream& oss, const std::string& str)
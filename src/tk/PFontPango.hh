@@ -26,7 +26,6 @@ public:
 	virtual bool load(const PFont::Descr& descr);
 	virtual void unload(void);
 
-	virtual uint getWidth(const std::string& text, uint chars = 0) = 0;
 	virtual bool useAscentDescent(void) const;
 	virtual void setColor(PFont::Color* color) = 0;
 
@@ -42,6 +41,7 @@ private:
 	void toNativeDescrAddStretch(const PFont::Descr& descr,
 				     std::ostringstream& native) const;
 
+	virtual uint textWidth(const std::string& text, uint chars) = 0;
 	virtual void drawText(PSurface* dest, int x, int y,
 			      const std::string& text, uint chars,
 			      bool fg) = 0;
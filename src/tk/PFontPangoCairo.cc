@@ -104,7 +104,7 @@ PFontPangoCairo::~PFontPangoCairo(void)
 }
 
 uint
-PFontPangoCairo::getWidth(const std::string& text, uint chars)
+PFontPangoCairo::textWidth(const std::string& text, uint chars)
 {
 	PFontPangoCairoLayout layout(_cairo_surface, _font_description,
 				     text, charsToLen(chars));
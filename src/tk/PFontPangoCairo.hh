@@ -34,10 +34,10 @@ public:
 	PFontPangoCairo(void);
 	virtual ~PFontPangoCairo(void);
 
-	virtual uint getWidth(const std::string& text, uint chars = 0);
 	virtual void setColor(PFont::Color* color);
 
 private:
+	virtual uint textWidth(const std::string& text, uint chars);
 	virtual void drawText(PSurface* dest, int x, int y,
 			      const std::string& text, uint chars,
 			      bool fg);
@@ -60,7 +60,7 @@ PFontPangoXft::~PFontPangoXft(void)
 }
 
 uint
-PFontPangoXft::getWidth(const std::string& text, uint chars)
+PFontPangoXft::textWidth(const std::string& text, uint chars)
 {
 	PFontPangoXftLayout layout(_context, _font_description, text,
 				   charsToLen(chars));
@@ -12,7 +12,7 @@
 static const char* DEFAULT_SERIF = "courier";
 static const char* DEFAULT_SANS = "helvetica";
 
-static Util::StringTo<const char*> weight_map[] =
+static Util::StringTo<const char*> weight_map_entries[] =
 	{{"THIN", "light"},
 	 {"EXTRALIGHT", "light"},
 	 {"ULTRALIGHT", "light"},
@@ -30,14 +30,16 @@ static Util::StringTo<const char*> weight_map[] =
 	 {"BLACK", "bold"},
 	 {"HEAVY", "bold"},
 	 {nullptr, "medium"}};
+static Util::StringToIndex<const char*> weight_map(weight_map_entries);
 
-static Util::StringTo<const char*> slant_map[] =
+static Util::StringTo<const char*> slant_map_entries[] =
 	{{"ITALIC", "i"},
 	 {"OBLICQUE", "o"},
 	 {"ROMAN", "r"},
 	 {nullptr, "r"}};
+static Util::StringToIndex<const char*> slant_map(slant_map_entries);
 
-static Util::StringTo<const char*> width_map[] =
+static Util::StringTo<const char*> width_map_entries[] =
 	{{"ULTRACONDENSED", "condensed"},
 	 {"EXTRACONDENSED", "condensed"},
 	 {"CONDENSED", "condensed"},
@@ -48,6 +50,7 @@ static Util::StringTo<const char*> width_map[] =
 	 {"EXTRAEXPANDED", "normal"},
 	 {"ULTRAEXPANDED", "normal"},
 	 {nullptr, "*"}};
+static Util::StringToIndex<const char*> width_map(width_map_entries);
 
 
 
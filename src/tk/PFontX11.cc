@@ -82,7 +82,7 @@ PFontX11::unload(void)
  * Gets the width the text would take using this font
  */
 uint
-PFontX11::getWidth(const std::string &text, uint max_chars)
+PFontX11::textWidth(const std::string &text, uint max_chars)
 {
 	if (! text.size()) {
 		return 0;
@@ -65,7 +65,7 @@ PFontXft::unload(void)
  * Gets the width the text would take using this font.
  */
 uint
-PFontXft::getWidth(const std::string &text, uint max_chars)
+PFontXft::textWidth(const std::string &text, uint max_chars)
 {
 	if (! text.size()) {
 		return 0;
@@ -27,7 +27,6 @@ public:
 	virtual bool load(const PFont::Descr& descr);
 	virtual void unload(void);
 
-	virtual uint getWidth(const std::string &text, uint max_chars = 0);
 	virtual bool useAscentDescent(void) const;
 
 	virtual void setColor(PFont::Color *color);
@@ -36,6 +35,7 @@ protected:
 	virtual std::string toNativeDescr(const PFont::Descr &descr) const;
 
 private:
+	virtual uint textWidth(const std::string &text, uint max_chars);
 	virtual void drawText(PSurface *dest, int x, int y,
 			      const std::string &text, uint chars, bool fg);
 
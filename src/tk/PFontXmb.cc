@@ -117,7 +117,7 @@ PFontXmb::unload(void)
  * Gets the width the text would take using this font
  */
 uint
-PFontXmb::getWidth(const std::string &text, uint max_chars)
+PFontXmb::textWidth(const std::string &text, uint max_chars)
 {
 	if (! text.size()) {
 		return 0;
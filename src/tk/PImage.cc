@@ -17,8 +17,10 @@
 #include "PImageLoaderPng.hh"
 #include "PImageLoaderXpm.hh"
 #include "String.hh"
+#include "ThreadPool.hh"
 #include "Util.hh"
 
+#include <algorithm>
 #include <cstring>
 #include <memory>
 
@@ -26,14 +28,6 @@ extern "C" {
 #include <X11/Xutil.h>
 }
 
-static void
-destroyXImage(XImage *ximage)
-{
-	delete [] ximage->data;
-	ximage->data = nullptr;
-	X11::destroyImage(ximage);
-}
-
 typedef ulong (*rgbToPixel)(uchar, uchar, uchar);
 
 // cppcheck-suppress unusedFunction
@@ -216,6 +210,7 @@ PImage::PImage(void)
 	: _type(IMAGE_TYPE_NO),
 	  _pixmap(None),
 	  _mask(None),
+	  _picture(None),
 	  _width(0),
 	  _height(0),
 	  _data(nullptr),
@@ -227,17 +222,21 @@ PImage::PImage(void)
  * PImage constructor, loads image if one is specified.
  *
  * @param path Path to image file, if specified this is loaded.
+ * @param hint_width Width the image will be scaled to, 0 if unknown.
+ * @param hint_height Height the image will be scaled to, 0 if unknown.
  */
-PImage::PImage(const std::string &path)
+PImage::PImage(const std::string &path,
+	       size_t hint_width, size_t hint_height)
 	: _type(IMAGE_TYPE_NO),
 	  _pixmap(None),
 	  _mask(None),
+	  _picture(None),
 	  _width(0),
 	  _height(0),
 	  _data(nullptr),
 	  _use_alpha(false)
 {
-	if (! path.size() || ! load(path)) {
+	if (! path.size() || ! load(path, hint_width, hint_height)) {
 		throw LoadException(path);
 	}
 }
@@ -246,6 +245,7 @@ PImage::PImage(PImage *image)
 	: _type(image->getType()),
 	  _pixmap(None),
 	  _mask(None),
+	  _picture(None),
 	  _width(image->getWidth()),
 	  _height(image->getHeight()),
 	  _use_alpha(image->_use_alpha)
@@ -254,6 +254,21 @@ PImage::PImage(PImage *image)
 	memcpy(_data, image->getData(), _width * _height);
 }
 
+/**
+ * Create PImage from ARGB data, the image takes ownership of data.
+ */
+PImage::PImage(uchar *data, size_t width, size_t height, bool use_alpha)
+	: _type(IMAGE_TYPE_NO),
+	  _pixmap(None),
+	  _mask(None),
+	  _picture(None),
+	  _width(width),
+	  _height(height),
+	  _data(data),
+	  _use_alpha(use_alpha)
+{
+}
+
 /**
  * Create PImage from XImage.
  */
@@ -261,6 +276,7 @@ PImage::PImage(XImage *image, uchar opacity)
 	: _type(IMAGE_TYPE_FIXED),
 	  _pixmap(None),
 	  _mask(None),
+	  _picture(None),
 	  _width(image->width),
 	  _height(image->height),
 	  _data(new uchar[image->width * image->height * 4]),
@@ -290,10 +306,13 @@ PImage::~PImage(void)
  * Loads image from file.
  *
  * @param file File to load.
+ * @param hint_width Width the image will be scaled to, loaders
+ *                   supporting it decode a smaller image. 0 if unknown.
+ * @param hint_height Height the image will be scaled to.
  * @return Returns true on success, else false.
  */
 bool
-PImage::load(const std::string &file)
+PImage::load(const std::string &file, size_t hint_width, size_t hint_height)
 {
 	unload();
 
@@ -308,7 +327,9 @@ PImage::load(const std::string &file)
 		_data = PImageLoaderJpeg::load(file,
 					       _width,
 					       _height,
-					       _use_alpha);
+					       _use_alpha,
+					       hint_width,
+					       hint_height);
 	} else
 #endif // PEKWM_HAVE_IMAGE_JPEG
 #ifdef PEKWM_HAVE_IMAGE_PNG
@@ -352,9 +373,11 @@ PImage::unload(void)
 	if (_mask) {
 		X11::freePixmap(_mask);
 	}
+	X11::renderFreePicture(_picture);
 
 	_pixmap = None;
 	_mask = None;
+	_picture = None;
 	_width = 0;
 	_height = 0;
 }
@@ -382,6 +405,10 @@ PImage::draw(Render &rend, int x, int y, size_t width, size_t height)
 		height = _height;
 	}
 
+	if (_use_alpha && drawAlphaRender(rend, x, y, width, height)) {
+		return;
+	}
+
 	// Draw image, select correct drawing method depending on image type,
 	// size and if alpha exists.
 	if ((_type == IMAGE_TYPE_FIXED)
@@ -493,6 +520,29 @@ PImage::getMask(bool &need_free, size_t width, size_t height)
 	return pix;
 }
 
+/**
+ * Create 32 bit pixmap with premultiplied alpha, as used by XRender
+ * ARGB32 pictures, of image scaled to size. The caller frees the
+ * pixmap.
+ *
+ * @return Pixmap, None if XRender is not available.
+ */
+Pixmap
+PImage::createArgbPixmap(size_t width, size_t height)
+{
+	if ((width == _width) && (height == _height)) {
+		return X11::createArgbPixmap(_data, width, height);
+	}
+
+	uchar *scaled_data = getScaledData(width, height);
+	if (scaled_data == nullptr) {
+		return None;
+	}
+	Pixmap pix = X11::createArgbPixmap(scaled_data, width, height);
+	delete [] scaled_data;
+	return pix;
+}
+
 /**
  * Scales image to size.
  *
@@ -519,6 +569,53 @@ PImage::scale(size_t width, size_t height)
 	}
 }
 
+/**
+ * Composite image on the X server using XRender, the image data is
+ * uploaded once and scaling and tiling is done with picture transforms
+ * and repeat instead of on the CPU.
+ *
+ * @return false if XRender is not available for rend.
+ */
+bool
+PImage::drawAlphaRender(Render &rend, int x, int y,
+			size_t width, size_t height)
+{
+	if (! X11::hasExtensionXRender()) {
+		return false;
+	}
+	Picture dst = rend.getPicture();
+	if (dst == None) {
+		return false;
+	}
+	if (_picture == None) {
+		_picture = X11::renderCreateArgbPicture(_data, _width, _height);
+		if (_picture == None) {
+			return false;
+		}
+	}
+
+	if (_type == IMAGE_TYPE_SCALED) {
+		// bilinear filtering samples outside of the picture at the
+		// edges, pad to not blend in transparent pixels.
+		X11::renderSetPictureRepeat(_picture, RENDER_REPEAT_PAD);
+		X11::renderSetPictureScale(_picture, _width, _height,
+					   width, height);
+	} else {
+		X11::renderSetPictureRepeat(_picture,
+					    _type == IMAGE_TYPE_TILED
+					    ? RENDER_REPEAT_NORMAL
+					    : RENDER_REPEAT_NONE);
+		X11::renderSetPictureScale(_picture, _width, _height,
+					   _width, _height);
+		if (_type != IMAGE_TYPE_TILED) {
+			width = std::min(width, _width);
+			height = std::min(height, _height);
+		}
+	}
+	X11::renderComposite(_picture, dst, 0, 0, x, y, width, height);
+	return true;
+}
+
 /**
  * Draw image at position, not scaling.
  */
@@ -811,6 +908,67 @@ PImage::createMask(uchar* data, size_t width, size_t height)
 	return pix;
 }
 
+/**
+ * Allocate XImage with client side storage for width x height pixels,
+ * large images are shared with the server if possible to avoid copying
+ * them over the connection. Free with destroyXImage.
+ */
+XImage*
+PImage::allocXImage(size_t width, size_t height)
+{
+	XImage *ximage = X11::createShmImage(width, height);
+	if (! ximage) {
+		ximage = X11::createImage(nullptr, width, height);
+		if (! ximage) {
+			P_ERR("failed to create XImage " << width << "x"
+			      << height);
+			return nullptr;
+		}
+
+		// Allocate ximage data storage.
+		ximage->data = new char[ximage->bytes_per_line * height];
+	}
+	return ximage;
+}
+
+/**
+ * Free XImage allocated with allocXImage.
+ */
+void
+PImage::destroyXImage(XImage *ximage)
+{
+	if (! X11::isShmImage(ximage)) {
+		delete [] ximage->data;
+		ximage->data = nullptr;
+	}
+	X11::destroyImage(ximage);
+}
+
+/**
+ * Write image scaled to width x height into ximage, alpha is ignored.
+ * No X11 requests are made, making it safe to call from worker threads
+ * as long as each thread uses its own XImage.
+ */
+bool
+PImage::fillXImage(XImage *ximage, size_t width, size_t height)
+{
+	if (_data == nullptr) {
+		return false;
+	}
+	if (width == _width && height == _height) {
+		writeXImage(ximage, _data, width, height);
+		return true;
+	}
+
+	uchar *scaled_data = getScaledData(width, height);
+	if (scaled_data == nullptr) {
+		return false;
+	}
+	writeXImage(ximage, scaled_data, width, height);
+	delete [] scaled_data;
+	return true;
+}
+
 /**
  * Createx XImage from data.
  *
@@ -821,33 +979,124 @@ PImage::createMask(uchar* data, size_t width, size_t height)
 XImage*
 PImage::createXImage(uchar* data, size_t width, size_t height)
 {
-	// Create XImage
-	XImage *ximage = X11::createImage(nullptr, width, height);
-	if (! ximage) {
-		P_ERR("failed to create XImage " << width << "x" << height);
-		return nullptr;
+	XImage *ximage = allocXImage(width, height);
+	if (ximage) {
+		writeXImage(ximage, data, width, height);
 	}
+	return ximage;
+}
 
-	// Allocate ximage data storage.
-	ximage->data = new char[ximage->bytes_per_line * height];
+/**
+ * Minimum number of pixels for splitting conversion between the
+ * threads of the pool, below this the overhead is larger than the gain.
+ */
+static const size_t THREAD_MIN_PIXELS = 256 * 256;
 
-	uchar *src = data;
+/**
+ * Image data split into bands of rows, converted by separate jobs.
+ */
+struct WriteXImageJob {
+	XImage *ximage;
+	const uchar *data;
+	size_t width;
+	size_t height;
+	size_t rows;
+};
 
-	rgbToPixel toPixel = getRgbToPixelFun(ximage);
+static bool
+isHostLSBFirst(void)
+{
+	const uint one = 1;
+	return *reinterpret_cast<const uchar*>(&one) == 1;
+}
 
-	// Put data into XImage.
-	for (size_t y = 0; y < height; ++y) {
-		for (size_t x = 0; x < width; ++x) {
-			// skip alpha
-			src++;
-			uchar r = *src++;
-			uchar g = *src++;
-			uchar b = *src++;
-			XPutPixel(ximage, x, y, toPixel(r, g, b));
+/**
+ * Convert rows y_start to y_end of ARGB data into ximage, 32 and 16
+ * bit images in host byte order are written directly to the image data
+ * instead of using XPutPixel.
+ */
+static void
+writeXImageRows(XImage *ximage, const uchar *data, size_t width,
+		size_t y_start, size_t y_end)
+{
+	rgbToPixel toPixel = getRgbToPixelFun(ximage);
+	bool host_order =
+		(ximage->byte_order == LSBFirst) == isHostLSBFirst();
+	const uchar *src = data + y_start * width * 4;
+
+	// src[0] is alpha, ignored
+	if (host_order && ximage->bits_per_pixel == 32
+	    && toPixel == rgbToPixel24bitLSB && sizeof(uint) == 4) {
+		for (size_t y = y_start; y < y_end; ++y) {
+			uint *dst = reinterpret_cast<uint*>(
+				ximage->data + y * ximage->bytes_per_line);
+			for (size_t x = 0; x < width; ++x, src += 4) {
+				dst[x] = (src[1] << 16) | (src[2] << 8)
+					| src[3];
+			}
+		}
+	} else if (host_order && ximage->bits_per_pixel == 32
+		   && sizeof(uint) == 4) {
+		for (size_t y = y_start; y < y_end; ++y) {
+			uint *dst = reinterpret_cast<uint*>(
+				ximage->data + y * ximage->bytes_per_line);
+			for (size_t x = 0; x < width; ++x, src += 4) {
+				dst[x] = toPixel(src[1], src[2], src[3]);
+			}
+		}
+	} else if (host_order && ximage->bits_per_pixel == 16
+		   && sizeof(ushort) == 2) {
+		for (size_t y = y_start; y < y_end; ++y) {
+			ushort *dst = reinterpret_cast<ushort*>(
+				ximage->data + y * ximage->bytes_per_line);
+			for (size_t x = 0; x < width; ++x, src += 4) {
+				dst[x] = toPixel(src[1], src[2], src[3]);
+			}
+		}
+	} else {
+		for (size_t y = y_start; y < y_end; ++y) {
+			for (size_t x = 0; x < width; ++x, src += 4) {
+				XPutPixel(ximage, x, y,
+					  toPixel(src[1], src[2], src[3]));
+			}
 		}
 	}
+}
 
-	return ximage;
+static void
+writeXImageJob(size_t index, void *opaque)
+{
+	WriteXImageJob *job = static_cast<WriteXImageJob*>(opaque);
+	size_t y_start = index * job->rows;
+	size_t y_end = std::min(y_start + job->rows, job->height);
+	writeXImageRows(job->ximage, job->data, job->width, y_start, y_end);
+}
+
+ThreadPool *PImage::_thread_pool = nullptr;
+
+/**
+ * Convert ARGB data into the pixel format of ximage, large images are
+ * split into bands of rows converted on the thread pool.
+ */
+void
+PImage::writeXImage(XImage *ximage, const uchar *data,
+		    size_t width, size_t height)
+{
+	if (_thread_pool == nullptr || _thread_pool->size() < 2
+	    || width * height < THREAD_MIN_PIXELS) {
+		writeXImageRows(ximage, data, width, 0, height);
+		return;
+	}
+
+	size_t bands = _thread_pool->size();
+	WriteXImageJob job;
+	job.ximage = ximage;
+	job.data = data;
+	job.width = width;
+	job.height = height;
+	job.rows = (height + bands - 1) / bands;
+	_thread_pool->run((height + job.rows - 1) / job.rows,
+			  writeXImageJob, &job);
 }
 
 static inline uchar
@@ -15,12 +15,16 @@
 
 #include <string>
 
+class ThreadPool;
+
 //! @brief Image baseclass defining interface for image handling.
 class PImage {
 public:
-	PImage(const std::string &path);
+	PImage(const std::string &path,
+	       size_t hint_width = 0, size_t hint_height = 0);
 	PImage(PImage *image);
 	PImage(XImage *image, uchar opacity=255);
+	PImage(uchar *data, size_t width, size_t height, bool use_alpha);
 	virtual ~PImage(void);
 
 	//! @brief Returns type of image.
@@ -33,15 +37,28 @@ public:
 	inline size_t getWidth(void) const { return _width; }
 	//! @brief Returns height of image.
 	inline size_t getHeight(void) const { return _height; }
+	/** Returns false if all pixels are fully opaque. */
+	inline bool useAlpha(void) const { return _use_alpha; }
 
-	bool load(const std::string &file);
+	bool load(const std::string &file,
+		  size_t hint_width = 0, size_t hint_height = 0);
 	void unload(void);
 
 	void draw(Render &rend, int x, int y,
 		  size_t width = 0, size_t height = 0);
 	Pixmap getPixmap(bool &need_free, size_t width = 0, size_t height = 0);
 	Pixmap getMask(bool &need_free, size_t width = 0, size_t height = 0);
+	Pixmap createArgbPixmap(size_t width, size_t height);
 	void scale(size_t width, size_t height);
+	bool fillXImage(XImage *ximage, size_t width, size_t height);
+
+	static XImage *allocXImage(size_t width, size_t height);
+	static void destroyXImage(XImage *ximage);
+
+	/** Return pool used for converting large images, may be nullptr. */
+	static ThreadPool *getThreadPool(void) { return _thread_pool; }
+	/** Set pool used for converting large images, not owned. */
+	static void setThreadPool(ThreadPool *pool) { _thread_pool = pool; }
 
 	static void drawAlphaFixed(Render &rend,
 				   int x, int y, size_t width, size_t height,
@@ -59,6 +76,8 @@ protected:
 			int x, int y, size_t width, size_t height);
 	void drawTiled(Render &rend,
 		       int x, int y, size_t width, size_t height);
+	bool drawAlphaRender(Render &rend,
+			     int x, int y, size_t width, size_t height);
 	void drawAlphaScaled(Render &rend,
 			     int x, int y, size_t widht, size_t height);
 	void drawAlphaTiled(Render &rend,
@@ -72,6 +91,8 @@ private:
 	PImage& operator=(const PImage&);
 
 	XImage* createXImage(uchar* data, size_t width, size_t height);
+	static void writeXImage(XImage *ximage, const uchar *data,
+				size_t width, size_t height);
 	uchar* getScaledData(size_t width, size_t height);
 
 protected:
@@ -79,6 +100,8 @@ protected:
 
 	Pixmap _pixmap; //!< Pixmap representation of image.
 	Pixmap _mask; //!< Pixmap representation of image shape mask.
+	/** XRender picture of image, created on first alpha draw. */
+	Picture _picture;
 
 	size_t _width; //!< Width of image.
 	size_t _height; //!< Height of image.
@@ -87,6 +110,8 @@ protected:
 	uchar *_data;
 	/** If all pixels have 100% alpha, this is set to false. */
 	bool _use_alpha;
+
+	static ThreadPool *_thread_pool;
 };
 
 #endif // _PEKWM_PIMAGE_HH_
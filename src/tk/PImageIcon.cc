@@ -10,7 +10,9 @@
 
 #include <cstring>
 #include <iostream>
+#include <sstream>
 
+#include "ImageHandler.hh"
 #include "PImageIcon.hh"
 
 /**
@@ -45,29 +47,244 @@ PImageIcon::~PImageIcon(void)
 }
 
 /**
- * Load icon from window (if atom is set)
+ * Get icon from window shared between windows with the same icon, the
+ * icon is owned by the image handler and must be released with
+ * returnImage.
+ *
+ * @param win Window to read _NET_WM_ICON from.
+ * @param width Width the icon will be drawn with, 0 for largest.
+ * @param height Height the icon will be drawn with, 0 for largest.
+ * @return Icon, nullptr if window has no valid icon.
+ */
+PImage*
+PImageIcon::getFromWindow(Window win, size_t width, size_t height)
+{
+	uchar *udata;
+	ulong offset;
+	if (! readIcon(win, width, height, &udata, offset)) {
+		return nullptr;
+	}
+
+	const Cardinal *data = reinterpret_cast<Cardinal*>(udata) + offset;
+	std::ostringstream key;
+	key << "ICON#" << data[0] << "X" << data[1] << "#" << std::hex
+	    << hashIcon(data);
+	PImage *image = getShared(pekwm::imageHandler(), key.str(), data);
+	X11::free(udata);
+	return image;
+}
+
+/**
+ * Get icon with data from image handler, adding it if not found. Icons
+ * with colliding keys are added with a #n suffix, making them shared
+ * as well.
+ *
+ * @return Icon, must be released with returnImage.
+ */
+PImage*
+PImageIcon::getShared(ImageHandler *image_handler, const std::string &key,
+		      const Cardinal *data)
+{
+	for (uint i = 0; ; i++) {
+		std::ostringstream i_key;
+		i_key << key;
+		if (i > 0) {
+			i_key << "#" << i;
+		}
+
+		PImage *image = image_handler->findImage(i_key.str());
+		if (image == nullptr) {
+			PImageIcon *icon = new PImageIcon();
+			icon->setImageFromData(data);
+			image_handler->takeOwnership(icon, i_key.str());
+			return icon;
+		}
+		if (isIconData(image, data)) {
+			return image;
+		}
+		image_handler->returnImage(image);
+	}
+}
+
+/**
+ * Load icon from window (if atom is set), selecting the icon size
+ * closest to width x height.
  */
 PImageIcon*
-PImageIcon::newFromWindow(Window win)
+PImageIcon::newFromWindow(Window win, size_t width, size_t height)
 {
-	PImageIcon *icon = nullptr;
+	uchar *udata;
+	ulong offset;
+	if (! readIcon(win, width, height, &udata, offset)) {
+		return nullptr;
+	}
 
-	uchar *udata = 0;
-	ulong expected = 2, actual;
-	if (X11::getProperty(win, X11::getAtom(NET_WM_ICON), XA_CARDINAL,
-			     expected, &udata, &actual)) {
-		if (actual >= expected) {
+	PImageIcon *icon = new PImageIcon();
+	icon->setImageFromData(reinterpret_cast<Cardinal*>(udata) + offset);
+	X11::free(udata);
+	return icon;
+}
+
+/**
+ * Load icon shared by pekwm in _PEKWM_ICON, a 32 bit pixmap with
+ * premultiplied alpha already scaled to the size in _PEKWM_ICON_SIZE.
+ *
+ * @return Icon, nullptr if window has no shared icon.
+ */
+PImageIcon*
+PImageIcon::newFromShared(Window win)
+{
+	uchar *udata = nullptr;
+	ulong expected = 3, actual;
+	if (! X11::getProperty(win, X11::getAtom(PEKWM_ICON), XA_CARDINAL,
+			       expected, &udata, &actual)) {
+		return nullptr;
+	}
+
+	PImageIcon *icon = nullptr;
+	const Cardinal *shared = reinterpret_cast<Cardinal*>(udata);
+	size_t width = actual >= expected ? shared[1] : 0;
+	size_t height = actual >= expected ? shared[2] : 0;
+	if (width && height
+	    && width <= X11::getWidth() && height <= X11::getHeight()) {
+		uchar *data = new uchar[width * height * 4];
+		if (X11::readArgbPixmap(shared[0], width, height, data)) {
 			icon = new PImageIcon();
-			if (! icon->setImageFromData(udata, actual)) {
-				delete icon;
-				icon = nullptr;
-			}
+			icon->_width = width;
+			icon->_height = height;
+			icon->_data = data;
+		} else {
+			delete [] data;
 		}
-		X11::free(udata);
 	}
+	X11::free(udata);
 	return icon;
 }
 
+/**
+ * Read _NET_WM_ICON from window and find the icon to use.
+ *
+ * @param udata Set to property data, free with X11::free on success.
+ * @param offset Set to offset, in cardinals, of the icon in udata.
+ */
+bool
+PImageIcon::readIcon(Window win, size_t width, size_t height,
+		     uchar **udata, ulong &offset)
+{
+	ulong expected = 2, actual;
+	if (! X11::getProperty(win, X11::getAtom(NET_WM_ICON), XA_CARDINAL,
+			       expected, udata, &actual)) {
+		return false;
+	}
+
+	const Cardinal *data = reinterpret_cast<Cardinal*>(*udata);
+	// icons larger than the screen are disregarded
+	if (actual < expected
+	    || ! findIcon(data, actual, width, height,
+			  X11::getWidth(), X11::getHeight(), offset)) {
+		X11::free(*udata);
+		return false;
+	}
+	return true;
+}
+
+/**
+ * Find icon in _NET_WM_ICON data, which is a list of width, height
+ * and width * height ARGB pixels. The smallest icon at least width x
+ * height is used, the largest if none is large enough.
+ *
+ * @param num Number of cardinals in data.
+ * @param max_width Icons wider than max_width are invalid.
+ * @param max_height Icons higher than max_height are invalid.
+ * @param offset Set to the offset of the icon width, in cardinals.
+ * @return true if a valid icon was found.
+ */
+bool
+PImageIcon::findIcon(const Cardinal *data, ulong num,
+		     size_t width, size_t height,
+		     size_t max_width, size_t max_height, ulong &offset)
+{
+	bool found = false, best_fits = false;
+	size_t best_pixels = 0;
+	for (ulong pos = 0; pos + 2 <= num; ) {
+		size_t icon_width = data[pos];
+		size_t icon_height = data[pos + 1];
+		if (icon_width == 0 || icon_height == 0
+		    || icon_width > max_width
+		    || icon_height > max_height
+		    || icon_width * icon_height > num - pos - 2) {
+			break;
+		}
+
+		size_t pixels = icon_width * icon_height;
+		bool fits = icon_width >= width && icon_height >= height;
+		bool better;
+		if (! found) {
+			better = true;
+		} else if (fits != best_fits) {
+			better = fits;
+		} else if (fits && (width || height)) {
+			better = pixels < best_pixels;
+		} else {
+			better = pixels > best_pixels;
+		}
+
+		if (better) {
+			found = true;
+			best_fits = fits;
+			best_pixels = pixels;
+			offset = pos;
+		}
+		pos += pixels + 2;
+	}
+	return found;
+}
+
+/**
+ * FNV-1a hash of icon dimensions and pixels.
+ */
+uint
+PImageIcon::hashIcon(const Cardinal *data)
+{
+	size_t num = data[0] * data[1] + 2;
+	uint hash = 2166136261u;
+	for (size_t i = 0; i < num; i++) {
+		uint val = static_cast<uint>(data[i]);
+		for (int j = 0; j < 4; j++) {
+			hash = (hash ^ (val & 0xff)) * 16777619u;
+			val >>= 8;
+		}
+	}
+	return hash;
+}
+
+/**
+ * Check if image contains the icon data, guards against hash
+ * collisions when sharing icons.
+ */
+bool
+PImageIcon::isIconData(PImage *image, const Cardinal *data)
+{
+	size_t width = data[0];
+	size_t height = data[1];
+	if (image->getWidth() != width || image->getHeight() != height) {
+		return false;
+	}
+
+	const uchar *pixel = image->getData();
+	const Cardinal *src = data + 2;
+	for (size_t i = 0; i < width * height; i++, pixel += 4) {
+		uint val = static_cast<uint>(*src++);
+		if (pixel[0] != (val >> 24 & 0xff)
+		    || pixel[1] != (val >> 16 & 0xff)
+		    || pixel[2] != (val >> 8 & 0xff)
+		    || pixel[3] != (val & 0xff)) {
+			return false;
+		}
+	}
+	return true;
+}
+
 /**
  * Set _NET_WM_ICON on window.
  */
@@ -105,41 +322,23 @@ PImageIcon::newCardinals(size_t width, size_t height, uchar *data)
 }
 
 /**
- * Do the actual reading and loading of the icon data in ARGB data.
+ * Convert the icon at data, width and height followed by ARGB pixels,
+ * validated by findIcon. Pixmap and mask are created on demand.
  */
-bool
-PImageIcon::setImageFromData(uchar *udata, ulong actual)
+void
+PImageIcon::setImageFromData(const Cardinal *data)
 {
-	// Icon size successfully read, proceed with loading the actual
-	// icon data.
-	Cardinal *from_data = reinterpret_cast<Cardinal*>(udata);
-	size_t width = from_data[0];
-	size_t height = from_data[1];
-	size_t pixels = width * height;
-
-	// Some sort of sanity check on the values given, icons larger than
-	// the screen size will be disregarded.
-	if (width > X11::getWidth()
-	    || height > X11::getHeight()
-	    || actual < (pixels + 2)) {
-		return false;
-	}
-
-	_width = width;
-	_height = height;
-
-	_data = new uchar[pixels * 4];
-	fromCardinals(pixels, from_data, _data);
-	_pixmap = createPixmap(_data, _width, _height);
-	_mask =  createMask(_data, _width, _height);
-
-	return true;
+	_width = data[0];
+	_height = data[1];
+	_data = new uchar[_width * _height * 4];
+	fromCardinals(_width * _height, data + 2, _data);
 }
 
 void
-PImageIcon::fromCardinals(size_t pixels, Cardinal *from_data, uchar *to_data)
+PImageIcon::fromCardinals(size_t pixels, const Cardinal *from_data,
+			  uchar *to_data)
 {
-	Cardinal *src = from_data;
+	const Cardinal *src = from_data;
 	uchar *dst = to_data;
 	for (size_t i = 0; i < pixels; i += 1) {
 		int pixel = *src++;
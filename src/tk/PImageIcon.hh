@@ -1,6 +1,6 @@
 //
 // PImageIcon.hh for pekwm
-// Copyright (C) 2007-2021 Claes Nästén <pekdon@gmail.com>
+// Copyright (C) 2007-2023 Claes Nästén <pekdon@gmail.com>
 //
 // This program is licensed under the GNU GPL.
 // See the LICENSE file for more information.
@@ -14,6 +14,10 @@
 #include "PImage.hh"
 #include "X11.hh"
 
+#include <string>
+
+class ImageHandler;
+
 /**
  * Image loading from X11 windows.
  */
@@ -24,19 +28,36 @@ public:
 
 	void setOnWindow(Window win);
 
-	static PImageIcon *newFromWindow(Window win);
+	static PImage *getFromWindow(Window win,
+				     size_t width = 0, size_t height = 0);
+	static PImageIcon *newFromWindow(Window win,
+					 size_t width = 0, size_t height = 0);
+	static PImageIcon *newFromShared(Window win);
+	static PImage *getShared(ImageHandler *image_handler,
+				 const std::string &key,
+				 const Cardinal *data);
 	static void setOnWindow(Window win,
 				size_t width, size_t height, uchar *data);
 
+	static bool findIcon(const Cardinal *data, ulong num,
+			     size_t width, size_t height,
+			     size_t max_width, size_t max_height,
+			     ulong &offset);
+
 private:
 	PImageIcon(void);
 
 private:
-	bool setImageFromData(uchar *data, ulong actual);
+	void setImageFromData(const Cardinal *data);
+
+	static bool readIcon(Window win, size_t width, size_t height,
+			     uchar **udata, ulong &offset);
+	static uint hashIcon(const Cardinal *data);
+	static bool isIconData(PImage *image, const Cardinal *data);
 
 	static Cardinal* newCardinals(size_t width, size_t height, uchar *data);
 	static void fromCardinals(size_t pixels,
-				  Cardinal *from_data, uchar *to_data);
+				  const Cardinal *from_data, uchar *to_data);
 	static void toCardinals(size_t pixels,
 				uchar *from_data, Cardinal *to_data);
 
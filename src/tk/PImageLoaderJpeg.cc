@@ -26,6 +26,30 @@ namespace PImageLoaderJpeg
 		return "JPG";
 	}
 
+	/**
+	 * Get largest power of two scale denominator, up to 8, that
+	 * keeps a width x height image at least hint_width x hint_height
+	 * when decoded. A hint of 0 does not limit the scaling.
+	 */
+	uint
+	getScaleDenom(size_t width, size_t height,
+		      size_t hint_width, size_t hint_height)
+	{
+		if (hint_width == 0 && hint_height == 0) {
+			return 1;
+		}
+
+		uint denom = 8;
+		for (; denom > 1; denom /= 2) {
+			// libjpeg rounds scaled dimensions up
+			if ((width + denom - 1) / denom >= hint_width
+			    && (height + denom - 1) / denom >= hint_height) {
+				break;
+			}
+		}
+		return denom;
+	}
+
 	/**
 	 * Loads file into data.
 	 *
@@ -33,11 +57,15 @@ namespace PImageLoaderJpeg
 	 * @param width Set to the width of image.
 	 * @param height Set to the height of image.
 	 * @param use_alpha Set to true if pixels have < 100% alpha
+	 * @param hint_width Size the image will be scaled to, used to
+	 *                   decode a downscaled image directly. 0 decodes
+	 *                   the image in full size.
+	 * @param hint_height Size the image will be scaled to.
 	 * @return Pointer to data on success, else 0.
 	 */
 	uchar*
 	load(const std::string &file, size_t &width, size_t &height,
-	     bool &use_alpha)
+	     bool &use_alpha, size_t hint_width, size_t hint_height)
 	{
 		FILE *fp = fopen(file.c_str(), "rb");
 		if (! fp) {
@@ -58,6 +86,18 @@ namespace PImageLoaderJpeg
 		// Make sure we get data in 24bit RGB.
 		cinfo.out_color_space = JCS_RGB;
 
+		// Let the decoder downscale in the DCT domain, the final
+		// scaling is done when rendering the image.
+		cinfo.scale_num = 1;
+		cinfo.scale_denom = getScaleDenom(cinfo.image_width,
+						  cinfo.image_height,
+						  hint_width, hint_height);
+		if (cinfo.scale_denom > 1) {
+			P_TRACE("decoding " << file << " at 1/"
+				<< cinfo.scale_denom << " scale for "
+				<< hint_width << "x" << hint_height);
+		}
+
 		jpeg_start_decompress(&cinfo);
 
 		width = cinfo.output_width;
@@ -24,8 +24,11 @@
 namespace PImageLoaderJpeg
 {
 	const char *getExt(void);
+	uint getScaleDenom(size_t width, size_t height,
+			   size_t hint_width, size_t hint_height);
 	uchar* load(const std::string &file, size_t &width, size_t &height,
-		    bool &use_alpha);
+		    bool &use_alpha,
+		    size_t hint_width = 0, size_t hint_height = 0);
 }
 
 #endif // PEKWM_HAVE_IMAGE_JPEG
@@ -19,61 +19,20 @@ extern "C" {
 
 const int PNG_SIG_BYTES = 8;
 
-static void
-convertRgbaToArgb(uchar* data, size_t width, size_t height, bool& use_alpha)
-{
-	// alpha channel, no need to add alpha channel, check if an
-	// any alpha is < 100%
-	int pos = 0;
-	uchar alpha;
-	for (size_t y = 0; y < height; ++y) {
-		for (size_t x = 0; x < width; ++x) {
-			alpha = data[pos + 3];
-			data[pos + 3] = data[pos + 2];
-			data[pos + 2] = data[pos + 1];
-			data[pos + 1] = data[pos];
-			data[pos] = alpha;
-			if (! use_alpha && alpha != 255) {
-				use_alpha = true;
-			}
-			pos += 4;
-		}
-	}
-}
-
-static uchar*
-convertRgbToArgb(const uchar* data_rgb, size_t width, size_t height)
-{
-	uchar *data_argb = new uchar[width * height * 4];
-	int src = 0, dst = 0;
-	for (size_t y = 0; y < height; ++y) {
-		for (size_t x = 0; x < width; ++x) {
-			data_argb[dst++] = 0xff; // A
-			data_argb[dst++] = data_rgb[src++]; // R
-			data_argb[dst++] = data_rgb[src++]; // G
-			data_argb[dst++] = data_rgb[src++]; // B
-		}
-	}
-	return data_argb;
-}
-
-static uchar*
-convertArgbToRgb(const uchar* data_argb, size_t width, size_t height)
+/**
+ * Check if any pixel in the ARGB row is not fully opaque.
+ */
+static bool
+hasAlpha(const uchar *row, size_t width)
 {
-	uchar *data_rgb = new uchar[width * height * 4];
-	int src = 0, dst = 0;
-	for (size_t y = 0; y < height; ++y) {
-		for (size_t x = 0; x < width; ++x) {
-			src++; // A
-			data_rgb[dst++] = data_argb[src++]; // R
-			data_rgb[dst++] = data_argb[src++]; // G
-			data_rgb[dst++] = data_argb[src++]; // B
+	for (size_t x = 0; x < width; ++x, row += 4) {
+		if (*row != 255) {
+			return true;
 		}
 	}
-	return data_rgb;
+	return false;
 }
 
-
 /**
  * Checks file signature to see if it's a PNG file.
  *
@@ -161,7 +120,8 @@ namespace PImageLoaderPng
 		width = png_width;
 		height = png_height;
 
-		// Setup read information, read 24/32bit RGB/A
+		// Setup read information, transform every color type to
+		// 32bit ARGB so rows can be decoded into the final buffer.
 
 		// palette -> RGB mode
 		if (color_type == PNG_COLOR_TYPE_PALETTE) {
@@ -173,8 +133,10 @@ namespace PImageLoaderPng
 			png_set_expand_gray_1_2_4_to_8(png_ptr);
 		}
 
+		bool has_alpha = color_type & PNG_COLOR_MASK_ALPHA;
 		if (png_get_valid(png_ptr, info_ptr, PNG_INFO_tRNS)) {
 			png_set_tRNS_to_alpha(png_ptr);
+			has_alpha = true;
 		}
 
 		if (bpp == 16) {
@@ -186,46 +148,67 @@ namespace PImageLoaderPng
 			png_set_gray_to_rgb(png_ptr);
 		}
 
-		// Now load image data.
+		if (has_alpha) {
+			// RGBA -> ARGB
+			png_set_swap_alpha(png_ptr);
+		} else {
+			// RGB -> ARGB
+			png_set_filler(png_ptr, 0xff, PNG_FILLER_BEFORE);
+		}
+
+		int passes = png_set_interlace_handling(png_ptr);
 		png_read_update_info(png_ptr, info_ptr);
 
 		png_uint_32 rowbytes = png_get_rowbytes(png_ptr, info_ptr);
-		png_byte channels = png_get_channels(png_ptr, info_ptr);
-
-		size_t data_size = rowbytes * height;
-		uchar* data = new uchar[data_size];
-		png_bytepp row_pointers = new png_bytep[height];
+		if (rowbytes != width * 4) {
+			P_ERR("unexpected PNG row size " << rowbytes
+			      << " for width " << width);
+			png_destroy_read_struct(&png_ptr, &info_ptr, 0);
+			fclose(fp);
+			return 0;
+		}
 
-		for (png_uint_32 y = 0; y < height; ++y) {
-			row_pointers[y] = data + y * rowbytes;
+		// Decode rows directly into the returned buffer, interlaced
+		// images combine every pass into the same rows.
+		uchar *data = new uchar[rowbytes * height];
+		use_alpha = false;
+		if (setjmp(png_jmpbuf(png_ptr))) {
+			delete [] data;
+			png_destroy_read_struct(&png_ptr, &info_ptr, 0);
+			fclose(fp);
+			return 0;
 		}
 
-		png_read_image(png_ptr, row_pointers);
+		for (int pass = 0; pass < passes; ++pass) {
+			png_bytep row = data;
+			bool last = pass == passes - 1;
+			for (png_uint_32 y = 0; y < height; ++y) {
+				png_read_row(png_ptr, row, 0);
+				if (last && has_alpha && ! use_alpha) {
+					use_alpha = hasAlpha(row, width);
+				}
+				row += rowbytes;
+			}
+		}
 		png_read_end(png_ptr, 0);
-		delete [] row_pointers;
 
 		// Clean up.
 		png_destroy_read_struct(&png_ptr, &info_ptr, 0);
 
 		fclose(fp);
 
-		use_alpha = false;
-		if (channels < 4) {
-			uchar *data_argb =
-				convertRgbToArgb(data, width, height);
-			delete [] data;
-
-			data = data_argb;
-			use_alpha = false;
-		} else {
-			convertRgbaToArgb(data, width, height, use_alpha);
-		}
-
 		return data;
 	}
 
+	/**
+	 * Save ARGB data to file, rows are written directly from data
+	 * using libpng transforms to strip or move the alpha channel.
+	 *
+	 * @param alpha Write alpha channel, else 24bit RGB.
+	 */
 	bool
-	save(const std::string& file, uchar *data, size_t width, size_t height)
+	save(const std::string& file, uchar *data, size_t width, size_t height,
+	     bool alpha)
 	{
 		png_structp png_ptr =
 			png_create_write_struct(PNG_LIBPNG_VER_STRING,
@@ -242,39 +225,46 @@ namespace PImageLoaderPng
 			return false;
 		}
 
-		// Setup png lib error handling
-		if (setjmp(png_jmpbuf(png_ptr))) {
+		FILE *fp = fopen(file.c_str(), "wb");
+		if (!fp) {
+			USER_WARN("failed to open " << file << " for writing");
 			png_destroy_write_struct(&png_ptr, &info_ptr);
 			return false;
 		}
 
-		FILE *fp = fopen(file.c_str(), "wb");
-		if (!fp) {
-			USER_WARN("failed to open " << file << " for writing");
+		// Setup png lib error handling
+		if (setjmp(png_jmpbuf(png_ptr))) {
 			png_destroy_write_struct(&png_ptr, &info_ptr);
+			fclose(fp);
 			return false;
 		}
 
 		png_init_io(png_ptr, fp);
 
-		// Setup write information, write 24bit RGB
+		// Setup write information, write 24bit RGB or 32bit RGBA
 		png_set_IHDR(png_ptr, info_ptr, width, height, 8,
-			     PNG_COLOR_TYPE_RGB,
+			     alpha ? PNG_COLOR_TYPE_RGB_ALPHA
+				   : PNG_COLOR_TYPE_RGB,
 			     PNG_INTERLACE_NONE,
 			     PNG_COMPRESSION_TYPE_DEFAULT,
 			     PNG_FILTER_TYPE_DEFAULT);
 
-		uchar *rgb_data = convertArgbToRgb(data, width, height);
 		png_write_info(png_ptr, info_ptr);
-		png_bytep row = rgb_data;
+		if (alpha) {
+			// ARGB -> RGBA
+			png_set_swap_alpha(png_ptr);
+		} else {
+			// ARGB -> RGB
+			png_set_filler(png_ptr, 0, PNG_FILLER_BEFORE);
+		}
+
+		png_bytep row = data;
 		for (size_t y = 0; y < height; y++) {
 			png_write_row(png_ptr, row);
-			row += width * 3;
+			row += width * 4;
 		}
 		png_write_end(png_ptr, NULL);
 
-		delete [] rgb_data;
-
 		png_destroy_write_struct(&png_ptr, &info_ptr);
 		fclose(fp);
 
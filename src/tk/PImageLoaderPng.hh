@@ -27,7 +27,8 @@ namespace PImageLoaderPng
 	uchar* load(const std::string &file, size_t &width, size_t &height,
 		    bool &use_alpha);
 	bool save(const std::string &file,
-		  uchar *data, size_t width, size_t height);
+		  uchar *data, size_t width, size_t height,
+		  bool alpha = false);
 }
 
 #endif // PEKWM_HAVE_IMAGE_PNG
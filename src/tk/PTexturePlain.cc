@@ -363,23 +363,24 @@ PTextureLines::unsetColors()
 
 // PTextureImage
 
-PTextureImage::PTextureImage(PImage *image)
+PTextureImage::PTextureImage(PImage *image, bool referenced)
 	: _image(nullptr)
 {
 	// PTexture attributes
 	_type = PTexture::TYPE_IMAGE;
-	setImage(image);
+	setImage(image, referenced);
 }
 
 PTextureImage::PTextureImage(const std::string &image,
-			     const std::string &colormap)
+			     const std::string &colormap,
+			     size_t hint_width, size_t hint_height)
 	: _image(nullptr),
 	  _colormap(colormap)
 {
 	// PTexture attributes
 	_type = colormap.empty()
 		? PTexture::TYPE_IMAGE : PTexture::TYPE_IMAGE_MAPPED;
-	setImage(image, colormap);
+	setImage(image, colormap, hint_width, hint_height);
 }
 
 PTextureImage::~PTextureImage(void)
@@ -403,30 +404,36 @@ PTextureImage::getMask(size_t width, size_t height, bool &do_free)
 }
 
 /**
- * Set image resource
+ * Set image resource, the image handler takes ownership of the image
+ * unless it is already referenced in the image handler.
  */
 void
-PTextureImage::setImage(PImage *image)
+PTextureImage::setImage(PImage *image, bool referenced)
 {
 	unsetImage();
 	_image = image;
 	_colormap = "";
 	_width = _image->getWidth();
 	_height = _image->getHeight();
-	pekwm::imageHandler()->takeOwnership(image);
+	if (! referenced) {
+		pekwm::imageHandler()->takeOwnership(image);
+	}
 	_ok = true;
 }
 
 /**
- * Load image resource
+ * Load image resource, the size hint is the size scaled images are
+ * expected to be rendered in.
  */
 bool
-PTextureImage::setImage(const std::string &image, const std::string &colormap)
+PTextureImage::setImage(const std::string &image, const std::string &colormap,
+			size_t hint_width, size_t hint_height)
 {
 	unsetImage();
 
 	if (colormap.empty()) {
-		_image = pekwm::imageHandler()->getImage(image);
+		_image = pekwm::imageHandler()->getImage(image, hint_width,
+							 hint_height);
 	} else {
 		_image = pekwm::imageHandler()->getMappedImage(image, colormap);
 	}
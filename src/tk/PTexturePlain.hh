@@ -148,8 +148,9 @@ private:
 
 class PTextureImage : public PTexture {
 public:
-	PTextureImage(PImage *image);
-	PTextureImage(const std::string &image, const std::string &colormap);
+	PTextureImage(PImage *image, bool referenced = false);
+	PTextureImage(const std::string &image, const std::string &colormap,
+		      size_t hint_width = 0, size_t hint_height = 0);
 	virtual ~PTextureImage(void);
 
 	// START - PTexture interface.
@@ -159,10 +160,13 @@ public:
 	virtual Pixmap getMask(size_t width, size_t height, bool &do_free);
 	// END - PTexture interface.
 
-	bool setImage(const std::string &image, const std::string &colormap);
-	void setImage(PImage *image);
+	bool setImage(const std::string &image, const std::string &colormap,
+		      size_t hint_width = 0, size_t hint_height = 0);
+	void setImage(PImage *image, bool referenced = false);
 	void unsetImage(void);
 
+	PImage *getImage(void) { return _image; }
+
 private:
 	PImage *_image;
 	std::string _colormap;
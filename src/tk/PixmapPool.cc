@@ -0,0 +1,108 @@
+//
+// PixmapPool.cc for pekwm
+// Copyright (C) 2023 Claes Nästén <pekdon@gmail.com>
+//
+// This program is licensed under the GNU GPL.
+// See the LICENSE file for more information.
+//
+
+#include "PixmapPool.hh"
+
+PixmapPool::PixmapPool(void)
+	: _refs(0),
+	  _bytes(0),
+	  _bytes_saved(0)
+{
+}
+
+PixmapPool::~PixmapPool(void)
+{
+}
+
+/**
+ * Get pixmap with texture rendered at width x height, adding a
+ * reference to it.
+ *
+ * @return Pixmap, None if not in the pool.
+ */
+Pixmap
+PixmapPool::get(const PTexture *texture, uint width, uint height)
+{
+	std::map<Key, Pixmap>::iterator it =
+		_index.find(Key(texture, width, height));
+	if (it == _index.end()) {
+		return None;
+	}
+
+	Entry &entry = _pixmaps.find(it->second)->second;
+	entry.ref++;
+	_refs++;
+	_bytes_saved += entry.bytes;
+	return it->second;
+}
+
+/**
+ * Add pixmap with texture rendered at width x height, the pixmap starts
+ * with one reference.
+ */
+void
+PixmapPool::add(const PTexture *texture, uint width, uint height,
+		Pixmap pix, size_t bytes)
+{
+	Key key(texture, width, height);
+	_index[key] = pix;
+	_pixmaps.insert(std::pair<Pixmap, Entry>(pix, Entry(key, bytes)));
+	_refs++;
+	_bytes += bytes;
+}
+
+/**
+ * Release reference to pix.
+ *
+ * @return true if this was the last reference and pix should be freed.
+ */
+bool
+PixmapPool::release(Pixmap pix)
+{
+	std::map<Pixmap, Entry>::iterator it = _pixmaps.find(pix);
+	if (it == _pixmaps.end()) {
+		return false;
+	}
+
+	Entry &entry = it->second;
+	_refs--;
+	if (--entry.ref > 0) {
+		_bytes_saved -= entry.bytes;
+		return false;
+	}
+
+	if (entry.indexed) {
+		_index.erase(entry.key);
+	}
+	_bytes -= entry.bytes;
+	_pixmaps.erase(it);
+	return true;
+}
+
+/**
+ * Remove all pixmaps of texture from lookup, called before texture is
+ * deleted. Pixmaps still referenced stay in the pool until released.
+ */
+void
+PixmapPool::remove(const PTexture *texture)
+{
+	std::map<Key, Pixmap>::iterator it = _index.lower_bound(
+		Key(texture, 0, 0));
+	while (it != _index.end() && it->first.texture == texture) {
+		_pixmaps.find(it->second)->second.indexed = false;
+		_index.erase(it++);
+	}
+}
+
+void
+PixmapPool::dump(std::ostream &os) const
+{
+	os << "pixmap pool: " << _pixmaps.size() << " pixmaps, "
+	   << _refs << " references, " << (_bytes / 1024) << "KB, "
+	   << (_bytes_saved / 1024) << "KB saved by sharing" << std::endl;
+}
@@ -0,0 +1,105 @@
+//
+// PixmapPool.hh for pekwm
+// Copyright (C) 2023 Claes Nästén <pekdon@gmail.com>
+//
+// This program is licensed under the GNU GPL.
+// See the LICENSE file for more information.
+//
+
+#ifndef _PEKWM_PIXMAP_POOL_HH_
+#define _PEKWM_PIXMAP_POOL_HH_
+
+#include "config.h"
+
+#include "Types.hh"
+
+#include <map>
+#include <ostream>
+
+extern "C" {
+#include <X11/Xlib.h>
+}
+
+class PTexture;
+
+/**
+ * Reference counted pixmaps with a texture rendered at a given size,
+ * windows with the same texture and size, such as the borders of frames
+ * using the same decor, share a single server side pixmap.
+ *
+ * The pool only keeps track of the pixmaps, creating and freeing them
+ * is left to the caller.
+ */
+class PixmapPool {
+public:
+	PixmapPool(void);
+	~PixmapPool(void);
+
+	Pixmap get(const PTexture *texture, uint width, uint height);
+	void add(const PTexture *texture, uint width, uint height,
+		 Pixmap pix, size_t bytes);
+	bool release(Pixmap pix);
+	void remove(const PTexture *texture);
+
+	/** Number of pixmaps in the pool. */
+	size_t size(void) const { return _pixmaps.size(); }
+	ulong getRefs(void) const { return _refs; }
+	size_t getBytes(void) const { return _bytes; }
+	size_t getBytesSaved(void) const { return _bytes_saved; }
+
+	void dump(std::ostream &os) const;
+
+private:
+	struct Key {
+		Key(const PTexture *texture_, uint width_, uint height_)
+			: texture(texture_),
+			  width(width_),
+			  height(height_)
+		{
+		}
+
+		bool operator<(const Key &rhs) const {
+			if (texture != rhs.texture) {
+				return texture < rhs.texture;
+			}
+			if (width != rhs.width) {
+				return width < rhs.width;
+			}
+			return height < rhs.height;
+		}
+
+		const PTexture *texture;
+		uint width;
+		uint height;
+	};
+
+	struct Entry {
+		Entry(const Key &key_, size_t bytes_)
+			: key(key_),
+			  bytes(bytes_),
+			  ref(1),
+			  indexed(true)
+		{
+		}
+
+		Key key;
+		size_t bytes;
+		uint ref;
+		/** false once the texture is removed, only released. */
+		bool indexed;
+	};
+
+	/** Pixmaps by texture and size, for lookup. */
+	std::map<Key, Pixmap> _index;
+	/** All pixmaps in the pool, for release. */
+	std::map<Pixmap, Entry> _pixmaps;
+
+	/** Total number of references to pixmaps in the pool. */
+	ulong _refs;
+	/** Size of all pixmaps in the pool. */
+	size_t _bytes;
+	/** Size of the pixmaps not created thanks to sharing. */
+	size_t _bytes_saved;
+};
+
+#endif // _PEKWM_PIXMAP_POOL_HH_
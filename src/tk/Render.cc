@@ -61,17 +61,29 @@ Render::~Render(void)
 {
 }
 
+/**
+ * Get XRender picture for the render target, None if compositing on
+ * the X server is not supported.
+ */
+Picture
+Render::getPicture(void)
+{
+	return None;
+}
+
 // X11Render
 
 X11Render::X11Render(Drawable draw, Pixmap background)
 	: _draw(draw),
 	  _background(background),
-	  _gc(X11::getGC())
+	  _gc(X11::getGC()),
+	  _picture(None)
 {
 }
 
 X11Render::~X11Render(void)
 {
+	X11::renderFreePicture(_picture);
 }
 
 Drawable
@@ -86,6 +98,15 @@ X11Render::getImage(int x, int y, uint width, uint height)
 	return X11::getImage(_draw, x, y, width, height, AllPlanes, ZPixmap);
 }
 
+Picture
+X11Render::getPicture(void)
+{
+	if (_picture == None) {
+		_picture = X11::renderCreatePicture(_draw);
+	}
+	return _picture;
+}
+
 void
 X11Render::setColor(int pixel)
 {
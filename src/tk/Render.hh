@@ -32,6 +32,7 @@ public:
 	virtual Drawable getDrawable(void) const = 0;
 	virtual XImage *getImage(int x, int y, uint width, uint height) = 0;
 	virtual void destroyImage(XImage *image) = 0;
+	virtual Picture getPicture(void);
 
 	virtual void setColor(int pixel) = 0;
 	virtual void setLineWidth(int lw) = 0;
@@ -83,6 +84,7 @@ public:
 	virtual Drawable getDrawable(void) const;
 	virtual XImage *getImage(int x, int y, uint width, uint height);
 	virtual void destroyImage(XImage *image);
+	virtual Picture getPicture(void);
 
 	virtual void setColor(int pixel);
 	virtual void setLineWidth(int lw);
@@ -98,6 +100,13 @@ private:
 	Drawable _draw;
 	Pixmap _background;
 	GC _gc;
+	/**
+	 * XRender picture for _draw, created on first use and freed with
+	 * the render. Not cached per drawable, drawables are freed
+	 * without going through the render and creating the picture does
+	 * not wait for a reply.
+	 */
+	Picture _picture;
 };
 
 /**
@@ -0,0 +1,102 @@
+//
+// TextExtentCache.cc for pekwm
+// Copyright (C) 2023 Claes Nästén <pekdon@gmail.com>
+//
+// This program is licensed under the GNU GPL.
+// See the LICENSE file for more information.
+//
+
+#include "TextExtentCache.hh"
+
+TextExtentCache::TextExtentCache(size_t capacity)
+	: _capacity(capacity),
+	  _hits(0),
+	  _misses(0),
+	  _evictions(0)
+{
+}
+
+TextExtentCache::~TextExtentCache(void)
+{
+}
+
+/**
+ * Lookup width of text in font, marking the entry as recently used.
+ */
+bool
+TextExtentCache::get(const PFont *font, const std::string &text, uint &width)
+{
+	entry_map::iterator it = _map.find(Key(font, text));
+	if (it == _map.end()) {
+		_misses++;
+		return false;
+	}
+
+	_hits++;
+	if (it->second != _entries.begin()) {
+		_entries.splice(_entries.begin(), _entries, it->second);
+	}
+	width = it->second->second;
+	return true;
+}
+
+/**
+ * Store width of text in font, evicting the least recently used entry
+ * if the cache is full.
+ */
+void
+TextExtentCache::put(const PFont *font, const std::string &text, uint width)
+{
+	Key key(font, text);
+	entry_map::iterator it = _map.find(key);
+	if (it != _map.end()) {
+		it->second->second = width;
+		_entries.splice(_entries.begin(), _entries, it->second);
+		return;
+	}
+
+	if (_capacity == 0) {
+		return;
+	}
+	if (_map.size() >= _capacity) {
+		_map.erase(_entries.back().first);
+		_entries.pop_back();
+		_evictions++;
+	}
+	_entries.push_front(Entry(key, width));
+	_map[key] = _entries.begin();
+}
+
+/**
+ * Remove all entries for font, called when the font is unloaded or
+ * has properties affecting the width changed.
+ */
+void
+TextExtentCache::remove(const PFont *font)
+{
+	entry_map::iterator it = _map.lower_bound(Key(font, ""));
+	while (it != _map.end() && it->first.first == font) {
+		_entries.erase(it->second);
+		_map.erase(it++);
+	}
+}
+
+void
+TextExtentCache::clear(void)
+{
+	_entries.clear();
+	_map.clear();
+}
+
+void
+TextExtentCache::dump(std::ostream &os) const
+{
+	ulong lookups = _hits + _misses;
+	os << "text extent cache: " << _map.size() << "/" << _capacity
+	   << " entries, " << _hits << " hits, " << _misses << " misses, "
+	   << _evictions << " evictions";
+	if (lookups > 0) {
+		os << ", " << (_hits * 100 / lookups) << "% hit rate";
+	}
+	os << std::endl;
+}
@@ -0,0 +1,63 @@
+//
+// TextExtentCache.hh for pekwm
+// Copyright (C) 2023 Claes Nästén <pekdon@gmail.com>
+//
+// This program is licensed under the GNU GPL.
+// See the LICENSE file for more information.
+//
+
+#ifndef _PEKWM_TEXT_EXTENT_CACHE_HH_
+#define _PEKWM_TEXT_EXTENT_CACHE_HH_
+
+#include "config.h"
+
+#include "Types.hh"
+
+#include <list>
+#include <map>
+#include <ostream>
+#include <string>
+
+class PFont;
+
+/**
+ * Bounded, least recently used, cache of text widths keyed on font and
+ * text. The same titles are measured over and over again by decors,
+ * menus and panel widgets, measuring them again requires a full layout
+ * in the Xft and Pango backends.
+ */
+class TextExtentCache {
+public:
+	TextExtentCache(size_t capacity);
+	~TextExtentCache(void);
+
+	bool get(const PFont *font, const std::string &text, uint &width);
+	void put(const PFont *font, const std::string &text, uint width);
+	void remove(const PFont *font);
+	void clear(void);
+
+	size_t size(void) const { return _map.size(); }
+	size_t capacity(void) const { return _capacity; }
+	ulong getHits(void) const { return _hits; }
+	ulong getMisses(void) const { return _misses; }
+	ulong getEvictions(void) const { return _evictions; }
+
+	void dump(std::ostream &os) const;
+
+private:
+	typedef std::pair<const PFont*, std::string> Key;
+	typedef std::pair<Key, uint> Entry;
+	typedef std::list<Entry> entry_list;
+	typedef std::map<Key, entry_list::iterator> entry_map;
+
+	size_t _capacity;
+	/** Entries, most recently used first. */
+	entry_list _entries;
+	entry_map _map;
+
+	ulong _hits;
+	ulong _misses;
+	ulong _evictions;
+};
+
+#endif // _PEKWM_TEXT_EXTENT_CACHE_HH_
@@ -17,7 +17,7 @@
 
 #include <iostream>
 
-static Util::StringTo<PTexture::Type> parse_map[] =
+static Util::StringTo<PTexture::Type> parse_map_entries[] =
 	{{"SOLID", PTexture::TYPE_SOLID},
 	 {"SOLIDRAISED", PTexture::TYPE_SOLID_RAISED},
 	 {"LINESHORZ", PTexture::TYPE_LINES_HORZ},
@@ -26,6 +26,7 @@ static Util::StringTo<PTexture::Type> parse_map[] =
 	 {"IMAGEMAPPED", PTexture::TYPE_IMAGE_MAPPED},
 	 {"EMPTY", PTexture::TYPE_EMPTY},
 	 {nullptr, PTexture::TYPE_NO}};
+static Util::StringToIndex<PTexture::Type> parse_map(parse_map_entries);
 
 static bool
 parseSize(const std::string &str, uint &width, uint &height)
@@ -44,20 +45,29 @@ parseSize(const std::string &str, uint &width, uint &height)
 	return true;
 }
 
+static void
+dumpTextureHandler(std::ostream &os, void *opaque)
+{
+	reinterpret_cast<TextureHandler*>(opaque)->dump(os);
+}
+
 TextureHandler::TextureHandler(void)
 	: _length_min(5)
 {
+	Debug::addDump("textures", dumpTextureHandler, this);
 }
 
 TextureHandler::~TextureHandler(void)
 {
+	Debug::removeDump("textures");
 }
 
 /**
  * Gets or creates a PTexture
  */
 PTexture*
-TextureHandler::getTexture(const std::string &texture)
+TextureHandler::getTexture(const std::string &texture,
+			   size_t hint_width, size_t hint_height)
 {
 	if (texture.size() < _length_min) {
 		// name to short, can not be a valid texture.
@@ -65,21 +75,29 @@ TextureHandler::getTexture(const std::string &texture)
 		return nullptr;
 	}
 
+	// textures loaded for a size are not shared with other textures
+	std::string name(texture);
+	if (hint_width || hint_height) {
+		std::ostringstream hint;
+		hint << "@" << hint_width << "x" << hint_height;
+		name += hint.str();
+	}
+
 	// check for already existing entry
 	entry_vector::iterator it(_textures.begin());
 	for (; it != _textures.end(); ++it) {
-		if (*(*it) == texture) {
+		if (*(*it) == name) {
 			(*it)->incRef();
 			return (*it)->getTexture();
 		}
 	}
 
 	// parse texture
-	PTexture *ptexture = parse(texture);
+	PTexture *ptexture = parse(texture, hint_width, hint_height);
 	if (ptexture) {
 		// create new entry
 		TextureHandler::Entry *entry =
-			new TextureHandler::Entry(texture, ptexture);
+			new TextureHandler::Entry(name, ptexture);
 		entry->incRef();
 		_textures.push_back(entry);
 	}
@@ -127,6 +145,7 @@ TextureHandler::returnTexture(PTexture *texture)
 
 			(*it)->decRef();
 			if ((*it)->getRef() == 0) {
+				_pixmaps.remove(texture);
 				delete *it;
 				_textures.erase(it);
 			}
@@ -135,10 +154,76 @@ TextureHandler::returnTexture(PTexture *texture)
 	}
 
 	if (! found) {
+		_pixmaps.remove(texture);
 		delete texture;
 	}
 }
 
+/**
+ * Set background of win to texture rendered at width x height, opaque
+ * textures are rendered to a pixmap shared with all windows using the
+ * same texture and size.
+ *
+ * @param pix Pixmap previously set on win by this function, released
+ *            and updated to the pixmap now in use, None if the texture
+ *            is not rendered to a shared pixmap.
+ */
+void
+TextureHandler::setBackground(PTexture *texture, Window win,
+			      uint width, uint height, Pixmap &pix)
+{
+	ulong pixel;
+	Pixmap new_pix = None;
+	if (! texture->getPixel(pixel) && texture->getOpacity() == 255
+	    && width > 0 && height > 0) {
+		new_pix = getPixmap(texture, width, height);
+	}
+
+	if (new_pix == None) {
+		texture->setBackground(win, 0, 0, width, height);
+	} else {
+		X11::setWindowBackgroundPixmap(win, new_pix);
+	}
+	returnPixmap(pix);
+	pix = new_pix;
+}
+
+/**
+ * Get pixmap with texture rendered at width x height, rendering it if
+ * not already in the pool. Return with returnPixmap.
+ */
+Pixmap
+TextureHandler::getPixmap(PTexture *texture, uint width, uint height)
+{
+	Pixmap pix = _pixmaps.get(texture, width, height);
+	if (pix != None) {
+		return pix;
+	}
+
+	pix = X11::createPixmap(width, height);
+	if (pix != None) {
+		texture->render(pix, 0, 0, width, height);
+		int depth = X11::getDepth();
+		size_t bpp = depth > 16 ? 4 : (depth > 8 ? 2 : 1);
+		_pixmaps.add(texture, width, height, pix,
+			     width * height * bpp);
+	}
+	return pix;
+}
+
+/**
+ * Release pixmap from getPixmap, freed on the last reference. pix is
+ * set to None.
+ */
+void
+TextureHandler::returnPixmap(Pixmap &pix)
+{
+	if (pix != None && _pixmaps.release(pix)) {
+		X11::freePixmap(pix);
+	}
+	pix = None;
+}
+
 /**
  * Log all referenced textures as trace messages.
  */
@@ -156,11 +241,24 @@ TextureHandler::logTextures(const std::string& msg) const
 	P_TRACE(oss.str());
 }
 
+void
+TextureHandler::dump(std::ostream &os) const
+{
+	os << "textures: " << _textures.size() << std::endl;
+	entry_vector::const_iterator it(_textures.begin());
+	for (; it != _textures.end(); ++it) {
+		os << "  " << (*it)->getName() << " (" << (*it)->getRef()
+		   << " references)" << std::endl;
+	}
+	_pixmaps.dump(os);
+}
+
 /**
  * Parses the string, and creates a texture
  */
 PTexture*
-TextureHandler::parse(const std::string &texture)
+TextureHandler::parse(const std::string &texture,
+		      size_t hint_width, size_t hint_height)
 {
 	PTexture *ptexture = 0;
 	std::vector<std::string> tok;
@@ -190,7 +288,8 @@ TextureHandler::parse(const std::string &texture)
 			ptexture = parseLines(false, tok);
 			break;
 		case PTexture::TYPE_IMAGE:
-			ptexture = parseImage(texture);
+			ptexture = parseImage(texture, hint_width,
+					      hint_height);
 			break;
 		case PTexture::TYPE_IMAGE_MAPPED:
 			ptexture = parseImageMapped(texture);
@@ -320,16 +419,20 @@ TextureHandler::parseLines(bool horz, std::vector<std::string> &tok)
 }
 
 /**
- * Parse Image texture, w
+ * Parse Image texture, scaled images are decoded for the size hint if
+ * the image loader supports it.
  */
 PTexture*
-TextureHandler::parseImage(const std::string& texture)
+TextureHandler::parseImage(const std::string& texture,
+			   size_t hint_width, size_t hint_height)
 {
 	// 6==strlen("IMAGE ")
-	PTextureImage *image = new PTextureImage(texture.substr(6), "");
+	PTextureImage *image = new PTextureImage(texture.substr(6), "",
+						 hint_width, hint_height);
 	if (! image->isOk()) {
 		size_t pos = texture.find_first_not_of(" \t", 6);
-		image->setImage(texture.substr(pos), "");
+		image->setImage(texture.substr(pos), "",
+				hint_width, hint_height);
 	}
 	return image;
 }
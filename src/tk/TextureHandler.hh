@@ -13,6 +13,7 @@
 
 #include "Compat.hh"
 #include "PTexture.hh"
+#include "PixmapPool.hh"
 #include "String.hh"
 
 #include <map>
@@ -64,18 +65,29 @@ public:
 	~TextureHandler(void);
 
 	size_t getLengthMin(void) { return _length_min; }
-	PTexture *getTexture(const std::string &texture);
+	PTexture *getTexture(const std::string &texture,
+			     size_t hint_width = 0, size_t hint_height = 0);
 	PTexture *referenceTexture(PTexture *texture);
 	void returnTexture(PTexture *texture);
 
+	void setBackground(PTexture *texture, Window win,
+			   uint width, uint height, Pixmap &pix);
+	Pixmap getPixmap(PTexture *texture, uint width, uint height);
+	void returnPixmap(Pixmap &pix);
+	/** Return pool of shared texture pixmaps. */
+	const PixmapPool &getPixmapPool(void) const { return _pixmaps; }
+
 	void logTextures(const std::string& msg) const;
+	void dump(std::ostream &os) const;
 
 private:
-	PTexture *parse(const std::string &texture);
+	PTexture *parse(const std::string &texture,
+			size_t hint_width, size_t hint_height);
 	PTexture *parseSolid(std::vector<std::string> &tok);
 	PTexture *parseSolidRaised(const std::vector<std::string> &tok);
 	PTexture *parseLines(bool horz, std::vector<std::string> &tok);
-	PTexture *parseImage(const std::string& texture);
+	PTexture *parseImage(const std::string& texture,
+			     size_t hint_width, size_t hint_height);
 	PTexture *parseImageMapped(const std::string& texture);
 
 	bool parseSize(PTexture *tex, const std::string &size);
@@ -86,6 +98,8 @@ private:
 
 	entry_vector _textures;
 	std::map<std::string, std::map<int,int>*> _color_maps;
+	/** Textures rendered to pixmaps, shared between windows. */
+	PixmapPool _pixmaps;
 };
 
 namespace pekwm
@@ -7,9 +7,13 @@
 //
 
 #include "Debug.hh"
+#include "Observable.hh"
 #include "X11App.hh"
+#include "X11Stats.hh"
 #include "X11Util.hh"
 
+#include <algorithm>
+
 extern "C" {
 #include <sys/wait.h>
 #include <errno.h>
@@ -21,6 +25,7 @@ static bool is_signal_alrm = false;
 static bool is_signal_hup = false;
 static bool is_signal_int_term = false;
 static bool is_signal_chld = false;
+static bool is_signal_usr1 = false;
 
 static void sigHandler(int signal)
 {
@@ -40,6 +45,9 @@ static void sigHandler(int signal)
 		// Do nothing, just used to break out of waiting
 		is_signal_alrm = true;
 		break;
+	case SIGUSR1:
+		is_signal_usr1 = true;
+		break;
 	}
 }
 
@@ -62,6 +70,7 @@ X11App::X11App(Geometry gm, int gm_mask, const std::string &title,
 	addFd(_dpy_fd);
 
 	initSignalHandler();
+	Debug::addDump("x11", X11Stats::dump, nullptr);
 
 	_gm = gm;
 	XSetWindowAttributes attr;
@@ -102,6 +111,7 @@ X11App::X11App(Geometry gm, int gm_mask, const std::string &title,
 
 X11App::~X11App(void)
 {
+	Debug::removeDump("x11");
 	if (_buffer != None) {
 		X11::xdbeFreeBackBuffer(_buffer);
 	}
@@ -150,13 +160,16 @@ X11App::main(uint timeout_s)
 	while (_stop == -1) {
 		if (is_signal) {
 			handleSignal();
+		} else if (X11::pending()) {
+			processEvent();
+			timed_out = false;
 		} else {
+			// all queued events processed, deliver notifications
+			// deferred while processing the batch before refresh.
+			pekwm::observerMapping()->flush();
 			refresh(timed_out);
 
-			if (X11::pending()) {
-				processEvent();
-				timed_out = false;
-			} else {
+			if (! X11::pending()) {
 				timed_out = waitForData(timeout_s);
 			}
 		}
@@ -185,6 +198,45 @@ X11App::setBackground(Pixmap background)
 	X11::setWindowBackgroundPixmap(_window, _background);
 }
 
+/**
+ * Mark area of the back buffer as updated, the next call to swapBuffer
+ * will only copy the damaged areas to the window. Rectangles on the
+ * same row that overlap or touch are merged.
+ */
+void
+X11App::addDamage(int x, int y, uint width, uint height)
+{
+	if (x < 0) {
+		width = static_cast<int>(width) + x > 0 ? width + x : 0;
+		x = 0;
+	}
+	if (static_cast<uint>(x) + width > _gm.width) {
+		width = static_cast<uint>(x) < _gm.width ? _gm.width - x : 0;
+	}
+	if (width == 0 || height == 0) {
+		return;
+	}
+
+	XRectangle rect = { static_cast<short>(x), static_cast<short>(y),
+			    static_cast<unsigned short>(width),
+			    static_cast<unsigned short>(height) };
+	std::vector<XRectangle>::iterator it = _damage.begin();
+	while (it != _damage.end()) {
+		if (it->y == rect.y && it->height == rect.height
+		    && it->x <= rect.x + rect.width
+		    && rect.x <= it->x + it->width) {
+			int rx = std::max(it->x + it->width,
+					  rect.x + rect.width);
+			rect.x = std::min(it->x, rect.x);
+			rect.width = rx - rect.x;
+			it = _damage.erase(it);
+		} else {
+			++it;
+		}
+	}
+	_damage.push_back(rect);
+}
+
 /**
  * Return drawable to use for rendering, independent of XDBE being used
  * or not.
@@ -237,13 +289,18 @@ X11App::refresh(bool)
 
 /**
  * Swap out the window back buffer (if one is allocated), must be called
- * after drawing to refresh the screen.
+ * after drawing to refresh the screen. If damage has been reported
+ * using addDamage, only the damaged areas are copied.
  */
 void
 X11App::swapBuffer(void)
 {
-	if (_buffer != None) {
+	if (_buffer == None) {
+		_damage.clear();
+	} else if (_damage.empty()) {
 		X11::xdbeSwapBackBuffer(_window);
+	} else {
+		copyDamage();
 	}
 }
 
@@ -278,6 +335,7 @@ X11App::initSignalHandler(void)
 	sigaction(SIGHUP, &act, 0);
 	sigaction(SIGCHLD, &act, 0);
 	sigaction(SIGALRM, &act, 0);
+	sigaction(SIGUSR1, &act, 0);
 }
 
 void
@@ -307,6 +365,12 @@ X11App::handleSignal(void)
 		stop(1);
 		is_signal_int_term = false;
 	}
+	if (is_signal_usr1) {
+		// X11 request counters, including the bytes copied from
+		// the back buffer, are written to the log.
+		Debug::dump("x11", Debug::getStream(""));
+		is_signal_usr1 = false;
+	}
 	is_signal = false;
 }
 
@@ -344,6 +408,41 @@ X11App::waitForData(int timeout_s)
 	return ret < 1;
 }
 
+/**
+ * Copy damaged areas from the back buffer to the window, the back
+ * buffer is left intact as it is never swapped. Falls back to a
+ * regular swap if the entire window is damaged.
+ */
+void
+X11App::copyDamage(void)
+{
+	int depth = X11::getDepth();
+	uint bpp = depth > 16 ? 4 : (depth > 8 ? 2 : 1);
+	ulong full_bytes = static_cast<ulong>(_gm.width) * _gm.height * bpp;
+
+	ulong bytes = 0;
+	std::vector<XRectangle>::iterator it = _damage.begin();
+	for (; it != _damage.end(); ++it) {
+		bytes += static_cast<ulong>(it->width) * it->height * bpp;
+	}
+
+	if (bytes >= full_bytes) {
+		X11::xdbeSwapBackBuffer(_window);
+		X11_STAT_BYTES("swapBuffer full", REQUEST, full_bytes);
+		bytes = full_bytes;
+	} else {
+		for (it = _damage.begin(); it != _damage.end(); ++it) {
+			X11::copyArea(_buffer, _window, it->x, it->y,
+				      it->width, it->height, it->x, it->y);
+		}
+		X11_STAT_BYTES("swapBuffer damage", REQUEST, bytes);
+	}
+
+	P_TRACE(_wm_class << ": swap " << _damage.size() << " rectangles "
+		<< bytes << "/" << full_bytes << " bytes");
+	_damage.clear();
+}
+
 void
 X11App::processEvent(void)
 {
@@ -32,6 +32,7 @@ public:
 protected:
 	bool hasBuffer(void) const;
 	void setBackground(Pixmap pixmap);
+	void addDamage(int x, int y, uint width, uint height);
 
 	Drawable getRenderDrawable(void) const;
 	Drawable getRenderBackground(void) const;
@@ -50,12 +51,15 @@ private:
 	bool waitForData(int timeout_s);
 
 	void processEvent(void);
+	void copyDamage(void);
 
 private:
 	std::string _wm_name;
 	std::string _wm_class;
 	XdbeBackBuffer _buffer;
 	Pixmap _background;
+	/** Areas of the back buffer updated since the last swap. */
+	std::vector<XRectangle> _damage;
 
 	int _stop;
 	std::vector<int> _fds;
@@ -0,0 +1,123 @@
+//
+// bench.hh for pekwm
+// Copyright (C) 2023 Claes Nästén <pekdon@gmail.com>
+//
+// This program is licensed under the GNU GPL.
+// See the LICENSE file for more information.
+//
+
+#ifndef _BENCH_HH_
+#define _BENCH_HH_
+
+#include "Compat.hh"
+#include "Types.hh"
+
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <vector>
+
+extern "C" {
+#include <time.h>
+}
+
+/**
+ * Wall clock timer, started when constructed.
+ */
+class BenchTimer {
+public:
+	BenchTimer(void)
+	{
+		clock_gettime(CLOCK_MONOTONIC, &_start);
+	}
+
+	/**
+	 * Return number of nanoseconds elapsed since construction.
+	 */
+	double elapsed(void) const
+	{
+		struct timespec now;
+		clock_gettime(CLOCK_MONOTONIC, &now);
+		return (now.tv_sec - _start.tv_sec) * 1000000000.0
+			+ (now.tv_nsec - _start.tv_nsec);
+	}
+
+private:
+	struct timespec _start;
+};
+
+/**
+ * Run F iterations times and report the time spent, results are
+ * written as tab separated suite, name, iterations, total ns and ns per
+ * iteration for comparison between builds.
+ */
+#define BENCH_FN(bench_name, iterations, F)				\
+	do {								\
+		BenchTimer __bench_timer;				\
+		for (uint __bench_i = 0; __bench_i < (iterations);	\
+		     __bench_i++) {					\
+			F;						\
+		}							\
+		report(bench_name, (iterations),			\
+		       __bench_timer.elapsed());			\
+	} while (0)
+
+class BenchSuite {
+public:
+	BenchSuite(const std::string& name)
+		: _name(name)
+	{
+		_suites.push_back(this);
+	}
+	virtual ~BenchSuite(void) { }
+
+	/**
+	 * Run all suites, or only the suites named on the command line.
+	 */
+	static int main(int argc, char **argv)
+	{
+		std::vector<BenchSuite*>::iterator it(_suites.begin());
+		for (; it != _suites.end(); ++it) {
+			if (isSelected((*it)->name(), argc, argv)) {
+				(*it)->run();
+			}
+		}
+		return 0;
+	}
+
+	const std::string& name() const { return _name; }
+
+protected:
+	virtual void run(void) = 0;
+
+	void report(const std::string& bench_name, uint iterations,
+		    double elapsed_ns)
+	{
+		std::cout << _name << "\t" << bench_name << "\t"
+			  << iterations << "\t"
+			  << static_cast<ulong>(elapsed_ns) << "\t"
+			  << static_cast<ulong>(elapsed_ns / iterations)
+			  << std::endl;
+	}
+
+private:
+	static bool isSelected(const std::string& name, int argc, char **argv)
+	{
+		if (argc < 2) {
+			return true;
+		}
+		for (int i = 1; i < argc; i++) {
+			if (name == argv[i]) {
+				return true;
+			}
+		}
+		return false;
+	}
+
+	std::string _name;
+	static std::vector<BenchSuite*> _suites;
+};
+
+std::vector<BenchSuite*> BenchSuite::_suites;
+
+#endif // _BENCH_HH_
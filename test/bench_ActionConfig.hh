@@ -0,0 +1,133 @@
+//
+// bench_ActionConfig.hh for pekwm
+// Copyright (C) 2023 Claes Nästén <pekdon@gmail.com>
+//
+// This program is licensed under the GNU GPL.
+// See the LICENSE file for more information.
+//
+
+#include "bench.hh"
+
+#include "tk/Action.hh"
+#include "tk/ActionCache.hh"
+#include "CfgParser.hh"
+#include "CfgParserSource.hh"
+
+#include <sstream>
+
+/**
+ * Parse a keys and mouse configuration with 1000 key bindings and 500
+ * button bindings, the same way KeyGrabber and Config do, lookup every
+ * action name and parse _PEKWM_CMD commands with and without caching.
+ */
+class BenchActionConfig : public BenchSuite {
+public:
+	BenchActionConfig(void)
+		: BenchSuite("ActionConfig"),
+		  _cache(64, CMD_OK)
+	{
+		const char *actions[] = {
+			"GoToWorkspace Next",
+			"Set Shaded; Raise",
+			"Toggle AlwaysOnTop; Set Opaque",
+			"MoveToEdge BottomRight",
+			"FocusDirectional Left",
+			"ShowMenu Root",
+			"SetOpacity 80 90",
+			"MaxFill True True",
+			"SendToWorkspace 3; GoToWorkspace 3",
+			"Debug dump x11",
+			nullptr
+		};
+		const char *mods[] = {
+			"Mod4", "Mod4 Shift", "Mod1 Ctrl", "Ctrl Shift", nullptr
+		};
+
+		std::ostringstream cfg;
+		cfg << "Keys {" << std::endl;
+		for (int i = 0; i < 1000; i++) {
+			// keycodes, keysyms require a display
+			cfg << "\tKeyPress = \"" << mods[i % 4] << " #"
+			    << (10 + i % 50)
+			    << "\" { Actions = \"" << actions[i % 10]
+			    << "\" }" << std::endl;
+		}
+		cfg << "}" << std::endl << "FrameTitle {" << std::endl;
+		for (int i = 0; i < 500; i++) {
+			cfg << "\tButtonPress = \"" << mods[i % 4] << " "
+			    << (1 + i % 5) << "\" { Actions = \""
+			    << actions[i % 10] << "\" }" << std::endl;
+		}
+		cfg << "}" << std::endl;
+		_cfg = cfg.str();
+
+		_action_names = ActionConfig::getActionNameList();
+	}
+
+protected:
+	virtual void run(void)
+	{
+		BENCH_FN("parse keys and mouse", 20, parse());
+		BENCH_FN("action names lookup", 1000, lookup());
+		BENCH_FN("parse 1000 commands", 100, parseCmds(false));
+		BENCH_FN("cached 1000 commands", 100, parseCmds(true));
+	}
+
+private:
+	void parse(void)
+	{
+		CfgParser cfg(CfgParserOpt(""));
+		cfg.parse(new CfgParserSourceString(":memory:", _cfg));
+
+		CfgParser::Entry *root = cfg.getEntryRoot();
+		parseSection(root->findSection("KEYS"), KEYGRABBER_OK, false);
+		parseSection(root->findSection("FRAMETITLE"),
+			     FRAME_OK, true);
+	}
+
+	void parseSection(CfgParser::Entry *section, uint mask,
+			  bool is_button)
+	{
+		CfgParser::Entry::entry_cit it = section->begin();
+		for (; it != section->end(); ++it) {
+			ActionEvent ae;
+			ActionConfig::parseActionEvent(*it, ae, mask,
+						       is_button);
+		}
+	}
+
+	void lookup(void)
+	{
+		std::vector<std::string>::const_iterator it =
+			_action_names.begin();
+		for (; it != _action_names.end(); ++it) {
+			ActionConfig::getAction(*it, KEYGRABBER_OK);
+		}
+	}
+
+	void parseCmds(bool cached)
+	{
+		const char *cmds[] = {
+			"SetGeometry 50%x100%+0+0 current HonourStrut",
+			"SetGeometry 50%x100%+50%+0 current HonourStrut",
+			"Set Maximized Vertical",
+			"GoToWorkspace 2",
+			nullptr
+		};
+		for (int i = 0; i < 1000; i++) {
+			ActionEvent ae;
+			if (cached) {
+				_cache.parse(cmds[i % 4], ae);
+			} else {
+				Action action;
+				ActionConfig::parseAction(cmds[i % 4], action,
+							  CMD_OK);
+				ae.action_list.push_back(action);
+			}
+		}
+	}
+
+	ActionCache _cache;
+	std::string _cfg;
+	std::vector<std::string> _action_names;
+};
@@ -0,0 +1,200 @@
+//
+// bench_ImageHandler.hh for pekwm
+// Copyright (C) 2023 Claes Nästén <pekdon@gmail.com>
+//
+// This program is licensed under the GNU GPL.
+// See the LICENSE file for more information.
+//
+
+#include "bench.hh"
+
+#include "tk/ImageHandler.hh"
+#include "tk/PImageLoaderJpeg.hh"
+#include "tk/PImageLoaderPng.hh"
+
+#include <sstream>
+
+extern "C" {
+#include <stdio.h>
+#include <stdlib.h>
+#ifdef PEKWM_HAVE_IMAGE_JPEG
+#include <jpeglib.h>
+#endif // PEKWM_HAVE_IMAGE_JPEG
+}
+
+/**
+ * Load the images of a theme, a 1920x1080 background and 20 small
+ * decor images, decoding every image (cold) and using the on-disk image
+ * cache populated by a previous load (warm).
+ *
+ * Decode a 7680x4320 JPEG wallpaper in full size and for 1920x1080 and
+ * 2560x1440 heads.
+ *
+ * Decode a 3840x2160 PNG wallpaper with and without alpha.
+ */
+class BenchImageHandler : public BenchSuite {
+public:
+	BenchImageHandler(void)
+		: BenchSuite("ImageHandler")
+	{
+	}
+
+protected:
+	virtual void run(void)
+	{
+		char dir[] = "/tmp/pekwm_bench_image_handler.XXXXXX";
+		_dir = mkdtemp(dir);
+		runTheme();
+		runJpeg();
+		runPng();
+
+		std::string cmd = "rm -rf " + _dir;
+		if (system(cmd.c_str())) {
+			std::cerr << "failed to remove " << _dir << std::endl;
+		}
+	}
+
+private:
+	void runTheme(void)
+	{
+#ifdef PEKWM_HAVE_IMAGE_PNG
+		writeImage("background.png", 1920, 1080);
+		for (int i = 0; i < 20; i++) {
+			std::ostringstream name;
+			name << "decor" << i << ".png";
+			writeImage(name.str(), 32, 32);
+		}
+
+		ImageHandler cold;
+		cold.path_push_back(_dir + "/");
+		BENCH_FN("cold theme load", 20, loadTheme(cold));
+
+		ImageHandler warm;
+		warm.path_push_back(_dir + "/");
+		warm.setCache(_dir + "/cache", 64 * 1024 * 1024);
+		loadTheme(warm);
+		BENCH_FN("warm theme load", 20, loadTheme(warm));
+#else // ! PEKWM_HAVE_IMAGE_PNG
+		std::cout << "# no PNG support, skipping theme" << std::endl;
+#endif // PEKWM_HAVE_IMAGE_PNG
+	}
+
+	void runJpeg(void)
+	{
+#ifdef PEKWM_HAVE_IMAGE_JPEG
+		std::string file = _dir + "/wallpaper.jpg";
+		writeJpeg(file, 7680, 4320);
+		BENCH_FN("jpeg full size", 5, loadJpeg(file, 0, 0));
+		BENCH_FN("jpeg 1920x1080", 5, loadJpeg(file, 1920, 1080));
+		BENCH_FN("jpeg 2560x1440", 5, loadJpeg(file, 2560, 1440));
+#else // ! PEKWM_HAVE_IMAGE_JPEG
+		std::cout << "# no JPEG support, skipping jpeg" << std::endl;
+#endif // PEKWM_HAVE_IMAGE_JPEG
+	}
+
+	void runPng(void)
+	{
+#ifdef PEKWM_HAVE_IMAGE_PNG
+		writeImage("wallpaper.png", 3840, 2160);
+		writeImage("wallpaper_alpha.png", 3840, 2160, true);
+		std::string file = _dir + "/wallpaper.png";
+		std::string file_alpha = _dir + "/wallpaper_alpha.png";
+		BENCH_FN("png 3840x2160", 5, loadPng(file));
+		BENCH_FN("png 3840x2160 alpha", 5, loadPng(file_alpha));
+#else // ! PEKWM_HAVE_IMAGE_PNG
+		std::cout << "# no PNG support, skipping png" << std::endl;
+#endif // PEKWM_HAVE_IMAGE_PNG
+	}
+
+#ifdef PEKWM_HAVE_IMAGE_JPEG
+	void writeJpeg(const std::string &file, size_t width, size_t height)
+	{
+		FILE *fp = fopen(file.c_str(), "wb");
+		struct jpeg_compress_struct cinfo;
+		struct jpeg_error_mgr jerr;
+		cinfo.err = jpeg_std_error(&jerr);
+		jpeg_create_compress(&cinfo);
+		jpeg_stdio_dest(&cinfo, fp);
+		cinfo.image_width = width;
+		cinfo.image_height = height;
+		cinfo.input_components = 3;
+		cinfo.in_color_space = JCS_RGB;
+		jpeg_set_defaults(&cinfo);
+		jpeg_start_compress(&cinfo, TRUE);
+
+		uchar *row = new uchar[width * 3];
+		for (size_t y = 0; y < height; y++) {
+			uchar *p = row;
+			for (size_t x = 0; x < width; x++) {
+				*p++ = x * 255 / width;
+				*p++ = y * 255 / height;
+				*p++ = rand() % 32;
+			}
+			jpeg_write_scanlines(&cinfo, &row, 1);
+		}
+		delete [] row;
+
+		jpeg_finish_compress(&cinfo);
+		jpeg_destroy_compress(&cinfo);
+		fclose(fp);
+	}
+
+	void loadJpeg(const std::string &file, size_t width, size_t height)
+	{
+		size_t img_width, img_height;
+		bool use_alpha;
+		uchar *data = PImageLoaderJpeg::load(file,
+						     img_width, img_height,
+						     use_alpha,
+						     width, height);
+		delete [] data;
+	}
+#endif // PEKWM_HAVE_IMAGE_JPEG
+
+#ifdef PEKWM_HAVE_IMAGE_PNG
+	void writeImage(const std::string &name, size_t width, size_t height,
+			bool alpha = false)
+	{
+		uchar *data = new uchar[width * height * 4];
+		uchar *p = data;
+		for (size_t y = 0; y < height; y++) {
+			for (size_t x = 0; x < width; x++) {
+				*p++ = alpha ? x * 255 / width : 255;
+				*p++ = x * 255 / width;
+				*p++ = y * 255 / height;
+				*p++ = rand() % 32;
+			}
+		}
+		PImageLoaderPng::save(_dir + "/" + name, data, width, height,
+				      alpha);
+		delete [] data;
+	}
+
+	void loadPng(const std::string &file)
+	{
+		size_t width, height;
+		bool use_alpha;
+		uchar *data = PImageLoaderPng::load(file, width, height,
+						    use_alpha);
+		delete [] data;
+	}
+#endif // PEKWM_HAVE_IMAGE_PNG
+
+	void loadTheme(ImageHandler &handler)
+	{
+		std::vector<PImage*> images;
+		images.push_back(handler.getImage("background.png"));
+		for (int i = 0; i < 20; i++) {
+			std::ostringstream name;
+			name << "decor" << i << ".png";
+			images.push_back(handler.getImage(name.str()));
+		}
+
+		std::vector<PImage*>::iterator it = images.begin();
+		for (; it != images.end(); ++it) {
+			handler.returnImage(*it);
+		}
+	}
+
+	std::string _dir;
+};
@@ -0,0 +1,87 @@
+//
+// bench_Observable.hh for pekwm
+// Copyright (C) 2023 Claes Nästén <pekdon@gmail.com>
+//
+// This program is licensed under the GNU GPL.
+// See the LICENSE file for more information.
+//
+
+#include "bench.hh"
+
+#include "Observable.hh"
+
+class BenchObservable : public Observable {
+public:
+	virtual ~BenchObservable(void) { }
+};
+
+class BenchObserver : public Observer {
+public:
+	BenchObserver(void) : num(0) { }
+	virtual ~BenchObserver(void) { }
+	virtual void notify(Observable*, Observation*) { num++; }
+
+	uint num;
+};
+
+/**
+ * Add, notify and remove observers for a set of short lived observables
+ * the way frames, clients and decors do on map/unmap.
+ */
+class BenchObserverMapping : public BenchSuite {
+public:
+	BenchObserverMapping(void)
+		: BenchSuite("ObserverMapping")
+	{
+	}
+
+protected:
+	virtual void run(void)
+	{
+		ObserverMapping om;
+		std::vector<BenchObservable> observables(2000);
+		std::vector<BenchObserver> observers(3);
+		Observation observation;
+
+		// keep a base of long lived observables in the mapping
+		for (size_t i = 0; i < 1000; i++) {
+			om.addObserver(&observables[i], &observers[0]);
+		}
+
+		BENCH_FN("churn", 1000,
+			 churn(om, observables, observers, observation));
+		BENCH_FN("notify", 1000,
+			 notify(om, observables, observation));
+	}
+
+private:
+	static void churn(ObserverMapping &om,
+			  std::vector<BenchObservable> &observables,
+			  std::vector<BenchObserver> &observers,
+			  Observation &observation)
+	{
+		for (size_t i = 1000; i < observables.size(); i++) {
+			for (size_t j = 0; j < observers.size(); j++) {
+				om.addObserver(&observables[i], &observers[j]);
+			}
+		}
+		for (size_t i = 1000; i < observables.size(); i++) {
+			om.notifyObservers(&observables[i], &observation);
+		}
+		for (size_t i = 1000; i < observables.size(); i++) {
+			for (size_t j = 0; j < observers.size(); j++) {
+				om.removeObserver(&observables[i],
+						  &observers[j]);
+			}
+		}
+	}
+
+	static void notify(ObserverMapping &om,
+			   std::vector<BenchObservable> &observables,
+			   Observation &observation)
+	{
+		for (size_t i = 0; i < 1000; i++) {
+			om.notifyObservers(&observables[i], &observation);
+		}
+	}
+};
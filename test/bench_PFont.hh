@@ -0,0 +1,139 @@
+//
+// bench_PFont.hh for pekwm
+// Copyright (C) 2023 Claes Nästén <pekdon@gmail.com>
+//
+// This program is licensed under the GNU GPL.
+// See the LICENSE file for more information.
+//
+
+#include "bench.hh"
+
+#include "Charset.hh"
+#include "X11.hh"
+#include "tk/FontHandler.hh"
+#include "tk/PFont.hh"
+
+/**
+ * Font with a fixed advance per character, measuring walks the string
+ * the way a layout would making the cost grow with the text length.
+ */
+class BenchPFontFixed : public PFont {
+public:
+	BenchPFontFixed(void) : PFont(), num_measure(0) { }
+	virtual ~BenchPFontFixed(void) { }
+
+	virtual bool load(const PFont::Descr&) { return true; }
+	virtual void unload(void) { }
+	virtual void setColor(PFont::Color*) { }
+
+	uint num_measure;
+
+protected:
+	virtual std::string toNativeDescr(const PFont::Descr&) const {
+		return "FIXED";
+	}
+
+private:
+	virtual uint textWidth(const std::string& text, uint max_chars)
+	{
+		num_measure++;
+		if (max_chars == 0 || max_chars > text.size()) {
+			max_chars = text.size();
+		}
+		uint width = 0;
+		Charset::Utf8Iterator it(text, 0);
+		for (; ! it.end() && it.pos() < max_chars; ++it) {
+			width += 7;
+		}
+		return width;
+	}
+	virtual void drawText(PSurface*, int, int, const std::string&,
+			      uint, bool) { }
+};
+
+/**
+ * Trim a long browser like title to a typical title bar width, cold
+ * measures a title not seen before and warm the same title re-rendered.
+ * The X11 backends are measured when a display is available.
+ */
+class BenchPFont : public BenchSuite {
+public:
+	BenchPFont(void)
+		: BenchSuite("PFont")
+	{
+		for (int i = 0; i < 20; i++) {
+			_title += "Räksmörgås — a rather long title ";
+		}
+		_title.resize(300);
+	}
+
+protected:
+	virtual void run(void)
+	{
+		BenchPFontFixed fixed;
+		benchFont("fixed", &fixed, 500);
+		std::cout << "# fixed measure calls per cold trim: "
+			  << measureCalls(fixed) << std::endl;
+
+		Display *dpy = XOpenDisplay(nullptr);
+		if (dpy == nullptr) {
+			std::cout << "# no display, skipping X11 fonts"
+				  << std::endl;
+			return;
+		}
+
+		Charset::init();
+		X11::init(dpy, false, false);
+		{
+			FontHandler font_handler(false, "");
+			const char *fonts[] = {
+				"X11#fixed", "XMB#fixed", "XFT#Sans-10",
+				"PANGO#Sans-10", nullptr
+			};
+			for (int i = 0; fonts[i] != nullptr; i++) {
+				PFont *font = font_handler.getFont(fonts[i]);
+				benchFont(fonts[i], font, 50);
+				font_handler.returnFont(font);
+			}
+		}
+		X11::destruct();
+		Charset::destruct();
+	}
+
+private:
+	void benchFont(const std::string &name, PFont *font, uint iterations)
+	{
+		BENCH_FN(name + " trimEnd cold", iterations,
+			 trimCold(font, PFont::FONT_TRIM_END));
+		BENCH_FN(name + " trimEnd warm", iterations,
+			 trim(font, PFont::FONT_TRIM_END));
+		PFont::setTrimString("...");
+		BENCH_FN(name + " trimMiddle cold", iterations,
+			 trimCold(font, PFont::FONT_TRIM_MIDDLE));
+		BENCH_FN(name + " trimMiddle warm", iterations,
+			 trim(font, PFont::FONT_TRIM_MIDDLE));
+		PFont::setTrimString("");
+	}
+
+	uint measureCalls(BenchPFontFixed &font)
+	{
+		font.num_measure = 0;
+		trimCold(&font, PFont::FONT_TRIM_END);
+		return font.num_measure;
+	}
+
+	void trimCold(PFont *font, PFont::TrimType trim_type)
+	{
+		// setOffset drops the width cache
+		font->setOffset(0, 0);
+		trim(font, trim_type);
+	}
+
+	void trim(PFont *font, PFont::TrimType trim_type)
+	{
+		std::string title(_title);
+		font->trim(title, trim_type, 400);
+	}
+
+	std::string _title;
+};
@@ -0,0 +1,105 @@
+//
+// bench_PImage.hh for pekwm
+// Copyright (C) 2023 Claes Nästén <pekdon@gmail.com>
+//
+// This program is licensed under the GNU GPL.
+// See the LICENSE file for more information.
+//
+
+#include "bench.hh"
+
+#include "ThreadPool.hh"
+#include "tk/ImageColorMap.hh"
+#include "tk/PImage.hh"
+
+#include <sstream>
+
+extern "C" {
+#include <stdlib.h>
+#include <X11/Xutil.h>
+}
+
+/**
+ * Convert a 3840x2160 image to 32 and 16 bit XImages and apply a 16
+ * entry color map to it, using the calling thread only and a thread
+ * pool with one thread per CPU.
+ */
+class BenchPImage : public BenchSuite {
+public:
+	BenchPImage(void)
+		: BenchSuite("PImage")
+	{
+	}
+
+protected:
+	virtual void run(void)
+	{
+		const size_t width = 3840, height = 2160;
+		uchar *data = new uchar[width * height * 4];
+		for (size_t i = 0; i < width * height * 4; i++) {
+			data[i] = rand();
+		}
+		PImage image(data, width, height, false);
+
+		XImage *ximage32 = createXImage(width, height, 24, 32,
+						0xff0000, 0xff00, 0xff);
+		XImage *ximage16 = createXImage(width, height, 16, 16,
+						0xf800, 0x07e0, 0x001f);
+		std::map<int, int> map;
+		for (int i = 0; i < 16; i++) {
+			map[rand()] = rand();
+		}
+		ImageColorMap color_map(map);
+
+		BENCH_FN("fillXImage 32bpp", 10,
+			 image.fillXImage(ximage32, width, height));
+		BENCH_FN("fillXImage 16bpp", 10,
+			 image.fillXImage(ximage16, width, height));
+		BENCH_FN("color map", 10,
+			 color_map.apply(image.getData(), width * height));
+
+		ThreadPool pool;
+		PImage::setThreadPool(&pool);
+		std::ostringstream suffix;
+		suffix << " " << pool.size() << " threads";
+		BENCH_FN("fillXImage 32bpp" + suffix.str(), 10,
+			 image.fillXImage(ximage32, width, height));
+		BENCH_FN("fillXImage 16bpp" + suffix.str(), 10,
+			 image.fillXImage(ximage16, width, height));
+		BENCH_FN("color map" + suffix.str(), 10,
+			 color_map.apply(image.getData(), width * height));
+		PImage::setThreadPool(nullptr);
+
+		XDestroyImage(ximage32);
+		XDestroyImage(ximage16);
+	}
+
+private:
+	/**
+	 * Create XImage without a display connection.
+	 */
+	static XImage *createXImage(size_t width, size_t height,
+				    int depth, int bpp,
+				    ulong red, ulong green, ulong blue)
+	{
+		XImage *ximage =
+			static_cast<XImage*>(calloc(1, sizeof(XImage)));
+		ximage->width = width;
+		ximage->height = height;
+		ximage->format = ZPixmap;
+		ximage->byte_order = LSBFirst;
+		ximage->bitmap_unit = 32;
+		ximage->bitmap_bit_order = LSBFirst;
+		ximage->bitmap_pad = 32;
+		ximage->depth = depth;
+		ximage->bits_per_pixel = bpp;
+		ximage->bytes_per_line = width * bpp / 8;
+		ximage->red_mask = red;
+		ximage->green_mask = green;
+		ximage->blue_mask = blue;
+		ximage->data = static_cast<char*>(
+			malloc(ximage->bytes_per_line * height));
+		XInitImage(ximage);
+		return ximage;
+	}
+};
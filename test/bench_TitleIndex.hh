@@ -0,0 +1,76 @@
+//
+// bench_TitleIndex.hh for pekwm
+// Copyright (C) 2023 Claes Nästén <pekdon@gmail.com>
+//
+// This program is licensed under the GNU GPL.
+// See the LICENSE file for more information.
+//
+
+#include "bench.hh"
+
+#include "RegexString.hh"
+#include "TitleIndex.hh"
+
+#include <sstream>
+
+/**
+ * Type a search string one keystroke at a time against 1000 client
+ * titles, comparing the title index with compiling a regular
+ * expression and matching every title per keystroke.
+ */
+class BenchTitleIndex : public BenchSuite {
+public:
+	BenchTitleIndex(void)
+		: BenchSuite("TitleIndex")
+	{
+		const char *apps[] = {
+			"Mozilla Firefox", "xterm", "Emacs", "Thunderbird",
+			"GIMP", "LibreOffice Writer", nullptr
+		};
+		for (int i = 0; i < 1000; i++) {
+			std::ostringstream title;
+			title << "Document " << i << ".txt - "
+			      << apps[i % 6];
+			_titles.push_back(title.str());
+			_index.add(reinterpret_cast<Client*>(i + 1),
+				   title.str());
+		}
+	}
+
+protected:
+	virtual void run(void)
+	{
+		// 7 keystrokes per iteration
+		const std::string query("thunder");
+		BENCH_FN("index type query", 100, typeIndex(query));
+		BENCH_FN("regex type query", 100, typeRegex(query));
+	}
+
+private:
+	void typeIndex(const std::string &query)
+	{
+		TitleIndex::Search search;
+		std::vector<Client*> result;
+		for (size_t i = 1; i <= query.size(); i++) {
+			_index.search(search, query.substr(0, i), result);
+		}
+	}
+
+	void typeRegex(const std::string &query)
+	{
+		for (size_t i = 1; i <= query.size(); i++) {
+			RegexString re("/" + query.substr(0, i) + "/i");
+			std::vector<const std::string*> result;
+			std::vector<std::string>::const_iterator it =
+				_titles.begin();
+			for (; it != _titles.end(); ++it) {
+				if (re == *it) {
+					result.push_back(&*it);
+				}
+			}
+		}
+	}
+
+	TitleIndex _index;
+	std::vector<std::string> _titles;
+};
@@ -0,0 +1,51 @@
+//
+// bench_pekwm.cc for pekwm
+// Copyright (C) 2023 Claes Nästén <pekdon@gmail.com>
+//
+// This program is licensed under the GNU GPL.
+// See the LICENSE file for more information.
+//
+
+#include "config.h"
+#include "bench.hh"
+
+#include "Debug.hh"
+#include "pekwm.hh"
+
+#include "bench_ActionConfig.hh"
+#include "bench_ImageHandler.hh"
+#include "bench_Observable.hh"
+#include "bench_PImage.hh"
+#include "bench_PFont.hh"
+#include "bench_TitleIndex.hh"
+
+static int
+main_bench(int argc, char *argv[])
+{
+	Debug::setLogFile("/dev/null");
+
+	// ActionConfig
+	BenchActionConfig benchActionConfig;
+	// ImageHandler
+	BenchImageHandler benchImageHandler;
+	// Observable
+	BenchObserverMapping benchObserverMapping;
+	// PFont
+	BenchPFont benchPFont;
+	// PImage
+	BenchPImage benchPImage;
+	// TitleIndex
+	BenchTitleIndex benchTitleIndex;
+
+	return BenchSuite::main(argc, argv);
+}
+
+int
+main(int argc, char *argv[])
+{
+	pekwm::initNoDisplay();
+	int res = main_bench(argc, argv);
+	pekwm::cleanupNoDisplay();
+
+	return res;
+}
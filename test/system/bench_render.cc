@@ -0,0 +1,126 @@
+/**
+ * Benchmark drawing images with alpha fixed, scaled and tiled,
+ * composited on the X server with XRender and blended on the CPU.
+ */
+
+#include "X11.hh"
+#include "tk/PImage.hh"
+#include "tk/Render.hh"
+
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <string>
+
+extern "C" {
+#include <time.h>
+}
+
+static double
+bench_now(void)
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec * 1000000000.0 + ts.tv_nsec;
+}
+
+/**
+ * Report result in the same tab separated format as bench_pekwm:
+ * suite, name, iterations, total ns and ns per iteration.
+ */
+static void
+bench_report(const std::string &name, int iterations, double elapsed_ns)
+{
+	std::cout << "Render\t" << name << "\t" << iterations << "\t"
+		  << static_cast<unsigned long>(elapsed_ns) << "\t"
+		  << static_cast<unsigned long>(elapsed_ns / iterations)
+		  << std::endl;
+}
+
+static PImage*
+bench_image(size_t width, size_t height)
+{
+	uchar *data = new uchar[width * height * 4];
+	uchar *p = data;
+	for (size_t y = 0; y < height; y++) {
+		for (size_t x = 0; x < width; x++) {
+			*p++ = x * 255 / width;
+			*p++ = x * 255 / width;
+			*p++ = y * 255 / height;
+			*p++ = 128;
+		}
+	}
+	return new PImage(data, width, height, true);
+}
+
+static void
+bench_draw(const std::string &name, PImage *image, ImageType type,
+	   uint width, uint height, int iterations)
+{
+	Pixmap pix = X11::createPixmap(width, height);
+	X11Render rend(pix);
+	rend.setColor(X11::getWhitePixel());
+	rend.fill(0, 0, width, height);
+
+	image->setType(type);
+	// first draw uploads the image when using XRender
+	image->draw(rend, 0, 0, width, height);
+	X11::sync(False);
+
+	double start = bench_now();
+	for (int i = 0; i < iterations; i++) {
+		image->draw(rend, 0, 0, width, height);
+	}
+	X11::sync(False);
+	bench_report(name, iterations, bench_now() - start);
+
+	X11::freePixmap(pix);
+}
+
+static void
+bench_run(const std::string &prefix, int iterations)
+{
+	PImage *image = bench_image(64, 64);
+	bench_draw(prefix + "-fixed", image, IMAGE_TYPE_FIXED,
+		   64, 64, iterations);
+	bench_draw(prefix + "-scaled", image, IMAGE_TYPE_SCALED,
+		   256, 256, iterations);
+	bench_draw(prefix + "-tiled", image, IMAGE_TYPE_TILED,
+		   1024, 768, iterations);
+	delete image;
+}
+
+int
+main(int argc, char *argv[])
+{
+	int iterations = 100;
+	for (int i = 1; i < argc; i++) {
+		if (strncmp(argv[i], "iterations=", 11) == 0) {
+			iterations = atoi(argv[i] + 11);
+		}
+	}
+	if (iterations < 1) {
+		std::cerr << "ERROR: invalid iterations" << std::endl;
+		return 1;
+	}
+
+	Display *dpy = XOpenDisplay(NULL);
+	if (dpy == NULL) {
+		std::cerr << "ERROR: unable to open display" << std::endl;
+		return 1;
+	}
+	X11::init(dpy);
+
+	if (X11::hasExtensionXRender()) {
+		bench_run("xrender", iterations);
+	} else {
+		std::cout << "# no XRender support, skipping xrender"
+			  << std::endl;
+	}
+	X11::setUseXRender(false);
+	bench_run("cpu", iterations);
+	std::cout << "DONE" << std::endl;
+
+	X11::destruct();
+	return 0;
+}
@@ -0,0 +1,12 @@
+#!/bin/sh
+#
+# Generate a dynamic menu with $1 entries for pekwm_menu_bench.plux
+#
+
+echo "Dynamic {"
+i=1
+while test "${i}" -le "${1}"; do
+  echo "Entry = \"Generated menu entry number ${i}\" { Actions = \"Exec true\" }"
+  i=$((i + 1))
+done
+echo "}"
@@ -2,9 +2,14 @@
  * Client used for testing pekwm.
  */
 
+#include <cstdlib>
 #include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
 
 extern "C" {
+#include <time.h>
 #include <X11/Xlib.h>
 #include <X11/Xutil.h>
 #include <X11/Xatom.h>
@@ -92,6 +97,409 @@ window(Display *dpy, int screen, Window root)
 	}
 }
 
+/**
+ * Benchmark options, given as key=value arguments after bench.
+ */
+struct BenchOptions {
+	BenchOptions(void)
+		: windows(20),
+		  title("bench"),
+		  icon(0),
+		  churn(10),
+		  workspaces(20),
+		  restart(false),
+		  timeout(30)
+	{
+	}
+
+	/** Number of windows to map. */
+	int windows;
+	/** Title prefix, window number is appended. */
+	std::string title;
+	/** Size of _NET_WM_ICON set on windows, 0 for no icon. */
+	int icon;
+	/** Number of rounds of title changes on all windows. */
+	int churn;
+	/** Number of workspace switches. */
+	int workspaces;
+	/** Restart pekwm and wait for all windows to be adopted. */
+	bool restart;
+	/** Seconds to wait for pekwm to respond before failing. */
+	int timeout;
+};
+
+static double
+bench_now(void)
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec * 1000000000.0 + ts.tv_nsec;
+}
+
+/**
+ * Report result in the same tab separated format as bench_pekwm:
+ * suite, name, iterations, total ns and ns per iteration.
+ */
+static void
+bench_report(const std::string &name, int iterations, double elapsed_ns)
+{
+	std::cout << "X11\t" << name << "\t" << iterations << "\t"
+		  << static_cast<unsigned long>(elapsed_ns) << "\t"
+		  << static_cast<unsigned long>(elapsed_ns / iterations)
+		  << std::endl;
+}
+
+/**
+ * Wait for next event, fails if no event arrives before deadline
+ * (as returned by bench_now).
+ */
+static bool
+bench_next_event(Display *dpy, XEvent *ev, double deadline)
+{
+	while (! XPending(dpy)) {
+		double left = deadline - bench_now();
+		if (left <= 0) {
+			return false;
+		}
+
+		struct timeval tv;
+		tv.tv_sec = static_cast<long>(left / 1000000000.0);
+		tv.tv_usec = static_cast<long>(left / 1000.0) % 1000000;
+
+		int xfd = ConnectionNumber(dpy);
+		fd_set rfds;
+		FD_ZERO(&rfds);
+		FD_SET(xfd, &rfds);
+		select(xfd + 1, &rfds, 0, 0, &tv);
+	}
+	XNextEvent(dpy, ev);
+	return true;
+}
+
+static bool
+bench_get_cardinal(Display *dpy, Window win, Atom atom, long &value)
+{
+	Atom type;
+	int format;
+	unsigned long items, left;
+	unsigned char *data = 0;
+	int status = XGetWindowProperty(dpy, win, atom, 0, 1, False,
+					AnyPropertyType, &type, &format,
+					&items, &left, &data);
+	if (status != Success || data == 0) {
+		return false;
+	}
+	bool ok = items == 1 && format == 32;
+	if (ok) {
+		value = *reinterpret_cast<long*>(data);
+	}
+	XFree(data);
+	return ok;
+}
+
+static void
+bench_send_root_message(Display *dpy, Window root, Window win, Atom type,
+			long data0, long data1)
+{
+	XEvent ev = {0};
+	ev.xclient.type = ClientMessage;
+	ev.xclient.window = win;
+	ev.xclient.message_type = type;
+	ev.xclient.format = 32;
+	ev.xclient.data.l[0] = data0;
+	ev.xclient.data.l[1] = data1;
+	XSendEvent(dpy, root, False,
+		   SubstructureRedirectMask | SubstructureNotifyMask, &ev);
+	XFlush(dpy);
+}
+
+/**
+ * Wait for PropertyNotify of atom on root where the property value
+ * is value.
+ */
+static bool
+bench_wait_root_property(Display *dpy, Window root, Atom atom, long value,
+			 double deadline)
+{
+	XEvent ev;
+	while (bench_next_event(dpy, &ev, deadline)) {
+		long current;
+		if (ev.type == PropertyNotify
+		    && ev.xproperty.window == root
+		    && ev.xproperty.atom == atom
+		    && bench_get_cardinal(dpy, root, atom, current)
+		    && current == value) {
+			return true;
+		}
+	}
+	return false;
+}
+
+/**
+ * Wait for win to be reparented into a frame.
+ */
+static bool
+bench_wait_reparent(Display *dpy, Window root, Window win, double deadline)
+{
+	XEvent ev;
+	while (bench_next_event(dpy, &ev, deadline)) {
+		if (ev.type == ReparentNotify
+		    && ev.xreparent.window == win
+		    && ev.xreparent.parent != root) {
+			return true;
+		}
+	}
+	return false;
+}
+
+static void
+bench_set_title(Display *dpy, Window win, Atom net_wm_name,
+		Atom utf8_string, const std::string &title)
+{
+	XChangeProperty(dpy, win, net_wm_name, utf8_string, 8,
+			PropModeReplace,
+			reinterpret_cast<const unsigned char*>(title.c_str()),
+			title.size());
+}
+
+static void
+bench_set_icon(Display *dpy, Window win, Atom net_wm_icon, int size)
+{
+	std::vector<long> icon(2 + size * size);
+	icon[0] = size;
+	icon[1] = size;
+	for (int i = 0; i < size * size; i++) {
+		icon[2 + i] = 0xff000000 | (i * 2654435761U & 0xffffff);
+	}
+	XChangeProperty(dpy, win, net_wm_icon, XA_CARDINAL, 32,
+			PropModeReplace,
+			reinterpret_cast<unsigned char*>(&icon[0]),
+			icon.size());
+}
+
+/**
+ * Send command to pekwm using the _PEKWM_CMD protocol, only commands
+ * fitting in a single message are supported.
+ */
+static void
+bench_send_command(Display *dpy, Window root, Atom pekwm_cmd,
+		   const std::string &cmd)
+{
+	XEvent ev = {0};
+	ev.xclient.type = ClientMessage;
+	ev.xclient.window = root;
+	ev.xclient.message_type = pekwm_cmd;
+	ev.xclient.format = 8;
+	strncpy(ev.xclient.data.b, cmd.c_str(),
+		sizeof(ev.xclient.data.b) - 1);
+	XSendEvent(dpy, root, False,
+		   SubstructureRedirectMask | SubstructureNotifyMask, &ev);
+	XFlush(dpy);
+}
+
+/**
+ * Map windows and measure pekwm performance, see BenchOptions for
+ * available options. Results are written one per line followed by
+ * DONE, failures are reported with ERROR.
+ */
+static int
+bench(Display *dpy, Window root, const BenchOptions &opts)
+{
+	Atom net_active_window = XInternAtom(dpy, "_NET_ACTIVE_WINDOW", False);
+	Atom net_current_desktop =
+		XInternAtom(dpy, "_NET_CURRENT_DESKTOP", False);
+	Atom net_number_of_desktops =
+		XInternAtom(dpy, "_NET_NUMBER_OF_DESKTOPS", False);
+	Atom net_wm_name = XInternAtom(dpy, "_NET_WM_NAME", False);
+	Atom net_wm_icon = XInternAtom(dpy, "_NET_WM_ICON", False);
+	Atom utf8_string = XInternAtom(dpy, "UTF8_STRING", False);
+	Atom pekwm_cmd = XInternAtom(dpy, "_PEKWM_CMD", False);
+	double timeout = opts.timeout * 1000000000.0;
+
+	XSelectInput(dpy, root, PropertyChangeMask);
+	unsigned long requests_start = NextRequest(dpy);
+
+	// map windows one at a time, waiting for each to be decorated
+	std::vector<Window> windows;
+	double elapsed = 0.0;
+	for (int i = 0; i < opts.windows; i++) {
+		XSetWindowAttributes attrs = {0};
+		attrs.event_mask = StructureNotifyMask;
+		Window win = XCreateWindow(dpy, root, 0, 0, 100, 100, 0,
+					   CopyFromParent, InputOutput,
+					   CopyFromParent, CWEventMask,
+					   &attrs);
+		char wm_name[] = "test_client";
+		char wm_class[] = "pekwm";
+		XClassHint hint = {wm_name, wm_class};
+		XSetClassHint(dpy, win, &hint);
+
+		std::ostringstream title;
+		title << opts.title << " " << i;
+		bench_set_title(dpy, win, net_wm_name, utf8_string,
+				title.str());
+		if (opts.icon > 0) {
+			bench_set_icon(dpy, win, net_wm_icon, opts.icon);
+		}
+		windows.push_back(win);
+
+		double start = bench_now();
+		XMapWindow(dpy, win);
+		XFlush(dpy);
+		if (! bench_wait_reparent(dpy, root, win, start + timeout)) {
+			std::cout << "ERROR: window " << i
+				  << " not decorated" << std::endl;
+			return 1;
+		}
+		elapsed += bench_now() - start;
+	}
+	bench_report("map-to-decorated", opts.windows, elapsed);
+
+	// focus each window, waiting for _NET_ACTIVE_WINDOW to update
+	double start = bench_now();
+	for (int i = 0; i < opts.windows; i++) {
+		bench_send_root_message(dpy, root, windows[i],
+					net_active_window, 2, CurrentTime);
+		if (! bench_wait_root_property(dpy, root, net_active_window,
+					       windows[i],
+					       bench_now() + timeout)) {
+			std::cout << "ERROR: window " << i
+				  << " not focused" << std::endl;
+			return 1;
+		}
+	}
+	bench_report("focus-switch", opts.windows, bench_now() - start);
+
+	// change title of all windows, the round ends with a focus
+	// change making sure pekwm has processed all title changes.
+	start = bench_now();
+	for (int r = 0; r < opts.churn && opts.windows > 1; r++) {
+		for (int i = 0; i < opts.windows; i++) {
+			std::ostringstream title;
+			title << opts.title << " " << i << " round " << r;
+			bench_set_title(dpy, windows[i], net_wm_name,
+					utf8_string, title.str());
+		}
+		Window focus = windows[r % 2];
+		bench_send_root_message(dpy, root, focus, net_active_window,
+					2, CurrentTime);
+		if (! bench_wait_root_property(dpy, root, net_active_window,
+					       focus,
+					       bench_now() + timeout)) {
+			std::cout << "ERROR: title churn round " << r
+				  << " not processed" << std::endl;
+			return 1;
+		}
+	}
+	if (opts.churn > 0 && opts.windows > 1) {
+		bench_report("title-churn", opts.churn, bench_now() - start);
+	}
+
+	// switch workspace, ending on the initial workspace
+	long desktops = 0, desktop = 0;
+	bench_get_cardinal(dpy, root, net_number_of_desktops, desktops);
+	bench_get_cardinal(dpy, root, net_current_desktop, desktop);
+	if (desktops > 1 && opts.workspaces > 0) {
+		int switches = opts.workspaces + opts.workspaces % 2;
+		start = bench_now();
+		for (int i = 1; i <= switches; i++) {
+			long target = (desktop + i % 2) % desktops;
+			bench_send_root_message(dpy, root, root,
+						net_current_desktop,
+						target, CurrentTime);
+			if (! bench_wait_root_property(dpy, root,
+						       net_current_desktop,
+						       target,
+						       bench_now()
+						       + timeout)) {
+				std::cout << "ERROR: workspace " << target
+					  << " not activated" << std::endl;
+				return 1;
+			}
+		}
+		bench_report("workspace-switch", switches,
+			     bench_now() - start);
+	}
+
+	std::cout << "requests\t" << NextRequest(dpy) - requests_start
+		  << std::endl;
+
+	// restart pekwm, windows are reparented to the root window on
+	// shutdown and into new frames when adopted.
+	if (opts.restart) {
+		start = bench_now();
+		bench_send_command(dpy, root, pekwm_cmd, "Restart");
+		int adopted = 0;
+		std::vector<bool> released(opts.windows, false);
+		XEvent ev;
+		while (adopted < opts.windows
+		       && bench_next_event(dpy, &ev, start + timeout)) {
+			if (ev.type != ReparentNotify) {
+				continue;
+			}
+			for (int i = 0; i < opts.windows; i++) {
+				if (windows[i] != ev.xreparent.window) {
+					continue;
+				}
+				if (ev.xreparent.parent == root) {
+					released[i] = true;
+				} else if (released[i]) {
+					released[i] = false;
+					adopted++;
+				}
+			}
+		}
+		if (adopted < opts.windows) {
+			std::cout << "ERROR: " << adopted << " of "
+				  << opts.windows << " windows adopted"
+				  << std::endl;
+			return 1;
+		}
+		bench_report("restart-adopt", 1, bench_now() - start);
+	}
+
+	std::cout << "DONE" << std::endl;
+
+	// keep windows until stopped
+	XEvent ev;
+	while (next_event(dpy, &ev)) {
+	}
+	return 0;
+}
+
+static int
+bench_main(Display *dpy, Window root, int argc, char *argv[])
+{
+	BenchOptions opts;
+	for (int i = 0; i < argc; i++) {
+		std::string arg(argv[i]);
+		std::string::size_type pos = arg.find('=');
+		std::string key = arg.substr(0, pos);
+		std::string value =
+			pos == std::string::npos ? "" : arg.substr(pos + 1);
+		if (key == "windows") {
+			opts.windows = atoi(value.c_str());
+		} else if (key == "title") {
+			opts.title = value;
+		} else if (key == "icon") {
+			opts.icon = atoi(value.c_str());
+		} else if (key == "churn") {
+			opts.churn = atoi(value.c_str());
+		} else if (key == "workspaces") {
+			opts.workspaces = atoi(value.c_str());
+		} else if (key == "restart") {
+			opts.restart = value != "0";
+		} else if (key == "timeout") {
+			opts.timeout = atoi(value.c_str());
+		} else {
+			std::cerr << "ERROR: unknown bench option " << arg
+				  << std::endl;
+			return 1;
+		}
+	}
+	return bench(dpy, root, opts);
+}
+
 int
 main(int argc, char *argv[])
 {
@@ -111,6 +519,10 @@ main(int argc, char *argv[])
 		visual_info(dpy, screen);
 	} else if (argc == 2 && std::string(argv[1]) == "pixmap_formats") {
 		pixmap_formats(dpy);
+	} else if (argc >= 2 && std::string(argv[1]) == "bench") {
+		int ret = bench_main(dpy, root, argc - 2, argv + 2);
+		XCloseDisplay(dpy);
+		return ret;
 	} else {
 		window(dpy, screen, root);
 	}
@@ -3,11 +3,15 @@
  */
 
 #include <cstdio>
+#include <cstdlib>
 #include <cstring>
 #include <iostream>
+#include <set>
+#include <vector>
 
 extern "C" {
 #include <assert.h>
+#include <sys/time.h>
 #include <unistd.h>
 #include <X11/Xlib.h>
 #include <X11/Xutil.h>
@@ -30,8 +34,8 @@ enum SystrayOpcode {
 };
 
 static void
-send_message(Display* dpy, Window w, long message,
-	     long data1, long data2, long data3)
+send_message_nosync(Display* dpy, Window w, long message,
+		    long data1, long data2, long data3)
 {
     XEvent ev = {0};
 
@@ -47,7 +51,14 @@ send_message(Display* dpy, Window w, long message,
     ev.xclient.data.l[4] = data3;
 
     XSendEvent(dpy, w, False, NoEventMask, &ev);
-    XSync(dpy, False);
+}
+
+static void
+send_message(Display* dpy, Window w, long message,
+	     long data1, long data2, long data3)
+{
+	send_message_nosync(dpy, w, message, data1, data2, data3);
+	XSync(dpy, False);
 }
 
 void
@@ -131,6 +142,77 @@ handle_stdin(Display* dpy, Window w)
 	}
 }
 
+static long
+elapsed_ms(const struct timeval& start)
+{
+	struct timeval now;
+	gettimeofday(&now, 0);
+	return (now.tv_sec - start.tv_sec) * 1000
+		+ (now.tv_usec - start.tv_usec) / 1000;
+}
+
+/**
+ * Dock num clients in one burst and measure the time until all clients
+ * are embedded and the layout has been stable for 500ms.
+ */
+static int
+bench_dock(Display* dpy, Window root, Window owner, int num)
+{
+	Atom xembed = XInternAtom(dpy, "_XEMBED", False);
+	std::vector<Window> wins;
+	for (int i = 0; i < num; i++) {
+		Window w = XCreateSimpleWindow(dpy, root, -32, -32, 32, 32,
+					       0, 0, 0);
+		XSelectInput(dpy, w, StructureNotifyMask);
+		set_xembed_info(dpy, w, XEMBED_FLAG_MAPPED);
+		wins.push_back(w);
+	}
+	XSync(dpy, False);
+
+	struct timeval start;
+	gettimeofday(&start, 0);
+	for (int i = 0; i < num; i++) {
+		send_message_nosync(dpy, owner, SYSTEM_TRAY_REQUEST_DOCK,
+				    wins[i], 0, 0);
+	}
+	XFlush(dpy);
+
+	std::set<Window> embedded;
+	long last_change_ms = 0;
+	int dpy_fd = ConnectionNumber(dpy);
+	for (;;) {
+		while (XPending(dpy)) {
+			XEvent ev;
+			XNextEvent(dpy, &ev);
+			if (ev.type == ClientMessage
+			    && ev.xclient.message_type == xembed) {
+				embedded.insert(ev.xclient.window);
+			} else if (ev.type != ConfigureNotify
+				   && ev.type != ReparentNotify
+				   && ev.type != MapNotify) {
+				continue;
+			}
+			last_change_ms = elapsed_ms(start);
+		}
+
+		if (static_cast<int>(embedded.size()) == num
+		    && elapsed_ms(start) - last_change_ms >= 500) {
+			break;
+		}
+
+		fd_set rfds;
+		FD_ZERO(&rfds);
+		FD_SET(dpy_fd, &rfds);
+		struct timeval timeout = { 0, 50000 };
+		select(dpy_fd + 1, &rfds, 0, 0, &timeout);
+	}
+
+	std::cout << "stable layout for " << num << " clients after "
+		  << last_change_ms << " ms" << std::endl;
+	XCloseDisplay(dpy);
+	return 0;
+}
+
 int
 main(int argc, char *argv[])
 {
@@ -143,11 +225,14 @@ main(int argc, char *argv[])
 	// parse options
 	long xembed_flags = XEMBED_FLAG_MAPPED;
 	bool set_xembed = true;
+	int bench_num = 0;
 	for (int i = 1; i < argc; i++) {
 		if (strcmp(argv[i],  "unmapped") == 0) {
 			xembed_flags = 0;
 		} else if (strcmp(argv[i], "skip-xembed") == 0) {
 			set_xembed = false;
+		} else if (strcmp(argv[i], "bench") == 0 && (i + 1) < argc) {
+			bench_num = atoi(argv[++i]);
 		}
 	}
 
@@ -163,6 +248,10 @@ main(int argc, char *argv[])
 		owner = wait_for_owner(dpy, owner_atom);
 	}
 
+	if (bench_num > 0) {
+		return bench_dock(dpy, root, owner, bench_num);
+	}
+
 	Window w = XCreateSimpleWindow(dpy, root, -32, -32, 32, 32, 0, 0, 0);
 	XSelectInput(dpy, w, ButtonPressMask);
 
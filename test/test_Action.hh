@@ -11,6 +11,7 @@
 #include "test.hh"
 
 #include "tk/Action.hh"
+#include "tk/ActionCache.hh"
 
 class TestAction : public Action,
 		   public TestSuite {
@@ -200,3 +201,71 @@ TestActionConfig::assertAction(const std::string& msg, const Action& action,
 			     e_str[i], action.getParamS(i));
 	}
 }
+
+class TestActionCache : public TestSuite {
+public:
+	TestActionCache()
+		: TestSuite("ActionCache")
+	{
+	}
+
+	virtual bool run_test(TestSpec spec, bool status);
+
+	static void testParse(void);
+	static void testEvict(void);
+};
+
+bool
+TestActionCache::run_test(TestSpec spec, bool status)
+{
+	TEST_FN(spec, "parse", testParse());
+	TEST_FN(spec, "evict", testEvict());
+	return status;
+}
+
+void
+TestActionCache::testParse(void)
+{
+	ActionCache cache(4, CMD_OK);
+	ActionEvent ae;
+	ASSERT_TRUE("parse", cache.parse("GoToWorkspace 2", ae));
+	ASSERT_EQUAL("parse actions", 1, ae.action_list.size());
+	ASSERT_EQUAL("parse action", ACTION_GOTO_WORKSPACE,
+		     ae.action_list[0].getAction());
+	ASSERT_EQUAL("parse miss", 1, cache.getMisses());
+
+	ActionEvent ae_cached;
+	ASSERT_TRUE("cached", cache.parse("GoToWorkspace 2", ae_cached));
+	ASSERT_EQUAL("cached hit", 1, cache.getHits());
+	ASSERT_EQUAL("cached actions", 1, ae_cached.action_list.size());
+	ASSERT_EQUAL("cached action", ACTION_GOTO_WORKSPACE,
+		     ae_cached.action_list[0].getAction());
+	ASSERT_EQUAL("cached param", ae.action_list[0].getParamI(0),
+		     ae_cached.action_list[0].getParamI(0));
+
+	// failures are cached too, unknown actions are invalid
+	ASSERT_TRUE("invalid", ! cache.parse("NoSuchAction", ae));
+	ASSERT_EQUAL("invalid actions", 0, ae.action_list.size());
+	ASSERT_TRUE("invalid cached", ! cache.parse("NoSuchAction", ae));
+	ASSERT_EQUAL("invalid hit", 2, cache.getHits());
+	ASSERT_EQUAL("size", 2, cache.size());
+}
+
+void
+TestActionCache::testEvict(void)
+{
+	ActionCache cache(2, CMD_OK);
+	ActionEvent ae;
+	cache.parse("Raise", ae);
+	cache.parse("Lower", ae);
+	// Raise most recently used, Lower evicted
+	cache.parse("Raise", ae);
+	cache.parse("Close", ae);
+	ASSERT_EQUAL("size", 2, cache.size());
+	ASSERT_EQUAL("misses", 3, cache.getMisses());
+
+	cache.parse("Raise", ae);
+	ASSERT_EQUAL("kept", 2, cache.getHits());
+	cache.parse("Lower", ae);
+	ASSERT_EQUAL("evicted", 4, cache.getMisses());
+}
@@ -0,0 +1,310 @@
+//
+// test_ImageCache.hh for pekwm
+// Copyright (C) 2023 Claes Nästén <pekdon@gmail.com>
+//
+// This program is licensed under the GNU GPL.
+// See the LICENSE file for more information.
+//
+
+#include "test.hh"
+#include "tk/ImageCache.hh"
+#include "tk/PImage.hh"
+
+#include <cstring>
+#include <fstream>
+
+extern "C" {
+#include <dirent.h>
+#include <stdlib.h>
+#include <sys/stat.h>
+#include <sys/time.h>
+#include <unistd.h>
+}
+
+class TestImageCache : public TestSuite {
+public:
+	TestImageCache(void);
+	~TestImageCache(void);
+
+	bool run_test(TestSpec spec, bool status);
+
+private:
+	static void testStoreLoad(void);
+	static void testStale(void);
+	static void testHint(void);
+	static void testEvict(void);
+	static void testEvictTmp(void);
+	static void testTrackSize(void);
+
+	static std::string makeDir(void);
+	static void writeFile(const std::string &path,
+			      const std::string &content);
+	static PImage *makeImage(uchar fill);
+	static void setMtime(const std::string &path, time_t mtime);
+	static int countFiles(const std::string &dir);
+	static void removeDir(const std::string &dir);
+};
+
+TestImageCache::TestImageCache(void)
+	: TestSuite("ImageCache")
+{
+}
+
+TestImageCache::~TestImageCache(void)
+{
+}
+
+bool
+TestImageCache::run_test(TestSpec spec, bool status)
+{
+	TEST_FN(spec, "storeLoad", testStoreLoad());
+	TEST_FN(spec, "stale", testStale());
+	TEST_FN(spec, "hint", testHint());
+	TEST_FN(spec, "evict", testEvict());
+	TEST_FN(spec, "evictTmp", testEvictTmp());
+	TEST_FN(spec, "trackSize", testTrackSize());
+	return status;
+}
+
+void
+TestImageCache::testStoreLoad(void)
+{
+	std::string dir = makeDir();
+	std::string src = dir + "/image.png";
+	writeFile(src, "png");
+
+	ImageCache cache(dir + "/cache", 1024 * 1024);
+	ASSERT_EQUAL("miss", true, cache.load(src) == nullptr);
+	ASSERT_EQUAL("missing source", true,
+		     cache.load(dir + "/missing.png") == nullptr);
+	ASSERT_EQUAL("misses", 1, cache.getMisses());
+
+	PImage *image = makeImage(0x7f);
+	ASSERT_EQUAL("store", true, cache.store(src, image));
+	ASSERT_EQUAL("no temporary files", 1, countFiles(dir + "/cache"));
+	PImage *cached = cache.load(src);
+	ASSERT_EQUAL("hit", true, cached != nullptr);
+	ASSERT_EQUAL("hits", 1, cache.getHits());
+	ASSERT_EQUAL("width", 3, cached->getWidth());
+	ASSERT_EQUAL("height", 2, cached->getHeight());
+	ASSERT_EQUAL("alpha", true, cached->useAlpha());
+	ASSERT_EQUAL("data", 0,
+		     memcmp(image->getData(), cached->getData(), 3 * 2 * 4));
+	delete cached;
+	delete image;
+
+	removeDir(dir);
+}
+
+void
+TestImageCache::testStale(void)
+{
+	std::string dir = makeDir();
+	std::string src = dir + "/image.png";
+	writeFile(src, "png");
+
+	ImageCache cache(dir + "/cache/", 1024 * 1024);
+	PImage *image = makeImage(0x10);
+	cache.store(src, image);
+	delete image;
+
+	// same mtime, different size
+	setMtime(src, 1000);
+	writeFile(src, "png data");
+	setMtime(src, 1000);
+	ASSERT_EQUAL("size changed", true, cache.load(src) == nullptr);
+
+	image = makeImage(0x10);
+	cache.store(src, image);
+	delete image;
+	setMtime(src, 2000);
+	ASSERT_EQUAL("mtime changed", true, cache.load(src) == nullptr);
+	ASSERT_EQUAL("misses", 2, cache.getMisses());
+
+	removeDir(dir);
+}
+
+void
+TestImageCache::testHint(void)
+{
+	std::string dir = makeDir();
+	std::string src = dir + "/image.jpg";
+	writeFile(src, "jpg");
+
+	ImageCache cache(dir + "/cache", 1024 * 1024);
+	PImage *image = makeImage(0x30);
+	cache.store(src, image, 1920, 1080);
+	delete image;
+	std::string entry = cache.getEntryPath(src, 1920, 1080);
+	ASSERT_EQUAL("entry", true, cache.getEntryPath(src) != entry);
+	ASSERT_EQUAL("full size", true, cache.load(src) == nullptr);
+	ASSERT_EQUAL("other hint", true,
+		     cache.load(src, 1280, 1024) == nullptr);
+	PImage *hinted = cache.load(src, 1920, 1080);
+	ASSERT_EQUAL("hint", true, hinted != nullptr);
+	delete hinted;
+
+	removeDir(dir);
+}
+
+void
+TestImageCache::testEvict(void)
+{
+	std::string dir = makeDir();
+	std::string src_a = dir + "/a.png";
+	std::string src_b = dir + "/b.png";
+	std::string src_c = dir + "/c.png";
+	writeFile(src_a, "a");
+	writeFile(src_b, "b");
+	writeFile(src_c, "c");
+
+	ImageCache sizer(dir + "/cache", 1024 * 1024);
+	PImage *image = makeImage(0x20);
+	sizer.store(src_a, image);
+	struct stat st;
+	stat(sizer.getEntryPath(src_a).c_str(), &st);
+
+	// room for two entries
+	ImageCache cache(dir + "/cache", st.st_size * 2);
+	cache.store(src_b, image);
+	// make a recently used, b is evicted instead
+	setMtime(cache.getEntryPath(src_a), time(nullptr) + 10);
+	setMtime(cache.getEntryPath(src_b), time(nullptr) - 10);
+	cache.store(src_c, image);
+	delete image;
+
+	ASSERT_EQUAL("evictions", 1, cache.getEvictions());
+	PImage *a = cache.load(src_a);
+	PImage *b = cache.load(src_b);
+	PImage *c = cache.load(src_c);
+	ASSERT_EQUAL("a", true, a != nullptr);
+	ASSERT_EQUAL("b", true, b == nullptr);
+	ASSERT_EQUAL("c", true, c != nullptr);
+	delete a;
+	delete c;
+
+	removeDir(dir);
+}
+
+void
+TestImageCache::testEvictTmp(void)
+{
+	std::string dir = makeDir();
+	std::string src = dir + "/image.png";
+	writeFile(src, "png");
+	std::string stale = dir + "/cache/00000000.argb.tmp.AAAAAA";
+	std::string recent = dir + "/cache/00000000.argb.tmp.BBBBBB";
+	ASSERT_EQUAL("mkdir", 0, mkdir((dir + "/cache").c_str(), 0700));
+	writeFile(stale, "stale");
+	writeFile(recent, "recent");
+	setMtime(stale, time(nullptr) - 7200);
+
+	ImageCache cache(dir + "/cache", 1024 * 1024);
+	PImage *image = makeImage(0x40);
+	cache.store(src, image);
+	delete image;
+
+	struct stat st;
+	ASSERT_EQUAL("stale", -1, stat(stale.c_str(), &st));
+	ASSERT_EQUAL("recent", 0, stat(recent.c_str(), &st));
+	ASSERT_EQUAL("evictions", 0, cache.getEvictions());
+	ASSERT_EQUAL("files", 2, countFiles(dir + "/cache"));
+
+	removeDir(dir);
+}
+
+void
+TestImageCache::testTrackSize(void)
+{
+	std::string dir = makeDir();
+	std::string src_a = dir + "/a.png";
+	std::string src_b = dir + "/b.png";
+	std::string src_c = dir + "/c.png";
+	writeFile(src_a, "a");
+	writeFile(src_b, "b");
+	writeFile(src_c, "c");
+
+	ImageCache sizer(dir + "/cache", 1024 * 1024);
+	PImage *image = makeImage(0x50);
+	sizer.store(src_a, image);
+	struct stat st;
+	stat(sizer.getEntryPath(src_a).c_str(), &st);
+	size_t entry_size = st.st_size;
+	unlink(sizer.getEntryPath(src_a).c_str());
+
+	// first store scans the directory, an entry not stored by this
+	// instance is not seen until the tracked size goes above the
+	// maximum and the directory is scanned again.
+	ImageCache cache(dir + "/cache", entry_size * 2);
+	cache.store(src_a, image);
+	sizer.store(src_b, image);
+	setMtime(sizer.getEntryPath(src_b), time(nullptr) - 10);
+	cache.store(src_c, image);
+	ASSERT_EQUAL("no scan", 3, countFiles(dir + "/cache"));
+	cache.store(src_a, image);
+	delete image;
+	ASSERT_EQUAL("scan", 1, cache.getEvictions());
+	ASSERT_EQUAL("b", true,
+		     stat(cache.getEntryPath(src_b).c_str(), &st) == -1);
+	ASSERT_EQUAL("files", 2, countFiles(dir + "/cache"));
+
+	removeDir(dir);
+}
+
+std::string
+TestImageCache::makeDir(void)
+{
+	char dir[] = "/tmp/pekwm_test_image_cache.XXXXXX";
+	return mkdtemp(dir);
+}
+
+void
+TestImageCache::writeFile(const std::string &path,
+			  const std::string &content)
+{
+	std::ofstream ofs(path.c_str());
+	ofs << content;
+}
+
+PImage*
+TestImageCache::makeImage(uchar fill)
+{
+	uchar *data = new uchar[3 * 2 * 4];
+	for (uint i = 0; i < 3 * 2 * 4; i++) {
+		data[i] = fill + i;
+	}
+	return new PImage(data, 3, 2, true);
+}
+
+void
+TestImageCache::setMtime(const std::string &path, time_t mtime)
+{
+	struct timeval tv[2];
+	tv[0].tv_sec = tv[1].tv_sec = mtime;
+	tv[0].tv_usec = tv[1].tv_usec = 0;
+	utimes(path.c_str(), tv);
+}
+
+int
+TestImageCache::countFiles(const std::string &dir)
+{
+	int count = 0;
+	DIR *dh = opendir(dir.c_str());
+	if (dh != nullptr) {
+		struct dirent *de;
+		while ((de = readdir(dh)) != nullptr) {
+			if (de->d_name[0] != '.') {
+				count++;
+			}
+		}
+		closedir(dh);
+	}
+	return count;
+}
+
+void
+TestImageCache::removeDir(const std::string &dir)
+{
+	std::string cmd = "rm -rf " + dir;
+	ASSERT_EQUAL("rm", 0, system(cmd.c_str()));
+}
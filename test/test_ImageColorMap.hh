@@ -0,0 +1,108 @@
+//
+// test_ImageColorMap.hh for pekwm
+// Copyright (C) 2023 Claes Nästén <pekdon@gmail.com>
+//
+// This program is licensed under the GNU GPL.
+// See the LICENSE file for more information.
+//
+
+#include "test.hh"
+#include "ThreadPool.hh"
+#include "tk/ImageColorMap.hh"
+#include "tk/PImage.hh"
+
+class TestImageColorMap : public TestSuite {
+public:
+	TestImageColorMap(void);
+	~TestImageColorMap(void);
+
+	bool run_test(TestSpec spec, bool status);
+
+private:
+	static void testLookup(void);
+	static void testApply(void);
+	static void testApplyThreads(void);
+
+	static std::map<int, int> makeMap(void);
+};
+
+TestImageColorMap::TestImageColorMap(void)
+	: TestSuite("ImageColorMap")
+{
+}
+
+TestImageColorMap::~TestImageColorMap(void)
+{
+}
+
+bool
+TestImageColorMap::run_test(TestSpec spec, bool status)
+{
+	TEST_FN(spec, "lookup", testLookup());
+	TEST_FN(spec, "apply", testApply());
+	TEST_FN(spec, "applyThreads", testApplyThreads());
+	return status;
+}
+
+void
+TestImageColorMap::testLookup(void)
+{
+	ImageColorMap color_map(makeMap());
+	ASSERT_EQUAL("size", 3, color_map.size());
+
+	int to = 0;
+	ASSERT_EQUAL("first", true, color_map.lookup(-16777216, to));
+	ASSERT_EQUAL("first", -1, to);
+	ASSERT_EQUAL("last", true, color_map.lookup(0x00ff00, to));
+	ASSERT_EQUAL("last", 0x0000ff, to);
+	ASSERT_EQUAL("missing", false, color_map.lookup(0x123456, to));
+	ASSERT_EQUAL("missing", 0x0000ff, to);
+
+	ImageColorMap empty;
+	ASSERT_EQUAL("empty", false, empty.lookup(0, to));
+}
+
+void
+TestImageColorMap::testApply(void)
+{
+	ImageColorMap color_map(makeMap());
+	int pixels[] = {0, 0x00ff00, 0x00ff00, 0x123456, -16777216, 0};
+	color_map.apply(reinterpret_cast<uchar*>(pixels), 6);
+	ASSERT_EQUAL("0", 0x00ff00, pixels[0]);
+	ASSERT_EQUAL("1", 0x0000ff, pixels[1]);
+	ASSERT_EQUAL("2", 0x0000ff, pixels[2]);
+	ASSERT_EQUAL("3", 0x123456, pixels[3]);
+	ASSERT_EQUAL("4", -1, pixels[4]);
+	ASSERT_EQUAL("5", 0x00ff00, pixels[5]);
+}
+
+void
+TestImageColorMap::testApplyThreads(void)
+{
+	ThreadPool pool(4);
+	PImage::setThreadPool(&pool);
+
+	ImageColorMap color_map(makeMap());
+	std::vector<int> pixels(512 * 512);
+	for (size_t i = 0; i < pixels.size(); i++) {
+		pixels[i] = i % 3 ? 0x00ff00 : 0x100000 + i;
+	}
+	color_map.apply(reinterpret_cast<uchar*>(&pixels[0]),
+			pixels.size());
+	for (size_t i = 0; i < pixels.size(); i++) {
+		int expected = i % 3 ? 0x0000ff : 0x100000 + i;
+		ASSERT_EQUAL("pixel", expected, pixels[i]);
+	}
+
+	PImage::setThreadPool(nullptr);
+}
+
+std::map<int, int>
+TestImageColorMap::makeMap(void)
+{
+	std::map<int, int> map;
+	map[-16777216] = -1;
+	map[0] = 0x00ff00;
+	map[0x00ff00] = 0x0000ff;
+	return map;
+}
@@ -8,7 +8,9 @@
 
 #include "test.hh"
 
+#include "Client.hh"
 #include "Observable.hh"
+#include "tk/PWinObj.hh"
 
 class TestObservable : public Observable {
 public:
@@ -20,12 +22,19 @@ public:
 	virtual ~TestObservation(void);
 };
 
+class TestCoalesceObservation : public Observation {
+public:
+	virtual ~TestCoalesceObservation(void);
+	virtual bool canCoalesce(void) const { return true; }
+};
+
 class TestObserver : public Observer {
 public:
 	virtual ~TestObserver(void);
 	virtual void notify(Observable* observable, Observation* observation);
 
 	std::vector<TestObservation*> observations;
+	std::vector<std::pair<Observable*, Observation*> > notifications;
 };
 
 class TestObserverMapping : public TestSuite {
@@ -39,6 +48,11 @@ private:
 	static void testNotify(void);
 	static void testRemoveObservable(void);
 	static void testDestructObservable(void);
+	static void testDeferred(void);
+	static void testDeferredRemoveObservable(void);
+	static void testDeferredWmObservations(void);
+	static void testManyObservables(void);
+	static void testManyObservers(void);
 };
 
 TestObservable::~TestObservable(void)
@@ -49,6 +63,10 @@ TestObservation::~TestObservation(void)
 {
 }
 
+TestCoalesceObservation::~TestCoalesceObservation(void)
+{
+}
+
 TestObserver::~TestObserver(void)
 {
 }
@@ -59,6 +77,8 @@ TestObserver::notify(Observable* observable, Observation* observation)
 	TestObservation *test_observation =
 		dynamic_cast<TestObservation*>(observation);
 	observations.push_back(test_observation);
+	notifications.push_back(std::pair<Observable*, Observation*>(
+					observable, observation));
 }
 
 TestObserverMapping::TestObserverMapping(void)
@@ -76,6 +96,13 @@ TestObserverMapping::run_test(TestSpec spec, bool status)
 	TEST_FN(spec, "notify", testNotify());
 	TEST_FN(spec, "removeObservable", testRemoveObservable());
 	TEST_FN(spec, "destructObservable", testDestructObservable());
+	TEST_FN(spec, "deferred", testDeferred());
+	TEST_FN(spec, "deferredRemoveObservable",
+		testDeferredRemoveObservable());
+	TEST_FN(spec, "deferredWmObservations",
+		testDeferredWmObservations());
+	TEST_FN(spec, "manyObservables", testManyObservables());
+	TEST_FN(spec, "manyObservers", testManyObservers());
 	return status;
 }
 
@@ -157,3 +184,168 @@ TestObserverMapping::testDestructObservable(void)
 
 	ASSERT_EQUAL("destruct observable", 0, om->size());
 }
+
+void
+TestObserverMapping::testDeferred(void)
+{
+	ObserverMapping om;
+	TestObservable observable1;
+	TestObservable observable2;
+	TestObserver observer;
+	TestObservation observation;
+	TestCoalesceObservation coalesce1;
+	TestCoalesceObservation coalesce2;
+
+	om.addObserver(&observable1, &observer);
+	om.addObserver(&observable2, &observer);
+	om.setDeferred(true);
+
+	// observations that can not be coalesced are delivered directly
+	om.notifyObservers(&observable1, &observation);
+	ASSERT_EQUAL("direct", 1, observer.notifications.size());
+	ASSERT_EQUAL("direct", 0, om.queueSize());
+
+	// same observable and type is only queued once, first position
+	// is kept.
+	om.notifyObservers(&observable1, &coalesce1);
+	om.notifyObservers(&observable2, nullptr);
+	om.notifyObservers(&observable1, &coalesce2);
+	om.notifyObservers(&observable1, nullptr);
+	om.notifyObservers(&observable2, &coalesce1);
+	om.notifyObservers(&observable2, nullptr);
+	ASSERT_EQUAL("queued", 1, observer.notifications.size());
+	ASSERT_EQUAL("queued", 4, om.queueSize());
+
+	om.flush();
+	ASSERT_EQUAL("flush", 0, om.queueSize());
+	ASSERT_EQUAL("flush", 5, observer.notifications.size());
+	ASSERT_TRUE("order 1", observer.notifications[1].first == &observable1);
+	ASSERT_TRUE("order 1", observer.notifications[1].second == &coalesce1);
+	ASSERT_TRUE("order 2", observer.notifications[2].first == &observable2);
+	ASSERT_TRUE("order 2", observer.notifications[2].second == nullptr);
+	ASSERT_TRUE("order 3", observer.notifications[3].first == &observable1);
+	ASSERT_TRUE("order 3", observer.notifications[3].second == nullptr);
+	ASSERT_TRUE("order 4", observer.notifications[4].first == &observable2);
+	ASSERT_TRUE("order 4", observer.notifications[4].second == &coalesce1);
+
+	// leaving deferred mode flushes the queue
+	om.notifyObservers(&observable1, nullptr);
+	ASSERT_EQUAL("disable", 1, om.queueSize());
+	om.setDeferred(false);
+	ASSERT_EQUAL("disable", 0, om.queueSize());
+	ASSERT_EQUAL("disable", 6, observer.notifications.size());
+
+	om.notifyObservers(&observable1, nullptr);
+	ASSERT_EQUAL("not deferred", 7, observer.notifications.size());
+}
+
+void
+TestObserverMapping::testDeferredRemoveObservable(void)
+{
+	ObserverMapping om;
+	TestObservable observable;
+	TestObserver observer;
+
+	om.addObserver(&observable, &observer);
+	om.setDeferred(true);
+	om.notifyObservers(&observable, nullptr);
+	ASSERT_EQUAL("queued", 1, om.queueSize());
+
+	om.removeObservable(&observable);
+	ASSERT_EQUAL("removed", 0, om.queueSize());
+	om.flush();
+	ASSERT_EQUAL("removed", 0, observer.notifications.size());
+}
+
+/**
+ * Layer changes are coalesced per client while handling a batch of
+ * events, deleted window objects are always notified directly.
+ */
+void
+TestObserverMapping::testDeferredWmObservations(void)
+{
+	ObserverMapping om;
+	TestObservable client;
+	TestObserver observer;
+
+	om.addObserver(&client, &observer);
+	om.setDeferred(true);
+	om.notifyObservers(&client, &Client::layer_changed);
+	om.notifyObservers(&client, &Client::layer_changed);
+	om.notifyObservers(&client, &Client::layer_changed);
+	ASSERT_EQUAL("layer queued", 0, observer.notifications.size());
+	ASSERT_EQUAL("layer queued", 1, om.queueSize());
+
+	om.notifyObservers(&client, &PWinObj::pwin_obj_deleted);
+	ASSERT_EQUAL("deleted direct", 1, observer.notifications.size());
+	ASSERT_TRUE("deleted direct", observer.notifications[0].second
+		    == &PWinObj::pwin_obj_deleted);
+
+	om.flush();
+	ASSERT_EQUAL("layer flush", 2, observer.notifications.size());
+	ASSERT_TRUE("layer flush", observer.notifications[1].second
+		    == &Client::layer_changed);
+}
+
+void
+TestObserverMapping::testManyObservables(void)
+{
+	ObserverMapping om;
+	std::vector<TestObservable> observables(1000);
+	TestObserver observer;
+	TestObservation observation;
+
+	for (size_t i = 0; i < observables.size(); i++) {
+		om.addObserver(&observables[i], &observer);
+	}
+	ASSERT_EQUAL("add", 1000, om.size());
+
+	// remove every other observable, the remaining must still be
+	// found after entries have been shifted.
+	for (size_t i = 0; i < observables.size(); i += 2) {
+		om.removeObserver(&observables[i], &observer);
+	}
+	ASSERT_EQUAL("remove", 500, om.size());
+
+	for (size_t i = 0; i < observables.size(); i++) {
+		om.notifyObservers(&observables[i], &observation);
+	}
+	ASSERT_EQUAL("notify", 500, observer.notifications.size());
+	for (size_t i = 0; i < observer.notifications.size(); i++) {
+		ASSERT_TRUE("notify",
+			    observer.notifications[i].first
+			    == &observables[i * 2 + 1]);
+	}
+
+	for (size_t i = 1; i < observables.size(); i += 2) {
+		om.removeObservable(&observables[i]);
+	}
+	ASSERT_EQUAL("removeObservable", 0, om.size());
+}
+
+void
+TestObserverMapping::testManyObservers(void)
+{
+	ObserverMapping om;
+	TestObservable observable;
+	std::vector<TestObserver> observers(10);
+	TestObservation observation;
+
+	for (size_t i = 0; i < observers.size(); i++) {
+		om.addObserver(&observable, &observers[i]);
+	}
+	om.removeObserver(&observable, &observers[0]);
+	om.removeObserver(&observable, &observers[5]);
+	om.notifyObservers(&observable, &observation);
+
+	for (size_t i = 0; i < observers.size(); i++) {
+		size_t expected = (i == 0 || i == 5) ? 0 : 1;
+		ASSERT_EQUAL("notify", expected,
+			     observers[i].notifications.size());
+	}
+
+	for (size_t i = 0; i < observers.size(); i++) {
+		om.removeObserver(&observable, &observers[i]);
+	}
+	ASSERT_EQUAL("remove", 0, om.size());
+}
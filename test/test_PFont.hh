@@ -10,6 +10,7 @@
 
 #include "test.hh"
 #include "tk/PFont.hh"
+#include "tk/TextExtentCache.hh"
 
 struct WMP {
 	const char *str;
@@ -23,10 +24,12 @@ public:
 
 	virtual bool load(const PFont::Descr&) { return true; }
 	virtual void unload() { }
-	virtual uint getWidth(const std::string& text, uint max_chars = 0);
 	virtual void setColor(PFont::Color*) { }
 
+	uint getLookups(void) const { return _lookups; }
+
 private:
+	virtual uint textWidth(const std::string& text, uint max_chars);
 	virtual std::string toNativeDescr(const PFont::Descr& descr) const {
 		return descr.str();
 	}
@@ -35,9 +38,11 @@ private:
 
 private:
 	std::map<std::string, uint> _width_map;
+	uint _lookups;
 };
 
 MockPFont::MockPFont(WMP *width_map)
+	: _lookups(0)
 {
 	for (int i = 0; width_map[i].str != nullptr; ++i) {
 		_width_map[width_map[i].str] = width_map[i].w;
@@ -49,8 +54,9 @@ MockPFont::~MockPFont(void)
 }
 
 uint
-MockPFont::getWidth(const std::string& text, uint max_chars)
+MockPFont::textWidth(const std::string& text, uint max_chars)
 {
+	_lookups++;
 	std::string key = text + std::to_string(max_chars);
 	std::map<std::string, uint>::iterator it = _width_map.find(key);
 	if (it == _width_map.end()) {
@@ -82,6 +88,10 @@ private:
 	static void testTrimEndNoSpace(void);
 	static void testTrimEndUTF8(void);
 	static void testTrimMiddle(void);
+	static void testTrimCached(void);
+
+	// getWidth
+	static void testGetWidthExtentCache(void);
 };
 
 TestPFont::TestPFont(void)
@@ -106,6 +116,9 @@ TestPFont::run_test(TestSpec spec, bool status)
 	TEST_FN(spec, "trimEndNoSpace", testTrimEndNoSpace());
 	TEST_FN(spec, "trimEndUTF8", testTrimEndUTF8());
 	TEST_FN(spec, "trimMiddle", testTrimMiddle());
+	TEST_FN(spec, "trimCached", testTrimCached());
+
+	TEST_FN(spec, "getWidthExtentCache", testGetWidthExtentCache());
 	return status;
 }
 
@@ -202,6 +215,14 @@ TestPFont::testTrimEndUTF8(void)
 		       {"Räksmörgås — M13", 60},
 		       {"Räksmörgås — M12", 50},
 		       {"Räksmörgås — M10", 40},
+		       {"Räksmörgås — M18", 95},
+		       {"Räksmörgås — M9", 35},
+		       {"Räksmörgås — M8", 30},
+		       {"Räksmörgås — M6", 25},
+		       {"Räksmörgås — M5", 20},
+		       {"Räksmörgås — M4", 15},
+		       {"Räksmörgås — M3", 10},
+		       {"Räksmörgås — M1", 5},
 		       {nullptr, 0}};
 	MockPFont font(fontd);
 	std::string str("Räksmörgås — M");
@@ -226,6 +247,7 @@ TestPFont::testTrimMiddle(void)
 		       {"test0", 40},
 		       {"est0", 30},
 		       {"st0", 20},
+		       {"t0", 10},
 
 		       {"test2", 20},
 
@@ -237,3 +259,52 @@ TestPFont::testTrimMiddle(void)
 	font.trim(str, PFont::FONT_TRIM_MIDDLE, 60);
 	ASSERT_EQUAL("trim middle", "te..st", str);
 }
+
+void
+TestPFont::testTrimCached(void)
+{
+	WMP fontd[] = {{"test0", 100},
+		       {"test1", 25},
+		       {"test2", 50},
+		       {"test3", 75},
+		       {nullptr, 0}};
+	MockPFont font(fontd);
+	std::string str("test");
+	font.trim(str, PFont::FONT_TRIM_END, 60);
+	ASSERT_EQUAL("trim end", "te", str);
+	uint lookups = font.getLookups();
+	ASSERT_TRUE("lookups", lookups <= 3);
+
+	str = "test";
+	font.trim(str, PFont::FONT_TRIM_END, 60);
+	ASSERT_EQUAL("trim end, cached", "te", str);
+	ASSERT_EQUAL("no lookups", lookups, font.getLookups());
+
+	str = "test";
+	font.setOffset(0, 0);
+	font.trim(str, PFont::FONT_TRIM_END, 60);
+	ASSERT_EQUAL("trim end, cleared", "te", str);
+	ASSERT_EQUAL("lookups after clear", lookups * 2, font.getLookups());
+}
+
+void
+TestPFont::testGetWidthExtentCache(void)
+{
+	WMP fontd[] = {{"test0", 100},
+		       {"test2", 50},
+		       {nullptr, 0}};
+	MockPFont font(fontd);
+	TextExtentCache cache(16);
+	font.setExtentCache(&cache);
+
+	ASSERT_EQUAL("width", 100, font.getWidth("test"));
+	ASSERT_EQUAL("width", 100, font.getWidth("test"));
+	ASSERT_EQUAL("prefix width", 50, font.getWidth("test", 2));
+	ASSERT_EQUAL("prefix width", 50, font.getWidth("test", 2));
+	ASSERT_EQUAL("lookups", 2, font.getLookups());
+	ASSERT_EQUAL("hits", 2, cache.getHits());
+
+	font.setOffset(0, 0);
+	ASSERT_EQUAL("cleared", 0, cache.size());
+	font.setExtentCache(nullptr);
+}
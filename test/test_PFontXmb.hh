@@ -22,10 +22,10 @@ public:
 
 	const std::string& getNative() const { return _native; }
 
-	virtual uint getWidth(const std::string&, uint chars=0) { return 0; }
 	virtual void setColor(PFont::Color*) { }
 
 private:
+	virtual uint textWidth(const std::string&, uint) { return 0; }
 	virtual void drawText(PSurface*, int, int, const std::string&,
 			      uint, bool) { }
 
@@ -0,0 +1,160 @@
+//
+// test_PImage.hh for pekwm
+// Copyright (C) 2023 Claes Nästén <pekdon@gmail.com>
+//
+// This program is licensed under the GNU GPL.
+// See the LICENSE file for more information.
+//
+
+#include "test.hh"
+#include "ThreadPool.hh"
+#include "tk/PImage.hh"
+
+extern "C" {
+#include <stdlib.h>
+#include <X11/Xutil.h>
+}
+
+class TestPImage : public TestSuite {
+public:
+	TestPImage(void);
+	~TestPImage(void);
+
+	bool run_test(TestSpec spec, bool status);
+
+private:
+	static void testFillXImage(void);
+	static void testFillXImageThreads(void);
+
+	static void assertFillXImage(PImage &image, int depth, int bpp,
+				     ulong red, ulong green, ulong blue);
+	static ulong toMask(uchar value, ulong mask);
+	static PImage *makeImage(size_t width, size_t height);
+	static XImage *createXImage(size_t width, size_t height,
+				    int depth, int bpp,
+				    ulong red, ulong green, ulong blue);
+};
+
+TestPImage::TestPImage(void)
+	: TestSuite("PImage")
+{
+}
+
+TestPImage::~TestPImage(void)
+{
+}
+
+bool
+TestPImage::run_test(TestSpec spec, bool status)
+{
+	TEST_FN(spec, "fillXImage", testFillXImage());
+	TEST_FN(spec, "fillXImageThreads", testFillXImageThreads());
+	return status;
+}
+
+void
+TestPImage::testFillXImage(void)
+{
+	PImage *image = makeImage(7, 3);
+	assertFillXImage(*image, 24, 32, 0xff0000, 0xff00, 0xff);
+	assertFillXImage(*image, 24, 32, 0xff, 0xff00, 0xff0000);
+	assertFillXImage(*image, 16, 16, 0xf800, 0x07e0, 0x001f);
+	assertFillXImage(*image, 15, 16, 0x7c00, 0x3e0, 0x1f);
+	// packed 24bit, converted with XPutPixel
+	assertFillXImage(*image, 24, 24, 0xff0000, 0xff00, 0xff);
+	delete image;
+}
+
+void
+TestPImage::testFillXImageThreads(void)
+{
+	ThreadPool pool(4);
+	PImage::setThreadPool(&pool);
+	PImage *image = makeImage(300, 301);
+	assertFillXImage(*image, 24, 32, 0xff0000, 0xff00, 0xff);
+	assertFillXImage(*image, 16, 16, 0xf800, 0x07e0, 0x001f);
+	delete image;
+	PImage::setThreadPool(nullptr);
+}
+
+/**
+ * Fill XImage using image and compare every pixel with the pixel
+ * value calculated from the image masks.
+ */
+void
+TestPImage::assertFillXImage(PImage &image, int depth, int bpp,
+			     ulong red, ulong green, ulong blue)
+{
+	size_t width = image.getWidth();
+	size_t height = image.getHeight();
+	XImage *ximage = createXImage(width, height, depth, bpp,
+				      red, green, blue);
+	ASSERT_TRUE("fill", image.fillXImage(ximage, width, height));
+
+	const uchar *src = image.getData();
+	for (size_t y = 0; y < height; y++) {
+		for (size_t x = 0; x < width; x++, src += 4) {
+			ulong expected = toMask(src[1], red)
+				| toMask(src[2], green)
+				| toMask(src[3], blue);
+			ASSERT_EQUAL("pixel", expected,
+				     XGetPixel(ximage, x, y));
+		}
+	}
+	XDestroyImage(ximage);
+}
+
+/**
+ * Scale 8 bit value to the number of bits in mask and shift it into
+ * place.
+ */
+ulong
+TestPImage::toMask(uchar value, ulong mask)
+{
+	int shift = 0;
+	for (; ! (mask & 1); mask >>= 1) {
+		shift++;
+	}
+	int bits = 0;
+	for (; mask & 1; mask >>= 1) {
+		bits++;
+	}
+	return static_cast<ulong>(value >> (8 - bits)) << shift;
+}
+
+PImage*
+TestPImage::makeImage(size_t width, size_t height)
+{
+	uchar *data = new uchar[width * height * 4];
+	for (size_t i = 0; i < width * height * 4; i++) {
+		data[i] = rand();
+	}
+	return new PImage(data, width, height, false);
+}
+
+/**
+ * Create XImage without a display connection.
+ */
+XImage*
+TestPImage::createXImage(size_t width, size_t height, int depth, int bpp,
+			 ulong red, ulong green, ulong blue)
+{
+	XImage *ximage = static_cast<XImage*>(calloc(1, sizeof(XImage)));
+	ximage->width = width;
+	ximage->height = height;
+	ximage->format = ZPixmap;
+	ximage->byte_order = LSBFirst;
+	ximage->bitmap_unit = 32;
+	ximage->bitmap_bit_order = LSBFirst;
+	ximage->bitmap_pad = 32;
+	ximage->depth = depth;
+	ximage->bits_per_pixel = bpp;
+	ximage->bytes_per_line = (width * bpp / 8 + 3) & ~3;
+	ximage->red_mask = red;
+	ximage->green_mask = green;
+	ximage->blue_mask = blue;
+	ximage->data = static_cast<char*>(
+		calloc(ximage->bytes_per_line, height));
+	XInitImage(ximage);
+	return ximage;
+}
@@ -0,0 +1,176 @@
+//
+// test_PImageIcon.hh for pekwm
+// Copyright (C) 2023 Claes Nästén <pekdon@gmail.com>
+//
+// This program is licensed under the GNU GPL.
+// See the LICENSE file for more information.
+//
+
+#include "test.hh"
+#include "tk/ImageHandler.hh"
+#include "tk/PImageIcon.hh"
+
+#include <vector>
+
+class TestPImageIcon : public TestSuite {
+public:
+	TestPImageIcon(void);
+	~TestPImageIcon(void);
+
+	bool run_test(TestSpec spec, bool status);
+
+private:
+	static void testFindIcon(void);
+	static void testFindIconInvalid(void);
+	static void testShared(void);
+	static void testSharedCollision(void);
+
+	static void addIcon(std::vector<Cardinal> &data,
+			    size_t width, size_t height);
+	static ulong findIcon(const std::vector<Cardinal> &data,
+			      size_t width, size_t height);
+};
+
+TestPImageIcon::TestPImageIcon(void)
+	: TestSuite("PImageIcon")
+{
+}
+
+TestPImageIcon::~TestPImageIcon(void)
+{
+}
+
+bool
+TestPImageIcon::run_test(TestSpec spec, bool status)
+{
+	TEST_FN(spec, "findIcon", testFindIcon());
+	TEST_FN(spec, "findIconInvalid", testFindIconInvalid());
+	TEST_FN(spec, "shared", testShared());
+	TEST_FN(spec, "sharedCollision", testSharedCollision());
+	return status;
+}
+
+void
+TestPImageIcon::testFindIcon(void)
+{
+	std::vector<Cardinal> data;
+	addIcon(data, 32, 32); // offset 0
+	addIcon(data, 16, 16); // offset 1026
+	addIcon(data, 48, 48); // offset 1284
+
+	ASSERT_EQUAL("largest", 1284, findIcon(data, 0, 0));
+	ASSERT_EQUAL("exact", 1026, findIcon(data, 16, 16));
+	ASSERT_EQUAL("smallest larger", 0, findIcon(data, 20, 20));
+	ASSERT_EQUAL("width only", 0, findIcon(data, 24, 0));
+	ASSERT_EQUAL("none larger", 1284, findIcon(data, 64, 64));
+}
+
+void
+TestPImageIcon::testFindIconInvalid(void)
+{
+	std::vector<Cardinal> data;
+	data.push_back(16);
+	ulong offset;
+	ASSERT_EQUAL("no height", false,
+		     PImageIcon::findIcon(&data[0], data.size(), 0, 0,
+					  800, 600, offset));
+
+	data.clear();
+	addIcon(data, 16, 16);
+	addIcon(data, 32, 32);
+	// second icon truncated
+	ASSERT_EQUAL("truncated", true,
+		     PImageIcon::findIcon(&data[0], data.size() - 1, 0, 0,
+					  800, 600, offset));
+	ASSERT_EQUAL("truncated", 0, offset);
+	// second icon larger than the screen
+	ASSERT_EQUAL("too large", true,
+		     PImageIcon::findIcon(&data[0], data.size(), 0, 0,
+					  24, 24, offset));
+	ASSERT_EQUAL("too large", 0, offset);
+
+	data[0] = 0;
+	ASSERT_EQUAL("zero size", false,
+		     PImageIcon::findIcon(&data[0], data.size(), 0, 0,
+					  800, 600, offset));
+}
+
+void
+TestPImageIcon::testShared(void)
+{
+	ImageHandler image_handler;
+	ASSERT_EQUAL("miss", true,
+		     image_handler.findImage("ICON#16X16#1") == nullptr);
+
+	uchar *data = new uchar[16 * 16 * 4];
+	PImage *image = new PImage(data, 16, 16, true);
+	image_handler.takeOwnership(image, "icon#16x16#1");
+	ASSERT_EQUAL("hit", true, image_handler.findImage("ICON#16X16#1")
+		     == image);
+	ASSERT_EQUAL("other key", true,
+		     image_handler.findImage("ICON#16X16#2") == nullptr);
+
+	image_handler.returnImage(image);
+	ASSERT_EQUAL("referenced", true,
+		     image_handler.findImage("ICON#16X16#1") == image);
+	image_handler.returnImage(image);
+	image_handler.returnImage(image);
+	ASSERT_EQUAL("released", true,
+		     image_handler.findImage("ICON#16X16#1") == nullptr);
+}
+
+void
+TestPImageIcon::testSharedCollision(void)
+{
+	ImageHandler image_handler;
+	std::vector<Cardinal> data_a;
+	addIcon(data_a, 2, 2);
+	std::vector<Cardinal> data_b(data_a);
+	data_b[2] = 0;
+
+	// same key, different data as on a hash collision
+	PImage *a = PImageIcon::getShared(&image_handler, "ICON#2X2#0",
+					  &data_a[0]);
+	PImage *b = PImageIcon::getShared(&image_handler, "ICON#2X2#0",
+					  &data_b[0]);
+	ASSERT_EQUAL("collision", true, a != b);
+	ASSERT_EQUAL("b suffix", true,
+		     image_handler.findImage("ICON#2X2#0#1") == b);
+	image_handler.returnImage(b);
+	ASSERT_EQUAL("a shared", true,
+		     PImageIcon::getShared(&image_handler, "ICON#2X2#0",
+					   &data_a[0]) == a);
+	ASSERT_EQUAL("b shared", true,
+		     PImageIcon::getShared(&image_handler, "ICON#2X2#0",
+					   &data_b[0]) == b);
+
+	image_handler.returnImage(a);
+	image_handler.returnImage(a);
+	image_handler.returnImage(b);
+	image_handler.returnImage(b);
+	ASSERT_EQUAL("released", true,
+		     image_handler.findImage("ICON#2X2#0#1") == nullptr);
+}
+
+void
+TestPImageIcon::addIcon(std::vector<Cardinal> &data,
+			size_t width, size_t height)
+{
+	data.push_back(width);
+	data.push_back(height);
+	for (size_t i = 0; i < width * height; i++) {
+		data.push_back(0xff000000 | i);
+	}
+}
+
+ulong
+TestPImageIcon::findIcon(const std::vector<Cardinal> &data,
+			 size_t width, size_t height)
+{
+	ulong offset = 0;
+	if (! PImageIcon::findIcon(&data[0], data.size(), width, height,
+				   800, 600, offset)) {
+		return static_cast<ulong>(-1);
+	}
+	return offset;
+}
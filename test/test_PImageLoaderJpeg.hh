@@ -0,0 +1,58 @@
+//
+// test_PImageLoaderJpeg.hh for pekwm
+// Copyright (C) 2023 Claes Nästén <pekdon@gmail.com>
+//
+// This program is licensed under the GNU GPL.
+// See the LICENSE file for more information.
+//
+
+#include "test.hh"
+#include "tk/PImageLoaderJpeg.hh"
+
+class TestPImageLoaderJpeg : public TestSuite {
+public:
+	TestPImageLoaderJpeg(void);
+	~TestPImageLoaderJpeg(void);
+
+	bool run_test(TestSpec spec, bool status);
+
+private:
+	static void testGetScaleDenom(void);
+};
+
+TestPImageLoaderJpeg::TestPImageLoaderJpeg(void)
+	: TestSuite("PImageLoaderJpeg")
+{
+}
+
+TestPImageLoaderJpeg::~TestPImageLoaderJpeg(void)
+{
+}
+
+bool
+TestPImageLoaderJpeg::run_test(TestSpec spec, bool status)
+{
+	TEST_FN(spec, "getScaleDenom", testGetScaleDenom());
+	return status;
+}
+
+void
+TestPImageLoaderJpeg::testGetScaleDenom(void)
+{
+	ASSERT_EQUAL("no hint", 1,
+		     PImageLoaderJpeg::getScaleDenom(7680, 4320, 0, 0));
+	ASSERT_EQUAL("8K on 1080p", 4,
+		     PImageLoaderJpeg::getScaleDenom(7680, 4320,
+						     1920, 1080));
+	ASSERT_EQUAL("8K on 1200p", 2,
+		     PImageLoaderJpeg::getScaleDenom(7680, 4320,
+						     1920, 1200));
+	ASSERT_EQUAL("small head", 8,
+		     PImageLoaderJpeg::getScaleDenom(7680, 4320, 640, 480));
+	ASSERT_EQUAL("larger than image", 1,
+		     PImageLoaderJpeg::getScaleDenom(1920, 1080,
+						     2560, 1440));
+	// 1001 / 2 rounds up to 501
+	ASSERT_EQUAL("round up", 2,
+		     PImageLoaderJpeg::getScaleDenom(1001, 1001, 501, 0));
+}
@@ -0,0 +1,175 @@
+//
+// test_PImageLoaderPng.hh for pekwm
+// Copyright (C) 2023 Claes Nästén <pekdon@gmail.com>
+//
+// This program is licensed under the GNU GPL.
+// See the LICENSE file for more information.
+//
+
+#include "test.hh"
+#include "tk/PImageLoaderPng.hh"
+
+#include <cstring>
+
+extern "C" {
+#include <png.h>
+#include <stdio.h>
+#include <unistd.h>
+}
+
+class TestPImageLoaderPng : public TestSuite {
+public:
+	TestPImageLoaderPng(void);
+	~TestPImageLoaderPng(void);
+
+	bool run_test(TestSpec spec, bool status);
+
+private:
+	static void testSaveLoad(void);
+	static void testSaveLoadAlpha(void);
+	static void testGray(void);
+	static void testInterlaced(void);
+
+	static void writePng(const std::string &file, int color_type,
+			     int interlace, const uchar *data,
+			     size_t width, size_t height);
+};
+
+TestPImageLoaderPng::TestPImageLoaderPng(void)
+	: TestSuite("PImageLoaderPng")
+{
+}
+
+TestPImageLoaderPng::~TestPImageLoaderPng(void)
+{
+}
+
+bool
+TestPImageLoaderPng::run_test(TestSpec spec, bool status)
+{
+	TEST_FN(spec, "saveLoad", testSaveLoad());
+	TEST_FN(spec, "saveLoadAlpha", testSaveLoadAlpha());
+	TEST_FN(spec, "gray", testGray());
+	TEST_FN(spec, "interlaced", testInterlaced());
+	return status;
+}
+
+void
+TestPImageLoaderPng::testSaveLoad(void)
+{
+	std::string file = "/tmp/pekwm_test_png_rgb.png";
+	uchar argb[] = {0xff, 1, 2, 3, 0xff, 4, 5, 6,
+			0xff, 7, 8, 9, 0xff, 10, 11, 12};
+	ASSERT_TRUE("save", PImageLoaderPng::save(file, argb, 2, 2));
+
+	size_t width, height;
+	bool use_alpha = true;
+	uchar *data = PImageLoaderPng::load(file, width, height, use_alpha);
+	unlink(file.c_str());
+	ASSERT_TRUE("load", data != nullptr);
+	ASSERT_EQUAL("width", 2, width);
+	ASSERT_EQUAL("height", 2, height);
+	ASSERT_EQUAL("alpha", false, use_alpha);
+	ASSERT_EQUAL("data", 0, memcmp(argb, data, sizeof(argb)));
+	delete [] data;
+}
+
+void
+TestPImageLoaderPng::testSaveLoadAlpha(void)
+{
+	std::string file = "/tmp/pekwm_test_png_rgba.png";
+	uchar argb[] = {0xff, 1, 2, 3, 0x80, 4, 5, 6,
+			0x00, 7, 8, 9, 0xff, 10, 11, 12};
+	ASSERT_TRUE("save", PImageLoaderPng::save(file, argb, 2, 2, true));
+
+	size_t width, height;
+	bool use_alpha = false;
+	uchar *data = PImageLoaderPng::load(file, width, height, use_alpha);
+	unlink(file.c_str());
+	ASSERT_TRUE("load", data != nullptr);
+	ASSERT_EQUAL("alpha", true, use_alpha);
+	ASSERT_EQUAL("data", 0, memcmp(argb, data, sizeof(argb)));
+	delete [] data;
+
+	// alpha channel without any transparent pixels
+	uchar opaque[] = {0xff, 1, 2, 3};
+	ASSERT_TRUE("save", PImageLoaderPng::save(file, opaque, 1, 1, true));
+	data = PImageLoaderPng::load(file, width, height, use_alpha);
+	unlink(file.c_str());
+	ASSERT_TRUE("load", data != nullptr);
+	ASSERT_EQUAL("opaque", false, use_alpha);
+	delete [] data;
+}
+
+void
+TestPImageLoaderPng::testGray(void)
+{
+	std::string file = "/tmp/pekwm_test_png_gray.png";
+	uchar gray[] = {0x10, 0x20, 0x30};
+	writePng(file, PNG_COLOR_TYPE_GRAY, PNG_INTERLACE_NONE, gray, 3, 1);
+
+	size_t width, height;
+	bool use_alpha = true;
+	uchar *data = PImageLoaderPng::load(file, width, height, use_alpha);
+	unlink(file.c_str());
+	ASSERT_TRUE("load", data != nullptr);
+	uchar expected[] = {0xff, 0x10, 0x10, 0x10, 0xff, 0x20, 0x20, 0x20,
+			    0xff, 0x30, 0x30, 0x30};
+	ASSERT_EQUAL("alpha", false, use_alpha);
+	ASSERT_EQUAL("data", 0, memcmp(expected, data, sizeof(expected)));
+	delete [] data;
+}
+
+void
+TestPImageLoaderPng::testInterlaced(void)
+{
+	std::string file = "/tmp/pekwm_test_png_interlaced.png";
+	const size_t size = 9;
+	uchar rgb[size * size * 3];
+	for (size_t i = 0; i < sizeof(rgb); i++) {
+		rgb[i] = i % 251;
+	}
+	writePng(file, PNG_COLOR_TYPE_RGB, PNG_INTERLACE_ADAM7,
+		 rgb, size, size);
+
+	size_t width, height;
+	bool use_alpha;
+	uchar *data = PImageLoaderPng::load(file, width, height, use_alpha);
+	unlink(file.c_str());
+	ASSERT_TRUE("load", data != nullptr);
+	ASSERT_EQUAL("width", size, width);
+	ASSERT_EQUAL("height", size, height);
+	for (size_t i = 0; i < size * size; i++) {
+		ASSERT_EQUAL("A", 0xff, data[i * 4]);
+		ASSERT_EQUAL("R", rgb[i * 3], data[i * 4 + 1]);
+		ASSERT_EQUAL("G", rgb[i * 3 + 1], data[i * 4 + 2]);
+		ASSERT_EQUAL("B", rgb[i * 3 + 2], data[i * 4 + 3]);
+	}
+	delete [] data;
+}
+
+void
+TestPImageLoaderPng::writePng(const std::string &file, int color_type,
+			      int interlace, const uchar *data,
+			      size_t width, size_t height)
+{
+	FILE *fp = fopen(file.c_str(), "wb");
+	png_structp png_ptr =
+		png_create_write_struct(PNG_LIBPNG_VER_STRING, 0, 0, 0);
+	png_infop info_ptr = png_create_info_struct(png_ptr);
+	png_init_io(png_ptr, fp);
+	png_set_IHDR(png_ptr, info_ptr, width, height, 8, color_type,
+		     interlace, PNG_COMPRESSION_TYPE_DEFAULT,
+		     PNG_FILTER_TYPE_DEFAULT);
+	png_write_info(png_ptr, info_ptr);
+
+	size_t rowbytes = png_get_rowbytes(png_ptr, info_ptr);
+	std::vector<png_bytep> rows;
+	for (size_t y = 0; y < height; y++) {
+		rows.push_back(const_cast<uchar*>(data) + y * rowbytes);
+	}
+	png_write_image(png_ptr, &rows[0]);
+	png_write_end(png_ptr, 0);
+	png_destroy_write_struct(&png_ptr, &info_ptr);
+	fclose(fp);
+}
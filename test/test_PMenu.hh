@@ -0,0 +1,54 @@
+//
+// test_PMenu.hh for pekwm
+// Copyright (C) 2023 Claes Nästén <pekdon@gmail.com>
+//
+// This program is licensed under the GNU GPL.
+// See the LICENSE file for more information.
+//
+
+#include "test.hh"
+#include "PMenu.hh"
+
+class TestPMenu : public TestSuite {
+public:
+	TestPMenu(void);
+	~TestPMenu(void);
+
+	virtual bool run_test(TestSpec spec, bool status);
+
+private:
+	static void testIsScrollButton(void);
+};
+
+TestPMenu::TestPMenu(void)
+	: TestSuite("PMenu")
+{
+}
+
+TestPMenu::~TestPMenu(void)
+{
+}
+
+bool
+TestPMenu::run_test(TestSpec spec, bool status)
+{
+	TEST_FN(spec, "isScrollButton", testIsScrollButton());
+	return status;
+}
+
+/**
+ * The wheel scrolls a scrolled menu on press, both press and release
+ * must then be consumed and the release must not execute the item.
+ */
+void
+TestPMenu::testIsScrollButton(void)
+{
+	ASSERT_EQUAL("wheel up", true, PMenu::isScrollButton(true, Button4));
+	ASSERT_EQUAL("wheel down", true,
+		     PMenu::isScrollButton(true, Button5));
+	ASSERT_EQUAL("click", false, PMenu::isScrollButton(true, Button1));
+	ASSERT_EQUAL("not scrolled", false,
+		     PMenu::isScrollButton(false, Button4));
+	ASSERT_EQUAL("not scrolled", false,
+		     PMenu::isScrollButton(false, Button5));
+}
@@ -0,0 +1,118 @@
+//
+// test_PixmapPool.hh for pekwm
+// Copyright (C) 2023 Claes Nästén <pekdon@gmail.com>
+//
+// This program is licensed under the GNU GPL.
+// See the LICENSE file for more information.
+//
+
+#include "test.hh"
+#include "tk/PixmapPool.hh"
+
+#include <sstream>
+
+class TestPixmapPool : public TestSuite {
+public:
+	TestPixmapPool(void);
+	~TestPixmapPool(void);
+
+	bool run_test(TestSpec spec, bool status);
+
+private:
+	static void testGetRelease(void);
+	static void testShared(void);
+	static void testRemove(void);
+};
+
+TestPixmapPool::TestPixmapPool(void)
+	: TestSuite("PixmapPool")
+{
+}
+
+TestPixmapPool::~TestPixmapPool(void)
+{
+}
+
+bool
+TestPixmapPool::run_test(TestSpec spec, bool status)
+{
+	TEST_FN(spec, "getRelease", testGetRelease());
+	TEST_FN(spec, "shared", testShared());
+	TEST_FN(spec, "remove", testRemove());
+	return status;
+}
+
+void
+TestPixmapPool::testGetRelease(void)
+{
+	const PTexture *tex = reinterpret_cast<const PTexture*>(0x10);
+	PixmapPool pool;
+	ASSERT_EQUAL("miss", None, pool.get(tex, 10, 2));
+
+	pool.add(tex, 10, 2, 100, 80);
+	ASSERT_EQUAL("hit", 100, pool.get(tex, 10, 2));
+	ASSERT_EQUAL("other size", None, pool.get(tex, 2, 10));
+	ASSERT_EQUAL("refs", 2, pool.getRefs());
+
+	ASSERT_EQUAL("release", false, pool.release(100));
+	ASSERT_EQUAL("release last", true, pool.release(100));
+	ASSERT_EQUAL("size", 0, pool.size());
+	ASSERT_EQUAL("bytes", 0, pool.getBytes());
+	ASSERT_EQUAL("freed", None, pool.get(tex, 10, 2));
+	ASSERT_EQUAL("unknown", false, pool.release(100));
+}
+
+/**
+ * 200 frames with the same border, only one pixmap is created.
+ */
+void
+TestPixmapPool::testShared(void)
+{
+	const PTexture *tex = reinterpret_cast<const PTexture*>(0x10);
+	PixmapPool pool;
+	pool.add(tex, 1000, 4, 100, 16000);
+	for (int i = 1; i < 200; i++) {
+		pool.get(tex, 1000, 4);
+	}
+	ASSERT_EQUAL("size", 1, pool.size());
+	ASSERT_EQUAL("refs", 200, pool.getRefs());
+	ASSERT_EQUAL("bytes", 16000, pool.getBytes());
+	ASSERT_EQUAL("saved", 199 * 16000, pool.getBytesSaved());
+
+	std::ostringstream os;
+	pool.dump(os);
+	ASSERT_EQUAL("dump",
+		     "pixmap pool: 1 pixmaps, 200 references, 15KB, "
+		     "3109KB saved by sharing\n", os.str());
+
+	pool.release(100);
+	ASSERT_EQUAL("saved", 198 * 16000, pool.getBytesSaved());
+}
+
+/**
+ * Removed textures are no longer returned, but referenced pixmaps are
+ * kept until released.
+ */
+void
+TestPixmapPool::testRemove(void)
+{
+	const PTexture *tex1 = reinterpret_cast<const PTexture*>(0x10);
+	const PTexture *tex2 = reinterpret_cast<const PTexture*>(0x20);
+	PixmapPool pool;
+	pool.add(tex1, 10, 2, 100, 80);
+	pool.add(tex1, 2, 10, 101, 80);
+	pool.add(tex2, 10, 2, 102, 80);
+
+	pool.remove(tex1);
+	ASSERT_EQUAL("removed", None, pool.get(tex1, 10, 2));
+	ASSERT_EQUAL("removed", None, pool.get(tex1, 2, 10));
+	ASSERT_EQUAL("kept", 102, pool.get(tex2, 10, 2));
+	ASSERT_EQUAL("size", 3, pool.size());
+
+	// new texture at the same address
+	pool.add(tex1, 10, 2, 103, 80);
+	ASSERT_EQUAL("release old", true, pool.release(100));
+	ASSERT_EQUAL("new", 103, pool.get(tex1, 10, 2));
+	ASSERT_EQUAL("release old", true, pool.release(101));
+	ASSERT_EQUAL("size", 2, pool.size());
+}
@@ -0,0 +1,80 @@
+//
+// test_SearchDialog.hh for pekwm
+// Copyright (C) 2023 Claes Nästén <pekdon@gmail.com>
+//
+// This program is licensed under the GNU GPL.
+// See the LICENSE file for more information.
+//
+
+#include "test.hh"
+#include "SearchDialog.hh"
+
+class TestSearchResult : public TestSuite {
+public:
+	TestSearchResult(void);
+	~TestSearchResult(void);
+
+	virtual bool run_test(TestSpec spec, bool status);
+
+private:
+	static void testUpdate(void);
+	static void testRepeatAfterClose(void);
+};
+
+TestSearchResult::TestSearchResult(void)
+	: TestSuite("SearchResult")
+{
+}
+
+TestSearchResult::~TestSearchResult(void)
+{
+}
+
+bool
+TestSearchResult::run_test(TestSpec spec, bool status)
+{
+	TEST_FN(spec, "update", testUpdate());
+	TEST_FN(spec, "repeatAfterClose", testRepeatAfterClose());
+	return status;
+}
+
+void
+TestSearchResult::testUpdate(void)
+{
+	// clients are only compared, never dereferenced
+	std::vector<Client*> clients;
+	clients.push_back(reinterpret_cast<Client*>(0x10));
+	clients.push_back(reinterpret_cast<Client*>(0x20));
+
+	SearchResult result;
+	ASSERT_EQUAL("initial", true, result.update(clients, 1));
+	ASSERT_EQUAL("same", false, result.update(clients, 1));
+	ASSERT_EQUAL("generation", true, result.update(clients, 2));
+
+	clients.pop_back();
+	ASSERT_EQUAL("clients", true, result.update(clients, 2));
+	ASSERT_EQUAL("clients", 1, result.clients().size());
+
+	// an empty search on a fresh result must still build the menu
+	SearchResult empty;
+	std::vector<Client*> none;
+	ASSERT_EQUAL("empty", true, empty.update(none, 1));
+}
+
+/**
+ * Closing the dialog lowers the result menu, searching for the same
+ * string again must rebuild it even though nothing changed.
+ */
+void
+TestSearchResult::testRepeatAfterClose(void)
+{
+	std::vector<Client*> clients;
+	clients.push_back(reinterpret_cast<Client*>(0x10));
+
+	SearchResult result;
+	ASSERT_EQUAL("search", true, result.update(clients, 1));
+	result.clear();
+	ASSERT_EQUAL("close", 0, result.clients().size());
+	ASSERT_EQUAL("repeat", true, result.update(clients, 1));
+	ASSERT_EQUAL("repeat", false, result.update(clients, 1));
+}
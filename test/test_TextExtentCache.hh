@@ -0,0 +1,96 @@
+//
+// test_TextExtentCache.hh for pekwm
+// Copyright (C) 2023 Claes Nästén <pekdon@gmail.com>
+//
+// This program is licensed under the GNU GPL.
+// See the LICENSE file for more information.
+//
+
+#include "test.hh"
+#include "tk/TextExtentCache.hh"
+
+class TestTextExtentCache : public TestSuite {
+public:
+	TestTextExtentCache(void);
+	~TestTextExtentCache(void);
+
+	bool run_test(TestSpec spec, bool status);
+
+private:
+	static void testGetPut(void);
+	static void testEvict(void);
+	static void testRemove(void);
+};
+
+TestTextExtentCache::TestTextExtentCache(void)
+	: TestSuite("TextExtentCache")
+{
+}
+
+TestTextExtentCache::~TestTextExtentCache(void)
+{
+}
+
+bool
+TestTextExtentCache::run_test(TestSpec spec, bool status)
+{
+	TEST_FN(spec, "getPut", testGetPut());
+	TEST_FN(spec, "evict", testEvict());
+	TEST_FN(spec, "remove", testRemove());
+	return status;
+}
+
+void
+TestTextExtentCache::testGetPut(void)
+{
+	const PFont *font = reinterpret_cast<const PFont*>(0x10);
+	TextExtentCache cache(4);
+	uint width = 0;
+	ASSERT_EQUAL("miss", false, cache.get(font, "text", width));
+	cache.put(font, "text", 42);
+	ASSERT_EQUAL("hit", true, cache.get(font, "text", width));
+	ASSERT_EQUAL("width", 42, width);
+	ASSERT_EQUAL("other font", false,
+		     cache.get(reinterpret_cast<const PFont*>(0x20), "text",
+			       width));
+	ASSERT_EQUAL("hits", 1, cache.getHits());
+	ASSERT_EQUAL("misses", 2, cache.getMisses());
+}
+
+void
+TestTextExtentCache::testEvict(void)
+{
+	const PFont *font = reinterpret_cast<const PFont*>(0x10);
+	TextExtentCache cache(2);
+	uint width;
+	cache.put(font, "a", 1);
+	cache.put(font, "b", 2);
+	// make a recently used, b is evicted instead
+	cache.get(font, "a", width);
+	cache.put(font, "c", 3);
+
+	ASSERT_EQUAL("size", 2, cache.size());
+	ASSERT_EQUAL("evictions", 1, cache.getEvictions());
+	ASSERT_EQUAL("a", true, cache.get(font, "a", width));
+	ASSERT_EQUAL("b", false, cache.get(font, "b", width));
+	ASSERT_EQUAL("c", true, cache.get(font, "c", width));
+}
+
+void
+TestTextExtentCache::testRemove(void)
+{
+	const PFont *font1 = reinterpret_cast<const PFont*>(0x10);
+	const PFont *font2 = reinterpret_cast<const PFont*>(0x20);
+	TextExtentCache cache(8);
+	uint width;
+	cache.put(font1, "", 0);
+	cache.put(font1, "a", 1);
+	cache.put(font2, "a", 2);
+	cache.put(font1, "b", 3);
+
+	cache.remove(font1);
+	ASSERT_EQUAL("size", 1, cache.size());
+	ASSERT_EQUAL("font1", false, cache.get(font1, "a", width));
+	ASSERT_EQUAL("font2", true, cache.get(font2, "a", width));
+	ASSERT_EQUAL("font2 width", 2, width);
+}
@@ -0,0 +1,110 @@
+//
+// test_ThreadPool.hh for pekwm
+// Copyright (C) 2023 Claes Nästén <pekdon@gmail.com>
+//
+// This program is licensed under the GNU GPL.
+// See the LICENSE file for more information.
+//
+
+#include "test.hh"
+#include "ThreadPool.hh"
+
+#include <vector>
+
+class TestThreadPool : public TestSuite {
+public:
+	TestThreadPool(void);
+	~TestThreadPool(void);
+
+	bool run_test(TestSpec spec, bool status);
+
+private:
+	static void testRun(void);
+	static void testSingle(void);
+	static void testNested(void);
+
+	static void incJob(size_t index, void *opaque);
+	static void nestedJob(size_t index, void *opaque);
+
+	struct Nested {
+		ThreadPool *pool;
+		std::vector<std::vector<int> > counts;
+	};
+};
+
+TestThreadPool::TestThreadPool(void)
+	: TestSuite("ThreadPool")
+{
+}
+
+TestThreadPool::~TestThreadPool(void)
+{
+}
+
+bool
+TestThreadPool::run_test(TestSpec spec, bool status)
+{
+	TEST_FN(spec, "run", testRun());
+	TEST_FN(spec, "single", testSingle());
+	TEST_FN(spec, "nested", testNested());
+	return status;
+}
+
+void
+TestThreadPool::testRun(void)
+{
+	ThreadPool pool(4);
+	ASSERT_TRUE("size", pool.size() >= 1 && pool.size() <= 4);
+
+	std::vector<int> counts(100, 0);
+	// run twice, workers are re-used between runs
+	pool.run(counts.size(), incJob, &counts);
+	pool.run(counts.size(), incJob, &counts);
+	for (size_t i = 0; i < counts.size(); i++) {
+		ASSERT_EQUAL("count", 2, counts[i]);
+	}
+
+	pool.run(0, incJob, &counts);
+}
+
+void
+TestThreadPool::testSingle(void)
+{
+	ThreadPool pool(1);
+	ASSERT_EQUAL("size", 1, pool.size());
+
+	std::vector<int> counts(3, 0);
+	pool.run(counts.size(), incJob, &counts);
+	ASSERT_EQUAL("0", 1, counts[0]);
+	ASSERT_EQUAL("2", 1, counts[2]);
+}
+
+void
+TestThreadPool::testNested(void)
+{
+	ThreadPool pool(4);
+	Nested nested;
+	nested.pool = &pool;
+	nested.counts.resize(8, std::vector<int>(10, 0));
+	pool.run(nested.counts.size(), nestedJob, &nested);
+	for (size_t i = 0; i < nested.counts.size(); i++) {
+		for (size_t j = 0; j < nested.counts[i].size(); j++) {
+			ASSERT_EQUAL("count", 1, nested.counts[i][j]);
+		}
+	}
+}
+
+void
+TestThreadPool::incJob(size_t index, void *opaque)
+{
+	std::vector<int> *counts = static_cast<std::vector<int>*>(opaque);
+	(*counts)[index]++;
+}
+
+void
+TestThreadPool::nestedJob(size_t index, void *opaque)
+{
+	Nested *nested = static_cast<Nested*>(opaque);
+	std::vector<int> &counts = nested->counts[index];
+	nested->pool->run(counts.size(), incJob, &counts);
+}
@@ -0,0 +1,174 @@
+//
+// test_TitleIndex.hh for pekwm
+// Copyright (C) 2023 Claes Nästén <pekdon@gmail.com>
+//
+// This program is licensed under the GNU GPL.
+// See the LICENSE file for more information.
+//
+
+#include "test.hh"
+#include "TitleIndex.hh"
+
+extern "C" {
+#include <locale.h>
+}
+
+class TestTitleIndex : public TestSuite {
+public:
+	TestTitleIndex(void);
+	~TestTitleIndex(void);
+
+	bool run_test(TestSpec spec, bool status);
+
+private:
+	static void testMatch(void);
+	static void testSearchRanked(void);
+	static void testSearchRefine(void);
+	static void testSearchLocale(void);
+};
+
+TestTitleIndex::TestTitleIndex(void)
+	: TestSuite("TitleIndex")
+{
+}
+
+TestTitleIndex::~TestTitleIndex(void)
+{
+}
+
+bool
+TestTitleIndex::run_test(TestSpec spec, bool status)
+{
+	TEST_FN(spec, "match", testMatch());
+	TEST_FN(spec, "searchRanked", testSearchRanked());
+	TEST_FN(spec, "searchRefine", testSearchRefine());
+	TEST_FN(spec, "searchLocale", testSearchLocale());
+	return status;
+}
+
+void
+TestTitleIndex::testMatch(void)
+{
+	ASSERT_EQUAL("prefix", TitleIndex::MATCH_PREFIX,
+		     TitleIndex::match("xterm", "xt"));
+	ASSERT_EQUAL("word", TitleIndex::MATCH_WORD,
+		     TitleIndex::match("mail - inbox", "inb"));
+	ASSERT_EQUAL("word after substring", TitleIndex::MATCH_WORD,
+		     TitleIndex::match("inboxes box", "box"));
+	ASSERT_EQUAL("substring", TitleIndex::MATCH_SUBSTRING,
+		     TitleIndex::match("xterm", "term"));
+	ASSERT_EQUAL("fuzzy", TitleIndex::MATCH_FUZZY,
+		     TitleIndex::match("firefox", "ffx"));
+	ASSERT_EQUAL("none", TitleIndex::MATCH_NONE,
+		     TitleIndex::match("firefox", "fxf"));
+	ASSERT_EQUAL("fold", std::string("xterm räksmörgås"),
+		     TitleIndex::fold("XTerm Räksmörgås"));
+	ASSERT_EQUAL("literal", true, TitleIndex::isLiteral("x term"));
+	ASSERT_EQUAL("regex", false, TitleIndex::isLiteral("x.*term"));
+}
+
+void
+TestTitleIndex::testSearchRanked(void)
+{
+	Client *c1 = reinterpret_cast<Client*>(0x10);
+	Client *c2 = reinterpret_cast<Client*>(0x20);
+	Client *c3 = reinterpret_cast<Client*>(0x30);
+	Client *c4 = reinterpret_cast<Client*>(0x40);
+	Client *c5 = reinterpret_cast<Client*>(0x50);
+
+	TitleIndex index;
+	index.add(c1, "Fuzzy Term Match");
+	index.add(c2, "Subterm");
+	index.add(c3, "XTerm - Term");
+	index.add(c4, "Term");
+	index.add(c5, "Emacs");
+
+	TitleIndex::Search search;
+	std::vector<Client*> result;
+	index.search(search, "TERM", result);
+	ASSERT_EQUAL("size", 4, result.size());
+	ASSERT_EQUAL("prefix", c4, result[0]);
+	ASSERT_EQUAL("word 1", c1, result[1]);
+	ASSERT_EQUAL("word 2", c3, result[2]);
+	ASSERT_EQUAL("substring", c2, result[3]);
+
+	index.search(search, "ftm", result);
+	ASSERT_EQUAL("fuzzy size", 1, result.size());
+	ASSERT_EQUAL("fuzzy", c1, result[0]);
+
+	index.search(search, "", result);
+	ASSERT_EQUAL("empty", 0, result.size());
+}
+
+void
+TestTitleIndex::testSearchRefine(void)
+{
+	Client *c1 = reinterpret_cast<Client*>(0x10);
+	Client *c2 = reinterpret_cast<Client*>(0x20);
+
+	TitleIndex index;
+	index.add(c1, "abc");
+	index.add(c2, "xyz");
+
+	TitleIndex::Search search;
+	std::vector<Client*> result;
+	index.search(search, "a", result);
+	ASSERT_EQUAL("a", 1, result.size());
+
+	// c2 re-titled, refining without noticing the change would miss it
+	index.update(c2, "abd");
+	index.search(search, "ab", result);
+	ASSERT_EQUAL("updated", 2, result.size());
+
+	// refine, c2 no longer matching
+	index.search(search, "abc", result);
+	ASSERT_EQUAL("refined", 1, result.size());
+	ASSERT_EQUAL("refined client", c1, result[0]);
+
+	// shorter query is not refined
+	index.search(search, "ab", result);
+	ASSERT_EQUAL("shorter", 2, result.size());
+
+	index.remove(c1);
+	index.search(search, "ab", result);
+	ASSERT_EQUAL("removed", 1, result.size());
+	ASSERT_EQUAL("removed client", c2, result[0]);
+	ASSERT_EQUAL("index size", 1, index.size());
+}
+
+/**
+ * Non-ASCII titles and queries are folded using the locale.
+ */
+void
+TestTitleIndex::testSearchLocale(void)
+{
+	std::string prev_locale = setlocale(LC_CTYPE, nullptr);
+	if (setlocale(LC_CTYPE, "C.UTF-8") == nullptr) {
+		std::cout << "# no C.UTF-8 locale, skipping" << std::endl;
+		return;
+	}
+
+	Client *c1 = reinterpret_cast<Client*>(0x10);
+	Client *c2 = reinterpret_cast<Client*>(0x20);
+
+	TitleIndex index;
+	index.add(c1, "Räksmörgås");
+	index.add(c2, "ÖVERSIKT - ΣΟΦΙΑ");
+
+	TitleIndex::Search search;
+	std::vector<Client*> prefix, word, greek;
+	index.search(search, "RÄKSMÖ", prefix);
+	index.search(search, "översikt", word);
+	index.search(search, "σοφ", greek);
+	std::string folded = TitleIndex::fold("ÅÄÖ Σοφία ČŽ");
+
+	setlocale(LC_CTYPE, prev_locale.c_str());
+
+	ASSERT_EQUAL("fold", std::string("åäö σοφία čž"), folded);
+	ASSERT_EQUAL("prefix size", 1, prefix.size());
+	ASSERT_EQUAL("prefix", c1, prefix[0]);
+	ASSERT_EQUAL("upper title size", 1, word.size());
+	ASSERT_EQUAL("upper title", c2, word[0]);
+	ASSERT_EQUAL("word size", 1, greek.size());
+	ASSERT_EQUAL("word", c2, greek[0]);
+}
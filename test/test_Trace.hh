@@ -0,0 +1,179 @@
+//
+// test_Trace.hh for pekwm
+// Copyright (C) 2023 Claes Nästén <pekdon@gmail.com>
+//
+// This program is licensed under the GNU GPL.
+// See the LICENSE file for more information.
+//
+
+#include "test.hh"
+#include "Trace.hh"
+
+class TestTrace : public TestSuite {
+public:
+	TestTrace(void);
+	virtual ~TestTrace(void);
+
+	virtual bool run_test(TestSpec spec, bool status);
+
+private:
+	static void testRecord(void);
+	static void testRing(void);
+	static void testDisabled(void);
+	static void testLongDuration(void);
+	static void testEventQueue(void);
+
+	static void recordDuration(Trace::Kind kind, uint type, uint us);
+};
+
+TestTrace::TestTrace(void)
+	: TestSuite("Trace")
+{
+}
+
+TestTrace::~TestTrace(void)
+{
+	Trace::reset();
+	Trace::setEnabled(true);
+}
+
+bool
+TestTrace::run_test(TestSpec spec, bool status)
+{
+	TEST_FN(spec, "record", testRecord());
+	TEST_FN(spec, "ring", testRing());
+	TEST_FN(spec, "disabled", testDisabled());
+	TEST_FN(spec, "longDuration", testLongDuration());
+	TEST_FN(spec, "eventQueue", testEventQueue());
+	return status;
+}
+
+void
+TestTrace::testRecord(void)
+{
+	Trace::reset();
+	recordDuration(Trace::KIND_DISPATCH, 20, 0);
+	recordDuration(Trace::KIND_DISPATCH, 20, 3);
+	recordDuration(Trace::KIND_DISPATCH, 20, 3);
+	recordDuration(Trace::KIND_DISPATCH, 20, 100);
+	recordDuration(Trace::KIND_DISPATCH, 1000, 1);
+
+	ASSERT_EQUAL("count", 4, Trace::getCount(Trace::KIND_DISPATCH, 20));
+	ASSERT_EQUAL("other kind", 0, Trace::getCount(Trace::KIND_EVENT, 20));
+	ASSERT_EQUAL("clamped type", 1,
+		     Trace::getCount(Trace::KIND_DISPATCH,
+				     Trace::TYPE_MAX - 1));
+	ASSERT_EQUAL("bucket <1us", 1,
+		     Trace::getBucket(Trace::KIND_DISPATCH, 20, 0));
+	// 3us in [2, 4)
+	ASSERT_EQUAL("bucket 2-4us", 2,
+		     Trace::getBucket(Trace::KIND_DISPATCH, 20, 2));
+	// 100us in [64, 128)
+	ASSERT_EQUAL("bucket 64-128us", 1,
+		     Trace::getBucket(Trace::KIND_DISPATCH, 20, 7));
+	ASSERT_EQUAL("p50", 4,
+		     Trace::getPercentile(Trace::KIND_DISPATCH, 20, 50));
+	ASSERT_EQUAL("p99", 128,
+		     Trace::getPercentile(Trace::KIND_DISPATCH, 20, 99));
+}
+
+void
+TestTrace::testRing(void)
+{
+	Trace::reset();
+	for (uint i = 0; i < Trace::RING_SIZE + 10; i++) {
+		recordDuration(Trace::KIND_ACTION, i % 100, 0);
+	}
+
+	ASSERT_EQUAL("size", Trace::RING_SIZE, Trace::size());
+	Trace::Record rec;
+	ASSERT_TRUE("oldest", Trace::getRecord(0, rec));
+	ASSERT_EQUAL("oldest type", 10, rec.type);
+	ASSERT_EQUAL("oldest kind", Trace::KIND_ACTION, rec.kind);
+	ASSERT_TRUE("newest", Trace::getRecord(Trace::RING_SIZE - 1, rec));
+	ASSERT_EQUAL("newest type", (Trace::RING_SIZE + 9) % 100, rec.type);
+	ASSERT_EQUAL("out of range", false,
+		     Trace::getRecord(Trace::RING_SIZE, rec));
+}
+
+void
+TestTrace::testDisabled(void)
+{
+	Trace::reset();
+	Trace::setEnabled(false);
+	{
+		Trace::Scope scope(Trace::KIND_RENDER, Trace::RENDER_TITLE);
+	}
+	Trace::setEnabled(true);
+	ASSERT_EQUAL("disabled", 0, Trace::size());
+
+	{
+		Trace::Scope scope(Trace::KIND_RENDER, Trace::RENDER_TITLE);
+	}
+	ASSERT_EQUAL("enabled", 1,
+		     Trace::getCount(Trace::KIND_RENDER,
+				     Trace::RENDER_TITLE));
+}
+
+/**
+ * Durations above 4.29s used to be clamped to 32 bits.
+ */
+void
+TestTrace::testLongDuration(void)
+{
+	Trace::reset();
+	recordDuration(Trace::KIND_EVENT, 1, 5000000);
+
+	Trace::Record rec;
+	ASSERT_TRUE("record", Trace::getRecord(0, rec));
+	ASSERT_TRUE("duration",
+		    rec.duration_ns >= static_cast<uint64_t>(5000) * 1000000);
+	ASSERT_EQUAL("bucket", 1,
+		     Trace::getBucket(Trace::KIND_EVENT, 1,
+				      Trace::BUCKETS - 1));
+}
+
+void
+TestTrace::testEventQueue(void)
+{
+	struct timespec t1 = { 1, 0 };
+	struct timespec t2 = { 2, 0 };
+	struct timespec t3 = { 3, 0 };
+	struct timespec read;
+
+	Trace::EventQueue queue;
+	queue.update(2, t1);
+	queue.update(2, t2);
+	queue.pop(read);
+	ASSERT_EQUAL("first batch", 1, read.tv_sec);
+	ASSERT_EQUAL("size", 1, queue.size());
+
+	// two events read while handling, one taken without pop
+	queue.update(3, t2);
+	queue.update(2, t3);
+	queue.pop(read);
+	ASSERT_EQUAL("dropped oldest", 2, read.tv_sec);
+	queue.pop(read);
+	ASSERT_EQUAL("second batch", 2, read.tv_sec);
+	ASSERT_EQUAL("empty", 0, queue.size());
+
+	// events not seen by update are read now
+	queue.pop(read);
+	ASSERT_TRUE("unknown", read.tv_sec > 3);
+}
+
+/**
+ * Record trace with a start time us microseconds before now.
+ */
+void
+TestTrace::recordDuration(Trace::Kind kind, uint type, uint us)
+{
+	struct timespec start;
+	Trace::now(start);
+	long nsec = start.tv_nsec - static_cast<long>(us) * 1000;
+	for (; nsec < 0; nsec += 1000000000) {
+		start.tv_sec--;
+	}
+	start.tv_nsec = nsec;
+	Trace::record(kind, type, start);
+}
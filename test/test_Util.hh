@@ -157,6 +157,7 @@ public:
 	virtual bool run_test(TestSpec spec, bool status);
 
 	static void testSplitString(void);
+	static void testStringToIndex(void);
 	static void assertSplitString(const std::string& msg,
 				      uint e_ret,
 				      std::vector<std::string> e_toks,
@@ -170,6 +171,7 @@ bool
 TestUtil::run_test(TestSpec spec, bool status)
 {
 	TEST_FN(spec, "splitString", testSplitString());
+	TEST_FN(spec, "StringToIndex", testStringToIndex());
 	return status;
 }
 
@@ -186,6 +188,48 @@ TestUtil::testSplitString(void)
 	assertSplitString("no limit", 3, no_limit, "1,2,3", ",");
 }
 
+void
+TestUtil::testStringToIndex(void)
+{
+	Util::StringTo<int> entries[] =
+		{{"Focus", 1},
+		 {"UnFocus", 2},
+		 {"focus", 3},
+		 {"Raise", 4},
+		 {"Lower", 5},
+		 {nullptr, -1}};
+	Util::StringToIndex<int> index(entries);
+
+	ASSERT_EQUAL("exact", 2, Util::StringToGet(index, "UnFocus"));
+	ASSERT_EQUAL("ignore case", 4, Util::StringToGet(index, "rAISE"));
+	ASSERT_EQUAL("duplicate, first wins", 1,
+		     Util::StringToGet(index, "FOCUS"));
+	ASSERT_EQUAL("missing", -1, Util::StringToGet(index, "Focu"));
+	ASSERT_EQUAL("empty", -1, Util::StringToGet(index, ""));
+
+	Util::StringTo<int> empty_entries[] = {{nullptr, 0}};
+	Util::StringToIndex<int> empty(empty_entries);
+	ASSERT_EQUAL("empty table", 0, Util::StringToGet(empty, "Focus"));
+
+	// all entries of a table must be found with a single comparison
+	Util::StringTo<int> many[101];
+	std::vector<std::string> names;
+	for (int i = 0; i < 100; i++) {
+		names.push_back("Name" + std::to_string(i));
+	}
+	for (int i = 0; i < 100; i++) {
+		many[i].name = names[i].c_str();
+		many[i].value = i;
+	}
+	many[100].name = nullptr;
+	many[100].value = -1;
+	Util::StringToIndex<int> many_index(many);
+	for (int i = 0; i < 100; i++) {
+		ASSERT_EQUAL(names[i], i,
+			     Util::StringToGet(many_index, names[i]));
+	}
+}
+
 void
 TestUtil::assertSplitString(const std::string& msg,
 			    uint e_ret, std::vector<std::string> e_toks,
@@ -28,7 +28,7 @@ public:
 
 	void testRecvPekwmCmd(void);
 	void assertSendRecvCommand(const std::string& msg, size_t expected_size,
-				   const std::string& cmd);
+				   const std::string& cmd, bool batch = false);
 };
 
 TestWindowManager::TestWindowManager(void)
@@ -55,6 +55,10 @@ TestWindowManager::testRecvPekwmCmd(void)
 	assertSendRecvCommand("2 messages", 2, "012345678901234578 two");
 	assertSendRecvCommand("3 messages", 3,
 			      "012345678901234578012345678901234578 three");
+	assertSendRecvCommand("batch 1 message", 1, "Raise\nLower", true);
+	assertSendRecvCommand("batch 2 messages", 2,
+			      "GoToWorkspace 2\nRaise\nLower", true);
+	assertSendRecvCommand("after batch", 1, "Raise");
 }
 
 static bool
@@ -78,10 +82,11 @@ static bool send_message(Window, AtomName, int,
 void
 TestWindowManager::assertSendRecvCommand(const std::string& msg,
 					 size_t expected_size,
-					 const std::string& cmd)
+					 const std::string& cmd, bool batch)
 {
 	std::vector<XClientMessageEvent> evs;
-	sendCommand(cmd, None, send_message, reinterpret_cast<void*>(&evs));
+	sendCommand(cmd, None, send_message, reinterpret_cast<void*>(&evs),
+		    batch);
 	ASSERT_EQUAL(msg + " sendCommand", expected_size, evs.size());
 	std::vector<XClientMessageEvent>::iterator it = evs.begin();
 	for (; it != evs.end(); ++it) {
@@ -90,4 +95,5 @@ TestWindowManager::assertSendRecvCommand(const std::string& msg,
 			     expected, recvPekwmCmd(&(*it)));
 	}
 	ASSERT_EQUAL(msg, cmd, _pekwm_cmd_buf);
+	ASSERT_EQUAL(msg + " batch", batch, _pekwm_cmd_batch);
 }
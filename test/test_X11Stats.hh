@@ -0,0 +1,174 @@
+//
+// test_X11Stats.hh for pekwm
+// Copyright (C) 2023 Claes Nästén <pekdon@gmail.com>
+//
+// This program is licensed under the GNU GPL.
+// See the LICENSE file for more information.
+//
+
+#include "test.hh"
+#include "Trace.hh"
+#include "X11Stats.hh"
+
+#include <sstream>
+
+class TestX11Stats : public TestSuite {
+public:
+	TestX11Stats(void);
+	virtual ~TestX11Stats(void);
+
+	virtual bool run_test(TestSpec spec, bool status);
+
+private:
+	static void testCount(void);
+	static void testRequestBytes(void);
+	static void testScope(void);
+	static void testDisabled(void);
+	static void testDump(void);
+
+	static X11Stats::Site _request;
+	static X11Stats::Site _round_trip;
+};
+
+X11Stats::Site TestX11Stats::_request("testRequest", X11Stats::REQUEST);
+X11Stats::Site TestX11Stats::_round_trip("testRoundTrip",
+					  X11Stats::ROUND_TRIP);
+
+TestX11Stats::TestX11Stats(void)
+	: TestSuite("X11Stats")
+{
+}
+
+TestX11Stats::~TestX11Stats(void)
+{
+	X11Stats::reset();
+	X11Stats::setEnabled(true);
+	X11Stats::setEvent(-1);
+}
+
+bool
+TestX11Stats::run_test(TestSpec spec, bool status)
+{
+	TEST_FN(spec, "count", testCount());
+	TEST_FN(spec, "requestBytes", testRequestBytes());
+	TEST_FN(spec, "scope", testScope());
+	TEST_FN(spec, "disabled", testDisabled());
+	TEST_FN(spec, "dump", testDump());
+	return status;
+}
+
+void
+TestX11Stats::testCount(void)
+{
+	X11Stats::reset();
+	_request.inc();
+	X11Stats::setEvent(PropertyNotify);
+	ASSERT_EQUAL("event", PropertyNotify, X11Stats::getEvent());
+	_request.inc();
+	_round_trip.inc(100);
+	_round_trip.inc(28);
+	X11Stats::setEvent(-1);
+	ASSERT_EQUAL("no event", -1, X11Stats::getEvent());
+
+	ASSERT_EQUAL("requests", 2, X11Stats::getCount(X11Stats::REQUEST));
+	ASSERT_EQUAL("round trips", 2,
+		     X11Stats::getCount(X11Stats::ROUND_TRIP));
+	ASSERT_EQUAL("site", 2, X11Stats::getCount("testRoundTrip"));
+	ASSERT_EQUAL("site bytes", 128, _round_trip.getBytes());
+	ASSERT_EQUAL("bytes", 128, X11Stats::getBytes());
+	ASSERT_EQUAL("site no event", 1,
+		     _request.getCount(X11Stats::EVENT_NONE));
+	ASSERT_EQUAL("site event", 1, _request.getCount(PropertyNotify));
+	ASSERT_EQUAL("site other event", 0,
+		     _request.getCount(ConfigureRequest));
+
+	X11Stats::reset();
+	ASSERT_EQUAL("reset", 0, X11Stats::getCount(X11Stats::REQUEST));
+	ASSERT_EQUAL("reset site", 0, _round_trip.getCount(PropertyNotify));
+	ASSERT_EQUAL("reset bytes", 0, X11Stats::getBytes());
+}
+
+/**
+ * Bytes transferred by requests, such as copied back buffer areas, are
+ * kept per site and not included in the bytes received.
+ */
+void
+TestX11Stats::testRequestBytes(void)
+{
+	X11Stats::reset();
+	_request.inc(4096);
+	_request.inc(1024);
+	ASSERT_EQUAL("site bytes", 5120, _request.getBytes());
+	ASSERT_EQUAL("received bytes", 0, X11Stats::getBytes());
+}
+
+/**
+ * Requests are attributed to the innermost trace scope, telling
+ * which dispatch, action or rendering made them.
+ */
+void
+TestX11Stats::testScope(void)
+{
+	X11Stats::reset();
+	_round_trip.inc();
+	{
+		Trace::Scope dispatch(Trace::KIND_DISPATCH, PropertyNotify);
+		_round_trip.inc();
+		{
+			Trace::Scope render(Trace::KIND_RENDER,
+					    Trace::RENDER_TITLE);
+			_round_trip.inc();
+			_round_trip.inc();
+		}
+		_round_trip.inc();
+	}
+
+	ASSERT_EQUAL("count", 5, _round_trip.getCount());
+	ASSERT_EQUAL("dispatch", 2,
+		     _round_trip.getScopeCount(Trace::KIND_DISPATCH,
+					       PropertyNotify));
+	ASSERT_EQUAL("render", 2,
+		     _round_trip.getScopeCount(Trace::KIND_RENDER,
+					       Trace::RENDER_TITLE));
+	ASSERT_EQUAL("outside scopes", Trace::KIND_NO,
+		     Trace::getScopeKind());
+
+	std::ostringstream os;
+	X11Stats::dump(os, nullptr);
+	ASSERT_TRUE("dump",
+		    os.str().find("render:title=2") != std::string::npos);
+	ASSERT_TRUE("dump",
+		    os.str().find("dispatch:PropertyNotify=2")
+		    != std::string::npos);
+}
+
+void
+TestX11Stats::testDisabled(void)
+{
+	X11Stats::reset();
+	X11Stats::setEnabled(false);
+	_request.inc();
+	X11Stats::setEnabled(true);
+	ASSERT_EQUAL("disabled", 0, X11Stats::getCount(X11Stats::REQUEST));
+}
+
+void
+TestX11Stats::testDump(void)
+{
+	X11Stats::reset();
+	X11Stats::setEvent(MapRequest);
+	_round_trip.inc();
+	X11Stats::setEvent(-1);
+
+	std::ostringstream os;
+	X11Stats::dump(os, nullptr);
+	std::string dump = os.str();
+	ASSERT_TRUE("totals",
+		    dump.find("0 requests, 1 round trips") != std::string::npos);
+	ASSERT_TRUE("site",
+		    dump.find("testRoundTrip") != std::string::npos);
+	ASSERT_TRUE("event",
+		    dump.find("MapRequest=1") != std::string::npos);
+	ASSERT_TRUE("unused site",
+		    dump.find("testRequest") == std::string::npos);
+}
@@ -15,15 +15,30 @@
 #include "test_Action.hh"
 #include "test_Config.hh"
 #include "test_FontHandler.hh"
+#include "test_ImageCache.hh"
+#include "test_ImageColorMap.hh"
 #include "test_Frame.hh"
 #include "test_InputDialog.hh"
 #include "test_ManagerWindows.hh"
 #include "test_Observable.hh"
 #include "test_PFont.hh"
+#include "test_PImage.hh"
+#include "test_PImageIcon.hh"
+#include "test_PMenu.hh"
+#include "test_PixmapPool.hh"
+#ifdef PEKWM_HAVE_IMAGE_JPEG
+#include "test_PImageLoaderJpeg.hh"
+#endif // PEKWM_HAVE_IMAGE_JPEG
+#ifdef PEKWM_HAVE_IMAGE_PNG
+#include "test_PImageLoaderPng.hh"
+#endif // PEKWM_HAVE_IMAGE_PNG
 #ifdef PEKWM_HAVE_PANGO
 #include "test_PFontPango.hh"
 #endif // PEKWM_HAVE_PANGO
 #include "test_PFontXmb.hh"
+#include "test_SearchDialog.hh"
+#include "test_TextExtentCache.hh"
+#include "test_TitleIndex.hh"
 #include "test_Theme.hh"
 #include "test_WindowManager.hh"
 #include "test_X11.hh"
@@ -40,6 +55,7 @@ main_tests(int argc, char *argv[])
 	// Action
 	TestAction testAction;
 	TestActionConfig testActionConfig;
+	TestActionCache testActionCache;
 
 	// Config
 	TestConfig testConfig;
@@ -47,6 +63,12 @@ main_tests(int argc, char *argv[])
 	// Frame
 	TestFrame testFrame;
 
+	// ImageCache
+	TestImageCache testImageCache;
+
+	// ImageColorMap
+	TestImageColorMap testImageColorMap;
+
 	// InputDialog
 	TestInputBuffer testInputBuffer;
 
@@ -66,6 +88,35 @@ main_tests(int argc, char *argv[])
 #endif // PEKWM_HAVE_PANGO
 	TestPFontXmb testPFontXmb;
 
+	// PImage
+	TestPImage testPImage;
+
+	// PImageIcon
+	TestPImageIcon testPImageIcon;
+
+	// PMenu
+	TestPMenu testPMenu;
+
+	// PixmapPool
+	TestPixmapPool testPixmapPool;
+
+	// PImageLoaderJpeg
+#ifdef PEKWM_HAVE_IMAGE_JPEG
+	TestPImageLoaderJpeg testPImageLoaderJpeg;
+#endif // PEKWM_HAVE_IMAGE_JPEG
+
+	// PImageLoaderPng
+#ifdef PEKWM_HAVE_IMAGE_PNG
+	TestPImageLoaderPng testPImageLoaderPng;
+#endif // PEKWM_HAVE_IMAGE_PNG
+	TestTextExtentCache testTextExtentCache;
+
+	// SearchDialog
+	TestSearchResult testSearchResult;
+
+	// TitleIndex
+	TestTitleIndex testTitleIndex;
+
 	// Theme
 	TestTheme testTheme;
 
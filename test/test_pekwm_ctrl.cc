@@ -92,6 +92,20 @@ TestPekwmCtrl::testSendCmd(void)
 	ASSERT_EQUAL("send 3 op 2", 2, bufs[1].second);
 	ASSERT_EQUAL("send 3 buf 3", "89", bufs[2].first);
 	ASSERT_EQUAL("send 3 op 3", 3, bufs[2].second);
+
+	// batch, flag set on the first message only
+	bufs.clear();
+	sendCommand("Raise\nLower", None, send_message, vbufs, true);
+	ASSERT_EQUAL("batch 1", 1, bufs.size());
+	ASSERT_EQUAL("batch 1 op", 4, bufs[0].second);
+
+	bufs.clear();
+	sendCommand("GoToWorkspace 2\nRaise", None, send_message, vbufs,
+		    true);
+	ASSERT_EQUAL("batch 2", 2, bufs.size());
+	ASSERT_EQUAL("batch 2 buf 1", "GoToWorkspace 2\nRai", bufs[0].first);
+	ASSERT_EQUAL("batch 2 op 1", 5, bufs[0].second);
+	ASSERT_EQUAL("batch 2 op 2", 3, bufs[1].second);
 }
 
 int
@@ -14,8 +14,11 @@
 #include "test_Charset.hh"
 #include "test_RegexString.hh"
 #include "test_String.hh"
+#include "test_ThreadPool.hh"
 #include "test_Tokenizer.hh"
+#include "test_Trace.hh"
 #include "test_Util.hh"
+#include "test_X11Stats.hh"
 
 int
 main(int argc, char *argv[])
@@ -26,7 +29,10 @@ main(int argc, char *argv[])
 	TestCharset testCharset;
 	TestRegexString testRegexString;
 	TestString testString;
+	TestThreadPool testThreadPool;
 	TestTokenizer testTokenizer;
+	TestTrace testTrace;
+	TestX11Stats testX11Stats;
 
 	// Util
 	TestGenerator testGenerator;